@@ -7,6 +7,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "include/dart_api.h"
 
@@ -23,6 +24,45 @@ namespace bin {
   extern void FUNCTION_NAME(name)(Dart_NativeArguments args);
 
 
+// An entry of a table of native functions. The tables are sorted by name in
+// strcmp order, so that natives are resolved by binary search.
+struct NativeEntry {
+  const char* name_;
+  Dart_NativeFunction function_;
+  int argument_count_;
+};
+
+
+// Returns the function of the entry with the given name and argument count
+// in a sorted table of num_entries entries, or NULL.
+inline Dart_NativeFunction FindNativeEntry(const NativeEntry* entries,
+                                           intptr_t num_entries,
+                                           const char* name,
+                                           int argument_count) {
+  intptr_t lo = 0;
+  intptr_t hi = num_entries;
+  while (lo < hi) {
+    const intptr_t mid = lo + (hi - lo) / 2;
+    const int result = strcmp(entries[mid].name_, name);
+    if (result < 0) {
+      lo = mid + 1;
+    } else if (result > 0) {
+      hi = mid;
+    } else {
+      return (entries[mid].argument_count_ == argument_count) ?
+          entries[mid].function_ : NULL;
+    }
+  }
+#if defined(DEBUG)
+  // A missing entry may also be due to a table that is out of order.
+  for (intptr_t i = 1; i < num_entries; i++) {
+    ASSERT(strcmp(entries[i - 1].name_, entries[i].name_) < 0);
+  }
+#endif  // defined(DEBUG)
+  return NULL;
+}
+
+
 class Builtin {
  public:
   // Note: Changes to this enum should be accompanied with changes to
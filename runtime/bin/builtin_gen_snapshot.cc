@@ -19,11 +19,7 @@ namespace bin {
 
 BUILTIN_NATIVE_LIST(DECLARE_FUNCTION);
 
-static struct NativeEntries {
-  const char* name_;
-  Dart_NativeFunction function_;
-  int argument_count_;
-} BuiltinEntries[] = {
+static const NativeEntry BuiltinEntries[] = {
   BUILTIN_NATIVE_LIST(REGISTER_FUNCTION)
 };
 
@@ -37,15 +33,10 @@ Dart_NativeFunction Builtin::NativeLookup(Dart_Handle name,
   ASSERT(function_name != NULL);
   ASSERT(auto_setup_scope != NULL);
   *auto_setup_scope = true;
-  int num_entries = sizeof(BuiltinEntries) / sizeof(struct NativeEntries);
-  for (int i = 0; i < num_entries; i++) {
-    struct NativeEntries* entry = &(BuiltinEntries[i]);
-    if (!strcmp(function_name, entry->name_) &&
-        (entry->argument_count_ == argument_count)) {
-      return reinterpret_cast<Dart_NativeFunction>(entry->function_);
-    }
-  }
-  return NULL;
+  return FindNativeEntry(BuiltinEntries,
+                         sizeof(BuiltinEntries) / sizeof(BuiltinEntries[0]),
+                         function_name,
+                         argument_count);
 }
 
 
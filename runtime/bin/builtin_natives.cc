@@ -21,62 +21,59 @@ namespace bin {
 // Lists the native functions implementing basic functionality in
 // standalone dart, such as printing, file I/O, and platform information.
 // Advanced I/O classes like sockets and process management are implemented
-// using functions listed in io_natives.cc.
+// using functions listed in io_natives.cc. The list is sorted by name.
 #define BUILTIN_NATIVE_LIST(V)                                                 \
-  V(Directory_Exists, 1)                                                       \
   V(Directory_Create, 1)                                                       \
-  V(Directory_Current, 0)                                                      \
-  V(Directory_SetCurrent, 1)                                                   \
-  V(Directory_SystemTemp, 0)                                                   \
   V(Directory_CreateTemp, 1)                                                   \
+  V(Directory_Current, 0)                                                      \
   V(Directory_Delete, 2)                                                       \
-  V(Directory_Rename, 2)                                                       \
+  V(Directory_Exists, 1)                                                       \
   V(Directory_List, 3)                                                         \
-  V(File_Open, 2)                                                              \
-  V(File_Exists, 1)                                                            \
+  V(Directory_Rename, 2)                                                       \
+  V(Directory_SetCurrent, 1)                                                   \
+  V(Directory_SystemTemp, 0)                                                   \
+  V(FileSystemWatcher_CloseWatcher, 1)                                         \
+  V(FileSystemWatcher_GetSocketId, 2)                                          \
+  V(FileSystemWatcher_InitWatcher, 0)                                          \
+  V(FileSystemWatcher_IsSupported, 0)                                          \
+  V(FileSystemWatcher_ReadEvents, 2)                                           \
+  V(FileSystemWatcher_UnwatchPath, 2)                                          \
+  V(FileSystemWatcher_WatchPath, 4)                                            \
+  V(File_AreIdentical, 2)                                                      \
   V(File_Close, 1)                                                             \
-  V(File_ReadByte, 1)                                                          \
-  V(File_WriteByte, 2)                                                         \
-  V(File_Read, 2)                                                              \
-  V(File_ReadInto, 4)                                                          \
-  V(File_WriteFrom, 4)                                                         \
-  V(File_Position, 1)                                                          \
-  V(File_SetPosition, 2)                                                       \
-  V(File_Truncate, 2)                                                          \
-  V(File_Length, 1)                                                            \
-  V(File_LengthFromPath, 1)                                                    \
-  V(File_Stat, 1)                                                              \
-  V(File_LastModified, 1)                                                      \
-  V(File_Flush, 1)                                                             \
+  V(File_Copy, 2)                                                              \
   V(File_Create, 1)                                                            \
   V(File_CreateLink, 2)                                                        \
-  V(File_LinkTarget, 1)                                                        \
   V(File_Delete, 1)                                                            \
   V(File_DeleteLink, 1)                                                        \
+  V(File_Exists, 1)                                                            \
+  V(File_Flush, 1)                                                             \
+  V(File_GetStdioHandleType, 1)                                                \
+  V(File_GetType, 2)                                                           \
+  V(File_LastModified, 1)                                                      \
+  V(File_Length, 1)                                                            \
+  V(File_LengthFromPath, 1)                                                    \
+  V(File_LinkTarget, 1)                                                        \
+  V(File_Map, 2)                                                               \
+  V(File_Open, 2)                                                              \
+  V(File_OpenStdio, 1)                                                         \
+  V(File_Position, 1)                                                          \
+  V(File_Read, 2)                                                              \
+  V(File_ReadByte, 1)                                                          \
+  V(File_ReadInto, 4)                                                          \
   V(File_Rename, 2)                                                            \
-  V(File_Copy, 2)                                                              \
   V(File_RenameLink, 2)                                                        \
   V(File_ResolveSymbolicLinks, 1)                                              \
-  V(File_OpenStdio, 1)                                                         \
-  V(File_GetStdioHandleType, 1)                                                \
-  V(File_GetType, 2)                                                           \
-  V(File_AreIdentical, 2)                                                      \
-  V(FileSystemWatcher_CloseWatcher, 1)                                         \
-  V(FileSystemWatcher_GetSocketId, 2)                                          \
-  V(FileSystemWatcher_InitWatcher, 0)                                          \
-  V(FileSystemWatcher_IsSupported, 0)                                          \
-  V(FileSystemWatcher_ReadEvents, 2)                                           \
-  V(FileSystemWatcher_UnwatchPath, 2)                                          \
-  V(FileSystemWatcher_WatchPath, 4)                                            \
+  V(File_SetPosition, 2)                                                       \
+  V(File_Stat, 1)                                                              \
+  V(File_Truncate, 2)                                                          \
+  V(File_WriteByte, 2)                                                         \
+  V(File_WriteFrom, 4)                                                         \
   V(Logger_PrintString, 1)
 
 BUILTIN_NATIVE_LIST(DECLARE_FUNCTION);
 
-static struct NativeEntries {
-  const char* name_;
-  Dart_NativeFunction function_;
-  int argument_count_;
-} BuiltinEntries[] = {
+static const NativeEntry BuiltinEntries[] = {
   BUILTIN_NATIVE_LIST(REGISTER_FUNCTION)
 };
 
@@ -93,13 +90,13 @@ Dart_NativeFunction Builtin::NativeLookup(Dart_Handle name,
   ASSERT(function_name != NULL);
   ASSERT(auto_setup_scope != NULL);
   *auto_setup_scope = true;
-  int num_entries = sizeof(BuiltinEntries) / sizeof(struct NativeEntries);
-  for (int i = 0; i < num_entries; i++) {
-    struct NativeEntries* entry = &(BuiltinEntries[i]);
-    if (!strcmp(function_name, entry->name_) &&
-        (entry->argument_count_ == argument_count)) {
-      return reinterpret_cast<Dart_NativeFunction>(entry->function_);
-    }
+  Dart_NativeFunction function =
+      FindNativeEntry(BuiltinEntries,
+                      sizeof(BuiltinEntries) / sizeof(BuiltinEntries[0]),
+                      function_name,
+                      argument_count);
+  if (function != NULL) {
+    return function;
   }
   return IONativeLookup(name, argument_count, auto_setup_scope);
 }
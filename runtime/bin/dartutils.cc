@@ -16,6 +16,7 @@
 #include "bin/file.h"
 #include "bin/io_buffer.h"
 #include "bin/socket.h"
+#include "bin/source_prefetcher.h"
 #include "bin/utils.h"
 
 namespace dart {
@@ -413,6 +414,58 @@ Dart_Handle DartUtils::ReadStringFromFile(const char* filename) {
 }
 
 
+// Queues the files imported, exported or included by a library for
+// prefetching, see SourcePrefetcher.
+class PrefetchVisitor : public DirectiveVisitor {
+ public:
+  PrefetchVisitor(Dart_Handle library_url, Dart_Handle builtin_lib)
+      : library_url_(library_url), builtin_lib_(builtin_lib) { }
+
+  virtual void VisitUri(const uint8_t* uri, intptr_t length) {
+    Dart_Handle url = Dart_NewStringFromUTF8(uri, length);
+    const char* url_string = NULL;
+    if (Dart_IsError(Dart_StringToCString(url, &url_string)) ||
+        DartUtils::IsDartSchemeURL(url_string) ||
+        DartUtils::IsDartExtensionSchemeURL(url_string)) {
+      return;
+    }
+    // Resolve the url the way the library tag handler does, errors are left
+    // for it to report.
+    Dart_Handle resolved_url =
+        DartUtils::ResolveUri(library_url_, url, builtin_lib_);
+    if (Dart_IsError(Dart_StringToCString(resolved_url, &url_string)) ||
+        DartUtils::IsHttpSchemeURL(url_string)) {
+      return;
+    }
+    Dart_Handle file_path =
+        DartUtils::FilePathFromUri(resolved_url, builtin_lib_);
+    const char* file_path_string = NULL;
+    if (Dart_IsError(Dart_StringToCString(file_path, &file_path_string))) {
+      return;
+    }
+    SourcePrefetcher::Prefetch(file_path_string);
+  }
+
+ private:
+  Dart_Handle library_url_;
+  Dart_Handle builtin_lib_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrefetchVisitor);
+};
+
+
+static void PrefetchDirectives(const uint8_t* source,
+                               intptr_t length,
+                               Dart_Handle library_url,
+                               Dart_Handle builtin_lib) {
+  if (!SourcePrefetcher::IsStarted()) {
+    return;
+  }
+  PrefetchVisitor visitor(library_url, builtin_lib);
+  SourcePrefetcher::ScanDirectives(source, length, &visitor);
+}
+
+
 Dart_Handle DartUtils::SetWorkingDirectory(Dart_Handle builtin_lib) {
   Dart_Handle directory = NewString(original_working_directory);
   return SingleArgDart_Invoke(builtin_lib, "_setWorkingDirectory", directory);
@@ -627,6 +680,7 @@ Dart_Handle DartUtils::LoadScript(const char* script_uri,
   if (is_snapshot) {
     returnValue = Dart_LoadScriptFromSnapshot(payload, len);
   } else {
+    PrefetchDirectives(buffer, len, resolved_script_uri, builtin_lib);
     Dart_Handle source = Dart_NewStringFromUTF8(buffer, len);
     if (Dart_IsError(source)) {
       returnValue = source;
@@ -659,8 +713,25 @@ Dart_Handle DartUtils::LoadSource(CommandLineOptions* url_mapping,
     // Read the file over http.
     source = DartUtils::ReadStringFromHttp(url_string);
   } else {
-    // Read the file.
-    source = DartUtils::ReadStringFromFile(url_string);
+    // Read the file, unless a prefetching thread has read it already.
+    intptr_t len = -1;
+    const uint8_t* buffer = SourcePrefetcher::Take(url_string, &len);
+    if (buffer == NULL) {
+      const char* error_msg = NULL;
+      buffer = ReadFileFully(url_string, &len, &error_msg);
+      if (buffer == NULL) {
+        return Dart_NewApiError(error_msg);
+      }
+    }
+    if ((tag == Dart_kImportTag) && SourcePrefetcher::IsStarted()) {
+      // Queue the files the library refers to before the VM asks for them
+      // one at a time while loading it.
+      PrefetchDirectives(
+          buffer, len, url,
+          Builtin::LoadAndCheckLibrary(Builtin::kBuiltinLibrary));
+    }
+    source = Dart_NewStringFromUTF8(buffer, len);
+    free(const_cast<uint8_t *>(buffer));
   }
   if (Dart_IsError(source)) {
     return source;  // source contains the error string.
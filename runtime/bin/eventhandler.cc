@@ -58,6 +58,7 @@ void TimeoutQueue::UpdateTimeout(Dart_Port port, int64_t timeout) {
 
 
 static EventHandler* event_handler = NULL;
+intptr_t EventHandler::thread_count_ = 1;
 
 
 void EventHandler::Start() {
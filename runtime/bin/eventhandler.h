@@ -121,9 +121,21 @@ class EventHandler {
 
   static EventHandlerImplementation* delegate();
 
+  /**
+   * Number of event-loop threads to start. Implementations that only run a
+   * single thread ignore it. Must be set before the event-handler is started.
+   */
+  static intptr_t thread_count() { return thread_count_; }
+  static void set_thread_count(intptr_t count) {
+    ASSERT(count > 0);
+    thread_count_ = count;
+  }
+
  private:
   friend class EventHandlerImplementation;
   EventHandlerImplementation delegate_;
+
+  static intptr_t thread_count_;
 };
 
 }  // namespace bin
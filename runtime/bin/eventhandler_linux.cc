@@ -20,6 +20,7 @@
 #include "bin/dartutils.h"
 #include "bin/fdutils.h"
 #include "bin/log.h"
+#include "bin/thread.h"
 #include "bin/utils.h"
 #include "platform/hashmap.h"
 #include "platform/thread.h"
@@ -104,8 +105,10 @@ static void UpdateEpollInstance(intptr_t epoll_fd_, SocketData* sd) {
 }
 
 
-EventHandlerImplementation::EventHandlerImplementation()
-    : socket_map_(&HashMap::SamePointerValue, 16) {
+EventLoop::EventLoop(EventHandlerImplementation* owner, bool handle_timers)
+    : owner_(owner),
+      socket_map_(&HashMap::SamePointerValue, 16),
+      timer_fd_(-1) {
   intptr_t result;
   result = TEMP_FAILURE_RETRY(pipe(interrupt_fds_));
   if (result != 0) {
@@ -134,8 +137,11 @@ EventHandlerImplementation::EventHandlerImplementation()
   if (status == -1) {
     FATAL("Failed adding interrupt fd to epoll instance");
   }
+  if (!handle_timers) {
+    return;
+  }
   timer_fd_ = TEMP_FAILURE_RETRY(timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC));
-  if (epoll_fd_ == -1) {
+  if (timer_fd_ == -1) {
     FATAL("Failed creating timerfd file descriptor");
   }
   // Register the timer_fd_ with the epoll instance.
@@ -152,15 +158,17 @@ EventHandlerImplementation::EventHandlerImplementation()
 }
 
 
-EventHandlerImplementation::~EventHandlerImplementation() {
+EventLoop::~EventLoop() {
   TEMP_FAILURE_RETRY(close(epoll_fd_));
-  TEMP_FAILURE_RETRY(close(timer_fd_));
+  if (timer_fd_ != -1) {
+    TEMP_FAILURE_RETRY(close(timer_fd_));
+  }
   TEMP_FAILURE_RETRY(close(interrupt_fds_[0]));
   TEMP_FAILURE_RETRY(close(interrupt_fds_[1]));
 }
 
 
-SocketData* EventHandlerImplementation::GetSocketData(intptr_t fd) {
+SocketData* EventLoop::GetSocketData(intptr_t fd) {
   ASSERT(fd >= 0);
   HashMap::Entry* entry = socket_map_.Lookup(
       GetHashmapKeyFromFd(fd), GetHashmapHashFromFd(fd), true);
@@ -177,9 +185,9 @@ SocketData* EventHandlerImplementation::GetSocketData(intptr_t fd) {
 }
 
 
-void EventHandlerImplementation::WakeupHandler(intptr_t id,
-                                               Dart_Port dart_port,
-                                               int64_t data) {
+void EventLoop::WakeupHandler(intptr_t id,
+                              Dart_Port dart_port,
+                              int64_t data) {
   InterruptMessage msg;
   msg.id = id;
   msg.dart_port = dart_port;
@@ -199,7 +207,7 @@ void EventHandlerImplementation::WakeupHandler(intptr_t id,
 }
 
 
-void EventHandlerImplementation::HandleInterruptFd() {
+void EventLoop::HandleInterruptFd() {
   const intptr_t MAX_MESSAGES = kInterruptMessageSize;
   InterruptMessage msg[MAX_MESSAGES];
   ssize_t bytes = TEMP_FAILURE_RETRY(
@@ -280,8 +288,7 @@ static void PrintEventMask(intptr_t fd, intptr_t events) {
 }
 #endif
 
-intptr_t EventHandlerImplementation::GetPollEvents(intptr_t events,
-                                                   SocketData* sd) {
+intptr_t EventLoop::GetPollEvents(intptr_t events, SocketData* sd) {
 #ifdef DEBUG_POLL
   PrintEventMask(sd->fd(), events);
 #endif
@@ -356,13 +363,12 @@ intptr_t EventHandlerImplementation::GetPollEvents(intptr_t events,
 }
 
 
-void EventHandlerImplementation::HandleEvents(struct epoll_event* events,
-                                              int size) {
+void EventLoop::HandleEvents(struct epoll_event* events, int size) {
   bool interrupt_seen = false;
   for (int i = 0; i < size; i++) {
     if (events[i].data.ptr == NULL) {
       interrupt_seen = true;
-    } else if (events[i].data.fd == timer_fd_) {
+    } else if ((timer_fd_ != -1) && (events[i].data.fd == timer_fd_)) {
       int64_t val;
       VOID_TEMP_FAILURE_RETRY(read(timer_fd_, &val, sizeof(val)));
       if (timeout_queue_.HasTimeout()) {
@@ -390,14 +396,13 @@ void EventHandlerImplementation::HandleEvents(struct epoll_event* events,
 }
 
 
-void EventHandlerImplementation::Poll(uword args) {
+void EventLoop::Poll(uword args) {
   static const intptr_t kMaxEvents = 16;
   struct epoll_event events[kMaxEvents];
-  EventHandler* handler = reinterpret_cast<EventHandler*>(args);
-  EventHandlerImplementation* handler_impl = &handler->delegate_;
-  ASSERT(handler_impl != NULL);
-  while (!handler_impl->shutdown_) {
-    intptr_t result = TEMP_FAILURE_RETRY(epoll_wait(handler_impl->epoll_fd_,
+  EventLoop* loop = reinterpret_cast<EventLoop*>(args);
+  ASSERT(loop != NULL);
+  while (!loop->shutdown_) {
+    intptr_t result = TEMP_FAILURE_RETRY(epoll_wait(loop->epoll_fd_,
                                                     events,
                                                     kMaxEvents,
                                                     -1));
@@ -407,41 +412,95 @@ void EventHandlerImplementation::Poll(uword args) {
         perror("Poll failed");
       }
     } else {
-      handler_impl->HandleEvents(events, result);
+      loop->HandleEvents(events, result);
     }
   }
-  delete handler;
+  // May delete this loop.
+  loop->owner_->LoopStopped();
 }
 
 
-void EventHandlerImplementation::Start(EventHandler* handler) {
-  int result = dart::Thread::Start(&EventHandlerImplementation::Poll,
-                                   reinterpret_cast<uword>(handler));
+void EventLoop::Start() {
+  int result = dart::Thread::Start(&EventLoop::Poll,
+                                   reinterpret_cast<uword>(this));
   if (result != 0) {
     FATAL1("Failed to start event handler thread %d", result);
   }
 }
 
 
+EventHandlerImplementation::EventHandlerImplementation()
+    : loops_(NULL),
+      num_loops_(EventHandler::thread_count()),
+      handler_(NULL),
+      running_loops_(0) {
+  ASSERT(num_loops_ > 0);
+  loops_ = new EventLoop*[num_loops_];
+  for (intptr_t i = 0; i < num_loops_; i++) {
+    loops_[i] = new EventLoop(this, i == 0);
+  }
+}
+
+
+EventHandlerImplementation::~EventHandlerImplementation() {
+  for (intptr_t i = 0; i < num_loops_; i++) {
+    delete loops_[i];
+  }
+  delete[] loops_;
+}
+
+
+EventLoop* EventHandlerImplementation::LoopFor(intptr_t id) const {
+  if (id < 0) {
+    return loops_[0];
+  }
+  return loops_[id % num_loops_];
+}
+
+
+void EventHandlerImplementation::LoopStopped() {
+  bool last;
+  {
+    MutexLocker ml(&mutex_);
+    ASSERT(running_loops_ > 0);
+    last = (--running_loops_ == 0);
+  }
+  if (last) {
+    delete handler_;
+  }
+}
+
+
+void EventHandlerImplementation::Start(EventHandler* handler) {
+  handler_ = handler;
+  running_loops_ = num_loops_;
+  for (intptr_t i = 0; i < num_loops_; i++) {
+    loops_[i]->Start();
+  }
+}
+
+
 void EventHandlerImplementation::Shutdown() {
-  SendData(kShutdownId, 0, 0);
+  for (intptr_t i = 0; i < num_loops_; i++) {
+    loops_[i]->WakeupHandler(kShutdownId, 0, 0);
+  }
 }
 
 
 void EventHandlerImplementation::SendData(intptr_t id,
                                           Dart_Port dart_port,
                                           int64_t data) {
-  WakeupHandler(id, dart_port, data);
+  LoopFor(id)->WakeupHandler(id, dart_port, data);
 }
 
 
-void* EventHandlerImplementation::GetHashmapKeyFromFd(intptr_t fd) {
+void* EventLoop::GetHashmapKeyFromFd(intptr_t fd) {
   // The hashmap does not support keys with value 0.
   return reinterpret_cast<void*>(fd + 1);
 }
 
 
-uint32_t EventHandlerImplementation::GetHashmapHashFromFd(intptr_t fd) {
+uint32_t EventLoop::GetHashmapHashFromFd(intptr_t fd) {
   // The hashmap does not support keys with value 0.
   return dart::Utils::WordHash(fd + 1);
 }
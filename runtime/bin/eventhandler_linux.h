@@ -14,6 +14,7 @@
 #include <sys/socket.h>
 
 #include "platform/hashmap.h"
+#include "platform/thread.h"
 
 
 namespace dart {
@@ -89,34 +90,67 @@ class SocketData {
 };
 
 
-class EventHandlerImplementation {
+class EventHandlerImplementation;
+
+
+// An event-loop thread with its own epoll instance and interrupt pipe. It
+// owns the SocketData of the file descriptors assigned to it, so the socket
+// map is only ever touched from this thread.
+class EventLoop {
  public:
-  EventHandlerImplementation();
-  ~EventHandlerImplementation();
+  EventLoop(EventHandlerImplementation* owner, bool handle_timers);
+  ~EventLoop();
 
   // Gets the socket data structure for a given file
   // descriptor. Creates a new one if one is not found.
   SocketData* GetSocketData(intptr_t fd);
-  void SendData(intptr_t id, Dart_Port dart_port, int64_t data);
-  void Start(EventHandler* handler);
-  void Shutdown();
+  void WakeupHandler(intptr_t id, Dart_Port dart_port, int64_t data);
+  void Start();
 
  private:
   void HandleEvents(struct epoll_event* events, int size);
   static void Poll(uword args);
-  void WakeupHandler(intptr_t id, Dart_Port dart_port, int64_t data);
   void HandleInterruptFd();
-  void SetPort(intptr_t fd, Dart_Port dart_port, intptr_t mask);
   intptr_t GetPollEvents(intptr_t events, SocketData* sd);
   static void* GetHashmapKeyFromFd(intptr_t fd);
   static uint32_t GetHashmapHashFromFd(intptr_t fd);
 
+  EventHandlerImplementation* owner_;
   HashMap socket_map_;
   TimeoutQueue timeout_queue_;
   bool shutdown_;
   int interrupt_fds_[2];
   int epoll_fd_;
-  int timer_fd_;
+  int timer_fd_;  // -1 unless this loop handles timers.
+
+  DISALLOW_COPY_AND_ASSIGN(EventLoop);
+};
+
+
+class EventHandlerImplementation {
+ public:
+  EventHandlerImplementation();
+  ~EventHandlerImplementation();
+
+  void SendData(intptr_t id, Dart_Port dart_port, int64_t data);
+  void Start(EventHandler* handler);
+  void Shutdown();
+
+ private:
+  friend class EventLoop;
+
+  // Sockets are assigned to event loops by file descriptor, timers are all
+  // handled by the first loop.
+  EventLoop* LoopFor(intptr_t id) const;
+  // Called by each event loop when its thread exits. The last one to exit
+  // deletes the event handler.
+  void LoopStopped();
+
+  EventLoop** loops_;
+  intptr_t num_loops_;
+  EventHandler* handler_;
+  dart::Mutex mutex_;
+  intptr_t running_loops_;
 };
 
 }  // namespace bin
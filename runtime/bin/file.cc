@@ -57,6 +57,36 @@ bool File::WriteFully(const void* buffer, int64_t num_bytes) {
 }
 
 
+MappedMemory* File::Map(int64_t num_bytes) {
+  off64_t position = Position();
+  off64_t length = Length();
+  if ((num_bytes <= 0) || (position < 0) || (length <= position)) {
+    return NULL;
+  }
+  int64_t num_mapped = length - position;
+  if (num_bytes < num_mapped) {
+    num_mapped = num_bytes;
+  }
+  if (num_mapped > kIntptrMax) {
+    return NULL;
+  }
+  MappedMemory* mapping = MapRange(position, num_mapped);
+  if ((mapping != NULL) && !SetPosition(position + num_mapped)) {
+    delete mapping;
+    return NULL;
+  }
+  return mapping;
+}
+
+
+void MappedMemory::Finalizer(Dart_WeakPersistentHandle handle, void* peer) {
+  delete reinterpret_cast<MappedMemory*>(peer);
+  if (handle != NULL) {
+    Dart_DeleteWeakPersistentHandle(handle);
+  }
+}
+
+
 File::FileOpenMode File::DartModeToFileMode(DartFileOpenMode mode) {
   ASSERT(mode == File::kDartRead ||
          mode == File::kDartWrite ||
@@ -195,6 +225,31 @@ void FUNCTION_NAME(File_Read)(Dart_NativeArguments args) {
 }
 
 
+void FUNCTION_NAME(File_Map)(Dart_NativeArguments args) {
+  File* file = GetFilePointer(Dart_GetNativeArgument(args, 0));
+  ASSERT(file != NULL);
+  int64_t length = 0;
+  MappedMemory* mapping = NULL;
+  if (DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 1), &length)) {
+    mapping = file->Map(length);
+  }
+  if (mapping == NULL) {
+    // Read a copy instead, File_Read also reports invalid arguments.
+    FUNCTION_NAME(File_Read)(args);
+    return;
+  }
+  Dart_Handle external_array = Dart_NewExternalTypedData(
+      Dart_TypedData_kUint8, mapping->data(), mapping->length());
+  if (Dart_IsError(external_array)) {
+    delete mapping;
+    Dart_PropagateError(external_array);
+  }
+  Dart_NewWeakPersistentHandle(external_array, mapping,
+                               MappedMemory::Finalizer);
+  Dart_SetReturnValue(args, external_array);
+}
+
+
 void FUNCTION_NAME(File_ReadInto)(Dart_NativeArguments args) {
   File* file = GetFilePointer(Dart_GetNativeArgument(args, 0));
   ASSERT(file != NULL);
@@ -999,6 +1054,32 @@ CObject* File::ReadIntoRequest(const CObjectArray& request) {
 }
 
 
+CObject* File::MapRequest(const CObjectArray& request) {
+  if (request.Length() == 2 &&
+      request[0]->IsIntptr() &&
+      request[1]->IsInt32OrInt64()) {
+    File* file = CObjectToFilePointer(request[0]);
+    ASSERT(file != NULL);
+    if (!file->IsClosed()) {
+      int64_t length = CObjectInt32OrInt64ToInt64(request[1]);
+      MappedMemory* mapping = file->Map(length);
+      if (mapping != NULL) {
+        CObjectExternalUint8Array* external_array =
+            new CObjectExternalUint8Array(CObject::NewExternalUint8Array(
+                mapping->length(), mapping->data(), mapping,
+                MappedMemory::Finalizer));
+        CObjectArray* result = new CObjectArray(CObject::NewArray(2));
+        result->SetAt(0, new CObjectIntptr(CObject::NewInt32(0)));
+        result->SetAt(1, external_array);
+        return result;
+      }
+    }
+  }
+  // Read a copy instead, ReadRequest also reports errors.
+  return ReadRequest(request);
+}
+
+
 static int SizeInBytes(Dart_TypedData_Type type) {
   switch (type) {
     case Dart_TypedData_kInt8:
@@ -22,6 +22,34 @@ namespace bin {
 // Forward declaration.
 class FileHandle;
 
+// A range of a file mapped into memory. The mapping is private, writes to it
+// are not carried through to the file.
+class MappedMemory {
+ public:
+  MappedMemory(void* address, intptr_t size, intptr_t offset)
+      : address_(address), size_(size), offset_(offset) { }
+  ~MappedMemory() { Unmap(); }
+
+  uint8_t* data() const {
+    return reinterpret_cast<uint8_t*>(address_) + offset_;
+  }
+  intptr_t length() const { return size_ - offset_; }
+
+  // Function for finalizing external byte arrays backed by a mapping.
+  static void Finalizer(Dart_WeakPersistentHandle handle, void* peer);
+
+ private:
+  void Unmap();
+
+  // The mapping starts at a page boundary, the mapped range offset_ bytes
+  // into it.
+  void* address_;
+  intptr_t size_;
+  intptr_t offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedMemory);
+};
+
 class File {
  public:
   enum FileOpenMode {
@@ -88,6 +116,13 @@ class File {
     return WriteFully(&byte, 1);
   }
 
+  // Map attempts to map num_bytes of the file at the current position into
+  // memory and advances the position past them, like Read. Returns NULL,
+  // leaving the position unchanged, if there is nothing to map or the file
+  // cannot be mapped (e.g. a pipe or a special file). Accessing a mapping
+  // after the file was truncated below it faults.
+  MappedMemory* Map(int64_t num_bytes);
+
   // Get the length of the file. Returns a negative value if the length cannot
   // be determined (e.g. not seekable device).
   off64_t Length();
@@ -160,6 +195,7 @@ class File {
   static CObject* WriteByteRequest(const CObjectArray& request);
   static CObject* ReadRequest(const CObjectArray& request);
   static CObject* ReadIntoRequest(const CObjectArray& request);
+  static CObject* MapRequest(const CObjectArray& request);
   static CObject* WriteFromRequest(const CObjectArray& request);
   static CObject* CreateLinkRequest(const CObjectArray& request);
   static CObject* DeleteLinkRequest(const CObjectArray& request);
@@ -173,6 +209,9 @@ class File {
   explicit File(FileHandle* handle) : handle_(handle) { }
   void Close();
 
+  // Maps length bytes of the file starting at position, see Map.
+  MappedMemory* MapRange(int64_t position, int64_t length);
+
   static const int kClosedFd = -1;
 
   // FileHandle is an OS specific class which stores data about the file.
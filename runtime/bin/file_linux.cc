@@ -9,6 +9,7 @@
 
 #include <errno.h>  // NOLINT
 #include <fcntl.h>  // NOLINT
+#include <sys/mman.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
 #include <sys/types.h>  // NOLINT
 #include <sys/sendfile.h>  // NOLINT
@@ -83,6 +84,29 @@ off64_t File::Position() {
 }
 
 
+MappedMemory* File::MapRange(int64_t position, int64_t length) {
+  ASSERT(handle_->fd() >= 0);
+  // Mappings start at a page boundary.
+  const int64_t page_size = sysconf(_SC_PAGESIZE);
+  const int64_t start = position - (position % page_size);
+  const int64_t size = length + (position - start);
+  if ((static_cast<off_t>(start) != start) || (size > kIntptrMax)) {
+    return NULL;
+  }
+  void* address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       handle_->fd(), start);
+  if (address == MAP_FAILED) {
+    return NULL;
+  }
+  return new MappedMemory(address, size, position - start);
+}
+
+
+void MappedMemory::Unmap() {
+  munmap(address_, size_);
+}
+
+
 bool File::SetPosition(off64_t position) {
   ASSERT(handle_->fd() >= 0);
   return lseek64(handle_->fd(), position, SEEK_SET) >= 0;
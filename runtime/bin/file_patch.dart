@@ -28,6 +28,7 @@ patch class _RandomAccessFile {
   /* patch */ static _read(int id, int bytes) native "File_Read";
   /* patch */ static _readInto(int id, List<int> buffer, int start, int end)
       native "File_ReadInto";
+  /* patch */ static _map(int id, int bytes) native "File_Map";
   /* patch */ static _writeByte(int id, int value) native "File_WriteByte";
   /* patch */ static _writeFrom(int id, List<int> buffer, int start, int end)
       native "File_WriteFrom";
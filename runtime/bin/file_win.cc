@@ -78,6 +78,41 @@ off64_t File::Position() {
 }
 
 
+MappedMemory* File::MapRange(int64_t position, int64_t length) {
+  ASSERT(handle_->fd() >= 0);
+  // Views start at a multiple of the allocation granularity.
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  const int64_t start = position - (position % info.dwAllocationGranularity);
+  const int64_t size = length + (position - start);
+  if (size > kIntptrMax) {
+    return NULL;
+  }
+  HANDLE file_handle = reinterpret_cast<HANDLE>(_get_osfhandle(handle_->fd()));
+  HANDLE mapping_handle =
+      CreateFileMapping(file_handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  if (mapping_handle == NULL) {
+    return NULL;
+  }
+  // The view keeps the mapping object alive.
+  void* address = MapViewOfFile(mapping_handle,
+                                FILE_MAP_COPY,
+                                static_cast<DWORD>(start >> 32),
+                                static_cast<DWORD>(start & 0xFFFFFFFF),
+                                static_cast<SIZE_T>(size));
+  CloseHandle(mapping_handle);
+  if (address == NULL) {
+    return NULL;
+  }
+  return new MappedMemory(address, size, position - start);
+}
+
+
+void MappedMemory::Unmap() {
+  UnmapViewOfFile(address_);
+}
+
+
 bool File::SetPosition(off64_t position) {
   ASSERT(handle_->fd() >= 0);
   return _lseeki64(handle_->fd(), position, SEEK_SET) >= 0;
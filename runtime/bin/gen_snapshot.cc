@@ -10,6 +10,7 @@
 #include <stdio.h>
 
 #include "include/dart_api.h"
+#include "include/dart_native_api.h"
 
 #include "bin/builtin.h"
 #include "bin/dartutils.h"
@@ -38,6 +39,11 @@ static const char* snapshot_filename = NULL;
 static const char* package_root = NULL;
 static uint8_t* snapshot_buffer = NULL;
 
+// Global state that indicates whether all functions are compiled before the
+// snapshot is written, so that their code can be included with
+// --snapshot_code.
+static bool compile_all = false;
+
 
 // Global state which contains a pointer to the script name for which
 // a snapshot needs to be created (NULL would result in the creation
@@ -86,6 +92,15 @@ static bool ProcessPackageRootOption(const char* option) {
 }
 
 
+static bool ProcessCompileAllOption(const char* option) {
+  if (strcmp(option, "--compile_all") == 0) {
+    compile_all = true;
+    return true;
+  }
+  return false;
+}
+
+
 static bool ProcessURLmappingOption(const char* option) {
   const char* mapping = ProcessOption(option, "--url_mapping=");
   if (mapping == NULL) {
@@ -115,7 +130,8 @@ static int ParseArguments(int argc,
   while ((i < argc) && IsValidFlag(argv[i], kPrefix, kPrefixLen)) {
     if (ProcessSnapshotOption(argv[i]) ||
         ProcessURLmappingOption(argv[i]) ||
-        ProcessPackageRootOption(argv[i])) {
+        ProcessPackageRootOption(argv[i]) ||
+        ProcessCompileAllOption(argv[i])) {
       i += 1;
       continue;
     }
@@ -412,6 +428,10 @@ static void PrintUsage() {
 "--package_root=<path>\n"
 "  Where to find packages, that is, \"package:...\" imports.\n"
 "\n"
+"--compile_all\n"
+"  Compiles all functions before writing the snapshot. Together with the\n"
+"  --snapshot_code vm flag their code is included in the snapshot.\n"
+"\n"
 "--url_mapping=<mapping>\n"
 "  Uses the URL mapping(s) specified on the command line to load the\n"
 "  libraries. For use only with --snapshot=.\n");
@@ -435,6 +455,11 @@ static void CreateAndWriteSnapshot() {
   uint8_t* buffer = NULL;
   intptr_t size = 0;
 
+  if (compile_all) {
+    result = Dart_CompileAll();
+    CHECK_RESULT(result);
+  }
+
   // First create a snapshot.
   result = Dart_CreateSnapshot(&buffer, &size);
   CHECK_RESULT(result);
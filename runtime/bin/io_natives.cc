@@ -18,7 +18,7 @@ namespace bin {
 
 // Lists the native functions implementing advanced dart:io classes.
 // Some classes, like File and Directory, list their implementations in
-// builtin_natives.cc instead.
+// builtin_natives.cc instead. The list is sorted by name.
 #define IO_NATIVE_LIST(V)                                                      \
   V(Crypto_GetRandomBytes, 1)                                                  \
   V(EventHandler_SendData, 3)                                                  \
@@ -27,59 +27,59 @@ namespace bin {
   V(Filter_End, 1)                                                             \
   V(Filter_Process, 4)                                                         \
   V(Filter_Processed, 3)                                                       \
-  V(InternetAddress_Parse, 1)                                                  \
   V(IOService_NewServicePort, 0)                                               \
-  V(Platform_NumberOfProcessors, 0)                                            \
-  V(Platform_OperatingSystem, 0)                                               \
-  V(Platform_PathSeparator, 0)                                                 \
-  V(Platform_LocalHostname, 0)                                                 \
-  V(Platform_ExecutableName, 0)                                                \
+  V(InternetAddress_Parse, 1)                                                  \
   V(Platform_Environment, 0)                                                   \
   V(Platform_ExecutableArguments, 0)                                           \
-  V(Platform_PackageRoot, 0)                                                   \
+  V(Platform_ExecutableName, 0)                                                \
   V(Platform_GetVersion, 0)                                                    \
-  V(Process_Start, 10)                                                         \
-  V(Process_Wait, 5)                                                           \
-  V(Process_Kill, 3)                                                           \
-  V(Process_SetExitCode, 1)                                                    \
+  V(Platform_LocalHostname, 0)                                                 \
+  V(Platform_NumberOfProcessors, 0)                                            \
+  V(Platform_OperatingSystem, 0)                                               \
+  V(Platform_PackageRoot, 0)                                                   \
+  V(Platform_PathSeparator, 0)                                                 \
+  V(Process_ClearSignalHandler, 1)                                             \
   V(Process_Exit, 1)                                                           \
-  V(Process_Sleep, 1)                                                          \
+  V(Process_Kill, 3)                                                           \
   V(Process_Pid, 1)                                                            \
+  V(Process_SetExitCode, 1)                                                    \
   V(Process_SetSignalHandler, 1)                                               \
-  V(Process_ClearSignalHandler, 1)                                             \
+  V(Process_Sleep, 1)                                                          \
+  V(Process_Start, 10)                                                         \
+  V(Process_Wait, 5)                                                           \
   V(SecureSocket_Connect, 9)                                                   \
   V(SecureSocket_Destroy, 1)                                                   \
+  V(SecureSocket_FilterPointer, 1)                                             \
   V(SecureSocket_Handshake, 1)                                                 \
   V(SecureSocket_Init, 1)                                                      \
+  V(SecureSocket_InitializeLibrary, 3)                                         \
   V(SecureSocket_PeerCertificate, 1)                                           \
   V(SecureSocket_RegisterBadCertificateCallback, 2)                            \
   V(SecureSocket_RegisterHandshakeCompleteCallback, 2)                         \
   V(SecureSocket_Renegotiate, 4)                                               \
-  V(SecureSocket_InitializeLibrary, 3)                                         \
-  V(SecureSocket_FilterPointer, 1)                                             \
-  V(ServerSocket_CreateBindListen, 5)                                          \
   V(ServerSocket_Accept, 2)                                                    \
-  V(Socket_CreateConnect, 3)                                                   \
-  V(Socket_CreateBindDatagram, 4)                                              \
+  V(ServerSocket_CreateBindListen, 5)                                          \
   V(Socket_Available, 1)                                                       \
-  V(Socket_Read, 2)                                                            \
-  V(Socket_RecvFrom, 1)                                                        \
-  V(Socket_WriteList, 4)                                                       \
-  V(Socket_SendTo, 6)                                                          \
+  V(Socket_CreateBindDatagram, 4)                                              \
+  V(Socket_CreateConnect, 3)                                                   \
+  V(Socket_GetError, 1)                                                        \
+  V(Socket_GetOption, 3)                                                       \
   V(Socket_GetPort, 1)                                                         \
   V(Socket_GetRemotePeer, 1)                                                   \
-  V(Socket_GetError, 1)                                                        \
   V(Socket_GetStdioHandle, 2)                                                  \
   V(Socket_GetType, 1)                                                         \
-  V(Socket_GetOption, 3)                                                       \
-  V(Socket_SetOption, 4)                                                       \
   V(Socket_JoinMulticast, 4)                                                   \
   V(Socket_LeaveMulticast, 4)                                                  \
+  V(Socket_Read, 2)                                                            \
+  V(Socket_RecvFrom, 1)                                                        \
+  V(Socket_SendTo, 6)                                                          \
+  V(Socket_SetOption, 4)                                                       \
   V(Socket_SetSocketId, 2)                                                     \
-  V(Stdin_ReadByte, 1)                                                         \
+  V(Socket_WriteList, 4)                                                       \
   V(Stdin_GetEchoMode, 0)                                                      \
-  V(Stdin_SetEchoMode, 1)                                                      \
   V(Stdin_GetLineMode, 0)                                                      \
+  V(Stdin_ReadByte, 1)                                                         \
+  V(Stdin_SetEchoMode, 1)                                                      \
   V(Stdin_SetLineMode, 1)                                                      \
   V(Stdout_GetTerminalSize, 0)                                                 \
   V(StringToSystemEncoding, 1)                                                 \
@@ -88,11 +88,7 @@ namespace bin {
 
 IO_NATIVE_LIST(DECLARE_FUNCTION);
 
-static struct NativeEntries {
-  const char* name_;
-  Dart_NativeFunction function_;
-  int argument_count_;
-} IOEntries[] = {
+static const NativeEntry IOEntries[] = {
   IO_NATIVE_LIST(REGISTER_FUNCTION)
 };
 
@@ -106,15 +102,10 @@ Dart_NativeFunction IONativeLookup(Dart_Handle name,
   ASSERT(function_name != NULL);
   ASSERT(auto_setup_scope != NULL);
   *auto_setup_scope = true;
-  int num_entries = sizeof(IOEntries) / sizeof(struct NativeEntries);
-  for (int i = 0; i < num_entries; i++) {
-    struct NativeEntries* entry = &(IOEntries[i]);
-    if (!strcmp(function_name, entry->name_) &&
-        (entry->argument_count_ == argument_count)) {
-      return reinterpret_cast<Dart_NativeFunction>(entry->function_);
-    }
-  }
-  return NULL;
+  return FindNativeEntry(IOEntries,
+                         sizeof(IOEntries) / sizeof(IOEntries[0]),
+                         function_name,
+                         argument_count);
 }
 
 }  // namespace bin
@@ -52,7 +52,8 @@ namespace bin {
   V(Directory, ListNext, 35)                                                   \
   V(Directory, ListStop, 36)                                                   \
   V(Directory, Rename, 37)                                                     \
-  V(SSLFilter, ProcessFilter, 38)
+  V(SSLFilter, ProcessFilter, 38)                                              \
+  V(File, Map, 39)
 
 #define DECLARE_REQUEST(type, method, id)                                      \
   k##type##method##Request = id,
@@ -20,6 +20,7 @@
 #include "bin/log.h"
 #include "bin/platform.h"
 #include "bin/process.h"
+#include "bin/source_prefetcher.h"
 #include "bin/vmservice_impl.h"
 #include "platform/globals.h"
 #include "platform/hashmap.h"
@@ -70,6 +71,10 @@ static bool start_vm_service = false;
 static int vm_service_server_port = -1;
 static const int DEFAULT_VM_SERVICE_SERVER_PORT = 8181;
 
+// Number of threads prefetching imported sources, none if not positive.
+static intptr_t prefetch_thread_count = 0;
+static const intptr_t DEFAULT_PREFETCH_THREAD_COUNT = 4;
+
 // The environment provided through the command line using -D options.
 static dart::HashMap* environment = NULL;
 
@@ -257,6 +262,36 @@ static bool ProcessEnableVmServiceOption(const char* port) {
   return true;
 }
 
+static bool ProcessEventHandlerThreadsOption(const char* arg) {
+  ASSERT(arg != NULL);
+  intptr_t count = atoi(arg);
+  if (count <= 0) {
+    Log::PrintErr("unrecognized --event-handler-threads option syntax. "
+                    "Use --event-handler-threads=<thread count>\n");
+    return false;
+  }
+  EventHandler::set_thread_count(count);
+  return true;
+}
+
+
+static bool ProcessPrefetchSourcesOption(const char* arg) {
+  ASSERT(arg != NULL);
+  prefetch_thread_count = -1;
+  if (*arg == '\0') {
+    prefetch_thread_count = DEFAULT_PREFETCH_THREAD_COUNT;
+  } else if (*arg == '=') {
+    prefetch_thread_count = atoi(arg + 1);
+  }
+  if (prefetch_thread_count <= 0) {
+    Log::PrintErr("unrecognized --prefetch-sources option syntax. "
+                    "Use --prefetch-sources[=<thread count>]\n");
+    return false;
+  }
+  return true;
+}
+
+
 bool trace_debug_protocol = false;
 static bool ProcessTraceDebugProtocolOption(const char* arg) {
   if (*arg != '\0') {
@@ -287,6 +322,8 @@ static struct {
   { "--print-script", ProcessPrintScriptOption },
   { "--enable-vm-service", ProcessEnableVmServiceOption },
   { "--trace-debug-protocol", ProcessTraceDebugProtocolOption },
+  { "--event-handler-threads=", ProcessEventHandlerThreadsOption },
+  { "--prefetch-sources", ProcessPrefetchSourcesOption },
   { NULL, NULL }
 };
 
@@ -639,6 +676,13 @@ static void PrintUsage() {
 "  enables the VM service and listens on specified port for connections\n"
 "  (default port number is 8181)\n"
 "\n"
+"--event-handler-threads=<thread count>\n"
+"  number of threads polling sockets for I/O events (default 1, Linux only)\n"
+"\n"
+"--prefetch-sources[=<thread count>]\n"
+"  reads the sources of imported libraries on the specified number of\n"
+"  threads ahead of loading them (default 4 threads)\n"
+"\n"
 "The following options are only used for VM development and may\n"
 "be changed in any future version:\n");
     const char* print_flags = "--print_flags";
@@ -831,6 +875,11 @@ void main(int argc, char** argv) {
   // Start event handler.
   EventHandler::Start();
 
+  // Start reading imported sources ahead of loading them, if requested.
+  if (prefetch_thread_count > 0) {
+    SourcePrefetcher::Start(prefetch_thread_count);
+  }
+
   // Start the VM service isolate, if necessary.
   if (start_vm_service) {
     ASSERT(vm_service_server_port >= 0);
@@ -961,6 +1010,8 @@ void main(int argc, char** argv) {
   Dart_ShutdownIsolate();
   // Terminate process exit-code handler.
   Process::TerminateExitCodeHandler();
+  // Free the prefetched sources that were never loaded.
+  SourcePrefetcher::Stop();
 
   Dart_Cleanup();
 
@@ -0,0 +1,451 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "bin/source_prefetcher.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bin/file.h"
+#include "bin/thread.h"
+#include "platform/hashmap.h"
+#include "platform/thread.h"
+
+
+namespace dart {
+namespace bin {
+
+Monitor* SourcePrefetcher::monitor_ = NULL;
+HashMap* SourcePrefetcher::sources_ = NULL;
+SourcePrefetcher::Source* SourcePrefetcher::queue_head_ = NULL;
+SourcePrefetcher::Source* SourcePrefetcher::queue_tail_ = NULL;
+intptr_t SourcePrefetcher::num_threads_ = 0;
+bool SourcePrefetcher::is_stopping_ = false;
+
+
+// A queued file. Sources stay in the map once taken, so that a file imported
+// by several libraries is only read once.
+class SourcePrefetcher::Source {
+ public:
+  explicit Source(const char* path)
+      : path_(strdup(path)),
+        data_(NULL),
+        length_(-1),
+        is_read_(false),
+        next_(NULL) { }
+  ~Source() {
+    free(path_);
+    free(data_);
+  }
+
+  char* path_;
+  uint8_t* data_;
+  intptr_t length_;
+  bool is_read_;
+  Source* next_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(Source);
+};
+
+
+void SourcePrefetcher::Start(intptr_t num_threads) {
+  ASSERT(!IsStarted());
+  ASSERT(num_threads > 0);
+  sources_ = new HashMap(&HashMap::SameStringValue, 64);
+  monitor_ = new Monitor();
+  is_stopping_ = false;
+  num_threads_ = num_threads;
+  for (intptr_t i = 0; i < num_threads; i++) {
+    int result = dart::Thread::Start(&SourcePrefetcher::ReadSources, 0);
+    if (result != 0) {
+      FATAL1("Failed to start source prefetching thread %d", result);
+    }
+  }
+}
+
+
+void SourcePrefetcher::Stop() {
+  if (!IsStarted()) {
+    return;
+  }
+  {
+    MonitorLocker ml(monitor_);
+    is_stopping_ = true;
+    ml.NotifyAll();
+    while (num_threads_ > 0) {
+      ml.Wait();
+    }
+    for (HashMap::Entry* entry = sources_->Start();
+         entry != NULL;
+         entry = sources_->Next(entry)) {
+      delete reinterpret_cast<Source*>(entry->value);
+    }
+    delete sources_;
+    sources_ = NULL;
+    queue_head_ = NULL;
+    queue_tail_ = NULL;
+  }
+  delete monitor_;
+  monitor_ = NULL;
+}
+
+
+void SourcePrefetcher::Prefetch(const char* path) {
+  ASSERT(IsStarted());
+  char* key = const_cast<char*>(path);
+  MonitorLocker ml(monitor_);
+  HashMap::Entry* entry =
+      sources_->Lookup(key, HashMap::StringHash(key), true);
+  if (entry->value != NULL) {
+    return;
+  }
+  Source* source = new Source(path);
+  // The map keeps a key of its own.
+  entry->key = source->path_;
+  entry->value = source;
+  if (queue_tail_ == NULL) {
+    queue_head_ = source;
+  } else {
+    queue_tail_->next_ = source;
+  }
+  queue_tail_ = source;
+  ml.Notify();
+}
+
+
+uint8_t* SourcePrefetcher::Take(const char* path, intptr_t* length) {
+  if (!IsStarted()) {
+    return NULL;
+  }
+  char* key = const_cast<char*>(path);
+  MonitorLocker ml(monitor_);
+  HashMap::Entry* entry =
+      sources_->Lookup(key, HashMap::StringHash(key), false);
+  if (entry == NULL) {
+    return NULL;
+  }
+  Source* source = reinterpret_cast<Source*>(entry->value);
+  while (!source->is_read_) {
+    ml.Wait();
+  }
+  uint8_t* data = source->data_;
+  *length = source->length_;
+  source->data_ = NULL;
+  return data;
+}
+
+
+uint8_t* SourcePrefetcher::ReadFile(const char* path, intptr_t* length) {
+  File* file = File::Open(path, File::kRead);
+  if (file == NULL) {
+    return NULL;
+  }
+  uint8_t* data = NULL;
+  int64_t file_length = file->Length();
+  if ((file_length > 0) && (file_length <= kIntptrMax)) {
+    data = reinterpret_cast<uint8_t*>(malloc(file_length));
+    if (!file->ReadFully(data, file_length)) {
+      free(data);
+      data = NULL;
+    }
+  }
+  delete file;
+  *length = static_cast<intptr_t>(file_length);
+  return data;
+}
+
+
+void SourcePrefetcher::ReadSources(uword unused) {
+  while (true) {
+    Source* source = NULL;
+    {
+      MonitorLocker ml(monitor_);
+      while ((queue_head_ == NULL) && !is_stopping_) {
+        ml.Wait();
+      }
+      if (is_stopping_) {
+        num_threads_--;
+        ml.NotifyAll();
+        return;
+      }
+      source = queue_head_;
+      queue_head_ = source->next_;
+      if (queue_head_ == NULL) {
+        queue_tail_ = NULL;
+      }
+    }
+    // Sources are only freed once all threads have stopped, and only this
+    // thread writes the path.
+    intptr_t length = -1;
+    uint8_t* data = ReadFile(source->path_, &length);
+    MonitorLocker ml(monitor_);
+    source->data_ = data;
+    source->length_ = length;
+    source->is_read_ = true;
+    ml.NotifyAll();
+  }
+}
+
+
+// Splits the directives at the start of a source into the few tokens needed
+// to find the URIs they refer to.
+class DirectiveScanner {
+ public:
+  DirectiveScanner(const uint8_t* source, intptr_t length)
+      : current_(source), end_(source + length) {
+    // Skip a byte order mark and a script tag.
+    static const uint8_t kBom[] = { 0xEF, 0xBB, 0xBF };
+    if (((end_ - current_) >= 3) && (memcmp(current_, kBom, 3) == 0)) {
+      current_ += 3;
+    }
+    if (((end_ - current_) >= 2) &&
+        (current_[0] == '#') && (current_[1] == '!')) {
+      while ((current_ < end_) && (*current_ != '\n')) {
+        current_++;
+      }
+    }
+  }
+
+  bool AtEnd() const { return current_ >= end_; }
+  uint8_t Peek() const { return AtEnd() ? 0 : *current_; }
+
+  void SkipWhitespaceAndComments() {
+    while (!AtEnd()) {
+      if ((*current_ == ' ') || (*current_ == '\t') ||
+          (*current_ == '\n') || (*current_ == '\r')) {
+        current_++;
+      } else if (IsAt("//")) {
+        while (!AtEnd() && (*current_ != '\n')) {
+          current_++;
+        }
+      } else if (IsAt("/*")) {
+        // Block comments nest.
+        intptr_t depth = 0;
+        do {
+          if (IsAt("/*")) {
+            depth++;
+            current_ += 2;
+          } else if (IsAt("*/")) {
+            depth--;
+            current_ += 2;
+          } else {
+            current_++;
+          }
+        } while (!AtEnd() && (depth > 0));
+      } else {
+        return;
+      }
+    }
+  }
+
+  bool ScanIdentifier(const uint8_t** start, intptr_t* length) {
+    *start = current_;
+    while (!AtEnd() && IsIdentifierChar(*current_)) {
+      current_++;
+    }
+    *length = current_ - *start;
+    return *length > 0;
+  }
+
+  bool AtString() const {
+    return IsQuote(Peek()) ||
+        ((Peek() == 'r') && ((end_ - current_) >= 2) && IsQuote(current_[1]));
+  }
+
+  // Scans a string literal. Literals with escapes or interpolation are
+  // scanned but not plain.
+  bool ScanString(const uint8_t** start, intptr_t* length, bool* is_plain) {
+    if (!AtString()) {
+      return false;
+    }
+    const bool is_raw = (Peek() == 'r');
+    if (is_raw) {
+      current_++;
+    }
+    const uint8_t quote = Peek();
+    const bool is_multiline = IsAtQuotes(quote, 3);
+    if (is_multiline) {
+      current_ += 3;
+      // A first line holding only whitespace is not part of the string.
+      const uint8_t* line = current_;
+      while ((line < end_) && ((*line == ' ') || (*line == '\t'))) {
+        line++;
+      }
+      if ((line < end_) && (*line == '\n')) {
+        current_ = line + 1;
+      } else if (((end_ - line) >= 2) && (line[0] == '\r') &&
+                 (line[1] == '\n')) {
+        current_ = line + 2;
+      }
+    } else {
+      current_++;
+    }
+    const intptr_t num_quotes = is_multiline ? 3 : 1;
+    *start = current_;
+    *is_plain = true;
+    while (!AtEnd() && !IsAtQuotes(quote, num_quotes)) {
+      if (!is_raw && ((*current_ == '\\') || (*current_ == '$'))) {
+        *is_plain = false;
+        if (*current_ == '\\') {
+          current_++;
+        }
+      }
+      current_++;
+    }
+    if (AtEnd()) {
+      return false;
+    }
+    *length = current_ - *start;
+    current_ += num_quotes;
+    return true;
+  }
+
+  // Skips metadata, i.e. '@' followed by a qualified name and arguments.
+  bool SkipMetadata() {
+    ASSERT(Peek() == '@');
+    current_++;
+    const uint8_t* name;
+    intptr_t name_length;
+    while (true) {
+      SkipWhitespaceAndComments();
+      if (!ScanIdentifier(&name, &name_length)) {
+        return false;
+      }
+      SkipWhitespaceAndComments();
+      if (Peek() != '.') {
+        break;
+      }
+      current_++;
+    }
+    if (Peek() == '(') {
+      return SkipTo(')');
+    }
+    return true;
+  }
+
+  // Skips past the given character outside of parentheses, a closing
+  // parenthesis ends the parenthesized arguments the scanner is at.
+  bool SkipTo(uint8_t terminator) {
+    intptr_t depth = 0;
+    while (true) {
+      SkipWhitespaceAndComments();
+      if (AtEnd()) {
+        return false;
+      }
+      const uint8_t c = *current_;
+      if (IsQuote(c)) {
+        const uint8_t* start;
+        intptr_t length;
+        bool is_plain;
+        if (!ScanString(&start, &length, &is_plain)) {
+          return false;
+        }
+        continue;
+      }
+      current_++;
+      if (c == '(') {
+        depth++;
+      } else if (c == ')') {
+        depth--;
+      }
+      if (depth < 0) {
+        return false;
+      }
+      if ((c == terminator) && (depth == 0)) {
+        return true;
+      }
+    }
+  }
+
+ private:
+  static bool IsQuote(uint8_t c) {
+    return (c == '\'') || (c == '"');
+  }
+
+  static bool IsIdentifierChar(uint8_t c) {
+    return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) ||
+        ((c >= '0') && (c <= '9')) || (c == '_') || (c == '$');
+  }
+
+  bool IsAt(const char* s) const {
+    intptr_t length = strlen(s);
+    return ((end_ - current_) >= length) &&
+        (memcmp(current_, s, length) == 0);
+  }
+
+  bool IsAtQuotes(uint8_t quote, intptr_t count) const {
+    if ((end_ - current_) < count) {
+      return false;
+    }
+    for (intptr_t i = 0; i < count; i++) {
+      if (current_[i] != quote) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const uint8_t* current_;
+  const uint8_t* end_;
+
+  DISALLOW_COPY_AND_ASSIGN(DirectiveScanner);
+};
+
+
+static bool IsKeyword(const uint8_t* word,
+                      intptr_t length,
+                      const char* keyword) {
+  return (static_cast<intptr_t>(strlen(keyword)) == length) &&
+      (memcmp(word, keyword, length) == 0);
+}
+
+
+void SourcePrefetcher::ScanDirectives(const uint8_t* source,
+                                      intptr_t length,
+                                      DirectiveVisitor* visitor) {
+  DirectiveScanner scanner(source, length);
+  while (true) {
+    scanner.SkipWhitespaceAndComments();
+    if (scanner.Peek() == '@') {
+      if (!scanner.SkipMetadata()) {
+        return;
+      }
+      continue;
+    }
+    const uint8_t* word;
+    intptr_t word_length;
+    if (!scanner.ScanIdentifier(&word, &word_length)) {
+      return;
+    }
+    if (IsKeyword(word, word_length, "import") ||
+        IsKeyword(word, word_length, "export") ||
+        IsKeyword(word, word_length, "part")) {
+      scanner.SkipWhitespaceAndComments();
+      const uint8_t* uri;
+      intptr_t uri_length;
+      bool is_plain;
+      if (scanner.ScanString(&uri, &uri_length, &is_plain)) {
+        // Adjacent string literals are concatenated, leave those to the
+        // library tag handler as well.
+        scanner.SkipWhitespaceAndComments();
+        if (is_plain && !scanner.AtString()) {
+          visitor->VisitUri(uri, uri_length);
+        }
+      } else if (!IsKeyword(word, word_length, "part")) {
+        // Only 'part of' is not followed by a URI.
+        return;
+      }
+    } else if (!IsKeyword(word, word_length, "library")) {
+      // The first declaration ends the directives.
+      return;
+    }
+    if (!scanner.SkipTo(';')) {
+      return;
+    }
+  }
+}
+
+}  // namespace bin
+}  // namespace dart
@@ -0,0 +1,85 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef BIN_SOURCE_PREFETCHER_H_
+#define BIN_SOURCE_PREFETCHER_H_
+
+#include "bin/builtin.h"
+#include "platform/globals.h"
+
+
+namespace dart {
+
+// Forward declarations.
+class HashMap;
+class Monitor;
+
+namespace bin {
+
+// Visits the URIs of the directives of a library source, see
+// SourcePrefetcher::ScanDirectives.
+class DirectiveVisitor {
+ public:
+  virtual ~DirectiveVisitor() { }
+
+  // Visits the (still escaped) contents of a URI string literal.
+  virtual void VisitUri(const uint8_t* uri, intptr_t length) = 0;
+};
+
+
+// Reads the sources of imported libraries and parts on a few threads ahead
+// of the library tag handler. Whenever a library is loaded, the files named
+// by its directives are resolved on the isolate's thread and queued, so the
+// sources of sibling imports are read in parallel and are often in memory by
+// the time the parser asks for them.
+class SourcePrefetcher {
+ public:
+  // Starts the threads reading the queued files. Until then nothing is
+  // prefetched.
+  static void Start(intptr_t num_threads);
+  static bool IsStarted() { return monitor_ != NULL; }
+
+  // Waits for the threads to finish their current reads and frees the
+  // contents of the files that were never taken.
+  static void Stop();
+
+  // Queues a read of the file at path, unless it was queued before.
+  static void Prefetch(const char* path);
+
+  // Returns the malloc'ed contents of the file at path if it was queued,
+  // waiting for a pending read, and passes their ownership to the caller.
+  // Returns NULL if the file was not queued, was taken before or could not be
+  // read, the caller then reads the file itself.
+  static uint8_t* Take(const char* path, intptr_t* length);
+
+  // Calls the visitor for the URI of every import, export and part directive
+  // at the start of a library source. The scan stops at the first
+  // declaration, or at anything it does not understand.
+  static void ScanDirectives(const uint8_t* source,
+                             intptr_t length,
+                             DirectiveVisitor* visitor);
+
+ private:
+  class Source;
+
+  static void ReadSources(uword unused);
+  static uint8_t* ReadFile(const char* path, intptr_t* length);
+
+  static Monitor* monitor_;
+  // Maps paths to their Source.
+  static HashMap* sources_;
+  // The queue of sources to read.
+  static Source* queue_head_;
+  static Source* queue_tail_;
+  static intptr_t num_threads_;
+  static bool is_stopping_;
+
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(SourcePrefetcher);
+};
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // BIN_SOURCE_PREFETCHER_H_
@@ -0,0 +1,175 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "bin/file.h"
+#include "bin/source_prefetcher.h"
+#include "platform/assert.h"
+#include "platform/globals.h"
+#include "vm/unit_test.h"
+
+
+namespace dart {
+namespace bin {
+
+// Collects the URIs visited by SourcePrefetcher::ScanDirectives.
+class UriCollector : public DirectiveVisitor {
+ public:
+  static const intptr_t kMaxUris = 8;
+  static const intptr_t kMaxUriLength = 64;
+
+  UriCollector() : length_(0) { }
+
+  virtual void VisitUri(const uint8_t* uri, intptr_t length) {
+    EXPECT(length_ < kMaxUris);
+    EXPECT(length < kMaxUriLength);
+    if ((length_ < kMaxUris) && (length < kMaxUriLength)) {
+      memmove(uris_[length_], uri, length);
+      uris_[length_][length] = '\0';
+      length_++;
+    }
+  }
+
+  intptr_t length() const { return length_; }
+  const char* At(intptr_t index) const { return uris_[index]; }
+
+ private:
+  char uris_[kMaxUris][kMaxUriLength];
+  intptr_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(UriCollector);
+};
+
+
+static void Scan(const char* source, UriCollector* collector) {
+  SourcePrefetcher::ScanDirectives(reinterpret_cast<const uint8_t*>(source),
+                                   strlen(source),
+                                   collector);
+}
+
+
+UNIT_TEST_CASE(SourcePrefetcherDirectives) {
+  const char* kSource =
+      "library test;\n"
+      "import 'a.dart';\n"
+      "import \"b.dart\" as b show c hide d;\n"
+      "export 'c.dart';\n"
+      "part 'd.dart';\n"
+      "class A { }\n"
+      "import 'unreached.dart';\n";
+  UriCollector collector;
+  Scan(kSource, &collector);
+  EXPECT_EQ(4, collector.length());
+  EXPECT_STREQ("a.dart", collector.At(0));
+  EXPECT_STREQ("b.dart", collector.At(1));
+  EXPECT_STREQ("c.dart", collector.At(2));
+  EXPECT_STREQ("d.dart", collector.At(3));
+}
+
+
+UNIT_TEST_CASE(SourcePrefetcherBomAndScriptTag) {
+  const char* kSource =
+      "\xEF\xBB\xBF#!/usr/bin/env dart\n"
+      "import 'a.dart';\n";
+  UriCollector collector;
+  Scan(kSource, &collector);
+  EXPECT_EQ(1, collector.length());
+  EXPECT_STREQ("a.dart", collector.At(0));
+}
+
+
+UNIT_TEST_CASE(SourcePrefetcherComments) {
+  const char* kSource =
+      "// import 'line.dart';\n"
+      "/* import 'block.dart'; /* import 'nested.dart'; */\n"
+      "   import 'still_comment.dart'; */\n"
+      "import /* inline */ 'a.dart';\n";
+  UriCollector collector;
+  Scan(kSource, &collector);
+  EXPECT_EQ(1, collector.length());
+  EXPECT_STREQ("a.dart", collector.At(0));
+}
+
+
+UNIT_TEST_CASE(SourcePrefetcherMetadata) {
+  const char* kSource =
+      "@deprecated\n"
+      "@meta.Annotation('import \\'x.dart\\';', (1 + 2))\n"
+      "library test;\n"
+      "@Foo() import 'a.dart';\n";
+  UriCollector collector;
+  Scan(kSource, &collector);
+  EXPECT_EQ(1, collector.length());
+  EXPECT_STREQ("a.dart", collector.At(0));
+}
+
+
+UNIT_TEST_CASE(SourcePrefetcherPartOf) {
+  const char* kSource =
+      "part of test.library;\n"
+      "class A { }\n";
+  UriCollector collector;
+  Scan(kSource, &collector);
+  EXPECT_EQ(0, collector.length());
+}
+
+
+UNIT_TEST_CASE(SourcePrefetcherStringUris) {
+  const char* kSource =
+      "import r'raw\\name.dart';\n"
+      "import 'escaped\\'name.dart';\n"
+      "import 'interpolated_$name.dart';\n"
+      "import 'adjacent' '.dart';\n"
+      "import '''triple.dart''';\n"
+      "import \"\"\"\n"
+      "multiline.dart\"\"\";\n"
+      "import r'''raw_triple.dart''';\n"
+      "import 'last.dart';\n";
+  UriCollector collector;
+  Scan(kSource, &collector);
+  EXPECT_EQ(5, collector.length());
+  EXPECT_STREQ("raw\\name.dart", collector.At(0));
+  EXPECT_STREQ("triple.dart", collector.At(1));
+  EXPECT_STREQ("multiline.dart", collector.At(2));
+  EXPECT_STREQ("raw_triple.dart", collector.At(3));
+  EXPECT_STREQ("last.dart", collector.At(4));
+}
+
+
+// Helper method to be able to run the test from the runtime
+// directory, or the top directory.
+static const char* GetFileName(const char* name) {
+  if (File::Exists(name)) {
+    return name;
+  } else {
+    static const int kRuntimeLength = strlen("runtime/");
+    return name + kRuntimeLength;
+  }
+}
+
+
+UNIT_TEST_CASE(SourcePrefetcherTake) {
+  const char* kFilename =
+      GetFileName("runtime/bin/source_prefetcher_test.cc");
+  const char* kUntakenFilename = GetFileName("runtime/bin/file_test.cc");
+  SourcePrefetcher::Start(2);
+  EXPECT(SourcePrefetcher::IsStarted());
+  SourcePrefetcher::Prefetch(kFilename);
+  SourcePrefetcher::Prefetch(kUntakenFilename);
+  intptr_t length = 0;
+  uint8_t* data = SourcePrefetcher::Take(kFilename, &length);
+  EXPECT(data != NULL);
+  EXPECT(length > 13);
+  EXPECT(memcmp("// Copyright ", data, 13) == 0);
+  free(data);
+  // A source is only handed out once.
+  EXPECT(SourcePrefetcher::Take(kFilename, &length) == NULL);
+  EXPECT(SourcePrefetcher::Take("not_queued.dart", &length) == NULL);
+  // Frees the untaken source.
+  SourcePrefetcher::Stop();
+  EXPECT(!SourcePrefetcher::IsStarted());
+  EXPECT(SourcePrefetcher::Take(kFilename, &length) == NULL);
+}
+
+}  // namespace bin
+}  // namespace dart
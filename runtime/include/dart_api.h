@@ -1038,6 +1038,24 @@ DART_EXPORT bool Dart_HasLivePorts();
  */
 DART_EXPORT bool Dart_Post(Dart_Port port_id, Dart_Handle object);
 
+/**
+ * Posts a message for some isolate like Dart_Post, but moves the backing
+ * store of any external typed data in the message that has a finalizer
+ * attached to the receiving isolate instead of copying it.
+ *
+ * On success those external typed data objects are left empty in the
+ * current isolate and their finalizers run in the receiving isolate.
+ * External typed data without a finalizer is copied as with Dart_Post.
+ *
+ * Requires there to be a current isolate.
+ *
+ * \param port The destination port.
+ * \param object An object from the current isolate.
+ *
+ * \return True if the message was posted.
+ */
+DART_EXPORT bool Dart_PostTransfer(Dart_Port port_id, Dart_Handle object);
+
 /**
  * Returns a new SendPort with the provided port id.
  */
@@ -21,6 +21,10 @@
 
 namespace dart {
 
+DEFINE_FLAG(bool, transfer_external_typed_data, false,
+    "Move finalizable external typed data sent through a SendPort to the "
+    "receiving isolate instead of copying its contents.");
+
 class IsolateStartData {
  public:
   IsolateStartData(char* library_url,
@@ -101,13 +105,15 @@ DEFINE_NATIVE_ENTRY(SendPortImpl_sendInternal_, 2) {
   GET_NON_NULL_NATIVE_ARGUMENT(Instance, obj, arguments->NativeArgAt(1));
 
   uint8_t* data = NULL;
-  MessageWriter writer(&data, &allocator);
+  MessageWriter writer(&data, &allocator, FLAG_transfer_external_typed_data);
   writer.WriteMessage(obj);
 
+  Message* message = new Message(send_id.Value(),
+                                 data, writer.BytesWritten(),
+                                 Message::kNormalPriority);
+  writer.TransferFinalizers(message);
   // TODO(turnidge): Throw an exception when the return value is false?
-  PortMap::PostMessage(new Message(send_id.Value(),
-                                   data, writer.BytesWritten(),
-                                   Message::kNormalPriority));
+  PortMap::PostMessage(message);
   return Object::null();
 }
 
@@ -8,8 +8,8 @@ patch class Object {
   bool operator ==(other) native "Object_equals";
 
   // Helpers used to implement hashCode. If a hashCode is used, we remember it
-  // in a weak table in the VM. A new hashCode value is calculated using a
-  // number generator.
+  // in the object header (64-bit) or in a weak table in the VM. A new hashCode
+  // value is calculated using a number generator.
   static final _hashCodeRnd = new Random();
 
   static _getHash(obj) native "Object_getHash";
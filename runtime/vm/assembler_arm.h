@@ -319,6 +319,9 @@ class Assembler : public ValueObject {
   }
   const GrowableObjectArray& object_pool() const { return object_pool_; }
 
+  // Relocatable code is only generated on x64.
+  bool GetExternalSlots(GrowableArray<intptr_t>* slots) const { return false; }
+
   bool use_far_branches() const {
     return FLAG_use_far_branches || use_far_branches_;
   }
@@ -18,6 +18,7 @@ namespace dart {
 DEFINE_FLAG(bool, print_stop_message, true, "Print stop message.");
 DEFINE_FLAG(bool, use_sse41, true, "Use SSE 4.1 if available");
 DECLARE_FLAG(bool, inline_alloc);
+DECLARE_FLAG(bool, incremental_marking);
 
 
 bool CPUFeatures::sse2_supported_ = false;
@@ -1399,6 +1400,12 @@ void Assembler::orl(Register dst, const Address& address) {
 }
 
 
+void Assembler::orl(const Address& address, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitComplex(1, address, imm);
+}
+
+
 void Assembler::xorl(Register dst, Register src) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
   EmitUint8(0x33);
@@ -2053,6 +2060,27 @@ void Assembler::StoreIntoObject(Register object,
   ASSERT(object != value);
   movl(dest, value);
   Label done;
+  if (FLAG_incremental_marking) {
+    // Every heap object stored into an old object goes to the stub, which
+    // also grays old objects while old space is marked incrementally.
+    if (can_value_be_smi) {
+      testl(value, Immediate(kSmiTagMask));
+      j(ZERO, &done, Assembler::kNearJump);
+    }
+    testl(object, Immediate(kNewObjectAlignmentOffset));
+    j(NOT_ZERO, &done, Assembler::kNearJump);
+    pushl(EAX);
+    pushl(ECX);
+    pushl(object);
+    pushl(value);
+    popl(ECX);
+    popl(EAX);
+    call(&StubCode::UpdateStoreBufferLabel());
+    popl(ECX);
+    popl(EAX);
+    Bind(&done);
+    return;
+  }
   if (can_value_be_smi) {
     StoreIntoObjectFilter(object, value, &done);
   } else {
@@ -534,6 +534,7 @@ class Assembler : public ValueObject {
   void orl(Register dst, const Immediate& imm);
   void orl(Register dst, Register src);
   void orl(Register dst, const Address& address);
+  void orl(const Address& address, const Immediate& imm);
 
   void xorl(Register dst, const Immediate& imm);
   void xorl(Register dst, Register src);
@@ -713,6 +714,9 @@ class Assembler : public ValueObject {
   }
   const GrowableObjectArray& object_pool() const { return object_pool_; }
 
+  // Relocatable code is only generated on x64.
+  bool GetExternalSlots(GrowableArray<intptr_t>* slots) const { return false; }
+
   void FinalizeInstructions(const MemoryRegion& region) {
     buffer_.FinalizeInstructions(region);
   }
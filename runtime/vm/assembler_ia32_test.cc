@@ -660,6 +660,22 @@ ASSEMBLER_TEST_RUN(CompareSwapNEQ, test) {
 }
 
 
+ASSEMBLER_TEST_GENERATE(LockOrMemory, assembler) {
+  __ movl(EAX, Immediate(4));
+  __ pushl(EAX);
+  __ lock();
+  __ orl(Address(ESP, 0), Immediate(8));
+  __ popl(EAX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(LockOrMemory, test) {
+  typedef int (*LockOrMemoryCode)();
+  EXPECT_EQ(12, reinterpret_cast<LockOrMemoryCode>(test->entry())());
+}
+
+
 ASSEMBLER_TEST_GENERATE(SignedDivide, assembler) {
   __ movl(EAX, Immediate(-87));
   __ movl(EDX, Immediate(123));
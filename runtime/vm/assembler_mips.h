@@ -167,6 +167,9 @@ class Assembler : public ValueObject {
     return buffer_.pointer_offsets();
   }
   const GrowableObjectArray& object_pool() const { return object_pool_; }
+
+  // Relocatable code is only generated on x64.
+  bool GetExternalSlots(GrowableArray<intptr_t>* slots) const { return false; }
   void FinalizeInstructions(const MemoryRegion& region) {
     buffer_.FinalizeInstructions(region);
   }
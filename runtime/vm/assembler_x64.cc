@@ -17,6 +17,7 @@ namespace dart {
 DEFINE_FLAG(bool, print_stop_message, true, "Print stop message.");
 DEFINE_FLAG(bool, use_sse41, true, "Use SSE 4.1 if available");
 DECLARE_FLAG(bool, inline_alloc);
+DECLARE_FLAG(bool, incremental_marking);
 
 
 bool CPUFeatures::sse4_1_supported_ = false;
@@ -69,6 +70,8 @@ Assembler::Assembler(bool use_far_branches)
     : buffer_(),
       object_pool_(GrowableObjectArray::Handle()),
       patchable_pool_entries_(),
+      external_slots_(),
+      has_unrecorded_addresses_(false),
       prologue_offset_(-1),
       comments_() {
   // Far branching mode is only needed and implemented for MIPS and ARM.
@@ -148,13 +151,30 @@ void Assembler::LoadExternalLabel(Register dst,
 }
 
 
-void Assembler::call(const ExternalLabel* label) {
-  {  // Encode movq(TMP, Immediate(label->address())), but always as imm64.
-    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
-    EmitRegisterREX(TMP, REX_W);
-    EmitUint8(0xB8 | (TMP & 7));
-    EmitInt64(label->address());
+void Assembler::EmitExternalLabelImm64(Register dst,
+                                       const ExternalLabel* label) {
+  // Encode movq(dst, Immediate(label->address())), but always as imm64.
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRegisterREX(dst, REX_W);
+  EmitUint8(0xB8 | (dst & 7));
+  external_slots_.Add(-1 - buffer_.GetPosition());
+  EmitInt64(label->address());
+}
+
+
+void Assembler::LoadExternalAddress(Register dst,
+                                    const ExternalLabel* label,
+                                    Register pp) {
+  if ((pp != kNoRegister) && (Isolate::Current() != Dart::vm_isolate())) {
+    LoadExternalLabel(dst, label, kNotPatchable, pp);
+  } else {
+    EmitExternalLabelImm64(dst, label);
   }
+}
+
+
+void Assembler::call(const ExternalLabel* label) {
+  EmitExternalLabelImm64(TMP, label);
   call(TMP);
 }
 
@@ -1590,6 +1610,19 @@ void Assembler::OrImmediate(Register dst, const Immediate& imm, Register pp) {
 }
 
 
+void Assembler::orq(const Address& address, const Immediate& imm) {
+  if (imm.is_int32()) {
+    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+    EmitOperandREX(0, address, REX_W);
+    EmitComplex(1, Operand(address), imm);
+  } else {
+    movq(TMP, imm);
+    orq(TMP, address);
+    movq(address, TMP);
+  }
+}
+
+
 void Assembler::xorq(Register dst, Register src) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
   Operand operand(src);
@@ -2182,12 +2215,7 @@ void Assembler::jmp(Label* label, bool near) {
 
 
 void Assembler::jmp(const ExternalLabel* label) {
-  {  // Encode movq(TMP, Immediate(label->address())), but always as imm64.
-    AssemblerBuffer::EnsureCapacity ensured(&buffer_);
-    EmitRegisterREX(TMP, REX_W);
-    EmitUint8(0xB8 | (TMP & 7));
-    EmitInt64(label->address());
-  }
+  EmitExternalLabelImm64(TMP, label);
   jmp(TMP);
 }
 
@@ -2374,16 +2402,46 @@ intptr_t Assembler::FindExternalLabel(const ExternalLabel* label,
   if (patchable == kNotPatchable) {
     // If the call site is not patchable, we can try to re-use an existing
     // entry.
-    return FindObject(smi, kNotPatchable);
+    const intptr_t length = object_pool_.Length();
+    const intptr_t index = FindObject(smi, kNotPatchable);
+    if (index == length) {
+      external_slots_.Add(index);
+    } else if (!IsExternalSlot(index)) {
+      // The entry was added as a constant, not as an address.
+      has_unrecorded_addresses_ = true;
+    }
+    return index;
   }
   // If the call is patchable, do not reuse an existing entry since each
   // reference may be patched independently.
   object_pool_.Add(smi, Heap::kOld);
   patchable_pool_entries_.Add(patchable);
+  external_slots_.Add(object_pool_.Length() - 1);
   return object_pool_.Length() - 1;
 }
 
 
+bool Assembler::IsExternalSlot(intptr_t slot) const {
+  for (intptr_t i = 0; i < external_slots_.length(); i++) {
+    if (external_slots_[i] == slot) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool Assembler::GetExternalSlots(GrowableArray<intptr_t>* slots) const {
+  if (has_unrecorded_addresses_) {
+    return false;
+  }
+  for (intptr_t i = 0; i < external_slots_.length(); i++) {
+    slots->Add(external_slots_[i]);
+  }
+  return true;
+}
+
+
 bool Assembler::CanLoadFromObjectPool(const Object& object) {
   // TODO(zra, kmillikin): Also load other large immediates from the object
   // pool
@@ -2394,13 +2452,9 @@ bool Assembler::CanLoadFromObjectPool(const Object& object) {
   }
   ASSERT(object.IsNotTemporaryScopedHandle());
   ASSERT(object.IsOld());
-  return (Isolate::Current() != Dart::vm_isolate()) &&
-         // Not in the VMHeap, OR is one of the VMHeap objects we put in every
-         // object pool.
-         // TODO(zra): Evaluate putting all VM heap objects into the pool.
-         (!object.InVMHeap() || (object.raw() == Object::null()) ||
-                                (object.raw() == Bool::True().raw()) ||
-                                (object.raw() == Bool::False().raw()));
+  // VM heap objects are also loaded from the pool, so that code does not
+  // embed their addresses and can be relocated to another process.
+  return (Isolate::Current() != Dart::vm_isolate());
 }
 
 
@@ -2462,6 +2516,8 @@ void Assembler::CompareObject(Register reg, const Object& object, Register pp) {
 intptr_t Assembler::FindImmediate(int64_t imm) {
   ASSERT(Isolate::Current() != Dart::vm_isolate());
   ASSERT(!object_pool_.IsNull());
+  // Large immediates are usually addresses, which cannot be relocated.
+  has_unrecorded_addresses_ = true;
   const Smi& smi = Smi::Handle(reinterpret_cast<RawSmi*>(imm));
   return FindObject(smi, kNotPatchable);
 }
@@ -2553,6 +2609,27 @@ void Assembler::StoreIntoObject(Register object,
   ASSERT(object != value);
   movq(dest, value);
   Label done;
+  if (FLAG_incremental_marking) {
+    // Every heap object stored into an old object goes to the stub, which
+    // also grays old objects while old space is marked incrementally.
+    if (can_value_be_smi) {
+      testl(value, Immediate(kSmiTagMask));
+      j(ZERO, &done, Assembler::kNearJump);
+    }
+    testl(object, Immediate(kNewObjectAlignmentOffset));
+    j(NOT_ZERO, &done, Assembler::kNearJump);
+    pushq(RAX);
+    pushq(RCX);
+    pushq(object);
+    pushq(value);
+    popq(RCX);
+    popq(RAX);
+    Call(&StubCode::UpdateStoreBufferLabel(), PP);
+    popq(RCX);
+    popq(RAX);
+    Bind(&done);
+    return;
+  }
   if (can_value_be_smi) {
     StoreIntoObjectFilter(object, value, &done);
   } else {
@@ -2611,6 +2688,7 @@ void Assembler::DoubleAbs(XmmRegister reg) {
 
 void Assembler::Stop(const char* message) {
   int64_t message_address = reinterpret_cast<int64_t>(message);
+  has_unrecorded_addresses_ = true;
   if (FLAG_print_stop_message) {
     pushq(TMP);  // Preserve TMP register.
     pushq(RDI);  // Preserve RDI register.
@@ -2889,16 +2967,18 @@ void Assembler::TryAllocate(const Class& cls,
   if (FLAG_inline_alloc) {
     Heap* heap = Isolate::Current()->heap();
     const intptr_t instance_size = cls.instance_size();
-    LoadImmediate(TMP, Immediate(heap->TopAddress()), pp);
+    const ExternalLabel top_label("new_space_top", heap->TopAddress());
+    const ExternalLabel end_label("new_space_end", heap->EndAddress());
+    LoadExternalAddress(TMP, &top_label, pp);
     movq(instance_reg, Address(TMP, 0));
     AddImmediate(instance_reg, Immediate(instance_size), pp);
     // instance_reg: potential next object start.
-    LoadImmediate(TMP, Immediate(heap->EndAddress()), pp);
+    LoadExternalAddress(TMP, &end_label, pp);
     cmpq(instance_reg, Address(TMP, 0));
     j(ABOVE_EQUAL, failure, near_jump);
     // Successfully allocated the object, now update top to point to
     // next object start and store the class in the class field of object.
-    LoadImmediate(TMP, Immediate(heap->TopAddress()), pp);
+    LoadExternalAddress(TMP, &top_label, pp);
     movq(Address(TMP, 0), instance_reg);
     ASSERT(instance_size >= kHeapObjectTag);
     AddImmediate(instance_reg, Immediate(kHeapObjectTag - instance_size), pp);
@@ -518,6 +518,7 @@ class Assembler : public ValueObject {
   void orq(Register dst, Register src);
   void orq(Register dst, const Address& address);
   void orq(Register dst, const Immediate& imm);
+  void orq(const Address& address, const Immediate& imm);
   void OrImmediate(Register dst, const Immediate& imm, Register pp);
 
   void xorq(Register dst, Register src);
@@ -682,6 +683,11 @@ class Assembler : public ValueObject {
 
   bool CanLoadImmediateFromPool(const Immediate& imm, Register pp);
   void LoadImmediate(Register reg, const Immediate& imm, Register pp);
+  // Loads the address of the label and records where it is embedded, so that
+  // the code can be relocated when it is loaded from a snapshot.
+  void LoadExternalAddress(Register dst,
+                           const ExternalLabel* label,
+                           Register pp);
   void LoadImmediate(const Address& dst, const Immediate& imm, Register pp);
   void LoadObject(Register dst, const Object& obj, Register pp);
   void JmpPatchable(const ExternalLabel* label, Register pp);
@@ -764,6 +770,12 @@ class Assembler : public ValueObject {
   }
   const GrowableObjectArray& object_pool() const { return object_pool_; }
 
+  // Adds the locations of all external addresses embedded in the code to
+  // 'slots': an object pool index, or -1 - offset of a 64-bit immediate in
+  // the instructions. Returns false if the code embeds an address whose
+  // location was not recorded, such code cannot be relocated.
+  bool GetExternalSlots(GrowableArray<intptr_t>* slots) const;
+
   void FinalizeInstructions(const MemoryRegion& region) {
     buffer_.FinalizeInstructions(region);
   }
@@ -863,6 +875,10 @@ class Assembler : public ValueObject {
   // Patchability of pool entries.
   GrowableArray<Patchability> patchable_pool_entries_;
 
+  // Locations of embedded external addresses, see GetExternalSlots.
+  GrowableArray<intptr_t> external_slots_;
+  bool has_unrecorded_addresses_;
+
   // Pair type parameter for DirectChainedHashMap.
   class ObjIndexPair {
    public:
@@ -932,6 +948,8 @@ class Assembler : public ValueObject {
                          Patchability patchable,
                          Register pp);
   bool CanLoadFromObjectPool(const Object& object);
+  void EmitExternalLabelImm64(Register dst, const ExternalLabel* label);
+  bool IsExternalSlot(intptr_t slot) const;
   void LoadWordFromPoolOffset(Register dst, Register pp, int32_t offset);
 
   inline void EmitUint8(uint8_t value);
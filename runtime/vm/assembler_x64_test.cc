@@ -1241,6 +1241,22 @@ ASSEMBLER_TEST_RUN(CompareSwapNEQ, test) {
 }
 
 
+ASSEMBLER_TEST_GENERATE(LockOrMemory, assembler) {
+  __ movq(RAX, Immediate(4));
+  __ pushq(RAX);
+  __ lock();
+  __ orq(Address(RSP, 0), Immediate(8));
+  __ popq(RAX);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(LockOrMemory, test) {
+  typedef int (*LockOrMemoryCode)();
+  EXPECT_EQ(12, reinterpret_cast<LockOrMemoryCode>(test->entry())());
+}
+
+
 ASSEMBLER_TEST_GENERATE(Exchange, assembler) {
   __ movq(RAX, Immediate(kLargeConstant));
   __ movq(RDX, Immediate(kAnotherLargeConstant));
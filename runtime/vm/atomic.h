@@ -14,6 +14,10 @@ class AtomicOperations : public AllStatic {
   // Atomically fetch the value at p and increment the value at p.
   // Returns the original value at p.
   static uintptr_t FetchAndIncrement(uintptr_t* p);
+
+  // Atomically compare *ptr to old_value, and if equal, store new_value.
+  // Returns the original value at ptr.
+  static uword CompareAndSwapWord(uword* ptr, uword old_value, uword new_value);
 };
 
 
@@ -15,6 +15,13 @@ uintptr_t AtomicOperations::FetchAndIncrement(uintptr_t* p) {
 }
 
 
+uword AtomicOperations::CompareAndSwapWord(uword* ptr,
+                                           uword old_value,
+                                           uword new_value) {
+  return __sync_val_compare_and_swap(ptr, old_value, new_value);
+}
+
+
 }  // namespace dart
 
 
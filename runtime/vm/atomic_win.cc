@@ -23,6 +23,16 @@ uintptr_t AtomicOperations::FetchAndIncrement(uintptr_t* p) {
 }
 
 
+uword AtomicOperations::CompareAndSwapWord(uword* ptr,
+                                           uword old_value,
+                                           uword new_value) {
+  return reinterpret_cast<uword>(InterlockedCompareExchangePointer(
+      reinterpret_cast<PVOID*>(ptr),
+      reinterpret_cast<PVOID>(new_value),
+      reinterpret_cast<PVOID>(old_value)));
+}
+
+
 }  // namespace dart
 
 #endif  // defined(TARGET_OS_WINDOWS)
@@ -8,8 +8,13 @@
 #include "bin/file.h"
 
 #include "platform/assert.h"
+#include "platform/json.h"
 
+#include "vm/bootstrap_natives.h"
 #include "vm/dart_api_impl.h"
+#include "vm/message_handler.h"
+#include "vm/object_store.h"
+#include "vm/port.h"
 #include "vm/stack_frame.h"
 #include "vm/unit_test.h"
 
@@ -52,6 +57,55 @@ BENCHMARK(CorelibCompileAll) {
 }
 
 
+//
+// Measure iteration over the token streams of the core lib scripts, which
+// happens every time a function is parsed again to be compiled.
+//
+BENCHMARK(CorelibTokenStreamIteration) {
+  const int kNumIterations = 10;
+  Isolate* isolate = benchmark->isolate();
+  const GrowableObjectArray& libs = GrowableObjectArray::Handle(
+      isolate, isolate->object_store()->libraries());
+  const GrowableObjectArray& streams =
+      GrowableObjectArray::Handle(isolate, GrowableObjectArray::New());
+  Library& lib = Library::Handle(isolate);
+  Array& scripts = Array::Handle(isolate);
+  Script& script = Script::Handle(isolate);
+  TokenStream& tokens = TokenStream::Handle(isolate);
+  for (intptr_t i = 0; i < libs.Length(); i++) {
+    lib ^= libs.At(i);
+    scripts = lib.LoadedScripts();
+    for (intptr_t j = 0; j < scripts.Length(); j++) {
+      script ^= scripts.At(j);
+      script.Tokenize(String::Handle(isolate, lib.private_key()));
+      tokens = script.tokens();
+      streams.Add(tokens);
+    }
+  }
+  Timer timer(true, "Iterate core lib token streams benchmark");
+  timer.Start();
+  String& literal = String::Handle(isolate);
+  intptr_t num_tokens = 0;
+  for (int iteration = 0; iteration < kNumIterations; iteration++) {
+    for (intptr_t i = 0; i < streams.Length(); i++) {
+      tokens ^= streams.At(i);
+      TokenStream::Iterator iterator(tokens, 0);
+      while (iterator.CurrentTokenKind() != Token::kEOS) {
+        if (iterator.CurrentTokenKind() == Token::kIDENT) {
+          literal = iterator.CurrentLiteral();
+        }
+        iterator.Advance();
+        num_tokens++;
+      }
+    }
+  }
+  timer.Stop();
+  EXPECT(num_tokens > 0);
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+
 //
 // Measure creation of core isolate from a snapshot.
 //
@@ -86,6 +140,72 @@ BENCHMARK(CorelibIsolateStartup) {
 }
 
 
+//
+// Measure creation of a core isolate and loading of a script snapshot of a
+// large application of which main only uses a small part.
+//
+BENCHMARK(LargeAppIsolateStartup) {
+  const int kNumIterations = 100;
+  const int kNumClasses = 500;
+  TextBuffer source(64 * KB);
+  for (int i = 0; i < kNumClasses; i++) {
+    source.Printf("class C%d {\n"
+                  "  var name = 'C%d';\n"
+                  "  int add(int x) => x + %d;\n"
+                  "  int sum(List<int> list) {\n"
+                  "    var result = 0;\n"
+                  "    for (var x in list) {\n"
+                  "      result = add(result + x);\n"
+                  "    }\n"
+                  "    return result;\n"
+                  "  }\n"
+                  "  String toString() => '$name: ${sum([1, 2, 3])}';\n"
+                  "}\n", i, i, i);
+  }
+  source.Printf("main() => new C0().sum([1, 2, 3]);\n");
+  char* err = NULL;
+  Dart_Isolate base_isolate = Dart_CurrentIsolate();
+  Dart_Isolate test_isolate = Dart_CreateIsolate(NULL, NULL,
+                                                 bin::snapshot_buffer,
+                                                 NULL, &err);
+  EXPECT(test_isolate != NULL);
+  Dart_EnterScope();
+  uint8_t* full_snapshot = NULL;
+  intptr_t full_size = 0;
+  Dart_Handle result = Dart_CreateSnapshot(&full_snapshot, &full_size);
+  EXPECT_VALID(result);
+  result = Dart_LoadScript(NewString("large_app.dart"),
+                           NewString(source.buf()),
+                           0, 0);
+  EXPECT_VALID(result);
+  uint8_t* script_snapshot = NULL;
+  intptr_t script_size = 0;
+  result = Dart_CreateScriptSnapshot(&script_snapshot, &script_size);
+  EXPECT_VALID(result);
+  Timer timer(true, "Large app Isolate startup benchmark");
+  timer.Start();
+  for (int i = 0; i < kNumIterations; i++) {
+    Dart_Isolate new_isolate =
+        Dart_CreateIsolate(NULL, NULL, full_snapshot, NULL, &err);
+    EXPECT(new_isolate != NULL);
+    Dart_EnterScope();
+    result = Dart_LoadScriptFromSnapshot(script_snapshot, script_size);
+    EXPECT_VALID(result);
+    result = Dart_Invoke(Dart_RootLibrary(), NewString("main"), 0, NULL);
+    EXPECT_VALID(result);
+    Dart_ExitScope();
+    Dart_ShutdownIsolate();
+  }
+  timer.Stop();
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time / kNumIterations);
+  Dart_EnterIsolate(test_isolate);
+  Dart_ExitScope();
+  Dart_ShutdownIsolate();
+  Dart_EnterIsolate(base_isolate);
+}
+
+
 //
 // Measure invocation of Dart API functions.
 //
@@ -190,6 +310,45 @@ BENCHMARK(UseDartApi) {
 }
 
 
+//
+// Measure the resolution of the natives of the core libraries, which every
+// isolate loading them from source pays.
+//
+BENCHMARK(BootstrapNativeLookup) {
+  const int kNumIterations = 1000;
+  static const struct {
+    const char* name_;
+    int argument_count_;
+  } kNatives[] = {
+#define NATIVE_NAME(name, count) { #name, count },
+    BOOTSTRAP_NATIVE_LIST(NATIVE_NAME)
+#undef NATIVE_NAME
+  };
+  const intptr_t kNumNatives = sizeof(kNatives) / sizeof(kNatives[0]);
+  Dart_EnterScope();
+  Dart_Handle* names = new Dart_Handle[kNumNatives];
+  for (intptr_t i = 0; i < kNumNatives; i++) {
+    names[i] = NewString(kNatives[i].name_);
+  }
+  bool auto_setup_scope = false;
+  Timer timer(true, "BootstrapNativeLookup benchmark");
+  timer.Start();
+  for (int iteration = 0; iteration < kNumIterations; iteration++) {
+    StackZone zone(Isolate::Current());
+    for (intptr_t i = 0; i < kNumNatives; i++) {
+      EXPECT(BootstrapNatives::Lookup(names[i],
+                                      kNatives[i].argument_count_,
+                                      &auto_setup_scope) != NULL);
+    }
+  }
+  timer.Stop();
+  delete[] names;
+  Dart_ExitScope();
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+
 //
 // Measure time accessing internal and external strings.
 //
@@ -482,4 +641,86 @@ BENCHMARK(CreateMirrorSystem) {
   benchmark->set_score(elapsed_time);
 }
 
+
+class BenchmarkMessageHandler : public MessageHandler {
+ public:
+  BenchmarkMessageHandler() { }
+
+  virtual bool HandleMessage(Message* message) {
+    delete message;
+    return true;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BenchmarkMessageHandler);
+};
+
+
+struct PostMessagesInfo {
+  Dart_Port* ports;
+  intptr_t num_ports;
+  intptr_t num_messages;
+  intptr_t first_port;
+  Monitor* monitor;
+  intptr_t* running;
+};
+
+
+static void PostMessages(uword param) {
+  PostMessagesInfo* info = reinterpret_cast<PostMessagesInfo*>(param);
+  for (intptr_t i = 0; i < info->num_messages; i++) {
+    Dart_Port port = info->ports[(info->first_port + i) % info->num_ports];
+    PortMap::PostMessage(new Message(port, NULL, 0, Message::kNormalPriority));
+  }
+  MonitorLocker ml(info->monitor);
+  (*info->running)--;
+  ml.Notify();
+}
+
+
+//
+// Measure the throughput of small messages posted by several threads to the
+// ports of many message handlers.
+//
+BENCHMARK(PostMessageThroughput) {
+  const intptr_t kNumHandlers = 64;
+  const intptr_t kNumThreads = 4;
+  const intptr_t kMessagesPerThread = 100000;
+  BenchmarkMessageHandler* handlers[kNumHandlers];
+  Dart_Port ports[kNumHandlers];
+  for (intptr_t i = 0; i < kNumHandlers; i++) {
+    handlers[i] = new BenchmarkMessageHandler();
+    ports[i] = PortMap::CreatePort(handlers[i]);
+  }
+  Monitor monitor;
+  intptr_t running = kNumThreads;
+  PostMessagesInfo info[kNumThreads];
+  Timer timer(true, "PostMessage throughput benchmark");
+  timer.Start();
+  for (intptr_t i = 0; i < kNumThreads; i++) {
+    info[i].ports = ports;
+    info[i].num_ports = kNumHandlers;
+    info[i].num_messages = kMessagesPerThread;
+    info[i].first_port = i * (kNumHandlers / kNumThreads);
+    info[i].monitor = &monitor;
+    info[i].running = &running;
+    int result = Thread::Start(PostMessages, reinterpret_cast<uword>(&info[i]));
+    EXPECT_EQ(0, result);
+  }
+  {
+    MonitorLocker ml(&monitor);
+    while (running > 0) {
+      ml.Wait();
+    }
+  }
+  timer.Stop();
+  for (intptr_t i = 0; i < kNumHandlers; i++) {
+    // Closing the ports drops the pending messages.
+    PortMap::ClosePorts(handlers[i]);
+    delete handlers[i];
+  }
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
 }  // namespace dart
@@ -159,17 +159,53 @@ RawBigint* BigintOperations::FromHexCString(const char* hex_string,
 
 RawBigint* BigintOperations::FromDecimalCString(const char* str,
                                                 Heap::Space space) {
-  Isolate* isolate = Isolate::Current();
-  // Read 8 digits a time. 10^8 < 2^27.
-  const int kDigitsPerIteration = 8;
-  const Chunk kTenMultiplier = 100000000;
-  ASSERT(kDigitBitSize >= 27);
-
   const intptr_t str_length = strlen(str);
   if (str_length < 0) {
     FATAL("Fatal error in BigintOperations::FromDecimalCString: "
           "string too long");
   }
+  GrowableArray<const Bigint*> powers;
+  Bigint& result =
+      Bigint::Handle(FromDecimalDigits(str, str_length, &powers));
+  if ((space == Heap::kOld) && !result.IsOld()) {
+    result ^= Object::Clone(result, Heap::kOld);
+  }
+  return result.raw();
+}
+
+
+RawBigint* BigintOperations::FromDecimalDigits(
+    const char* str,
+    intptr_t length,
+    GrowableArray<const Bigint*>* powers) {
+  if (length <= kDecimalConversionThreshold * kDigitsPerDecimalChunk) {
+    return SimpleFromDecimalDigits(str, length);
+  }
+  // Split off the largest power-of-two number of decimal chunks that leaves
+  // a non-empty upper part: str = upper * 10^lower_length + lower.
+  intptr_t level = 0;
+  while ((kDigitsPerDecimalChunk << (level + 1)) < length) {
+    level++;
+  }
+  const intptr_t lower_length = kDigitsPerDecimalChunk << level;
+  const Bigint& power = DecimalPower(powers, level);
+  Bigint& result = Bigint::Handle(
+      FromDecimalDigits(str, length - lower_length, powers));
+  result = Multiply(result, power);
+  const Bigint& lower = Bigint::Handle(
+      FromDecimalDigits(str + length - lower_length, lower_length, powers));
+  return Add(result, lower);
+}
+
+
+RawBigint* BigintOperations::SimpleFromDecimalDigits(const char* str,
+                                                     intptr_t str_length) {
+  Isolate* isolate = Isolate::Current();
+  // Read 8 digits a time. 10^8 < 2^27.
+  const int kDigitsPerIteration = kDigitsPerDecimalChunk;
+  const Chunk kTenMultiplier = 100000000;
+  ASSERT(kDigitBitSize >= 27);
+
   intptr_t str_pos = 0;
 
   // Read first digit separately. This avoids a multiplication and addition.
@@ -204,9 +240,6 @@ RawBigint* BigintOperations::FromDecimalCString(const char* str,
     }
   }
   Clamp(result);
-  if ((space == Heap::kOld) && !result.IsOld()) {
-    result ^= Object::Clone(result, Heap::kOld);
-  }
   return result.raw();
 }
 
@@ -379,26 +412,17 @@ const char* BigintOperations::ToDecimalCString(
   ASSERT(result != NULL);
   intptr_t result_pos = 0;
 
-  // We divide the input into pieces of ~27 bits which can be efficiently
-  // handled.
-  const intptr_t kChunkDivisor = 100000000;
-  const int kChunkDigits = 8;
-  ASSERT(pow(10.0, kChunkDigits) == kChunkDivisor);
-  ASSERT(static_cast<Chunk>(kChunkDivisor) < kDigitMaxValue);
-  ASSERT(Smi::IsValid(kChunkDivisor));
-  const Chunk divisor = static_cast<Chunk>(kChunkDivisor);
-
-  // Rest contains the remaining bigint that needs to be printed.
-  const Bigint& rest = Bigint::Handle(Copy(bigint));
-  while (!rest.IsZero()) {
-    Chunk remainder = InplaceUnsignedDivideRemainderDigit(rest, divisor);
-    intptr_t part = static_cast<intptr_t>(remainder);
-    for (int i = 0; i < kChunkDigits; i++) {
-      result[result_pos++] = '0' + (part % 10);
-      part /= 10;
+  // Large numbers are split at powers of ten 10^(8 * 2^level). Pick the
+  // level at which the number has at most two parts.
+  GrowableArray<const Bigint*> powers;
+  intptr_t level = -1;
+  if (length > kDecimalConversionThreshold) {
+    level = 0;
+    while (UnsignedCompare(DecimalPower(&powers, level + 1), bigint) <= 0) {
+      level++;
     }
-    ASSERT(part == 0);
   }
+  ToReversedDecimalDigits(bigint, level, 0, powers, result, &result_pos);
   // Move the resulting position back until we don't have any zeroes anymore.
   // This is done so that we can remove all leading zeroes.
   while (result_pos > 1 && result[result_pos - 1] == '0') {
@@ -423,6 +447,70 @@ const char* BigintOperations::ToDecimalCString(
 }
 
 
+void BigintOperations::ToReversedDecimalDigits(
+    const Bigint& value,
+    intptr_t level,
+    intptr_t pad_length,
+    const GrowableArray<const Bigint*>& powers,
+    char* result,
+    intptr_t* result_pos) {
+  const intptr_t start_pos = *result_pos;
+  if ((level < 0) || (value.Length() <= kDecimalConversionThreshold)) {
+    // We divide the input into pieces of ~27 bits which can be efficiently
+    // handled.
+    const intptr_t kChunkDivisor = 100000000;
+    const int kChunkDigits = kDigitsPerDecimalChunk;
+    ASSERT(pow(10.0, kChunkDigits) == kChunkDivisor);
+    ASSERT(static_cast<Chunk>(kChunkDivisor) < kDigitMaxValue);
+    ASSERT(Smi::IsValid(kChunkDivisor));
+    const Chunk divisor = static_cast<Chunk>(kChunkDivisor);
+
+    // Rest contains the remaining bigint that needs to be printed.
+    const Bigint& rest = Bigint::Handle(Copy(value));
+    while (!rest.IsZero()) {
+      Chunk remainder = InplaceUnsignedDivideRemainderDigit(rest, divisor);
+      intptr_t part = static_cast<intptr_t>(remainder);
+      for (int i = 0; i < kChunkDigits; i++) {
+        result[(*result_pos)++] = '0' + (part % 10);
+        part /= 10;
+      }
+      ASSERT(part == 0);
+    }
+  } else {
+    // value = upper * 10^lower_length + lower, where both parts have at
+    // most lower_length digits. The lower part keeps its leading zeroes.
+    const intptr_t lower_length = kDigitsPerDecimalChunk << level;
+    Bigint& upper = Bigint::Handle();
+    Bigint& lower = Bigint::Handle();
+    DivideRemainder(value, *powers[level], &upper, &lower);
+    lower.SetSign(false);
+    ToReversedDecimalDigits(lower, level - 1, lower_length, powers,
+                            result, result_pos);
+    ToReversedDecimalDigits(upper, level - 1,
+                            Utils::Maximum(pad_length - lower_length,
+                                           static_cast<intptr_t>(0)),
+                            powers, result, result_pos);
+  }
+  while ((*result_pos - start_pos) < pad_length) {
+    result[(*result_pos)++] = '0';
+  }
+  ASSERT((pad_length == 0) || ((*result_pos - start_pos) == pad_length));
+}
+
+
+const Bigint& BigintOperations::DecimalPower(
+    GrowableArray<const Bigint*>* powers, intptr_t level) {
+  if (powers->is_empty()) {
+    powers->Add(&Bigint::ZoneHandle(NewFromInt64(100000000)));
+  }
+  while (powers->length() <= level) {
+    const Bigint& last = *powers->Last();
+    powers->Add(&Bigint::ZoneHandle(Multiply(last, last)));
+  }
+  return *(*powers)[level];
+}
+
+
 bool BigintOperations::FitsIntoSmi(const Bigint& bigint) {
   intptr_t bigint_length = bigint.Length();
   if (bigint_length == 0) {
@@ -730,113 +818,137 @@ RawBigint* BigintOperations::Multiply(const Bigint& a, const Bigint& b) {
 
   intptr_t a_length = a.Length();
   intptr_t b_length = b.Length();
-  intptr_t result_length = a_length + b_length;
-  const Bigint& result = Bigint::Handle(Bigint::Allocate(result_length));
-
-  if (a.IsNegative() != b.IsNegative()) {
-    result.ToggleSign();
+  if ((a_length == 0) || (b_length == 0)) {
+    return Zero();
   }
+  Bigint& result = Bigint::Handle();
+  if (Utils::Minimum(a_length, b_length) >= kToom3Threshold) {
+    result = Toom3Multiply(a, b);
+  } else {
+    intptr_t result_length = a_length + b_length;
+    result = Bigint::Allocate(result_length);
+    // The digit operations only allocate in the zone.
+    NoGCScope no_gc;
+    MultiplyDigits(a.ChunkAddr(0), a_length,
+                   b.ChunkAddr(0), b_length,
+                   result.ChunkAddr(0));
+  }
+  result.SetSign(a.IsNegative() != b.IsNegative());
+  Clamp(result);
+  return result.raw();
+}
 
-  // Comba multiplication: compute each column separately.
-  // Example: r = a2a1a0 * b2b1b0.
-  //    r =  1    * a0b0 +
-  //        10    * (a1b0 + a0b1) +
-  //        100   * (a2b0 + a1b1 + a0b2) +
-  //        1000  * (a2b1 + a1b2) +
-  //        10000 * a2b2
-  //
-  // Each column will be accumulated in an integer of type DoubleChunk. We must
-  // guarantee that the column-sum will not overflow.  We achieve this by
-  // 'blocking' the sum into overflow-free sums followed by propagating the
-  // overflow.
-  //
-  // Each bigint digit fits in kDigitBitSize bits.
-  // Each product fits in 2*kDigitBitSize bits.
-  // The accumulator is 8 * sizeof(DoubleChunk) == 2*kDigitBitSize + kCarryBits.
-  //
-  // Each time we add a product to the accumulator it could carry one bit into
-  // the carry bits, supporting kBlockSize = 2^kCarryBits - 1 addition
-  // operations before the DoubleChunk overflows.
-  //
-  // At the end of the column sum and after each batch of kBlockSize additions
-  // the high kCarryBits+kDigitBitSize of accumulator are flushed to
-  // accumulator_overflow.
-  //
-  // Diagramatically, using one char per 4 bits:
-  //
-  //  0aaaaaaa * 0bbbbbbb  ->  00pppppppppppppp   product of 2 digits
-  //                                   |
-  //                                   +          ...added to
-  //                                   v
-  //                           ccSSSSSSSsssssss   accumulator
-  //                                              ...flushed to
-  //                           000000000sssssss   accumulator
-  //                    vvvvvvvvvVVVVVVV          accumulator_overflow
-  //
-  //  'sssssss' becomes the column sum an overflow is carried to next column:
-  //
-  //                           000000000VVVVVVV   accumulator
-  //                    0000000vvvvvvvvv          accumulator_overflow
-  //
-  // accumulator_overflow supports 2^(kDigitBitSize + kCarryBits) additions of
-  // products.
-  //
-  // Since the bottom (kDigitBitSize + kCarryBits) bits of accumulator_overflow
-  // are initialized from the previous column, that uses up the capacity to
-  // absorb 2^kCarryBits additions.  The accumulator_overflow can overflow if
-  // the column has more than 2^(kDigitBitSize + kCarryBits) - 2^kCarryBits
-  // elements With current configuration that is 2^36-2^8 elements.  That is too
-  // high to happen in practice.  Comba multiplication is O(N^2) so overflow
-  // won't happen during a human lifespan.
-
-  const intptr_t kCarryBits = 8 * sizeof(DoubleChunk) - 2 * kDigitBitSize;
-  const intptr_t kBlockSize = (1 << kCarryBits) - 1;
-
-  DoubleChunk accumulator = 0;  // Accumulates the result of one column.
-  DoubleChunk accumulator_overflow = 0;
-  for (intptr_t i = 0; i < result_length; i++) {
-    // Example: r = a2a1a0 * b2b1b0.
-    //   For i == 0, compute a0b0.
-    //       i == 1,         a1b0 + a0b1 + overflow from i == 0.
-    //       i == 2,         a2b0 + a1b1 + a0b2 + overflow from i == 1.
-    //       ...
-    // The indices into a and b are such that their sum equals i.
-    intptr_t a_index = Utils::Minimum(a_length - 1, i);
-    intptr_t b_index = i - a_index;
-    ASSERT(a_index + b_index == i);
 
-    // Instead of testing for a_index >= 0 && b_index < b_length we compute the
-    // number of iterations first.
-    intptr_t iterations = Utils::Minimum(b_length - b_index, a_index + 1);
+RawBigint* BigintOperations::Toom3Multiply(const Bigint& a, const Bigint& b) {
+  const Bigint& shorter = (a.Length() < b.Length()) ? a : b;
+  const Bigint& longer = (a.Length() < b.Length()) ? b : a;
+  const intptr_t short_length = shorter.Length();
+  const intptr_t long_length = longer.Length();
+  Bigint& result = Bigint::Handle();
+  Isolate* isolate = Isolate::Current();
 
-    // For large products we need extra bit for the overflow.  The sum is broken
-    // into blocks to avoid dealing with the overflow on each iteration.
-    for (intptr_t j_block = 0; j_block < iterations; j_block += kBlockSize) {
-      intptr_t j_end = Utils::Minimum(j_block + kBlockSize, iterations);
-      for (intptr_t j = j_block; j < j_end; j++) {
-        DoubleChunk chunk_a = a.GetChunkAt(a_index);
-        DoubleChunk chunk_b = b.GetChunkAt(b_index);
-        accumulator += chunk_a * chunk_b;
-        a_index--;
-        b_index++;
-      }
-      accumulator_overflow += (accumulator >> kDigitBitSize);
-      accumulator &= kDigitMask;
+  // Operands of very different lengths are multiplied in slices of the
+  // shorter length, a three-way split would leave the shorter one empty.
+  if (long_length > 2 * short_length) {
+    const Bigint& factor =
+        Bigint::Handle(DigitsSlice(shorter, 0, short_length));
+    result = Zero();
+    for (intptr_t start = 0; start < long_length; start += short_length) {
+      HANDLESCOPE(isolate);
+      Bigint& product =
+          Bigint::Handle(DigitsSlice(longer, start, short_length));
+      product = Multiply(product, factor);
+      product = DigitsShiftLeft(product, start);
+      result = Add(result, product);
     }
-    result.SetChunkAt(i, static_cast<Chunk>(accumulator));
-    // Overflow becomes the initial accumulator for the next column.
-    accumulator = accumulator_overflow & kDigitMask;
-    // And the overflow from the overflow becomes the new overflow.
-    accumulator_overflow = (accumulator_overflow >> kDigitBitSize);
+    return result.raw();
   }
-  ASSERT(accumulator == 0);
-  ASSERT(accumulator_overflow == 0);
 
+  // Split a = a2 * x^2 + a1 * x + a0 and b likewise with x = 2^(k * digit).
+  // Evaluate both polynomials at 0, 1, -1, -2 and infinity, multiply the
+  // values pointwise and interpolate the product's coefficients following
+  // Bodrato's sequence.
+  const intptr_t k = (long_length + 2) / 3;
+  const Bigint& a0 = Bigint::Handle(DigitsSlice(a, 0, k));
+  const Bigint& a1 = Bigint::Handle(DigitsSlice(a, k, k));
+  const Bigint& a2 = Bigint::Handle(DigitsSlice(a, 2 * k, k));
+  const Bigint& b0 = Bigint::Handle(DigitsSlice(b, 0, k));
+  const Bigint& b1 = Bigint::Handle(DigitsSlice(b, k, k));
+  const Bigint& b2 = Bigint::Handle(DigitsSlice(b, 2 * k, k));
+
+  Bigint& a_at_1 = Bigint::Handle(Add(a0, a2));
+  Bigint& a_at_minus_1 = Bigint::Handle(Subtract(a_at_1, a1));
+  a_at_1 = Add(a_at_1, a1);
+  Bigint& a_at_minus_2 = Bigint::Handle(Add(a_at_minus_1, a2));
+  a_at_minus_2 = ShiftLeft(a_at_minus_2, 1);
+  a_at_minus_2 = Subtract(a_at_minus_2, a0);
+
+  Bigint& b_at_1 = Bigint::Handle(Add(b0, b2));
+  Bigint& b_at_minus_1 = Bigint::Handle(Subtract(b_at_1, b1));
+  b_at_1 = Add(b_at_1, b1);
+  Bigint& b_at_minus_2 = Bigint::Handle(Add(b_at_minus_1, b2));
+  b_at_minus_2 = ShiftLeft(b_at_minus_2, 1);
+  b_at_minus_2 = Subtract(b_at_minus_2, b0);
+
+  const Bigint& r0 = Bigint::Handle(Multiply(a0, b0));
+  Bigint& r1 = Bigint::Handle(Multiply(a_at_1, b_at_1));
+  const Bigint& r_minus_1 =
+      Bigint::Handle(Multiply(a_at_minus_1, b_at_minus_1));
+  const Bigint& r_minus_2 =
+      Bigint::Handle(Multiply(a_at_minus_2, b_at_minus_2));
+  const Bigint& r4 = Bigint::Handle(Multiply(a2, b2));
+
+  Bigint& r3 = Bigint::Handle(Subtract(r_minus_2, r1));
+  r3 = ExactDivideByDigit(r3, 3);
+  r1 = Subtract(r1, r_minus_1);
+  r1 = ExactDivideByDigit(r1, 2);
+  Bigint& r2 = Bigint::Handle(Subtract(r_minus_1, r0));
+  r3 = Subtract(r2, r3);
+  r3 = ExactDivideByDigit(r3, 2);
+  r3 = Add(r3, Bigint::Handle(ShiftLeft(r4, 1)));
+  r2 = Add(r2, r1);
+  r2 = Subtract(r2, r4);
+  r1 = Subtract(r1, r3);
+
+  // The coefficients are non-negative, combine them.
+  result = DigitsShiftLeft(r4, k);
+  result = Add(result, r3);
+  result = DigitsShiftLeft(result, k);
+  result = Add(result, r2);
+  result = DigitsShiftLeft(result, k);
+  result = Add(result, r1);
+  result = DigitsShiftLeft(result, k);
+  result = Add(result, r0);
+  return result.raw();
+}
+
+
+RawBigint* BigintOperations::DigitsSlice(const Bigint& bigint,
+                                         intptr_t start,
+                                         intptr_t length) {
+  const intptr_t available = bigint.Length() - start;
+  if (available <= 0) {
+    return Zero();
+  }
+  length = Utils::Minimum(length, available);
+  const Bigint& result = Bigint::Handle(Bigint::Allocate(length));
+  for (intptr_t i = 0; i < length; i++) {
+    result.SetChunkAt(i, bigint.GetChunkAt(start + i));
+  }
   Clamp(result);
   return result.raw();
 }
 
 
+RawBigint* BigintOperations::ExactDivideByDigit(const Bigint& bigint,
+                                                Chunk digit) {
+  const Bigint& result = Bigint::Handle(Copy(bigint));
+  Chunk remainder = InplaceUnsignedDivideRemainderDigit(result, digit);
+  ASSERT(remainder == 0);
+  return result.raw();
+}
+
+
 RawBigint* BigintOperations::Divide(const Bigint& a, const Bigint& b) {
   Bigint& quotient = Bigint::Handle();
   Bigint& remainder = Bigint::Handle();
@@ -1580,9 +1692,6 @@ RawBigint* BigintOperations::MultiplyWithDigit(
 
 void BigintOperations::DivideRemainder(
     const Bigint& a, const Bigint& b, Bigint* quotient, Bigint* remainder) {
-  // TODO(floitsch): This function is very memory-intensive since all
-  // intermediate bigint results are allocated in new memory. It would be
-  // much more efficient to reuse the space of temporary intermediate variables.
   ASSERT(IsClamped(a));
   ASSERT(IsClamped(b));
   ASSERT(!b.IsZero());
@@ -1615,154 +1724,22 @@ void BigintOperations::DivideRemainder(
     return;
   }
 
-  // High level description:
-  // The algorithm is basically the algorithm that is taught in school:
-  // Let a the dividend and b the divisor. We are looking for
-  // the quotient q = truncate(a / b), and
-  // the remainder r = a - q * b.
-  // School algorithm:
-  // q = 0
-  // n = number_of_digits(a) - number_of_digits(b)
-  // for (i = n; i >= 0; i--) {
-  //   Maximize k such that k*y*10^i is less than or equal to a and
-  //                  (k + 1)*y*10^i is greater.
-  //   q = q + k * 10^i   // Add new digit to result.
-  //   a = a - k * b * 10^i
-  // }
-  // r = a
-  //
-  // Instead of working in base 10 we work in base kDigitBitSize.
-
-  int normalization_shift =
-      kDigitBitSize - CountBits(b.GetChunkAt(b_length - 1));
-  Bigint& dividend = Bigint::Handle(ShiftLeft(a, normalization_shift));
-  const Bigint& divisor = Bigint::Handle(ShiftLeft(b, normalization_shift));
-  dividend.SetSign(false);
-  divisor.SetSign(false);
-
-  intptr_t dividend_length = dividend.Length();
-  intptr_t divisor_length = b_length;
-  ASSERT(divisor_length == divisor.Length());
-
-  intptr_t quotient_length = dividend_length - divisor_length + 1;
+  // Long division on the digit arrays, see DivideRemainderDigits.
+  intptr_t a_length = a.Length();
+  intptr_t quotient_length = a_length - b_length + 1;
   *quotient = Bigint::Allocate(quotient_length);
-  quotient->SetSign(a.IsNegative() != b.IsNegative());
-
-  intptr_t quotient_pos = dividend_length - divisor_length;
-  // Find the first quotient-digit.
-  // The first digit must be computed separately from the other digits because
-  // the preconditions for the loop are not yet satisfied.
-  // For simplicity use a shifted divisor, so that the comparison and
-  // subtraction are easier.
-  int divisor_shift_amount = dividend_length - divisor_length;
-  Bigint& shifted_divisor =
-      Bigint::Handle(DigitsShiftLeft(divisor, divisor_shift_amount));
-  Chunk first_quotient_digit = 0;
-  Isolate* isolate = Isolate::Current();
-  while (UnsignedCompare(dividend, shifted_divisor) >= 0) {
-    HANDLESCOPE(isolate);
-    first_quotient_digit++;
-    dividend = Subtract(dividend, shifted_divisor);
-  }
-  quotient->SetChunkAt(quotient_pos--, first_quotient_digit);
-
-  // Find the remainder of the digits.
-
-  Chunk first_divisor_digit = divisor.GetChunkAt(divisor_length - 1);
-  // The short divisor only represents the first two digits of the divisor.
-  // If the divisor has only one digit, then the second part is zeroed out.
-  Bigint& short_divisor = Bigint::Handle(Bigint::Allocate(2));
-  if (divisor_length > 1) {
-    short_divisor.SetChunkAt(0, divisor.GetChunkAt(divisor_length - 2));
-  } else {
-    short_divisor.SetChunkAt(0, 0);
-  }
-  short_divisor.SetChunkAt(1, first_divisor_digit);
-  // The following bigint will be used inside the loop. It is allocated outside
-  // the loop to avoid repeated allocations.
-  Bigint& target = Bigint::Handle(Bigint::Allocate(3));
-  // The dividend_length here must be from the initial dividend.
-  for (intptr_t i = dividend_length - 1; i >= divisor_length; i--) {
-    // Invariant: let t = i - divisor_length
-    //   then dividend / (divisor << (t * kDigitBitSize)) <= kDigitMaxValue.
-    // Ex: dividend: 53451232, and divisor: 535  (with t == 5) is ok.
-    //     dividend: 56822123, and divisor: 563  (with t == 5) is bad.
-    //     dividend:  6822123, and divisor: 563  (with t == 5) is ok.
-
-    HANDLESCOPE(isolate);
-    // The dividend has changed. So recompute its length.
-    dividend_length = dividend.Length();
-    Chunk dividend_digit;
-    if (i > dividend_length) {
-      quotient->SetChunkAt(quotient_pos--, 0);
-      continue;
-    } else if (i == dividend_length) {
-      dividend_digit = 0;
-    } else {
-      ASSERT(i + 1 == dividend_length);
-      dividend_digit = dividend.GetChunkAt(i);
-    }
-    Chunk quotient_digit;
-    // Compute an estimate of the quotient_digit. The estimate will never
-    // be too small.
-    if (dividend_digit == first_divisor_digit) {
-      // Small shortcut: the else-branch would compute a value > kDigitMaxValue.
-      // However, by hypothesis, we know that the quotient_digit must fit into
-      // a digit. Avoid going through repeated iterations of the adjustment
-      // loop by directly assigning kDigitMaxValue to the quotient_digit.
-      // Ex:  51235 / 523.
-      //    51 / 5 would yield 10 (if computed in the else branch).
-      // However we know that 9 is the maximal value.
-      quotient_digit = kDigitMaxValue;
-    } else {
-      // Compute the estimate by using two digits of the dividend and one of
-      // the divisor.
-      // Ex: 32421 / 535
-      //    32 / 5 -> 6
-      // The estimate would hence be 6.
-      DoubleChunk two_dividend_digits = dividend_digit;
-      two_dividend_digits <<= kDigitBitSize;
-      two_dividend_digits += dividend.GetChunkAt(i - 1);
-      DoubleChunk q = two_dividend_digits / first_divisor_digit;
-      if (q > kDigitMaxValue) q = kDigitMaxValue;
-      quotient_digit = static_cast<Chunk>(q);
-    }
-
-    // Refine estimation.
-    quotient_digit++;  // The following loop will start by decrementing.
-    Bigint& estimation_product = Bigint::Handle();
-    target.SetChunkAt(0, ((i - 2) < 0) ? 0 : dividend.GetChunkAt(i - 2));
-    target.SetChunkAt(1, ((i - 1) < 0) ? 0 : dividend.GetChunkAt(i - 1));
-    target.SetChunkAt(2, dividend_digit);
-    do {
-      HANDLESCOPE(isolate);
-      quotient_digit = (quotient_digit - 1) & kDigitMask;
-      estimation_product = MultiplyWithDigit(short_divisor, quotient_digit);
-    } while (UnsignedCompareNonClamped(estimation_product, target) > 0);
-    // At this point the quotient_digit is fairly accurate.
-    // At the worst it is off by one.
-    // Remove a multiple of the divisor. If the estimate is incorrect we will
-    // subtract the divisor another time.
-    // Let t = i - divisor_length.
-    // dividend -= (quotient_digit * divisor) << (t * kDigitBitSize);
-    shifted_divisor = MultiplyWithDigit(divisor, quotient_digit);
-    shifted_divisor = DigitsShiftLeft(shifted_divisor, i - divisor_length);
-    dividend = Subtract(dividend, shifted_divisor);
-    if (dividend.IsNegative()) {
-      // The estimation was still too big.
-      quotient_digit--;
-      // TODO(floitsch): allocate space for the shifted_divisor once and reuse
-      // it at every iteration.
-      shifted_divisor = DigitsShiftLeft(divisor, i - divisor_length);
-      // TODO(floitsch): reuse the space of the previous dividend.
-      dividend = Add(dividend, shifted_divisor);
-    }
-    quotient->SetChunkAt(quotient_pos--, quotient_digit);
+  *remainder = Bigint::Allocate(b_length);
+  {
+    // The digit operations only allocate in the zone.
+    NoGCScope no_gc;
+    DivideRemainderDigits(a.ChunkAddr(0), a_length,
+                          b.ChunkAddr(0), b_length,
+                          quotient->ChunkAddr(0), remainder->ChunkAddr(0));
   }
-  ASSERT(quotient_pos == -1);
-  Clamp(*quotient);
-  *remainder = ShiftRight(dividend, normalization_shift);
+  quotient->SetSign(a.IsNegative() != b.IsNegative());
   remainder->SetSign(a.IsNegative());
+  Clamp(*quotient);
+  Clamp(*remainder);
 }
 
 
@@ -1784,6 +1761,335 @@ BigintOperations::Chunk BigintOperations::InplaceUnsignedDivideRemainderDigit(
 }
 
 
+void BigintOperations::MultiplyDigits(const Chunk* a, intptr_t a_length,
+                                      const Chunk* b, intptr_t b_length,
+                                      Chunk* result) {
+  if (a_length < b_length) {
+    MultiplyDigits(b, b_length, a, a_length, result);
+    return;
+  }
+  if (b_length < kKaratsubaThreshold) {
+    ColumnMultiplyDigits(a, a_length, b, b_length, result);
+    return;
+  }
+  Zone* zone = Isolate::Current()->current_zone();
+  Chunk* scratch = zone->Alloc<Chunk>(KaratsubaScratchLength(b_length));
+  if (a_length == b_length) {
+    KaratsubaMultiplyDigits(a, b, b_length, result, scratch);
+    return;
+  }
+  // Multiply 'b' with slices of 'a' of the same length and accumulate the
+  // partial products.
+  Chunk* product = zone->Alloc<Chunk>(2 * b_length);
+  const intptr_t result_length = a_length + b_length;
+  for (intptr_t i = 0; i < result_length; i++) {
+    result[i] = 0;
+  }
+  for (intptr_t start = 0; start < a_length; start += b_length) {
+    const intptr_t slice_length = Utils::Minimum(b_length, a_length - start);
+    if (slice_length == b_length) {
+      KaratsubaMultiplyDigits(a + start, b, b_length, product, scratch);
+    } else {
+      MultiplyDigits(b, b_length, a + start, slice_length, product);
+    }
+    InplaceAddDigits(result + start, result_length - start,
+                     product, slice_length + b_length);
+  }
+}
+
+
+void BigintOperations::ColumnMultiplyDigits(const Chunk* a, intptr_t a_length,
+                                            const Chunk* b, intptr_t b_length,
+                                            Chunk* result) {
+  intptr_t result_length = a_length + b_length;
+  // Comba multiplication: compute each column separately.
+  // Example: r = a2a1a0 * b2b1b0.
+  //    r =  1    * a0b0 +
+  //        10    * (a1b0 + a0b1) +
+  //        100   * (a2b0 + a1b1 + a0b2) +
+  //        1000  * (a2b1 + a1b2) +
+  //        10000 * a2b2
+  //
+  // Each column will be accumulated in an integer of type DoubleChunk. We must
+  // guarantee that the column-sum will not overflow.  We achieve this by
+  // 'blocking' the sum into overflow-free sums followed by propagating the
+  // overflow.
+  //
+  // Each bigint digit fits in kDigitBitSize bits.
+  // Each product fits in 2*kDigitBitSize bits.
+  // The accumulator is 8 * sizeof(DoubleChunk) == 2*kDigitBitSize + kCarryBits.
+  //
+  // Each time we add a product to the accumulator it could carry one bit into
+  // the carry bits, supporting kBlockSize = 2^kCarryBits - 1 addition
+  // operations before the DoubleChunk overflows.
+  //
+  // At the end of the column sum and after each batch of kBlockSize additions
+  // the high kCarryBits+kDigitBitSize of accumulator are flushed to
+  // accumulator_overflow.
+  //
+  // Diagramatically, using one char per 4 bits:
+  //
+  //  0aaaaaaa * 0bbbbbbb  ->  00pppppppppppppp   product of 2 digits
+  //                                   |
+  //                                   +          ...added to
+  //                                   v
+  //                           ccSSSSSSSsssssss   accumulator
+  //                                              ...flushed to
+  //                           000000000sssssss   accumulator
+  //                    vvvvvvvvvVVVVVVV          accumulator_overflow
+  //
+  //  'sssssss' becomes the column sum an overflow is carried to next column:
+  //
+  //                           000000000VVVVVVV   accumulator
+  //                    0000000vvvvvvvvv          accumulator_overflow
+  //
+  // accumulator_overflow supports 2^(kDigitBitSize + kCarryBits) additions of
+  // products.
+  //
+  // Since the bottom (kDigitBitSize + kCarryBits) bits of accumulator_overflow
+  // are initialized from the previous column, that uses up the capacity to
+  // absorb 2^kCarryBits additions.  The accumulator_overflow can overflow if
+  // the column has more than 2^(kDigitBitSize + kCarryBits) - 2^kCarryBits
+  // elements With current configuration that is 2^36-2^8 elements.  That is too
+  // high to happen in practice.  Comba multiplication is O(N^2) so overflow
+  // won't happen during a human lifespan.
+
+  const intptr_t kCarryBits = 8 * sizeof(DoubleChunk) - 2 * kDigitBitSize;
+  const intptr_t kBlockSize = (1 << kCarryBits) - 1;
+
+  DoubleChunk accumulator = 0;  // Accumulates the result of one column.
+  DoubleChunk accumulator_overflow = 0;
+  for (intptr_t i = 0; i < result_length; i++) {
+    // Example: r = a2a1a0 * b2b1b0.
+    //   For i == 0, compute a0b0.
+    //       i == 1,         a1b0 + a0b1 + overflow from i == 0.
+    //       i == 2,         a2b0 + a1b1 + a0b2 + overflow from i == 1.
+    //       ...
+    // The indices into a and b are such that their sum equals i.
+    intptr_t a_index = Utils::Minimum(a_length - 1, i);
+    intptr_t b_index = i - a_index;
+    ASSERT(a_index + b_index == i);
+
+    // Instead of testing for a_index >= 0 && b_index < b_length we compute the
+    // number of iterations first.
+    intptr_t iterations = Utils::Minimum(b_length - b_index, a_index + 1);
+
+    // For large products we need extra bit for the overflow.  The sum is broken
+    // into blocks to avoid dealing with the overflow on each iteration.
+    for (intptr_t j_block = 0; j_block < iterations; j_block += kBlockSize) {
+      intptr_t j_end = Utils::Minimum(j_block + kBlockSize, iterations);
+      for (intptr_t j = j_block; j < j_end; j++) {
+        DoubleChunk chunk_a = a[a_index];
+        DoubleChunk chunk_b = b[b_index];
+        accumulator += chunk_a * chunk_b;
+        a_index--;
+        b_index++;
+      }
+      accumulator_overflow += (accumulator >> kDigitBitSize);
+      accumulator &= kDigitMask;
+    }
+    result[i] = static_cast<Chunk>(accumulator);
+    // Overflow becomes the initial accumulator for the next column.
+    accumulator = accumulator_overflow & kDigitMask;
+    // And the overflow from the overflow becomes the new overflow.
+    accumulator_overflow = (accumulator_overflow >> kDigitBitSize);
+  }
+  ASSERT(accumulator == 0);
+  ASSERT(accumulator_overflow == 0);
+}
+
+
+void BigintOperations::KaratsubaMultiplyDigits(const Chunk* a,
+                                               const Chunk* b,
+                                               intptr_t length,
+                                               Chunk* result,
+                                               Chunk* scratch) {
+  if (length < kKaratsubaThreshold) {
+    ColumnMultiplyDigits(a, length, b, length, result);
+    return;
+  }
+  // With a = a1 * x + a0 and b = b1 * x + b0:
+  //   a * b = a1b1 * x^2 + ((a0 + a1)(b0 + b1) - a0b0 - a1b1) * x + a0b0.
+  const intptr_t low_length = length / 2;
+  const intptr_t high_length = length - low_length;
+  const intptr_t sum_length = high_length + 1;
+  Chunk* a_sum = scratch;
+  Chunk* b_sum = a_sum + sum_length;
+  Chunk* middle = b_sum + sum_length;
+  Chunk* rest = middle + 2 * sum_length;
+
+  KaratsubaMultiplyDigits(a, b, low_length, result, rest);
+  KaratsubaMultiplyDigits(a + low_length, b + low_length, high_length,
+                          result + 2 * low_length, rest);
+  AddDigits(a, low_length, a + low_length, high_length, a_sum);
+  AddDigits(b, low_length, b + low_length, high_length, b_sum);
+  KaratsubaMultiplyDigits(a_sum, b_sum, sum_length, middle, rest);
+  InplaceSubtractDigits(middle, 2 * sum_length, result, 2 * low_length);
+  InplaceSubtractDigits(middle, 2 * sum_length,
+                        result + 2 * low_length, 2 * high_length);
+  intptr_t middle_length = 2 * sum_length;
+  while ((middle_length > 0) && (middle[middle_length - 1] == 0)) {
+    middle_length--;
+  }
+  InplaceAddDigits(result + low_length, 2 * length - low_length,
+                   middle, middle_length);
+}
+
+
+intptr_t BigintOperations::KaratsubaScratchLength(intptr_t length) {
+  if (length < kKaratsubaThreshold) {
+    return 0;
+  }
+  // The two sums and their product, followed by the space needed by the
+  // largest of the three recursive multiplications.
+  const intptr_t sum_length = length - (length / 2) + 1;
+  return (4 * sum_length) + KaratsubaScratchLength(sum_length);
+}
+
+
+void BigintOperations::AddDigits(const Chunk* a, intptr_t a_length,
+                                 const Chunk* b, intptr_t b_length,
+                                 Chunk* result) {
+  if (a_length < b_length) {
+    AddDigits(b, b_length, a, a_length, result);
+    return;
+  }
+  Chunk carry = 0;
+  for (intptr_t i = 0; i < a_length; i++) {
+    Chunk sum = a[i] + carry;
+    if (i < b_length) {
+      sum += b[i];
+    }
+    result[i] = sum & kDigitMask;
+    carry = sum >> kDigitBitSize;
+  }
+  result[a_length] = carry;
+}
+
+
+void BigintOperations::InplaceAddDigits(Chunk* a, intptr_t a_length,
+                                        const Chunk* b, intptr_t b_length) {
+  ASSERT(a_length >= b_length);
+  Chunk carry = 0;
+  intptr_t i = 0;
+  for (; i < b_length; i++) {
+    Chunk sum = a[i] + b[i] + carry;
+    a[i] = sum & kDigitMask;
+    carry = sum >> kDigitBitSize;
+  }
+  for (; (carry != 0) && (i < a_length); i++) {
+    Chunk sum = a[i] + carry;
+    a[i] = sum & kDigitMask;
+    carry = sum >> kDigitBitSize;
+  }
+  ASSERT(carry == 0);
+}
+
+
+void BigintOperations::InplaceSubtractDigits(Chunk* a,
+                                             intptr_t a_length,
+                                             const Chunk* b,
+                                             intptr_t b_length) {
+  ASSERT(a_length >= b_length);
+  Chunk borrow = 0;
+  intptr_t i = 0;
+  for (; i < b_length; i++) {
+    Chunk difference = a[i] - b[i] - borrow;
+    a[i] = difference & kDigitMask;
+    borrow = (difference >> kDigitBitSize) & 1;
+  }
+  for (; (borrow != 0) && (i < a_length); i++) {
+    Chunk difference = a[i] - borrow;
+    a[i] = difference & kDigitMask;
+    borrow = (difference >> kDigitBitSize) & 1;
+  }
+  ASSERT(borrow == 0);
+}
+
+
+void BigintOperations::DivideRemainderDigits(const Chunk* a, intptr_t a_length,
+                                             const Chunk* b, intptr_t b_length,
+                                             Chunk* quotient,
+                                             Chunk* remainder) {
+  ASSERT(b_length >= 2);
+  ASSERT(a_length >= b_length);
+  // Normalize so that the divisor's top digit has its highest bit set, this
+  // keeps each quotient digit estimate at most two above the real one.
+  // Digits have fewer bits than a Chunk, so a shift by kDigitBitSize is
+  // well defined and yields 0.
+  const intptr_t shift = kDigitBitSize - CountBits(b[b_length - 1]);
+  Zone* zone = Isolate::Current()->current_zone();
+  Chunk* divisor = zone->Alloc<Chunk>(b_length);
+  Chunk* dividend = zone->Alloc<Chunk>(a_length + 1);
+  for (intptr_t i = b_length - 1; i > 0; i--) {
+    divisor[i] = ((b[i] << shift) | (b[i - 1] >> (kDigitBitSize - shift))) &
+        kDigitMask;
+  }
+  divisor[0] = (b[0] << shift) & kDigitMask;
+  dividend[a_length] = a[a_length - 1] >> (kDigitBitSize - shift);
+  for (intptr_t i = a_length - 1; i > 0; i--) {
+    dividend[i] = ((a[i] << shift) | (a[i - 1] >> (kDigitBitSize - shift))) &
+        kDigitMask;
+  }
+  dividend[0] = (a[0] << shift) & kDigitMask;
+
+  const DoubleChunk kBase = static_cast<DoubleChunk>(1) << kDigitBitSize;
+  const DoubleChunk divisor_top = divisor[b_length - 1];
+  const DoubleChunk divisor_next = divisor[b_length - 2];
+  for (intptr_t j = a_length - b_length; j >= 0; j--) {
+    // Estimate the quotient digit from the top digits.
+    const DoubleChunk top =
+        (static_cast<DoubleChunk>(dividend[j + b_length]) << kDigitBitSize) |
+        dividend[j + b_length - 1];
+    DoubleChunk quotient_digit = top / divisor_top;
+    DoubleChunk rest = top - (quotient_digit * divisor_top);
+    while ((quotient_digit >= kBase) ||
+           ((quotient_digit * divisor_next) >
+            ((rest << kDigitBitSize) | dividend[j + b_length - 2]))) {
+      quotient_digit--;
+      rest += divisor_top;
+      if (rest >= kBase) break;
+    }
+
+    // Subtract quotient_digit * divisor from the dividend.
+    DoubleChunk carry = 0;
+    int64_t borrow = 0;
+    for (intptr_t i = 0; i < b_length; i++) {
+      const DoubleChunk product = (quotient_digit * divisor[i]) + carry;
+      carry = product >> kDigitBitSize;
+      const int64_t difference = static_cast<int64_t>(dividend[i + j]) -
+          static_cast<int64_t>(product & kDigitMask) + borrow;
+      dividend[i + j] = static_cast<Chunk>(difference & kDigitMask);
+      borrow = difference >> kDigitBitSize;
+    }
+    const int64_t difference = static_cast<int64_t>(dividend[j + b_length]) -
+        static_cast<int64_t>(carry) + borrow;
+    dividend[j + b_length] = static_cast<Chunk>(difference & kDigitMask);
+
+    if (difference < 0) {
+      // The estimate was one too big, add the divisor back.
+      quotient_digit--;
+      Chunk add_carry = 0;
+      for (intptr_t i = 0; i < b_length; i++) {
+        Chunk sum = dividend[i + j] + divisor[i] + add_carry;
+        dividend[i + j] = sum & kDigitMask;
+        add_carry = sum >> kDigitBitSize;
+      }
+      dividend[j + b_length] =
+          (dividend[j + b_length] + add_carry) & kDigitMask;
+    }
+    quotient[j] = static_cast<Chunk>(quotient_digit);
+  }
+
+  // Undo the normalization on the remainder.
+  for (intptr_t i = 0; i < b_length - 1; i++) {
+    remainder[i] = ((dividend[i] >> shift) |
+                    (dividend[i + 1] << (kDigitBitSize - shift))) & kDigitMask;
+  }
+  remainder[b_length - 1] = dividend[b_length - 1] >> shift;
+}
+
+
 void BigintOperations::Clamp(const Bigint& bigint) {
   intptr_t length = bigint.Length();
   while (length > 0 && (bigint.GetChunkAt(length - 1) == 0)) {
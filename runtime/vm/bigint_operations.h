@@ -5,6 +5,7 @@
 
 #include "platform/utils.h"
 
+#include "vm/growable_array.h"
 #include "vm/object.h"
 
 namespace dart {
@@ -102,6 +103,14 @@ class BigintOperations : public AllStatic {
     return (length == 0) || (bigint.GetChunkAt(length - 1) != 0);
   }
 
+  // Operand lengths, in digits, above which Multiply switches from Comba to
+  // Karatsuba and from Karatsuba to Toom-3 multiplication.
+  static const intptr_t kKaratsubaThreshold = 32;
+  static const intptr_t kToom3Threshold = 192;
+  // Length, in digits, above which decimal conversions split the number
+  // at a power of ten and convert both halves recursively.
+  static const intptr_t kDecimalConversionThreshold = 32;
+
  private:
   typedef Bigint::Chunk Chunk;
   typedef Bigint::DoubleChunk DoubleChunk;
@@ -136,6 +145,60 @@ class BigintOperations : public AllStatic {
   static RawBigint* UnsignedSubtract(const Bigint& a, const Bigint& b);
 
   static RawBigint* MultiplyWithDigit(const Bigint& bigint, Chunk digit);
+
+  // Multiplies the magnitudes of 'a' and 'b' by splitting them in three.
+  static RawBigint* Toom3Multiply(const Bigint& a, const Bigint& b);
+  // Returns the non-negative bigint made of 'length' digits of 'bigint'
+  // starting at digit 'start'.
+  static RawBigint* DigitsSlice(const Bigint& bigint,
+                                intptr_t start,
+                                intptr_t length);
+  // Divides by 'digit', which must divide 'bigint'. Keeps the sign.
+  static RawBigint* ExactDivideByDigit(const Bigint& bigint, Chunk digit);
+
+  // Operations on little-endian arrays of kDigitBitSize-bit digits. The
+  // 'result' array has room for 'a_length' + 'b_length' digits.
+  static void MultiplyDigits(const Chunk* a, intptr_t a_length,
+                             const Chunk* b, intptr_t b_length,
+                             Chunk* result);
+  static void ColumnMultiplyDigits(const Chunk* a, intptr_t a_length,
+                                   const Chunk* b, intptr_t b_length,
+                                   Chunk* result);
+  static void KaratsubaMultiplyDigits(const Chunk* a, const Chunk* b,
+                                      intptr_t length,
+                                      Chunk* result, Chunk* scratch);
+  static intptr_t KaratsubaScratchLength(intptr_t length);
+  static void AddDigits(const Chunk* a, intptr_t a_length,
+                        const Chunk* b, intptr_t b_length,
+                        Chunk* result);
+  static void InplaceAddDigits(Chunk* a, intptr_t a_length,
+                               const Chunk* b, intptr_t b_length);
+  static void InplaceSubtractDigits(Chunk* a, intptr_t a_length,
+                                    const Chunk* b, intptr_t b_length);
+  // Knuth's algorithm D. Requires 'b_length' >= 2 and 'a_length' >=
+  // 'b_length'. The quotient has 'a_length' - 'b_length' + 1 digits and the
+  // remainder 'b_length' digits.
+  static void DivideRemainderDigits(const Chunk* a, intptr_t a_length,
+                                    const Chunk* b, intptr_t b_length,
+                                    Chunk* quotient, Chunk* remainder);
+
+  // Decimal conversion helpers. 'powers' holds the bigints
+  // 10^(kDigitsPerDecimalChunk * 2^i).
+  static const int kDigitsPerDecimalChunk = 8;
+  static RawBigint* FromDecimalDigits(const char* str,
+                                      intptr_t length,
+                                      GrowableArray<const Bigint*>* powers);
+  static RawBigint* SimpleFromDecimalDigits(const char* str,
+                                             intptr_t str_length);
+  static void ToReversedDecimalDigits(
+      const Bigint& value,
+      intptr_t level,
+      intptr_t pad_length,
+      const GrowableArray<const Bigint*>& powers,
+      char* result,
+      intptr_t* result_pos);
+  static const Bigint& DecimalPower(GrowableArray<const Bigint*>* powers,
+                                    intptr_t level);
   static RawBigint* DigitsShiftLeft(const Bigint& bigint, intptr_t amount) {
     return ShiftLeft(bigint, amount * kDigitBitSize);
   }
@@ -2229,4 +2229,147 @@ TEST_CASE(BigintDivideRemainder) {
       "01234567890ABCDEE");
 }
 
+
+// Bigint digits hold 28 bits.
+static const intptr_t kTestDigitBitSize = 28;
+
+
+// Returns a pseudo random positive bigint of exactly 'bits' bits.
+static RawBigint* PseudoRandomBigint(intptr_t bits, uint32_t* seed) {
+  const intptr_t hex_length = (bits + 3) / 4;
+  char* hex = Isolate::Current()->current_zone()->Alloc<char>(hex_length + 1);
+  for (intptr_t i = 0; i < hex_length; i++) {
+    *seed = (*seed * 1103515245) + 12345;
+    hex[i] = "0123456789ABCDEF"[(*seed >> 16) & 0xF];
+  }
+  hex[0] = 'F';
+  hex[hex_length] = '\0';
+  const Bigint& result =
+      Bigint::Handle(BigintOperations::FromHexCString(hex));
+  // Trim to 'bits' bits, keeping the top bit set.
+  return BigintOperations::ShiftRight(result, (hex_length * 4) - bits);
+}
+
+
+// Returns 2^bits - 1, all of whose digits are maximal.
+static RawBigint* AllOnesBigint(intptr_t bits) {
+  const Bigint& one = Bigint::Handle(BigintOperations::NewFromInt64(1));
+  const Bigint& power = Bigint::Handle(BigintOperations::ShiftLeft(one, bits));
+  return BigintOperations::Subtract(power, one);
+}
+
+
+static void TestBigintMultiplyLengths(intptr_t a_digits,
+                                      intptr_t b_digits,
+                                      uint32_t* seed) {
+  const intptr_t a_bits = a_digits * kTestDigitBitSize;
+  const intptr_t b_bits = b_digits * kTestDigitBitSize;
+  const Bigint& a = Bigint::Handle(PseudoRandomBigint(a_bits, seed));
+  const Bigint& b = Bigint::Handle(PseudoRandomBigint(b_bits, seed));
+  const Bigint& c = Bigint::Handle(PseudoRandomBigint(b_bits - 1, seed));
+
+  // The product is commutative and distributes over addition, even when the
+  // operands take different multiplication algorithms.
+  const Bigint& ab = Bigint::Handle(BigintOperations::Multiply(a, b));
+  Bigint& other = Bigint::Handle(BigintOperations::Multiply(b, a));
+  EXPECT_EQ(0, BigintOperations::Compare(ab, other));
+  const Bigint& ac = Bigint::Handle(BigintOperations::Multiply(a, c));
+  other = BigintOperations::Add(b, c);
+  other = BigintOperations::Multiply(a, other);
+  EXPECT_EQ(0, BigintOperations::Compare(
+      Bigint::Handle(BigintOperations::Add(ab, ac)), other));
+
+  // Dividing the product plus a remainder smaller than b by b gives back a
+  // and the remainder.
+  const Bigint& dividend = Bigint::Handle(BigintOperations::Add(ab, c));
+  other = BigintOperations::Divide(dividend, b);
+  EXPECT_EQ(0, BigintOperations::Compare(a, other));
+  other = BigintOperations::Remainder(dividend, b);
+  EXPECT_EQ(0, BigintOperations::Compare(c, other));
+
+  // Signs follow the operands.
+  const Bigint& minus_a =
+      Bigint::Handle(BigintOperations::Subtract(
+          Bigint::Handle(BigintOperations::NewFromInt64(0)), a));
+  other = BigintOperations::Multiply(minus_a, b);
+  EXPECT(other.IsNegative());
+  other = BigintOperations::Add(other, ab);
+  EXPECT(other.IsZero());
+
+  // (2^x - 1) * (2^y - 1) = 2^(x + y) - 2^x - 2^y + 1 carries through every
+  // digit.
+  const Bigint& x = Bigint::Handle(AllOnesBigint(a_bits));
+  const Bigint& y = Bigint::Handle(AllOnesBigint(b_bits));
+  const Bigint& xy = Bigint::Handle(BigintOperations::Multiply(x, y));
+  const Bigint& one = Bigint::Handle(BigintOperations::NewFromInt64(1));
+  other = BigintOperations::ShiftLeft(one, a_bits + b_bits);
+  other = BigintOperations::Subtract(
+      other, Bigint::Handle(BigintOperations::ShiftLeft(one, a_bits)));
+  other = BigintOperations::Subtract(
+      other, Bigint::Handle(BigintOperations::ShiftLeft(one, b_bits)));
+  other = BigintOperations::Add(other, one);
+  EXPECT_EQ(0, BigintOperations::Compare(xy, other));
+  other = BigintOperations::Divide(xy, y);
+  EXPECT_EQ(0, BigintOperations::Compare(x, other));
+}
+
+
+TEST_CASE(BigintMultiplyCrossover) {
+  const intptr_t k = BigintOperations::kKaratsubaThreshold;
+  const intptr_t t = BigintOperations::kToom3Threshold;
+  const intptr_t lengths[] = {
+    1, 2, k - 1, k, k + 1, 2 * k + 1, t - 1, t, t + 1, (3 * t) + 2
+  };
+  const intptr_t num_lengths = sizeof(lengths) / sizeof(lengths[0]);
+  uint32_t seed = 42;
+  for (intptr_t i = 0; i < num_lengths; i++) {
+    for (intptr_t j = 0; j < num_lengths; j++) {
+      TestBigintMultiplyLengths(lengths[i], lengths[j], &seed);
+    }
+  }
+}
+
+
+TEST_CASE(BigintDecimalCrossover) {
+  // Decimal digit counts around the split thresholds of the conversions.
+  const intptr_t t = BigintOperations::kDecimalConversionThreshold;
+  const intptr_t lengths[] = {
+    (8 * t) - 1, 8 * t, (8 * t) + 1, 9 * t, 16 * t, (16 * t) + 3, 64 * t
+  };
+  const intptr_t num_lengths = sizeof(lengths) / sizeof(lengths[0]);
+  const Bigint& ten = Bigint::Handle(BigintOperations::NewFromInt64(10));
+  uint32_t seed = 7;
+  for (intptr_t i = 0; i < num_lengths; i++) {
+    const intptr_t length = lengths[i];
+    char* str = Isolate::Current()->current_zone()->Alloc<char>(length + 1);
+
+    // A power of ten has many zero chunks once converted.
+    Bigint& expected = Bigint::Handle(BigintOperations::NewFromInt64(1));
+    for (intptr_t j = 1; j < length; j++) {
+      expected = BigintOperations::Multiply(expected, ten);
+    }
+    str[0] = '1';
+    for (intptr_t j = 1; j < length; j++) {
+      str[j] = '0';
+    }
+    str[length] = '\0';
+    Bigint& bigint = Bigint::Handle(BigintOperations::NewFromCString(str));
+    EXPECT_EQ(0, BigintOperations::Compare(expected, bigint));
+    EXPECT_STREQ(str,
+                 BigintOperations::ToDecimalCString(bigint, &ZoneAllocator));
+
+    // Arbitrary digits round trip.
+    for (intptr_t j = 0; j < length; j++) {
+      seed = (seed * 1103515245) + 12345;
+      str[j] = '0' + ((seed >> 16) % 10);
+    }
+    str[0] = '-';
+    str[1] = '9';
+    bigint = BigintOperations::NewFromCString(str);
+    EXPECT(bigint.IsNegative());
+    EXPECT_STREQ(str,
+                 BigintOperations::ToDecimalCString(bigint, &ZoneAllocator));
+  }
+}
+
 }  // namespace dart
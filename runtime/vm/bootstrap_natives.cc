@@ -20,8 +20,8 @@ namespace dart {
 
 // List all native functions implemented in the vm or core bootstrap dart
 // libraries so that we can resolve the native function to it's entry
-// point.
-static struct NativeEntries {
+// point. The entries are sorted by name.
+static const struct NativeEntries {
   const char* name_;
   Dart_NativeFunction function_;
   int argument_count_;
@@ -41,14 +41,32 @@ Dart_NativeFunction BootstrapNatives::Lookup(Dart_Handle name,
   *auto_setup_scope = false;
   const char* function_name = obj.ToCString();
   ASSERT(function_name != NULL);
-  int num_entries = sizeof(BootStrapEntries) / sizeof(struct NativeEntries);
-  for (int i = 0; i < num_entries; i++) {
-    struct NativeEntries* entry = &(BootStrapEntries[i]);
-    if ((strcmp(function_name, entry->name_) == 0) &&
-        (entry->argument_count_ == argument_count)) {
-      return reinterpret_cast<Dart_NativeFunction>(entry->function_);
+  const intptr_t num_entries =
+      sizeof(BootStrapEntries) / sizeof(struct NativeEntries);
+  intptr_t lo = 0;
+  intptr_t hi = num_entries;
+  while (lo < hi) {
+    const intptr_t mid = lo + (hi - lo) / 2;
+    const struct NativeEntries* entry = &(BootStrapEntries[mid]);
+    const int result = strcmp(entry->name_, function_name);
+    if (result < 0) {
+      lo = mid + 1;
+    } else if (result > 0) {
+      hi = mid;
+    } else if (entry->argument_count_ == argument_count) {
+      return entry->function_;
+    } else {
+      return NULL;
     }
   }
+#if defined(DEBUG)
+  // A missing entry may also be due to BOOTSTRAP_NATIVE_LIST being out of
+  // order.
+  for (intptr_t i = 1; i < num_entries; i++) {
+    ASSERT(strcmp(BootStrapEntries[i - 1].name_, BootStrapEntries[i].name_) <
+           0);
+  }
+#endif  // defined(DEBUG)
   return NULL;
 }
 
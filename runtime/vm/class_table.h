@@ -38,6 +38,11 @@ class ClassTable {
 
   void Register(const Class& cls);
 
+  // Frees the tables replaced when the class table grew. They are kept alive
+  // because sweeper tasks look up classes without synchronizing with the
+  // mutator, so this must only be called while no sweeper task is running.
+  void FreeOldTables();
+
   void VisitObjectPointers(ObjectPointerVisitor* visitor);
 
   void Print();
@@ -52,10 +57,26 @@ class ClassTable {
   static const int initial_capacity_ = 512;
   static const int capacity_increment_ = 256;
 
+  // A table replaced by growing the class table.
+  class OldTable {
+   public:
+    OldTable(RawClass** table, OldTable* next) : table_(table), next_(next) {}
+    ~OldTable() { free(table_); }
+
+    OldTable* next() const { return next_; }
+
+   private:
+    RawClass** table_;
+    OldTable* next_;
+
+    DISALLOW_COPY_AND_ASSIGN(OldTable);
+  };
+
   intptr_t top_;
   intptr_t capacity_;
 
   RawClass** table_;
+  OldTable* old_tables_;
 
   DISALLOW_COPY_AND_ASSIGN(ClassTable);
 };
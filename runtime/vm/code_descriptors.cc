@@ -23,6 +23,17 @@ void DescriptorList::AddDescriptor(PcDescriptors::Kind kind,
 
 RawPcDescriptors* DescriptorList::FinalizePcDescriptors(uword entry_point) {
   intptr_t num_descriptors = Length();
+  // Descriptors are emitted almost in pc order, so an insertion sort is
+  // cheap. It also keeps descriptors at the same pc in emission order.
+  for (intptr_t i = 1; i < num_descriptors; i++) {
+    const struct PcDesc data = list_[i];
+    intptr_t j = i;
+    while ((j > 0) && (list_[j - 1].pc_offset > data.pc_offset)) {
+      list_[j] = list_[j - 1];
+      j--;
+    }
+    list_[j] = data;
+  }
   const PcDescriptors& descriptors =
       PcDescriptors::Handle(PcDescriptors::New(num_descriptors));
   for (intptr_t i = 0; i < num_descriptors; i++) {
@@ -0,0 +1,145 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/code_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform/assert.h"
+#include "vm/atomic.h"
+#include "vm/object.h"
+#include "vm/raw_object.h"
+
+namespace dart {
+
+CodeIndex::CodeIndex() : table_(AllocateTable(0)), num_pending_(0) {
+}
+
+
+CodeIndex::~CodeIndex() {
+  free(table_);
+  table_ = NULL;
+}
+
+
+CodeIndex::Table* CodeIndex::AllocateTable(intptr_t length) {
+  // Table already contains space for one entry.
+  const intptr_t size =
+      sizeof(Table) + (((length > 0) ? (length - 1) : 0) * sizeof(Entry));
+  Table* table = reinterpret_cast<Table*>(malloc(size));
+  table->length = length;
+  return table;
+}
+
+
+int CodeIndex::CompareEntries(const void* a, const void* b) {
+  const uword a_start = reinterpret_cast<const Entry*>(a)->start;
+  const uword b_start = reinterpret_cast<const Entry*>(b)->start;
+  if (a_start < b_start) {
+    return -1;
+  }
+  return (a_start > b_start) ? 1 : 0;
+}
+
+
+void CodeIndex::Add(const Instructions& instructions) {
+  ASSERT(!instructions.IsNull());
+  AddRange(instructions.EntryPoint(),
+           instructions.EntryPoint() + instructions.size(),
+           instructions.raw());
+}
+
+
+void CodeIndex::AddRange(uword start,
+                         uword end,
+                         RawInstructions* instructions) {
+  ASSERT(start < end);
+  if (num_pending_ == static_cast<uintptr_t>(kPendingCapacity)) {
+    Merge(false);
+  }
+  Entry* entry = &pending_[num_pending_];
+  entry->start = start;
+  entry->end = end;
+  entry->instructions = instructions;
+  // The entry is complete before a reader can see it.
+  AtomicOperations::FetchAndIncrement(&num_pending_);
+}
+
+
+RawInstructions* CodeIndex::Lookup(uword pc) const {
+  const Table* table = table_;
+  // Find the last entry starting at or below pc.
+  intptr_t lo = 0;
+  intptr_t hi = table->length;
+  while (lo < hi) {
+    const intptr_t mid = lo + (hi - lo) / 2;
+    if (table->entries[mid].start <= pc) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if ((lo > 0) && (pc < table->entries[lo - 1].end)) {
+    return table->entries[lo - 1].instructions;
+  }
+  const intptr_t num_pending = num_pending_;
+  for (intptr_t i = 0; i < num_pending; i++) {
+    if ((pending_[i].start <= pc) && (pc < pending_[i].end)) {
+      return pending_[i].instructions;
+    }
+  }
+  return NULL;
+}
+
+
+void CodeIndex::RemoveUnmarked() {
+  Merge(true);
+}
+
+
+intptr_t CodeIndex::Length() const {
+  return table_->length + num_pending_;
+}
+
+
+void CodeIndex::Merge(bool remove_unmarked) {
+  // Sort a copy, readers may be scanning the pending entries.
+  const intptr_t num_pending = num_pending_;
+  Entry sorted_pending[kPendingCapacity];
+  memmove(sorted_pending, pending_, num_pending * sizeof(Entry));
+  qsort(sorted_pending, num_pending, sizeof(Entry), CompareEntries);
+
+  Table* old_table = table_;
+  const intptr_t old_length = old_table->length;
+  Table* new_table = AllocateTable(old_length + num_pending);
+  intptr_t i = 0;
+  intptr_t j = 0;
+  intptr_t length = 0;
+  while ((i < old_length) || (j < num_pending)) {
+    const Entry* next;
+    if ((j == num_pending) ||
+        ((i < old_length) &&
+         (old_table->entries[i].start < sorted_pending[j].start))) {
+      next = &old_table->entries[i++];
+    } else {
+      next = &sorted_pending[j++];
+    }
+    if (remove_unmarked && !next->instructions->IsMarked()) {
+      continue;
+    }
+    new_table->entries[length++] = *next;
+  }
+  new_table->length = length;
+
+  // Publish the new table before dropping the pending entries it absorbed,
+  // a reader may briefly find an entry twice but never miss one.
+  AtomicOperations::CompareAndSwapWord(reinterpret_cast<uword*>(&table_),
+                                       reinterpret_cast<uword>(old_table),
+                                       reinterpret_cast<uword>(new_table));
+  AtomicOperations::CompareAndSwapWord(&num_pending_, num_pending, 0);
+  free(old_table);
+}
+
+}  // namespace dart
@@ -0,0 +1,72 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_CODE_INDEX_H_
+#define VM_CODE_INDEX_H_
+
+#include "vm/globals.h"
+
+namespace dart {
+
+// Forward declarations.
+class Instructions;
+class RawInstructions;
+
+// Maps a PC to the Instructions object containing it in logarithmic time.
+//
+// The entries live in an immutable table sorted by start address, plus a
+// small buffer of recently added entries that is merged into a new table
+// once it fills up. Only the isolate's thread modifies the index, and it
+// publishes a new table before freeing the old one. Lookups neither lock
+// nor allocate, so they may also run in a signal handler that interrupts
+// the isolate's thread.
+class CodeIndex {
+ public:
+  CodeIndex();
+  ~CodeIndex();
+
+  // Adds the code range of a newly installed Instructions object.
+  void Add(const Instructions& instructions);
+  void AddRange(uword start, uword end, RawInstructions* instructions);
+
+  // Returns the Instructions object containing 'pc' or NULL.
+  RawInstructions* Lookup(uword pc) const;
+
+  // Removes the entries of Instructions objects left unmarked by the last
+  // marking phase, i.e. code about to be freed by the sweeper.
+  void RemoveUnmarked();
+
+  // Number of entries in the index.
+  intptr_t Length() const;
+
+ private:
+  struct Entry {
+    uword start;
+    uword end;
+    RawInstructions* instructions;
+  };
+
+  struct Table {
+    intptr_t length;
+    Entry entries[1];
+  };
+
+  static const intptr_t kPendingCapacity = 256;
+
+  static Table* AllocateTable(intptr_t length);
+  static int CompareEntries(const void* a, const void* b);
+
+  // Replaces the table with one holding the table and pending entries.
+  void Merge(bool remove_unmarked);
+
+  Table* table_;
+  Entry pending_[kPendingCapacity];
+  uintptr_t num_pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodeIndex);
+};
+
+}  // namespace dart
+
+#endif  // VM_CODE_INDEX_H_
@@ -204,6 +204,7 @@ RawError* Dart::InitializeIsolate(const uint8_t* snapshot_buffer, void* data) {
     if (!error.IsNull()) {
       return error.raw();
     }
+    StubCode::Init(isolate);
   } else {
     // Initialize from snapshot (this should replicate the functionality
     // of Object::Init(..) in a regular isolate creation path.
@@ -218,6 +219,9 @@ RawError* Dart::InitializeIsolate(const uint8_t* snapshot_buffer, void* data) {
     SnapshotReader reader(snapshot->content(), snapshot->length(),
                           Snapshot::kFull, isolate);
     reader.ReadFullSnapshot();
+    // Code in the snapshot calls the stubs of the isolate.
+    StubCode::Init(isolate);
+    reader.RelocateCode();
     if (FLAG_trace_isolates) {
       isolate->heap()->PrintSizes();
       isolate->megamorphic_cache_table()->PrintSizes();
@@ -230,7 +234,6 @@ RawError* Dart::InitializeIsolate(const uint8_t* snapshot_buffer, void* data) {
 
   Object::VerifyBuiltinVtables();
 
-  StubCode::Init(isolate);
   if (snapshot_buffer == NULL) {
     if (!isolate->object_store()->PreallocateObjects()) {
       return isolate->object_store()->sticky_error();
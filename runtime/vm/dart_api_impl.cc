@@ -579,11 +579,22 @@ DART_EXPORT Dart_WeakPersistentHandle Dart_NewWeakPersistentHandle(
   DARTSCOPE(isolate);
   ApiState* state = isolate->api_state();
   ASSERT(state != NULL);
-  return AllocateFinalizableHandle(isolate,
-                                   &state->weak_persistent_handles(),
-                                   object,
-                                   peer,
-                                   callback);
+  Dart_WeakPersistentHandle result =
+      AllocateFinalizableHandle(isolate,
+                                &state->weak_persistent_handles(),
+                                object,
+                                peer,
+                                callback);
+  const Object& ref = Object::Handle(isolate, Api::UnwrapHandle(object));
+  if (ref.IsExternalTypedData() && (callback != NULL)) {
+    // Remember the finalizer, a message may transfer the data along with it.
+    const ExternalTypedData& array = ExternalTypedData::Cast(ref);
+    if (array.finalizer() == NULL) {
+      array.set_finalizer(
+          reinterpret_cast<FinalizablePersistentHandle*>(result));
+    }
+  }
+  return result;
 }
 
 
@@ -630,6 +641,7 @@ DART_EXPORT void Dart_DeleteWeakPersistentHandle(
   }
   FinalizablePersistentHandle* weak_ref =
       Api::UnwrapAsWeakPersistentHandle(object);
+  ExternalTypedData::ForgetFinalizer(weak_ref->raw(), weak_ref);
   state->weak_persistent_handles().FreeHandle(weak_ref);
   return;
 }
@@ -1091,6 +1103,20 @@ DART_EXPORT bool Dart_Post(Dart_Port port_id, Dart_Handle handle) {
 }
 
 
+DART_EXPORT bool Dart_PostTransfer(Dart_Port port_id, Dart_Handle handle) {
+  Isolate* isolate = Isolate::Current();
+  DARTSCOPE(isolate);
+  const Object& object = Object::Handle(isolate, Api::UnwrapHandle(handle));
+  uint8_t* data = NULL;
+  MessageWriter writer(&data, &allocator, true);
+  writer.WriteMessage(object);
+  intptr_t len = writer.BytesWritten();
+  Message* message = new Message(port_id, data, len, Message::kNormalPriority);
+  writer.TransferFinalizers(message);
+  return PortMap::PostMessage(message);
+}
+
+
 DART_EXPORT Dart_Handle Dart_NewSendPort(Dart_Port port_id) {
   Isolate* isolate = Isolate::Current();
   DARTSCOPE(isolate);
@@ -615,49 +615,89 @@ Dart_CObject* ApiMessageReader::ReadInternalVMObject(intptr_t class_id,
     }                                                                          \
 
     case kTypedDataInt8ArrayCid:
-    case kExternalTypedDataInt8ArrayCid:
       READ_TYPED_DATA(Int8, int8_t);
 
     case kTypedDataUint8ArrayCid:
-    case kExternalTypedDataUint8ArrayCid:
       READ_TYPED_DATA(Uint8, uint8_t);
 
     case kTypedDataUint8ClampedArrayCid:
-    case kExternalTypedDataUint8ClampedArrayCid:
       READ_TYPED_DATA(Uint8Clamped, uint8_t);
 
     case kTypedDataInt16ArrayCid:
-    case kExternalTypedDataInt16ArrayCid:
       READ_TYPED_DATA(Int16, int16_t);
 
     case kTypedDataUint16ArrayCid:
-    case kExternalTypedDataUint16ArrayCid:
       READ_TYPED_DATA(Uint16, uint16_t);
 
     case kTypedDataInt32ArrayCid:
-    case kExternalTypedDataInt32ArrayCid:
       READ_TYPED_DATA(Int32, int32_t);
 
     case kTypedDataUint32ArrayCid:
-    case kExternalTypedDataUint32ArrayCid:
       READ_TYPED_DATA(Uint32, uint32_t);
 
     case kTypedDataInt64ArrayCid:
-    case kExternalTypedDataInt64ArrayCid:
       READ_TYPED_DATA(Int64, int64_t);
 
     case kTypedDataUint64ArrayCid:
-    case kExternalTypedDataUint64ArrayCid:
       READ_TYPED_DATA(Uint64, uint64_t);
 
     case kTypedDataFloat32ArrayCid:
-    case kExternalTypedDataFloat32ArrayCid:
       READ_TYPED_DATA(Float32, float);
 
     case kTypedDataFloat64ArrayCid:
-    case kExternalTypedDataFloat64ArrayCid:
       READ_TYPED_DATA(Float64, double);
 
+#define READ_EXTERNAL_TYPED_DATA(darttype)                                     \
+    {                                                                          \
+      Dart_CObject* object = AllocateDartCObject(                              \
+          Dart_CObject_kExternalTypedData);                                    \
+      AddBackRef(object_id, object, kIsDeserialized);                          \
+      object->value.as_external_typed_data.type =                              \
+          Dart_TypedData_k##darttype;                                          \
+      object->value.as_external_typed_data.length = ReadSmiValue();            \
+      object->value.as_external_typed_data.data =                              \
+          reinterpret_cast<uint8_t*>(ReadIntptrValue());                       \
+      object->value.as_external_typed_data.peer =                              \
+          reinterpret_cast<void*>(ReadIntptrValue());                          \
+      object->value.as_external_typed_data.callback =                          \
+          reinterpret_cast<Dart_WeakPersistentHandleFinalizer>(                \
+              ReadIntptrValue());                                              \
+      return object;                                                           \
+    }                                                                          \
+
+    case kExternalTypedDataInt8ArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Int8);
+
+    case kExternalTypedDataUint8ArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Uint8);
+
+    case kExternalTypedDataUint8ClampedArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Uint8Clamped);
+
+    case kExternalTypedDataInt16ArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Int16);
+
+    case kExternalTypedDataUint16ArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Uint16);
+
+    case kExternalTypedDataInt32ArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Int32);
+
+    case kExternalTypedDataUint32ArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Uint32);
+
+    case kExternalTypedDataInt64ArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Int64);
+
+    case kExternalTypedDataUint64ArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Uint64);
+
+    case kExternalTypedDataFloat32ArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Float32);
+
+    case kExternalTypedDataFloat64ArrayCid:
+      READ_EXTERNAL_TYPED_DATA(Float64);
+
     case kGrowableObjectArrayCid: {
       // A GrowableObjectArray is serialized as its length followed by
       // its backing store. The backing store is an array with a
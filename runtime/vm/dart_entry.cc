@@ -296,6 +296,22 @@ void ArgumentsDescriptor::InitOnce() {
 }
 
 
+intptr_t ArgumentsDescriptor::IndexOfCachedDescriptor(RawObject* raw) {
+  for (intptr_t i = 0; i < kCachedDescriptorCount; i++) {
+    if (cached_args_descriptors_[i] == raw) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+
+RawArray* ArgumentsDescriptor::CachedDescriptor(intptr_t index) {
+  ASSERT((index >= 0) && (index < kCachedDescriptorCount));
+  return cached_args_descriptors_[index];
+}
+
+
 RawObject* DartLibraryCalls::InstanceCreate(const Library& lib,
                                             const String& class_name,
                                             const String& constructor_name,
@@ -61,6 +61,12 @@ class ArgumentsDescriptor : public ValueObject {
   // Initialize the preallocated fixed length arguments descriptors cache.
   static void InitOnce();
 
+  // Snapshots refer to the cached descriptors in the VM heap by index.
+  // Returns -1 if 'raw' is not a cached descriptor.
+  static intptr_t IndexOfCachedDescriptor(RawObject* raw);
+  static RawArray* CachedDescriptor(intptr_t index);
+  static intptr_t NumCachedDescriptors() { return kCachedDescriptorCount; }
+
  private:
   // Absolute indexes into the array.
   enum {
@@ -291,12 +291,10 @@ void ActivationFrame::GetPcDescriptors() {
 intptr_t ActivationFrame::TokenPos() {
   if (token_pos_ < 0) {
     GetPcDescriptors();
-    for (intptr_t i = 0; i < pc_desc_.Length(); i++) {
-      if (pc_desc_.PC(i) == pc_) {
-        pc_desc_index_ = i;
-        token_pos_ = pc_desc_.TokenPos(i);
-        break;
-      }
+    const intptr_t i = pc_desc_.FindPC(pc_);
+    if (i >= 0) {
+      pc_desc_index_ = i;
+      token_pos_ = pc_desc_.TokenPos(i);
     }
   }
   return token_pos_;
@@ -4,6 +4,7 @@
 
 #include "platform/assert.h"
 #include "vm/class_finalizer.h"
+#include "vm/code_index.h"
 #include "vm/compiler.h"
 #include "vm/object.h"
 #include "vm/pages.h"
@@ -153,6 +154,43 @@ TEST_CASE(FindCodeObject) {
   EXPECT(code.Size() > (1 * MB));
   pc = code.EntryPoint() + (1 * MB);
   EXPECT(Code::LookupCode(pc) == code.raw());
+
+  // Code that survives a collection can still be found.
+  isolate->heap()->CollectAllGarbage();
+  EXPECT(Code::LookupCode(pc) == code.raw());
+  OS::SNPrint(buffer, 256, "foo%d", 123);
+  function_name = String::New(buffer);
+  function = clsA.LookupStaticFunction(function_name);
+  code = function.CurrentCode();
+  pc = code.EntryPoint() + 16;
+  EXPECT(Code::LookupCode(pc) == code.raw());
+  EXPECT(Code::LookupCode(code.EntryPoint() + code.Size()) != code.raw());
+}
+
+
+UNIT_TEST_CASE(CodeIndexLookup) {
+  CodeIndex* index = new CodeIndex();
+  const intptr_t kNumRanges = 1000;
+  const uword kRangeSize = 64;
+  const uword kBase = 0x100000;
+  // Add ranges out of order, with gaps between them, so that both the
+  // sorted table and the pending entries are searched.
+  for (intptr_t i = 0; i < kNumRanges; i++) {
+    const intptr_t slot = (i * 7) % kNumRanges;
+    const uword start = kBase + slot * 2 * kRangeSize;
+    index->AddRange(start, start + kRangeSize,
+                    reinterpret_cast<RawInstructions*>(start));
+  }
+  EXPECT_EQ(kNumRanges, index->Length());
+  for (intptr_t slot = 0; slot < kNumRanges; slot++) {
+    const uword start = kBase + slot * 2 * kRangeSize;
+    RawInstructions* expected = reinterpret_cast<RawInstructions*>(start);
+    EXPECT(index->Lookup(start) == expected);
+    EXPECT(index->Lookup(start + kRangeSize - 1) == expected);
+    EXPECT(index->Lookup(start + kRangeSize) == NULL);
+  }
+  EXPECT(index->Lookup(kBase - 1) == NULL);
+  delete index;
 }
 
 }  // namespace dart
@@ -1441,9 +1441,7 @@ void FlowGraphCompiler::EmitMegamorphicInstanceCall(
   if (FLAG_collect_code) {
     // If we are collecting code, the code object may be null.
     Label is_compiled;
-    const Immediate& raw_null =
-        Immediate(reinterpret_cast<intptr_t>(Object::null()));
-    __ cmpq(RBX, raw_null);
+    __ CompareObject(RBX, Object::null_object(), PP);
     __ j(NOT_EQUAL, &is_compiled, Assembler::kNearJump);
     __ call(&StubCode::CompileFunctionRuntimeCallLabel());
     AddCurrentDescriptor(PcDescriptors::kRuntimeCall,
@@ -8,6 +8,7 @@
 #include <utility>
 
 #include "vm/bit_set.h"
+#include "vm/json_stream.h"
 #include "vm/object.h"
 #include "vm/raw_object.h"
 
@@ -56,35 +57,68 @@ uword FreeList::TryAllocate(intptr_t size) {
     return reinterpret_cast<uword>(DequeueElement(index));
   }
 
-  if ((index + 1) < kNumLists) {
-    intptr_t next_index = free_map_.Next(index + 1);
-    if (next_index != -1) {
-      // Dequeue an element from the list, split and enqueue the remainder in
-      // the appropriate list.
-      FreeListElement* element = DequeueElement(next_index);
-      SplitElementAfterAndEnqueue(element, size);
-      return reinterpret_cast<uword>(element);
-    }
+  if (size <= static_cast<intptr_t>(end_ - top_)) {
+    return BumpAllocate(size);
+  }
+
+  // The bump region is too small, start a new one in a block that fits.
+  RetireBumpRegion();
+  FreeListElement* element = DequeueRegionFor(size);
+  if (element == NULL) {
+    return 0;
+  }
+  top_ = reinterpret_cast<uword>(element);
+  end_ = top_ + element->Size();
+  return BumpAllocate(size);
+}
+
+
+uword FreeList::BumpAllocate(intptr_t size) {
+  ASSERT(size <= static_cast<intptr_t>(end_ - top_));
+  uword result = top_;
+  top_ += size;
+  if (top_ < end_) {
+    FreeListElement::AsElement(top_, end_ - top_);
   }
+  return result;
+}
+
+
+void FreeList::RetireBumpRegion() {
+  if (top_ < end_) {
+    intptr_t size = end_ - top_;
+    EnqueueElement(FreeListElement::AsElement(top_, size), IndexForSize(size));
+  }
+  top_ = 0;
+  end_ = 0;
+}
+
 
+FreeListElement* FreeList::DequeueRegionFor(intptr_t size) {
+  // Large blocks make for the longest regions, so look there first.
   FreeListElement* previous = NULL;
   FreeListElement* current = free_lists_[kNumLists];
   while (current != NULL) {
     if (current->Size() >= size) {
-      // Found an element large enough to hold the requested size. Dequeue,
-      // split and enqueue the remainder.
       if (previous == NULL) {
         free_lists_[kNumLists] = current->next();
       } else {
         previous->set_next(current->next());
       }
-      SplitElementAfterAndEnqueue(current, size);
-      return reinterpret_cast<uword>(current);
+      return current;
     }
     previous = current;
     current = current->next();
   }
-  return 0;
+
+  intptr_t index = IndexForSize(size);
+  if ((index + 1) < kNumLists) {
+    intptr_t next_index = free_map_.Next(index + 1);
+    if (next_index != -1) {
+      return DequeueElement(next_index);
+    }
+  }
+  return NULL;
 }
 
 
@@ -100,6 +134,29 @@ void FreeList::Reset() {
   for (int i = 0; i < (kNumLists + 1); i++) {
     free_lists_[i] = NULL;
   }
+  top_ = 0;
+  end_ = 0;
+}
+
+
+void FreeList::Merge(FreeList* other) {
+  other->RetireBumpRegion();
+  for (int i = 0; i < (kNumLists + 1); i++) {
+    FreeListElement* first = other->free_lists_[i];
+    if (first == NULL) {
+      continue;
+    }
+    FreeListElement* last = first;
+    while (last->next() != NULL) {
+      last = last->next();
+    }
+    last->set_next(free_lists_[i]);
+    free_lists_[i] = first;
+    if (i != kNumLists) {
+      free_map_.Set(i, true);
+    }
+  }
+  other->Reset();
 }
 
 
@@ -209,18 +266,47 @@ void FreeList::PrintLarge() const {
 void FreeList::Print() const {
   PrintSmall();
   PrintLarge();
+  OS::Print("bump region: %8" Pd " bytes\n", end_ - top_);
 }
 
 
-void FreeList::SplitElementAfterAndEnqueue(FreeListElement* element,
-                                           intptr_t size) {
-  intptr_t remainder_size = element->Size() - size;
-  if (remainder_size == 0) return;
-
-  element = FreeListElement::AsElement(reinterpret_cast<uword>(element) + size,
-                                       remainder_size);
-  intptr_t remainder_index = IndexForSize(remainder_size);
-  EnqueueElement(element, remainder_index);
+void FreeList::PrintToJSONObject(JSONObject* jsobj) const {
+  intptr_t free_bytes = end_ - top_;
+  intptr_t free_blocks = (top_ < end_) ? 1 : 0;
+  intptr_t largest_block = end_ - top_;
+  intptr_t small_blocks = 0;
+  for (int i = 0; i < kNumLists; i++) {
+    intptr_t list_length = Length(i);
+    small_blocks += list_length;
+    free_bytes += list_length * i * kObjectAlignment;
+    if (list_length > 0) {
+      largest_block = Utils::Maximum(largest_block,
+                                     static_cast<intptr_t>(i) *
+                                         kObjectAlignment);
+    }
+  }
+  intptr_t large_blocks = 0;
+  for (FreeListElement* node = free_lists_[kNumLists];
+       node != NULL;
+       node = node->next()) {
+    large_blocks++;
+    free_bytes += node->Size();
+    largest_block = Utils::Maximum(largest_block, node->Size());
+  }
+  free_blocks += small_blocks + large_blocks;
+  // Share of the free memory that cannot serve an allocation of the size of
+  // the largest free block.
+  double fragmentation = 0.0;
+  if (free_bytes > 0) {
+    fragmentation = 100.0 * (free_bytes - largest_block) / free_bytes;
+  }
+  jsobj->AddProperty("freeBytes", free_bytes);
+  jsobj->AddProperty("freeBlocks", free_blocks);
+  jsobj->AddProperty("smallBlocks", small_blocks);
+  jsobj->AddProperty("largeBlocks", large_blocks);
+  jsobj->AddProperty("largestBlock", largest_block);
+  jsobj->AddProperty("bumpRegionBytes", static_cast<intptr_t>(end_ - top_));
+  jsobj->AddProperty("fragmentation", fragmentation);
 }
 
 }  // namespace dart
@@ -12,6 +12,9 @@
 
 namespace dart {
 
+// Forward declarations.
+class JSONObject;
+
 // FreeListElement describes a freelist element.  Smallest FreeListElement is
 // two words in size.  Second word of the raw object is used to keep a next_
 // pointer to chain elements of the list together. For objects larger than the
@@ -70,6 +73,12 @@ class FreeListElement {
 };
 
 
+// A segregated fit free list. Blocks smaller than kNumLists allocation units
+// are kept in exact size classes, larger ones in a single list. Requests that
+// do not find a block of their exact size are bump allocated from the current
+// region, a contiguous free block such as the free runs found by the sweeper.
+// Only when the region is exhausted is a new one carved out of the free
+// blocks, instead of splitting a block for every allocation.
 class FreeList {
  public:
   FreeList();
@@ -80,10 +89,17 @@ class FreeList {
 
   void Reset();
 
+  // Moves all elements of the other free list into this one, leaving the
+  // other free list empty.
+  void Merge(FreeList* other);
+
   intptr_t Length(int index) const;
 
   void Print() const;
 
+  // Adds the amount of free memory and how fragmented it is to the object.
+  void PrintToJSONObject(JSONObject* jsobj) const;
+
  private:
   static const int kNumLists = 128;
 
@@ -92,7 +108,9 @@ class FreeList {
   void EnqueueElement(FreeListElement* element, intptr_t index);
   FreeListElement* DequeueElement(intptr_t index);
 
-  void SplitElementAfterAndEnqueue(FreeListElement* element, intptr_t size);
+  uword BumpAllocate(intptr_t size);
+  void RetireBumpRegion();
+  FreeListElement* DequeueRegionFor(intptr_t size);
 
   void PrintSmall() const;
   void PrintLarge() const;
@@ -101,6 +119,11 @@ class FreeList {
 
   FreeListElement* free_lists_[kNumLists + 1];
 
+  // The unused part [top_, end_) of the bump region is always covered by a
+  // free list element, so that the page remains walkable.
+  uword top_;
+  uword end_;
+
   DISALLOW_COPY_AND_ASSIGN(FreeList);
 };
 
@@ -4,6 +4,7 @@
 
 #include "platform/assert.h"
 #include "vm/freelist.h"
+#include "vm/json_stream.h"
 #include "vm/unit_test.h"
 
 namespace dart {
@@ -35,19 +36,53 @@ TEST_CASE(FreeList) {
   // Make sure that small objects can still split the remainder.
   uword small_object3 = free_list->TryAllocate(kSmallObjectSize);
   EXPECT_EQ(large_object + kLargeObjectSize, small_object3);
-  // Split the large object.
+  // Freed blocks are not split while the bump region has room.
   free_list->Free(large_object, kLargeObjectSize);
   uword small_object4 = free_list->TryAllocate(kSmallObjectSize);
-  EXPECT_EQ(large_object, small_object4);
-  // Get the full remainder of the large object.
+  EXPECT_EQ(small_object3 + kSmallObjectSize, small_object4);
+  // Get the full remainder of the blob.
+  uword remainder = small_object4 + kSmallObjectSize;
+  uword large_object2 = free_list->TryAllocate(blob + kBlobSize - remainder);
+  EXPECT_EQ(remainder, large_object2);
+  // The exhausted bump region is replaced by the freed large object.
+  uword small_object5 = free_list->TryAllocate(kSmallObjectSize);
+  EXPECT_EQ(large_object, small_object5);
   large_object = free_list->TryAllocate(kLargeObjectSize - kSmallObjectSize);
-  EXPECT_EQ(small_object4 + kSmallObjectSize, large_object);
-  // Get another large object from the large unallocated remainder.
-  uword large_object2 = free_list->TryAllocate(kLargeObjectSize);
-  EXPECT_EQ(small_object3 + kSmallObjectSize, large_object2);
+  EXPECT_EQ(small_object5 + kSmallObjectSize, large_object);
+  EXPECT(free_list->TryAllocate(kSmallObjectSize) == 0);
   // Delete the memory associated with the test.
   free(reinterpret_cast<void*>(blob));
   delete free_list;
 }
 
+
+TEST_CASE(FreeListStatistics) {
+  FreeList* free_list = new FreeList();
+  intptr_t kBlobSize = 64 * KB;
+  intptr_t kObjectSize = 4 * kWordSize;
+  uword blob = reinterpret_cast<uword>(malloc(kBlobSize));
+  // Free every other object of the first half and the whole second half.
+  intptr_t half = kBlobSize / 2;
+  for (intptr_t offset = 0; offset < half; offset += 2 * kObjectSize) {
+    free_list->Free(blob + offset, kObjectSize);
+  }
+  free_list->Free(blob + half, half);
+  JSONStream js;
+  {
+    JSONObject jsobj(&js);
+    free_list->PrintToJSONObject(&jsobj);
+  }
+  char expected[256];
+  OS::SNPrint(expected, sizeof(expected),
+              "{\"freeBytes\":%" Pd ",\"freeBlocks\":%" Pd ","
+              "\"smallBlocks\":%" Pd ",\"largeBlocks\":1,"
+              "\"largestBlock\":%" Pd ",\"bumpRegionBytes\":0,"
+              "\"fragmentation\":",
+              half + half / 2, half / (2 * kObjectSize) + 1,
+              half / (2 * kObjectSize), half);
+  EXPECT_SUBSTRING(expected, js.ToCString());
+  free(reinterpret_cast<void*>(blob));
+  delete free_list;
+}
+
 }  // namespace dart
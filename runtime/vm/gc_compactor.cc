@@ -0,0 +1,293 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/gc_compactor.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vm/dart_api_state.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/object_id_ring.h"
+#include "vm/pages.h"
+#include "vm/raw_object.h"
+#include "vm/stack_frame.h"
+#include "vm/store_buffer.h"
+#include "vm/visitor.h"
+#include "vm/weak_table.h"
+
+namespace dart {
+
+// Like the scavenger, the compactor uses RawObject::kMarkBit to tag the
+// forwarding address it leaves in the header of an evacuated object.
+enum {
+  kForwardingMask = 1 << RawObject::kMarkBit,
+  kForwarded = kForwardingMask,
+};
+
+
+static inline uword ForwardedAddr(uword header) {
+  ASSERT((header & kForwardingMask) == kForwarded);
+  return header & ~kForwardingMask;
+}
+
+
+static inline void ForwardTo(uword original, uword target) {
+  // Make sure forwarding can be encoded.
+  ASSERT((target & kForwardingMask) == 0);
+  *reinterpret_cast<uword*>(original) = target | kForwarded;
+}
+
+
+static RawObject* ForwardedObject(RawObject* raw_obj) {
+  uword header = *reinterpret_cast<uword*>(RawObject::ToAddr(raw_obj));
+  return RawObject::FromAddr(ForwardedAddr(header));
+}
+
+
+class CompactorVisitor : public ObjectPointerVisitor {
+ public:
+  CompactorVisitor(Isolate* isolate, GCCompactor* compactor)
+      : ObjectPointerVisitor(isolate), compactor_(compactor) { }
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      UpdatePointer(current);
+    }
+  }
+
+  void UpdatePointer(RawObject** p) {
+    RawObject* raw_obj = *p;
+    if (!raw_obj->IsHeapObject() || raw_obj->IsNewObject()) {
+      return;
+    }
+    if (compactor_->IsEvacuated(RawObject::ToAddr(raw_obj))) {
+      *p = ForwardedObject(raw_obj);
+    }
+  }
+
+ private:
+  GCCompactor* compactor_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompactorVisitor);
+};
+
+
+class CompactorWeakVisitor : public HandleVisitor {
+ public:
+  explicit CompactorWeakVisitor(CompactorVisitor* visitor)
+      : visitor_(visitor) { }
+
+  void VisitHandle(uword addr) {
+    FinalizablePersistentHandle* handle =
+        reinterpret_cast<FinalizablePersistentHandle*>(addr);
+    visitor_->UpdatePointer(handle->raw_addr());
+  }
+
+ private:
+  CompactorVisitor* visitor_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompactorWeakVisitor);
+};
+
+
+GCCompactor::GCCompactor(Heap* heap, PageSpace* old_space)
+    : heap_(heap),
+      old_space_(old_space),
+      pages_(NULL),
+      num_pages_(0),
+      start_(0),
+      end_(0) {
+}
+
+
+GCCompactor::~GCCompactor() {
+  delete[] pages_;
+}
+
+
+static int CompareAddresses(const void* a, const void* b) {
+  const uword a_addr = *reinterpret_cast<const uword*>(a);
+  const uword b_addr = *reinterpret_cast<const uword*>(b);
+  if (a_addr < b_addr) {
+    return -1;
+  }
+  return (a_addr > b_addr) ? 1 : 0;
+}
+
+
+bool GCCompactor::IsEvacuated(uword addr) const {
+  if ((addr < start_) || (addr >= end_)) {
+    return false;
+  }
+  // Find the last page starting at or below addr.
+  intptr_t lo = 0;
+  intptr_t hi = num_pages_;
+  while (lo < hi) {
+    const intptr_t mid = lo + (hi - lo) / 2;
+    if (reinterpret_cast<uword>(pages_[mid]) <= addr) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return (lo > 0) && pages_[lo - 1]->Contains(addr);
+}
+
+
+bool GCCompactor::EvacuatePage(HeapPage* page, intptr_t* moved) {
+  intptr_t moved_in_page = 0;
+  uword current = page->object_start();
+  uword end = page->object_end();
+  while (current < end) {
+    RawObject* raw_obj = RawObject::FromAddr(current);
+    intptr_t size = raw_obj->Size();
+    if (raw_obj->IsMarked()) {
+      uword new_addr = old_space_->AllocateForEvacuation(size);
+      if (new_addr == 0) {
+        UndoEvacuation(page, current);
+        return false;
+      }
+      memmove(reinterpret_cast<void*>(new_addr),
+              reinterpret_cast<void*>(current),
+              size);
+      RawObject::FromAddr(new_addr)->ClearMarkBit();
+      // Only the header of the original is overwritten, the sizes of the
+      // objects left to evacuate may still be looked up through a class in
+      // the page.
+      ForwardTo(current, new_addr);
+      moved_in_page += size;
+    }
+    current += size;
+  }
+  ASSERT(current == end);
+  *moved += moved_in_page;
+  return true;
+}
+
+
+void GCCompactor::UndoEvacuation(HeapPage* page, uword end) {
+  // All marked objects below end have been forwarded.
+  uword current = page->object_start();
+  while (current < end) {
+    uword header = *reinterpret_cast<uword*>(current);
+    if ((header & kForwardingMask) == kForwarded) {
+      uword new_addr = ForwardedAddr(header);
+      RawObject* raw_copy = RawObject::FromAddr(new_addr);
+      // The copy still has the original header, the original stays marked
+      // for the sweeper.
+      *reinterpret_cast<uword*>(current) =
+          *reinterpret_cast<uword*>(new_addr);
+      RawObject::FromAddr(current)->SetMarkBit();
+      old_space_->UndoAllocateForEvacuation(new_addr, raw_copy->Size());
+    }
+    current += RawObject::FromAddr(current)->Size();
+  }
+  ASSERT(current == end);
+}
+
+
+void GCCompactor::UpdateRoots(Isolate* isolate,
+                              ObjectPointerVisitor* visitor) {
+  isolate->VisitObjectPointers(visitor,
+                               true,
+                               StackFrameIterator::kDontValidateFrames);
+  ObjectIdRing* ring = isolate->object_id_ring();
+  if (ring != NULL) {
+    ring->VisitPointers(visitor);
+  }
+}
+
+
+void GCCompactor::UpdateStoreBuffer(Isolate* isolate) {
+  // Marking left only live objects in the store buffer.
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  StoreBufferBlock* block = store_buffer->Blocks();
+  while (block != NULL) {
+    intptr_t count = block->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      RawObject* raw_obj = block->At(i);
+      if (IsEvacuated(RawObject::ToAddr(raw_obj))) {
+        raw_obj = ForwardedObject(raw_obj);
+      }
+      store_buffer->AddObjectGC(raw_obj);
+    }
+    StoreBufferBlock* next = block->next();
+    delete block;
+    block = next;
+  }
+}
+
+
+void GCCompactor::UpdateWeakTables() {
+  for (int sel = 0;
+       sel < Heap::kNumWeakSelectors;
+       sel++) {
+    // Entries are hashed by address, the table is rebuilt.
+    WeakTable* table = heap_->GetWeakTable(
+        Heap::kOld, static_cast<Heap::WeakSelector>(sel));
+    heap_->SetWeakTable(Heap::kOld,
+                        static_cast<Heap::WeakSelector>(sel),
+                        WeakTable::NewFrom(table));
+    intptr_t size = table->size();
+    for (intptr_t i = 0; i < size; i++) {
+      if (table->IsValidEntryAt(i)) {
+        RawObject* raw_obj = table->ObjectAt(i);
+        ASSERT(raw_obj->IsHeapObject());
+        if (IsEvacuated(RawObject::ToAddr(raw_obj))) {
+          raw_obj = ForwardedObject(raw_obj);
+        }
+        heap_->SetWeakEntry(raw_obj,
+                            static_cast<Heap::WeakSelector>(sel),
+                            table->ValueAt(i));
+      }
+    }
+    delete table;
+  }
+}
+
+
+intptr_t GCCompactor::Compact(HeapPage* pages) {
+  ASSERT(pages_ == NULL);
+  for (HeapPage* page = pages; page != NULL; page = page->next()) {
+    num_pages_++;
+  }
+  pages_ = new HeapPage*[num_pages_];
+  intptr_t i = 0;
+  for (HeapPage* page = pages; page != NULL; page = page->next()) {
+    pages_[i++] = page;
+  }
+  qsort(pages_, num_pages_, sizeof(pages_[0]), CompareAddresses);
+
+  intptr_t moved = 0;
+  for (i = 0; i < num_pages_; i++) {
+    if (!EvacuatePage(pages_[i], &moved)) {
+      // Old space is exhausted, this page and the ones after it are kept.
+      num_pages_ = i;
+      break;
+    }
+  }
+  if (num_pages_ == 0) {
+    return moved;
+  }
+  start_ = pages_[0]->object_start();
+  end_ = pages_[num_pages_ - 1]->object_end();
+
+  // All remaining old objects have been swept, so only live objects refer to
+  // the evacuated ones. New-space objects are marking roots, so even the
+  // unreachable ones only refer to evacuated objects.
+  Isolate* isolate = Isolate::Current();
+  CompactorVisitor visitor(isolate, this);
+  UpdateRoots(isolate, &visitor);
+  CompactorWeakVisitor weak_visitor(&visitor);
+  isolate->VisitWeakPersistentHandles(&weak_visitor, true);
+  heap_->IterateNewPointers(&visitor);
+  heap_->IterateOldPointers(&visitor);
+  UpdateStoreBuffer(isolate);
+  UpdateWeakTables();
+  return moved;
+}
+
+}  // namespace dart
@@ -0,0 +1,61 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_GC_COMPACTOR_H_
+#define VM_GC_COMPACTOR_H_
+
+#include "vm/allocation.h"
+
+namespace dart {
+
+// Forward declarations.
+class Heap;
+class HeapPage;
+class Isolate;
+class ObjectPointerVisitor;
+class PageSpace;
+
+// The class GCCompactor evacuates the marked objects of sparsely used old
+// generation data pages as part of a mark-sweep, so that the pages can be
+// released. It runs once all other pages have been swept: the evacuated
+// objects are copied into the free lists of the page space and every
+// reference to them is updated. Instructions never move, code is reached
+// through return addresses and patched calls that are not visited.
+class GCCompactor : public ValueObject {
+ public:
+  GCCompactor(Heap* heap, PageSpace* old_space);
+  ~GCCompactor();
+
+  // Moves the marked objects of the given list of data pages, which are no
+  // longer part of the page space. Returns the size of the moved objects.
+  // The evacuated pages are not referenced anymore afterwards. If old space
+  // runs out, the objects of the remaining pages stay where they are.
+  intptr_t Compact(HeapPage* pages);
+
+  // Whether the object at addr has been moved, i.e. lies in a page that was
+  // evacuated.
+  bool IsEvacuated(uword addr) const;
+
+ private:
+  bool EvacuatePage(HeapPage* page, intptr_t* moved);
+  void UndoEvacuation(HeapPage* page, uword end);
+  void UpdateRoots(Isolate* isolate, ObjectPointerVisitor* visitor);
+  void UpdateStoreBuffer(Isolate* isolate);
+  void UpdateWeakTables();
+
+  Heap* heap_;
+  PageSpace* old_space_;
+
+  // The evacuated pages sorted by address.
+  HeapPage** pages_;
+  intptr_t num_pages_;
+  uword start_;
+  uword end_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(GCCompactor);
+};
+
+}  // namespace dart
+
+#endif  // VM_GC_COMPACTOR_H_
@@ -8,114 +8,23 @@
 #include <utility>
 
 #include "vm/allocation.h"
+#include "vm/dart.h"
 #include "vm/dart_api_state.h"
 #include "vm/isolate.h"
+#include "vm/marking_stack.h"
 #include "vm/pages.h"
 #include "vm/raw_object.h"
+#include "vm/runtime_entry.h"
 #include "vm/stack_frame.h"
+#include "vm/thread_pool.h"
 #include "vm/visitor.h"
 #include "vm/object_id_ring.h"
 
 namespace dart {
 
-// A simple chunked marking stack.
-class MarkingStack : public ValueObject {
- public:
-  MarkingStack()
-      : head_(new MarkingStackChunk()),
-        empty_chunks_(NULL),
-        marking_stack_(NULL),
-        top_(0) {
-    marking_stack_ = head_->MarkingStackChunkMemory();
-  }
-
-  ~MarkingStack() {
-    // TODO(iposva): Consider caching a couple emtpy marking stack chunks.
-    ASSERT(IsEmpty());
-    delete head_;
-    MarkingStackChunk* next;
-    while (empty_chunks_ != NULL) {
-      next = empty_chunks_->next();
-      delete empty_chunks_;
-      empty_chunks_ = next;
-    }
-  }
-
-  bool IsEmpty() const {
-    return IsMarkingStackChunkEmpty() && (head_->next() == NULL);
-  }
-
-  void Push(RawObject* value) {
-    ASSERT(!IsMarkingStackChunkFull());
-    marking_stack_[top_] = value;
-    top_++;
-    if (IsMarkingStackChunkFull()) {
-      MarkingStackChunk* new_chunk;
-      if (empty_chunks_ == NULL) {
-        new_chunk = new MarkingStackChunk();
-      } else {
-        new_chunk = empty_chunks_;
-        empty_chunks_ = new_chunk->next();
-      }
-      new_chunk->set_next(head_);
-      head_ = new_chunk;
-      marking_stack_ = head_->MarkingStackChunkMemory();
-      top_ = 0;
-    }
-  }
-
-  RawObject* Pop() {
-    ASSERT(head_ != NULL);
-    ASSERT(!IsEmpty());
-    if (IsMarkingStackChunkEmpty()) {
-      MarkingStackChunk* empty_chunk = head_;
-      head_ = head_->next();
-      empty_chunk->set_next(empty_chunks_);
-      empty_chunks_ = empty_chunk;
-      marking_stack_ = head_->MarkingStackChunkMemory();
-      top_ = MarkingStackChunk::kMarkingStackChunkSize;
-    }
-    top_--;
-    return marking_stack_[top_];
-  }
-
- private:
-  class MarkingStackChunk {
-   public:
-    MarkingStackChunk() : next_(NULL) {}
-    ~MarkingStackChunk() {}
-
-    RawObject** MarkingStackChunkMemory() {
-      return &memory_[0];
-    }
-
-    MarkingStackChunk* next() const { return next_; }
-    void set_next(MarkingStackChunk* value) { next_ = value; }
-
-    static const uint32_t kMarkingStackChunkSize = 1024;
-
-   private:
-    RawObject* memory_[kMarkingStackChunkSize];
-    MarkingStackChunk* next_;
-
-    DISALLOW_COPY_AND_ASSIGN(MarkingStackChunk);
-  };
-
-  bool IsMarkingStackChunkFull() const {
-    return top_ == MarkingStackChunk::kMarkingStackChunkSize;
-  }
-
-  bool IsMarkingStackChunkEmpty() const {
-    return top_ == 0;
-  }
-
-  MarkingStackChunk* head_;
-  MarkingStackChunk* empty_chunks_;
-  RawObject** marking_stack_;
-  uint32_t top_;
-
-  DISALLOW_COPY_AND_ASSIGN(MarkingStack);
-};
+DEFINE_FLAG(int, marker_tasks, 0,
+            "The number of tasks used to mark old-space objects in parallel. "
+            "Values below 2 mark on the isolate's thread only.");
 
 
 class MarkingVisitor : public ObjectPointerVisitor {
@@ -124,19 +33,25 @@ class MarkingVisitor : public ObjectPointerVisitor {
                  Heap* heap,
                  PageSpace* page_space,
                  MarkingStack* marking_stack,
-                 bool visit_function_code)
+                 bool visit_function_code,
+                 bool incremental = false)
       : ObjectPointerVisitor(isolate),
         heap_(heap),
         vm_heap_(Dart::vm_isolate()->heap()),
         page_space_(page_space),
         marking_stack_(marking_stack),
         visiting_old_object_(NULL),
-        visit_function_code_(visit_function_code) {
+        visit_function_code_(visit_function_code),
+        incremental_(incremental),
+        marked_bytes_(0) {
     ASSERT(heap_ != vm_heap_);
   }
 
   MarkingStack* marking_stack() const { return marking_stack_; }
 
+  // Whether this visitor is one of the tasks of a parallel marking.
+  bool is_parallel() const { return marking_stack_->work_list() != NULL; }
+
   void VisitPointers(RawObject** first, RawObject** last) {
     for (RawObject** current = first; current <= last; current++) {
       MarkObject(*current, current);
@@ -145,11 +60,44 @@ class MarkingVisitor : public ObjectPointerVisitor {
 
   bool visit_function_code() const { return visit_function_code_; }
 
-  GrowableArray<RawFunction*>* skipped_code_functions() {
-    return &skipped_code_functions_;
+  // Grays an object stored or promoted between the slices of an incremental
+  // marking.
+  void MarkStoredObject(RawObject* raw_obj) {
+    ASSERT(incremental_ && (visiting_old_object_ == NULL));
+    MarkObject(raw_obj, NULL);
+  }
+
+  intptr_t marked_bytes() const { return marked_bytes_; }
+  void AddMarkedBytes(intptr_t bytes) { marked_bytes_ += bytes; }
+
+  void AddSkippedCodeFunction(RawFunction* raw_function) {
+    skipped_code_functions_.Push(raw_function);
+  }
+
+  // Takes over the functions skipped by a parallel marking task, so that
+  // their code is only detached once marking has completed.
+  void AdoptSkippedCodeFunctions(MarkingVisitor* task_visitor) {
+    ASSERT(!is_parallel() && task_visitor->is_parallel());
+    while (!task_visitor->skipped_code_functions_.IsEmpty()) {
+      skipped_code_functions_.Push(task_visitor->skipped_code_functions_.Pop());
+    }
+  }
+
+  // Returns NULL once all deferred weak properties have been handed out.
+  RawWeakProperty* PopDeferredWeakProperty() {
+    if (deferred_weak_properties_.IsEmpty()) {
+      return NULL;
+    }
+    return reinterpret_cast<RawWeakProperty*>(deferred_weak_properties_.Pop());
   }
 
   void DelayWeakProperty(RawWeakProperty* raw_weak) {
+    if (is_parallel()) {
+      // Another task may still mark the key, so the watched bit cannot be
+      // used. The property is processed again once all tasks are done.
+      deferred_weak_properties_.Push(raw_weak);
+      return;
+    }
     RawObject* raw_key = raw_weak->ptr()->key_;
     DelaySet::iterator it = delay_set_.find(raw_key);
     if (it != delay_set_.end()) {
@@ -184,10 +132,22 @@ class MarkingVisitor : public ObjectPointerVisitor {
            true);
 
     // Mark the object and push it on the marking stack.
-    ASSERT(!raw_obj->IsMarked());
+    if (is_parallel()) {
+      if (!raw_obj->TryAcquireMarkBit()) {
+        // Another task marked the object first.
+        return;
+      }
+    } else {
+      ASSERT(!raw_obj->IsMarked());
+      raw_obj->SetMarkBit();
+    }
+    marked_bytes_ += raw_obj->Size();
     RawClass* raw_class = isolate()->class_table()->At(raw_obj->GetClassId());
-    raw_obj->SetMarkBit();
-    raw_obj->ClearRememberedBit();
+    if (!incremental_) {
+      // The store buffer is rebuilt by a stop-the-world marking. An
+      // incremental marking keeps the one maintained by the mutator.
+      raw_obj->ClearRememberedBit();
+    }
     if (raw_obj->IsWatched()) {
       std::pair<DelaySet::iterator, DelaySet::iterator> ret;
       // Visit all elements with a key equal to raw_obj.
@@ -222,7 +182,12 @@ class MarkingVisitor : public ObjectPointerVisitor {
           !visiting_old_object_->IsRemembered()) {
         ASSERT(p != NULL);
         visiting_old_object_->SetRememberedBit();
-        isolate()->store_buffer()->AddObjectGC(visiting_old_object_);
+        if (is_parallel()) {
+          marking_stack_->work_list()->AddToStoreBuffer(isolate(),
+                                                        visiting_old_object_);
+        } else {
+          isolate()->store_buffer()->AddObjectGC(visiting_old_object_);
+        }
       }
       return;
     }
@@ -231,8 +196,9 @@ class MarkingVisitor : public ObjectPointerVisitor {
   }
 
   void DetachCode() {
-    for (int i = 0; i < skipped_code_functions_.length(); i++) {
-      RawFunction* func = skipped_code_functions_[i];
+    while (!skipped_code_functions_.IsEmpty()) {
+      RawFunction* func =
+          reinterpret_cast<RawFunction*>(skipped_code_functions_.Pop());
       RawCode* code = func->ptr()->code_;
       if (!code->IsMarked()) {
         // If the code wasn't strongly visited through other references
@@ -263,7 +229,12 @@ class MarkingVisitor : public ObjectPointerVisitor {
   typedef std::multimap<RawObject*, RawWeakProperty*> DelaySet;
   DelaySet delay_set_;
   const bool visit_function_code_;
-  GrowableArray<RawFunction*> skipped_code_functions_;
+  const bool incremental_;
+  intptr_t marked_bytes_;
+  // Functions are kept in marking stack chunks, which unlike zone allocated
+  // arrays can be grown by several marking tasks at the same time.
+  MarkingStack skipped_code_functions_;
+  MarkingStack deferred_weak_properties_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(MarkingVisitor);
 };
@@ -392,17 +363,108 @@ void GCMarker::IterateWeakReferences(Isolate* isolate,
 
 void GCMarker::DrainMarkingStack(Isolate* isolate,
                                  MarkingVisitor* visitor) {
-  while (!visitor->marking_stack()->IsEmpty()) {
-    RawObject* raw_obj = visitor->marking_stack()->Pop();
+  MarkingStack* marking_stack = visitor->marking_stack();
+  do {
+    while (!marking_stack->IsEmpty()) {
+      RawObject* raw_obj = marking_stack->Pop();
+      visitor->VisitingOldObject(raw_obj);
+      if (raw_obj->GetClassId() != kWeakPropertyCid) {
+        raw_obj->VisitPointers(visitor);
+      } else {
+        RawWeakProperty* raw_weak = reinterpret_cast<RawWeakProperty*>(raw_obj);
+        ProcessWeakProperty(raw_weak, visitor);
+      }
+    }
+    visitor->VisitingOldObject(NULL);
+  } while (marking_stack->Steal());
+}
+
+
+bool GCMarker::ScanMarkingStack(MarkingVisitor* visitor,
+                                intptr_t budget_in_bytes) {
+  MarkingStack* marking_stack = visitor->marking_stack();
+  intptr_t scanned_bytes = 0;
+  while ((scanned_bytes < budget_in_bytes) && !marking_stack->IsEmpty()) {
+    RawObject* raw_obj = marking_stack->Pop();
     visitor->VisitingOldObject(raw_obj);
     if (raw_obj->GetClassId() != kWeakPropertyCid) {
-      raw_obj->VisitPointers(visitor);
+      scanned_bytes += raw_obj->VisitPointers(visitor);
     } else {
       RawWeakProperty* raw_weak = reinterpret_cast<RawWeakProperty*>(raw_obj);
+      scanned_bytes += raw_weak->Size();
       ProcessWeakProperty(raw_weak, visitor);
     }
   }
   visitor->VisitingOldObject(NULL);
+  return !marking_stack->IsEmpty();
+}
+
+
+class MarkTask : public ThreadPool::Task {
+ public:
+  MarkTask(GCMarker* marker, Isolate* isolate, MarkingVisitor* visitor)
+      : marker_(marker), isolate_(isolate), visitor_(visitor) {
+  }
+
+  virtual void Run() {
+    Isolate::SetCurrentHelper(isolate_);
+    marker_->DrainMarkingStack(isolate_, visitor_);
+    Isolate::SetCurrentHelper(NULL);
+    // The work list is owned by the isolate's thread, which may release it
+    // as soon as the last task reports back.
+    visitor_->marking_stack()->work_list()->TaskFinished();
+  }
+
+ private:
+  GCMarker* marker_;
+  Isolate* isolate_;
+  MarkingVisitor* visitor_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkTask);
+};
+
+
+void GCMarker::MarkObjectsParallel(Isolate* isolate,
+                                   PageSpace* page_space,
+                                   MarkingVisitor* visitor,
+                                   bool visit_prologue_weak_persistent_handles,
+                                   intptr_t num_tasks) {
+  const bool visit_function_code = visitor->visit_function_code();
+  MarkingWorkList work_list(num_tasks);
+  MarkingStack** marking_stacks = new MarkingStack*[num_tasks];
+  MarkingVisitor** task_visitors = new MarkingVisitor*[num_tasks];
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    marking_stacks[i] = new MarkingStack(&work_list);
+    task_visitors[i] = new MarkingVisitor(isolate, heap_, page_space,
+                                          marking_stacks[i],
+                                          visit_function_code);
+  }
+
+  // The helper tasks wait for chunks to be published while the roots are
+  // visited on the isolate's thread, which then joins in as the first task.
+  for (intptr_t i = 1; i < num_tasks; i++) {
+    Dart::thread_pool()->Run(new MarkTask(this, isolate, task_visitors[i]));
+  }
+  IterateRoots(isolate, task_visitors[0],
+               visit_prologue_weak_persistent_handles);
+  DrainMarkingStack(isolate, task_visitors[0]);
+  work_list.WaitForHelperTasks();
+
+  // Weak properties whose keys were unmarked when a task reached them are
+  // resolved serially, just like the rest of the weak processing.
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    RawWeakProperty* raw_weak;
+    while ((raw_weak = task_visitors[i]->PopDeferredWeakProperty()) != NULL) {
+      ProcessWeakProperty(raw_weak, visitor);
+    }
+    visitor->AdoptSkippedCodeFunctions(task_visitors[i]);
+    visitor->AddMarkedBytes(task_visitors[i]->marked_bytes());
+    delete task_visitors[i];
+    delete marking_stacks[i];
+  }
+  delete[] task_visitors;
+  delete[] marking_stacks;
+  DrainMarkingStack(isolate, visitor);
 }
 
 
@@ -478,16 +540,115 @@ void GCMarker::MarkObjects(Isolate* isolate,
   Prologue(isolate, invoke_api_callbacks);
   MarkingVisitor mark(
       isolate, heap_, page_space, &marking_stack, visit_function_code);
-  IterateRoots(isolate, &mark, !invoke_api_callbacks);
-  DrainMarkingStack(isolate, &mark);
-  IterateWeakReferences(isolate, &mark);
+  if (FLAG_marker_tasks > 1) {
+    MarkObjectsParallel(
+        isolate, page_space, &mark, !invoke_api_callbacks, FLAG_marker_tasks);
+  } else {
+    IterateRoots(isolate, &mark, !invoke_api_callbacks);
+    DrainMarkingStack(isolate, &mark);
+  }
+  FinishMarking(isolate, page_space, &mark, invoke_api_callbacks);
+  Epilogue(isolate, invoke_api_callbacks);
+}
+
+
+void GCMarker::FinishMarking(Isolate* isolate,
+                             PageSpace* page_space,
+                             MarkingVisitor* visitor,
+                             bool invoke_api_callbacks) {
+  IterateWeakReferences(isolate, visitor);
   MarkingWeakVisitor mark_weak;
   IterateWeakRoots(isolate, &mark_weak, invoke_api_callbacks);
-  mark.Finalize();
+  visitor->Finalize();
+  marked_bytes_ = visitor->marked_bytes();
   ProcessWeakTables(page_space);
   ProcessObjectIdTable(isolate);
+}
+
 
+void GCMarker::FilterStoreBuffer(Isolate* isolate) {
+  // Drop the objects about to be freed from the store buffer kept by an
+  // incremental marking.
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  StoreBufferBlock* block = store_buffer->Blocks();
+  while (block != NULL) {
+    intptr_t count = block->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      RawObject* raw_obj = block->At(i);
+      if (raw_obj->IsMarked()) {
+        store_buffer->AddObjectGC(raw_obj);
+      }
+    }
+    StoreBufferBlock* next = block->next();
+    delete block;
+    block = next;
+  }
+}
+
+
+void GCMarker::FinishIncrementalMarking(Isolate* isolate,
+                                        PageSpace* page_space,
+                                        IncrementalMarker* incremental_marker,
+                                        bool invoke_api_callbacks) {
+  if (invoke_api_callbacks) {
+    isolate->gc_prologue_callbacks().Invoke();
+  }
+  // The write barrier grayed the old objects stored into old objects since
+  // the roots were first visited, only the roots and new space have to be
+  // visited again.
+  MarkingVisitor* mark = incremental_marker->visitor_;
+  IterateRoots(isolate, mark, !invoke_api_callbacks);
+  DrainMarkingStack(isolate, mark);
+  FinishMarking(isolate, page_space, mark, invoke_api_callbacks);
+  FilterStoreBuffer(isolate);
   Epilogue(isolate, invoke_api_callbacks);
 }
 
+
+IncrementalMarker::IncrementalMarker(Heap* heap,
+                                     Isolate* isolate,
+                                     PageSpace* page_space)
+    : marker_(heap),
+      isolate_(isolate),
+      marking_stack_(new MarkingStack()),
+      // Function code is always visited, code is only collected by
+      // stop-the-world markings.
+      visitor_(new MarkingVisitor(isolate, heap, page_space, marking_stack_,
+                                  true, true)) {
+  ASSERT(isolate_->incremental_marker() == NULL);
+  isolate_->set_incremental_marker(this);
+  marker_.IterateRoots(isolate_, visitor_, false);
+}
+
+
+IncrementalMarker::~IncrementalMarker() {
+  isolate_->set_incremental_marker(NULL);
+  // A marking is only abandoned when the heap is torn down.
+  while (!marking_stack_->IsEmpty()) {
+    marking_stack_->Pop();
+  }
+  delete visitor_;
+  delete marking_stack_;
+}
+
+
+bool IncrementalMarker::Step(intptr_t budget_in_bytes) {
+  return marker_.ScanMarkingStack(visitor_, budget_in_bytes);
+}
+
+
+void IncrementalMarker::MarkObject(RawObject* raw_obj) {
+  visitor_->MarkStoredObject(raw_obj);
+}
+
+
+DEFINE_LEAF_RUNTIME_ENTRY(void, MarkStoredObject, 2,
+                          Isolate* isolate,
+                          RawObject* value) {
+  IncrementalMarker* marker = isolate->incremental_marker();
+  ASSERT(marker != NULL);
+  marker->MarkObject(value);
+}
+END_LEAF_RUNTIME_ENTRY
+
 }  // namespace dart
@@ -12,17 +12,26 @@ namespace dart {
 // Forward declarations.
 class HandleVisitor;
 class Heap;
+class IncrementalMarker;
 class Isolate;
+class MarkingStack;
 class MarkingVisitor;
 class ObjectPointerVisitor;
 class PageSpace;
+class RawObject;
 class RawWeakProperty;
 
 // The class GCMarker is used to mark reachable old generation objects as part
 // of the mark-sweep collection. The marking bit used is defined in RawObject.
+//
+// With --marker_tasks greater than one, marking from the roots is shared
+// between the isolate's thread and helper tasks on the VM thread pool. Each
+// task owns a MarkingVisitor and marking stack and steals work published by
+// the others; mark bits are set atomically. Weak references and properties
+// are still resolved on the isolate's thread once all tasks are done.
 class GCMarker : public ValueObject {
  public:
-  explicit GCMarker(Heap* heap) : heap_(heap) { }
+  explicit GCMarker(Heap* heap) : heap_(heap), marked_bytes_(0) { }
   ~GCMarker() { }
 
   void MarkObjects(Isolate* isolate,
@@ -30,27 +39,86 @@ class GCMarker : public ValueObject {
                    bool invoke_api_callbacks,
                    bool collect_code);
 
+  // Completes the marking started by 'incremental_marker' in a final pause.
+  void FinishIncrementalMarking(Isolate* isolate,
+                                PageSpace* page_space,
+                                IncrementalMarker* incremental_marker,
+                                bool invoke_api_callbacks);
+
+  // Size of all objects marked by the last completed marking.
+  intptr_t marked_words() const { return marked_bytes_ >> kWordSizeLog2; }
+
  private:
   void Prologue(Isolate* isolate, bool invoke_api_callbacks);
   void Epilogue(Isolate* isolate, bool invoke_api_callbacks);
   void IterateRoots(Isolate* isolate,
                     ObjectPointerVisitor* visitor,
                     bool visit_prologue_weak_persistent_handles);
+  void MarkObjectsParallel(Isolate* isolate,
+                           PageSpace* page_space,
+                           MarkingVisitor* visitor,
+                           bool visit_prologue_weak_persistent_handles,
+                           intptr_t num_tasks);
   void IterateWeakRoots(Isolate* isolate,
                         HandleVisitor* visitor,
                         bool visit_prologue_weak_persistent_handles);
   void IterateWeakReferences(Isolate* isolate, MarkingVisitor* visitor);
   void DrainMarkingStack(Isolate* isolate, MarkingVisitor* visitor);
+  // Returns true if gray objects are left after about 'budget_in_bytes' of
+  // objects have been scanned.
+  bool ScanMarkingStack(MarkingVisitor* visitor, intptr_t budget_in_bytes);
   void ProcessWeakProperty(RawWeakProperty* raw_weak, MarkingVisitor* visitor);
   void ProcessWeakTables(PageSpace* page_space);
   void ProcessObjectIdTable(Isolate* isolate);
-
+  void FinishMarking(Isolate* isolate,
+                     PageSpace* page_space,
+                     MarkingVisitor* visitor,
+                     bool invoke_api_callbacks);
+  void FilterStoreBuffer(Isolate* isolate);
 
   Heap* heap_;
+  intptr_t marked_bytes_;
+
+  friend class IncrementalMarker;
+  friend class MarkTask;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(GCMarker);
 };
 
+
+// With --incremental_marking, old-space objects are marked in slices that
+// are interleaved with the mutator, see PageSpace::AdvanceIncrementalMarking.
+// The tri-color invariant is kept by an insertion write barrier, which grays
+// the unmarked old objects stored into old objects (Object::StorePointer and
+// the UpdateStoreBuffer stub), and by the scavenger, which grays the objects
+// it promotes. Objects allocated while marking start out white and are found
+// through the roots or the write barrier. The final pause only revisits the
+// roots and new space and drains the objects grayed since the last slice,
+// before weak references are processed as after a full marking.
+class IncrementalMarker {
+ public:
+  // Marks the objects directly reachable from the roots.
+  IncrementalMarker(Heap* heap, Isolate* isolate, PageSpace* page_space);
+  ~IncrementalMarker();
+
+  // Scans gray objects until about 'budget_in_bytes' of objects have been
+  // scanned. Returns false once no gray objects are left.
+  bool Step(intptr_t budget_in_bytes);
+
+  // Grays 'raw_obj' if it is an unmarked old object.
+  void MarkObject(RawObject* raw_obj);
+
+ private:
+  GCMarker marker_;
+  Isolate* isolate_;
+  MarkingStack* marking_stack_;
+  MarkingVisitor* visitor_;
+
+  friend class GCMarker;
+
+  DISALLOW_COPY_AND_ASSIGN(IncrementalMarker);
+};
+
 }  // namespace dart
 
 #endif  // VM_GC_MARKER_H_
@@ -11,7 +11,9 @@
 
 namespace dart {
 
-intptr_t GCSweeper::SweepPage(HeapPage* page, FreeList* freelist) {
+intptr_t GCSweeper::SweepPage(HeapPage* page,
+                              FreeList* freelist,
+                              bool concurrent) {
   // Keep track of the discovered live object sizes to be able to finish
   // sweeping early. Reset the per page in_use count for the next marking phase.
   intptr_t in_use = 0;
@@ -26,7 +28,11 @@ intptr_t GCSweeper::SweepPage(HeapPage* page, FreeList* freelist) {
     RawObject* raw_obj = RawObject::FromAddr(current);
     if (raw_obj->IsMarked()) {
       // Found marked object. Clear the mark bit and update swept bytes.
-      raw_obj->ClearMarkBit();
+      if (concurrent) {
+        raw_obj->ClearMarkBitAtomic();
+      } else {
+        raw_obj->ClearMarkBit();
+      }
       obj_size = raw_obj->Size();
       in_use += obj_size;
     } else {
@@ -57,14 +63,18 @@ intptr_t GCSweeper::SweepPage(HeapPage* page, FreeList* freelist) {
 }
 
 
-intptr_t GCSweeper::SweepLargePage(HeapPage* page) {
+intptr_t GCSweeper::SweepLargePage(HeapPage* page, bool concurrent) {
   RawObject* raw_obj = RawObject::FromAddr(page->object_start());
   if (!raw_obj->IsMarked()) {
     // The large object was not marked. Used size is zero, which also tells the
     // calling code that the large object page can be recycled.
     return 0;
   }
-  raw_obj->ClearMarkBit();
+  if (concurrent) {
+    raw_obj->ClearMarkBitAtomic();
+  } else {
+    raw_obj->ClearMarkBit();
+  }
   return raw_obj->Size();
 }
 
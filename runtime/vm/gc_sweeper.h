@@ -24,9 +24,11 @@ class GCSweeper {
   // Sweep the memory area for the page while clearing the mark bits and adding
   // all the unmarked objects to the freelist.
   // Returns the size of memory used by the marked objects.
-  intptr_t SweepPage(HeapPage* page, FreeList* freelist);
+  // A concurrent sweep runs next to the mutator, which may update other tag
+  // bits of the marked objects, so the mark bits are cleared atomically.
+  intptr_t SweepPage(HeapPage* page, FreeList* freelist, bool concurrent);
 
-  intptr_t SweepLargePage(HeapPage* page);
+  intptr_t SweepLargePage(HeapPage* page, bool concurrent);
 
  private:
   Heap* heap_;
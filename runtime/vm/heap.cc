@@ -10,6 +10,7 @@
 #include "vm/heap_histogram.h"
 #include "vm/heap_profiler.h"
 #include "vm/isolate.h"
+#include "vm/json_stream.h"
 #include "vm/object.h"
 #include "vm/object_set.h"
 #include "vm/os.h"
@@ -30,8 +31,8 @@ DEFINE_FLAG(bool, verify_before_gc, false,
 DEFINE_FLAG(bool, verify_after_gc, false,
             "Enables heap verification after GC.");
 DEFINE_FLAG(bool, gc_at_alloc, false, "GC at every allocation.");
-DEFINE_FLAG(int, new_gen_heap_size, 32, "new gen heap size in MB,"
-            "e.g: --new_gen_heap_size=64 allocates a 64MB new gen heap");
+DEFINE_FLAG(int, new_gen_heap_size, 32, "maximum new gen heap size in MB,"
+            "e.g: --new_gen_heap_size=64 reserves a 64MB new gen heap");
 DEFINE_FLAG(int, old_gen_heap_size, Heap::kHeapSizeInMB,
             "old gen heap size in MB,"
             "e.g: --old_gen_heap_size=1024 allocates a 1024MB old gen heap");
@@ -79,6 +80,9 @@ uword Heap::AllocateNew(intptr_t size) {
 
 uword Heap::AllocateOld(intptr_t size, HeapPage::PageType type) {
   ASSERT(Isolate::Current()->no_gc_scope_depth() == 0);
+  if (old_space_->AdvanceIncrementalMarking()) {
+    CollectGarbage(kOld);
+  }
   uword addr = old_space_->TryAllocate(size, type);
   if (addr == 0) {
     CollectAllGarbage();
@@ -163,7 +167,8 @@ void Heap::CollectGarbage(Space space, ApiCallbacks api_callbacks) {
       new_space_->Scavenge(invoke_api_callbacks);
       RecordAfterGC();
       PrintStats();
-      if (new_space_->HadPromotionFailure()) {
+      if (new_space_->HadPromotionFailure() ||
+          old_space_->AdvanceIncrementalMarking()) {
         // Old collections should call the API callbacks.
         CollectGarbage(kOld, kInvokeApiCallbacks);
       }
@@ -216,6 +221,16 @@ void Heap::CollectAllGarbage() {
 }
 
 
+void Heap::StartIncrementalMarking() {
+  old_space_->StartIncrementalMarking();
+}
+
+
+bool Heap::MarkIncrementally(intptr_t budget_in_bytes) {
+  return old_space_->MarkIncrementally(budget_in_bytes);
+}
+
+
 void Heap::SetGrowthControlState(bool state) {
   old_space_->SetGrowthControlState(state);
 }
@@ -233,6 +248,11 @@ void Heap::WriteProtect(bool read_only) {
 }
 
 
+void Heap::WaitForSweeperTasks() {
+  old_space_->CompleteSweep();
+}
+
+
 uword Heap::TopAddress() {
   return reinterpret_cast<uword>(new_space_->TopAddress());
 }
@@ -305,6 +325,21 @@ void Heap::PrintSizes() const {
 }
 
 
+void Heap::PrintToJSONStream(JSONStream* stream) {
+  JSONObject jsobj(stream);
+  jsobj.AddProperty("type", "Heap");
+  {
+    JSONObject new_space(&jsobj, "new");
+    new_space.AddProperty("used", UsedInWords(kNew) * kWordSize);
+    new_space.AddProperty("capacity", CapacityInWords(kNew) * kWordSize);
+  }
+  {
+    JSONObject old_space(&jsobj, "old");
+    old_space_->PrintToJSONObject(&old_space);
+  }
+}
+
+
 intptr_t Heap::UsedInWords(Space space) const {
   return space == kNew ? new_space_->UsedInWords() : old_space_->UsedInWords();
 }
@@ -381,6 +416,36 @@ int64_t Heap::PeerCount() const {
 }
 
 
+#if defined(ARCH_IS_64_BIT)
+static bool UsesHeaderHash(RawObject* raw_obj) {
+  // Objects of the VM isolate heap are shared by all isolates, keep their
+  // headers untouched.
+  return raw_obj->IsNewObject() || !raw_obj->IsVMHeapObject();
+}
+#endif
+
+
+void Heap::SetHash(RawObject* raw_obj, intptr_t hash) {
+#if defined(ARCH_IS_64_BIT)
+  if (UsesHeaderHash(raw_obj)) {
+    raw_obj->SetHeaderHash(hash);
+    return;
+  }
+#endif
+  SetWeakEntry(raw_obj, kHashes, hash);
+}
+
+
+intptr_t Heap::GetHash(RawObject* raw_obj) const {
+#if defined(ARCH_IS_64_BIT)
+  if (UsesHeaderHash(raw_obj)) {
+    return raw_obj->GetHeaderHash();
+  }
+#endif
+  return GetWeakEntry(raw_obj, kHashes);
+}
+
+
 int64_t Heap::HashCount() const {
   return
       new_weak_tables_[kHashes]->count() + old_weak_tables_[kHashes]->count();
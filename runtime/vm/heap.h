@@ -17,6 +17,7 @@ namespace dart {
 
 // Forward declarations.
 class Isolate;
+class JSONStream;
 class ObjectPointerVisitor;
 class ObjectSet;
 class VirtualMemory;
@@ -102,6 +103,11 @@ class Heap {
     return 0;
   }
 
+  // Gives back old-space memory returned by TryAllocate that was never used.
+  void FreeUnusedOld(uword addr, intptr_t size) {
+    old_space_->FreeUnused(addr, size);
+  }
+
   // Heap contains the specified address.
   bool Contains(uword addr) const;
   bool NewContains(uword addr) const;
@@ -131,12 +137,23 @@ class Heap {
   // The 'visitor' function should return false if the object is not found,
   // traversal through the heap space continues.
   RawInstructions* FindObjectInCodeSpace(FindObjectVisitor* visitor);
+
+  // Index of the Instructions objects in the code space, see CodeIndex.
+  CodeIndex* code_index() const { return old_space_->code_index(); }
   RawInstructions* FindObjectInStubCodeSpace(FindObjectVisitor* visitor);
 
   void CollectGarbage(Space space);
   void CollectGarbage(Space space, ApiCallbacks api_callbacks);
   void CollectAllGarbage();
 
+  // With --incremental_marking, old space is also marked in slices outside
+  // of collections, see PageSpace::AdvanceIncrementalMarking. These allow
+  // to start and advance marking at other times, e.g. while the isolate is
+  // idle. MarkIncrementally returns true once the marking is complete, the
+  // next CollectGarbage(kOld) then finishes the collection.
+  void StartIncrementalMarking();
+  bool MarkIncrementally(intptr_t budget_in_bytes);
+
   // Enables growth control on the page space heaps.  This should be
   // called before any user code is executed.
   void EnableGrowthControl() { SetGrowthControlState(true); }
@@ -147,6 +164,10 @@ class Heap {
   // Protect access to the heap.
   void WriteProtect(bool read_only);
 
+  // Waits until the old generation is completely swept. Objects whose header
+  // is rewritten in place must not be concurrently visited by a sweeper.
+  void WaitForSweeperTasks();
+
   // Accessors for inlined allocation in generated code.
   uword TopAddress();
   uword EndAddress();
@@ -161,6 +182,9 @@ class Heap {
   // Print heap sizes.
   void PrintSizes() const;
 
+  // Print heap sizes and old generation free list statistics.
+  void PrintToJSONStream(JSONStream* stream);
+
   // Return amount of memory used and capacity in a space.
   intptr_t UsedInWords(Space space) const;
   intptr_t CapacityInWords(Space space) const;
@@ -186,13 +210,10 @@ class Heap {
   int64_t PeerCount() const;
 
   // Associate an identity hashCode with an object. An non-existent hashCode
-  // is equal to 0.
-  void SetHash(RawObject* raw_obj, intptr_t hash) {
-    SetWeakEntry(raw_obj, kHashes, hash);
-  }
-  intptr_t GetHash(RawObject* raw_obj) const {
-    return GetWeakEntry(raw_obj, kHashes);
-  }
+  // is equal to 0. On 64-bit targets the hashCode lives in the object
+  // header, only objects of the VM isolate heap use the weak table.
+  void SetHash(RawObject* raw_obj, intptr_t hash);
+  intptr_t GetHash(RawObject* raw_obj) const;
   int64_t HashCount() const;
 
   // Used by the GC algorithms to propagate weak entries.
@@ -9,6 +9,10 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, marker_tasks);
+DECLARE_FLAG(int, new_gen_heap_size);
+DECLARE_FLAG(int, scavenger_tasks);
+
 TEST_CASE(OldGC) {
   const char* kScriptChars =
   "main() {\n"
@@ -46,4 +50,212 @@ TEST_CASE(LargeSweep) {
   Dart_ExitScope();
   heap->CollectGarbage(Heap::kOld);
 }
+
+
+// The first call of main builds a binary tree of the given depth. Every call
+// then allocates the given number of garbage trees and returns the number of
+// nodes still in the tree.
+static const char* kTreeScriptChars =
+  "var tree;\n"
+  "build(depth) {\n"
+  "  if (depth == 0) return [];\n"
+  "  return [build(depth - 1), build(depth - 1), new List(depth)];\n"
+  "}\n"
+  "count(node) {\n"
+  "  if (node.isEmpty) return 1;\n"
+  "  return 1 + count(node[0]) + count(node[1]);\n"
+  "}\n"
+  "main(depth, garbage) {\n"
+  "  if (tree == null) tree = build(depth);\n"
+  "  for (var i = 0; i < garbage; i++) build(10);\n"
+  "  return count(tree);\n"
+  "}\n";
+
+
+static void RunTreeScript(Dart_Handle lib, intptr_t depth, intptr_t garbage) {
+  Dart_EnterScope();
+  Dart_Handle args[2];
+  args[0] = Dart_NewInteger(depth);
+  args[1] = Dart_NewInteger(garbage);
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 2, args);
+  EXPECT_VALID(result);
+  int64_t node_count = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &node_count));
+  EXPECT_EQ((1 << (depth + 1)) - 1, node_count);
+  Dart_ExitScope();
+}
+
+
+TEST_CASE(ParallelMarking) {
+  Dart_Handle lib = TestCase::LoadTestScript(kTreeScriptChars, NULL);
+  RunTreeScript(lib, 14, 0);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const int saved_marker_tasks = FLAG_marker_tasks;
+  FLAG_marker_tasks = 4;
+  heap->CollectAllGarbage();
+  heap->CollectAllGarbage();
+  FLAG_marker_tasks = saved_marker_tasks;
+  RunTreeScript(lib, 14, 0);
+}
+
+
+TEST_CASE(ConcurrentSweep) {
+  Dart_Handle lib = TestCase::LoadTestScript(kTreeScriptChars, NULL);
+  RunTreeScript(lib, 12, 0);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const bool saved_concurrent_sweep = FLAG_concurrent_sweep;
+  FLAG_concurrent_sweep = true;
+  for (intptr_t i = 0; i < 3; i++) {
+    // Allocate while the old generation is still being swept.
+    heap->CollectGarbage(Heap::kOld);
+    RunTreeScript(lib, 12, 8);
+  }
+  FLAG_concurrent_sweep = saved_concurrent_sweep;
+  // Collecting again finishes the pending sweep first.
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(heap->Verify());
+}
+
+
+TEST_CASE(ParallelScavenge) {
+  Dart_Handle lib = TestCase::LoadTestScript(kTreeScriptChars, NULL);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const int saved_scavenger_tasks = FLAG_scavenger_tasks;
+  FLAG_scavenger_tasks = 4;
+  RunTreeScript(lib, 12, 0);
+  for (intptr_t i = 0; i < 3; i++) {
+    // The tree is copied and eventually promoted by the scavenger tasks.
+    heap->CollectGarbage(Heap::kNew);
+    RunTreeScript(lib, 12, 4);
+  }
+  FLAG_scavenger_tasks = saved_scavenger_tasks;
+  EXPECT(heap->Verify());
+}
+
+
+TEST_CASE(IdentityHashCode) {
+  const char* kScriptChars =
+  "var obj;\n"
+  "setup() {\n"
+  "  obj = new Object();\n"
+  "  return obj.hashCode;\n"
+  "}\n"
+  "check() => obj.hashCode;\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  Dart_EnterScope();
+  int64_t hash = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(
+      Dart_Invoke(lib, NewString("setup"), 0, NULL), &hash));
+  EXPECT(hash != 0);
+  // The hash code moves with the object when it is copied and promoted.
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kOld);
+  int64_t result = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(
+      Dart_Invoke(lib, NewString("check"), 0, NULL), &result));
+  EXPECT_EQ(hash, result);
+  Dart_ExitScope();
+}
+
+
+TEST_CASE(CloneDropsIdentityHashCode) {
+  Heap* heap = Isolate::Current()->heap();
+  const Array& array = Array::Handle(Array::New(1));
+  heap->SetHash(array.raw(), 42);
+  const Object& copy = Object::Handle(Object::Clone(array, Heap::kNew));
+  EXPECT_EQ(42, heap->GetHash(array.raw()));
+  EXPECT_EQ(0, heap->GetHash(copy.raw()));
+}
+
+
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+TEST_CASE(IncrementalMarking) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const bool saved_incremental_marking = FLAG_incremental_marking;
+  FLAG_incremental_marking = true;
+  const Array& holder = Array::Handle(Array::New(1, Heap::kOld));
+  heap->StartIncrementalMarking();
+  EXPECT(heap->MarkIncrementally(1 * GB));
+  EXPECT(holder.raw()->IsMarked());
+  // The holder has already been scanned, the string stored into it is only
+  // found through the write barrier.
+  String& late = String::Handle(String::New("late", Heap::kOld));
+  EXPECT(!late.raw()->IsMarked());
+  holder.SetAt(0, late);
+  EXPECT(late.raw()->IsMarked());
+  late = String::null();
+  heap->CollectGarbage(Heap::kOld);
+  FLAG_incremental_marking = saved_incremental_marking;
+  late ^= holder.At(0);
+  EXPECT(late.Equals("late"));
+  EXPECT(heap->Verify());
+}
+#endif  // defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+
+
+TEST_CASE(CompactOldSpace) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const intptr_t kNumArrays = 64 * KB;
+  const intptr_t kSurvivorStride = 16;
+  const Array& arrays = Array::Handle(Array::New(kNumArrays, Heap::kOld));
+  Array& element = Array::Handle();
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    element = Array::New(32, Heap::kOld);
+    element.SetAt(0, Smi::Handle(Smi::New(i)));
+    arrays.SetAt(i, element);
+  }
+  // Leave every page mostly empty.
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    if ((i % kSurvivorStride) != 0) {
+      arrays.SetAt(i, Object::null_object());
+    }
+  }
+  heap->CollectGarbage(Heap::kOld);
+  const intptr_t capacity_in_words = heap->CapacityInWords(Heap::kOld);
+  const Array& survivor =
+      Array::Handle(Array::RawCast(arrays.At(kSurvivorStride)));
+  int peer = 0;
+  heap->SetPeer(arrays.At(0), &peer);
+  const bool saved_compact_old_space = FLAG_compact_old_space;
+  FLAG_compact_old_space = true;
+  heap->CollectGarbage(Heap::kOld);
+  FLAG_compact_old_space = saved_compact_old_space;
+  EXPECT_LT(heap->CapacityInWords(Heap::kOld), capacity_in_words);
+  EXPECT_EQ(survivor.raw(), arrays.At(kSurvivorStride));
+  EXPECT_EQ(&peer, heap->GetPeer(arrays.At(0)));
+  for (intptr_t i = 0; i < kNumArrays; i += kSurvivorStride) {
+    element ^= arrays.At(i);
+    EXPECT_EQ(i, Smi::Value(Smi::RawCast(element.At(0))));
+  }
+  EXPECT(heap->Verify());
+}
+
+
+TEST_CASE(TenuringAge) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const int saved_tenuring_age = FLAG_tenuring_age;
+  FLAG_tenuring_age = 3;
+  const Array& array = Array::Handle(Array::New(1, Heap::kNew));
+  // The array stays in new space until it survives a third scavenge.
+  for (intptr_t i = 0; i < 2; i++) {
+    heap->CollectGarbage(Heap::kNew);
+    EXPECT(array.raw()->IsNewObject());
+  }
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(array.raw()->IsOldObject());
+  FLAG_tenuring_age = saved_tenuring_age;
+  EXPECT_LE(heap->CapacityInWords(Heap::kNew),
+            FLAG_new_gen_heap_size * MBInWords);
+  EXPECT(heap->Verify());
+}
+
 }
@@ -600,7 +600,12 @@ bool Value::NeedsStoreBuffer() {
     return false;
   }
 
-  return !BindsToConstant();
+  if (BindsToConstant()) {
+    // Incremental marking has to see old constants stored into old objects,
+    // only objects of the VM isolate heap are never collected.
+    return FLAG_incremental_marking && !BoundConstant().InVMHeap();
+  }
+  return true;
 }
 
 
@@ -2167,8 +2167,9 @@ void CheckStackOverflowInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 
   Register temp = locs()->temp(0).reg();
   // Generate stack overflow check.
-  __ LoadImmediate(
-      temp, Immediate(Isolate::Current()->stack_limit_address()), PP);
+  const ExternalLabel stack_limit_label(
+      "stack_limit", Isolate::Current()->stack_limit_address());
+  __ LoadExternalAddress(temp, &stack_limit_label, PP);
   __ cmpq(RSP, Address(temp, 0));
   __ j(BELOW_EQUAL, slow_path->entry_label());
   if (compiler->CanOSRFunction() && in_loop()) {
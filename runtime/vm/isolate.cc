@@ -124,6 +124,8 @@ bool IsolateMessageHandler::HandleMessage(Message* message) {
   SnapshotReader reader(message->data(), message->len(),
                         Snapshot::kMessage, Isolate::Current());
   const Object& msg_obj = Object::Handle(reader.ReadObject());
+  // The objects read now own any external data transferred with the message.
+  message->DropFinalizers();
   if (msg_obj.IsError()) {
     // An error occurred while reading the message.
     return ProcessUnhandledException(Object::null_instance(),
@@ -153,6 +155,8 @@ bool IsolateMessageHandler::HandleMessage(Message* message) {
       ASSERT(result.IsNull());
     }
   }
+  // Fold samples into the isolate's profile before the sample buffer wraps.
+  Profiler::ProcessSamples(isolate_, true);
   delete message;
   return success;
 }
@@ -276,6 +280,7 @@ void BaseIsolate::AssertCurrent(BaseIsolate* isolate) {
 
 Isolate::Isolate()
     : store_buffer_(),
+      incremental_marker_(NULL),
       message_notify_callback_(NULL),
       name_(NULL),
       start_time_(OS::GetCurrentTimeMicros()),
@@ -33,6 +33,7 @@ class HandleScope;
 class HandleVisitor;
 class Heap;
 class ICData;
+class IncrementalMarker;
 class Instance;
 class IsolateProfilerData;
 class LongJump;
@@ -84,6 +85,13 @@ class Isolate : public BaseIsolate {
 
   static void SetCurrent(Isolate* isolate);
 
+  // Makes 'isolate' current on a helper thread that works on its behalf
+  // while the isolate's own thread waits, e.g. during parallel marking.
+  // Unlike SetCurrent, the helper thread is not registered with the profiler.
+  static void SetCurrentHelper(Isolate* isolate) {
+    Thread::SetThreadLocal(isolate_key, reinterpret_cast<uword>(isolate));
+  }
+
   static void InitOnce();
   static Isolate* Init(const char* name_prefix);
   void Shutdown();
@@ -105,6 +113,15 @@ class Isolate : public BaseIsolate {
     return OFFSET_OF(Isolate, store_buffer_);
   }
 
+  // Not NULL while old space is being marked incrementally.
+  IncrementalMarker* incremental_marker() const { return incremental_marker_; }
+  void set_incremental_marker(IncrementalMarker* value) {
+    incremental_marker_ = value;
+  }
+  static intptr_t incremental_marker_offset() {
+    return OFFSET_OF(Isolate, incremental_marker_);
+  }
+
   ClassTable* class_table() { return &class_table_; }
   static intptr_t class_table_offset() {
     return OFFSET_OF(Isolate, class_table_);
@@ -417,6 +434,7 @@ class Isolate : public BaseIsolate {
   static ThreadLocalKey isolate_key;
 
   StoreBuffer store_buffer_;
+  IncrementalMarker* incremental_marker_;
   ClassTable class_table_;
   MegamorphicCacheTable megamorphic_cache_table_;
   Dart_MessageNotifyCallback message_notify_callback_;
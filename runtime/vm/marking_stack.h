@@ -0,0 +1,241 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_MARKING_STACK_H_
+#define VM_MARKING_STACK_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+#include "vm/isolate.h"
+#include "vm/store_buffer.h"
+#include "vm/thread.h"
+
+namespace dart {
+
+// Forward declarations.
+class RawObject;
+
+// The marking stack holds the objects a collector still has to scan. It is
+// used by the marker and, for the objects copied by a parallel scavenge, by
+// the scavenger.
+class MarkingStackChunk {
+ public:
+  MarkingStackChunk() : next_(NULL) {}
+  ~MarkingStackChunk() {}
+
+  RawObject** MarkingStackChunkMemory() {
+    return &memory_[0];
+  }
+
+  MarkingStackChunk* next() const { return next_; }
+  void set_next(MarkingStackChunk* value) { next_ = value; }
+
+  static const uint32_t kMarkingStackChunkSize = 1024;
+
+ private:
+  RawObject* memory_[kMarkingStackChunkSize];
+  MarkingStackChunk* next_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkingStackChunk);
+};
+
+
+// State shared by the tasks of a parallel marking or scavenge. Each task
+// publishes the marking stack chunks it fills and steals published chunks once
+// its own stack runs dry. The work is complete when every task is looking for
+// work and no published chunks are left.
+// Helper tasks run with the isolate as their current isolate, so the
+// StackResource based MonitorLocker and MutexLocker cannot be used here.
+class MarkingWorkList : public ValueObject {
+ public:
+  explicit MarkingWorkList(intptr_t num_tasks)
+      : num_tasks_(num_tasks),
+        num_idle_(0),
+        num_finished_(0),
+        full_chunks_(NULL) {
+    ASSERT(num_tasks_ > 1);
+  }
+
+  ~MarkingWorkList() {
+    ASSERT(full_chunks_ == NULL);
+  }
+
+  intptr_t num_tasks() const { return num_tasks_; }
+
+  void Publish(MarkingStackChunk* chunk) {
+    monitor_.Enter();
+    chunk->set_next(full_chunks_);
+    full_chunks_ = chunk;
+    if (num_idle_ > 0) {
+      monitor_.Notify();
+    }
+    monitor_.Exit();
+  }
+
+  // Returns a published chunk, or NULL once marking is complete.
+  MarkingStackChunk* Steal() {
+    monitor_.Enter();
+    num_idle_++;
+    while ((full_chunks_ == NULL) && (num_idle_ < num_tasks_)) {
+      monitor_.Wait(Monitor::kNoTimeout);
+    }
+    MarkingStackChunk* chunk = full_chunks_;
+    if (chunk != NULL) {
+      full_chunks_ = chunk->next();
+      chunk->set_next(NULL);
+      num_idle_--;
+    } else {
+      // All tasks ran out of work, let the waiting ones finish as well.
+      monitor_.NotifyAll();
+    }
+    monitor_.Exit();
+    return chunk;
+  }
+
+  void AddToStoreBuffer(Isolate* isolate, RawObject* raw_obj) {
+    store_buffer_mutex_.Lock();
+    isolate->store_buffer()->AddObjectGC(raw_obj);
+    store_buffer_mutex_.Unlock();
+  }
+
+  // Called by each helper task as the last thing it does.
+  void TaskFinished() {
+    monitor_.Enter();
+    num_finished_++;
+    monitor_.NotifyAll();
+    monitor_.Exit();
+  }
+
+  void WaitForHelperTasks() {
+    monitor_.Enter();
+    while (num_finished_ < (num_tasks_ - 1)) {
+      monitor_.Wait(Monitor::kNoTimeout);
+    }
+    monitor_.Exit();
+  }
+
+ private:
+  const intptr_t num_tasks_;
+  intptr_t num_idle_;
+  intptr_t num_finished_;
+  MarkingStackChunk* full_chunks_;
+  Monitor monitor_;
+  Mutex store_buffer_mutex_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkingWorkList);
+};
+
+
+// A simple chunked marking stack. When marking in parallel, full chunks are
+// handed to the shared work list instead of being chained locally.
+class MarkingStack {
+ public:
+  explicit MarkingStack(MarkingWorkList* work_list = NULL)
+      : head_(new MarkingStackChunk()),
+        empty_chunks_(NULL),
+        marking_stack_(NULL),
+        top_(0),
+        work_list_(work_list) {
+    marking_stack_ = head_->MarkingStackChunkMemory();
+  }
+
+  ~MarkingStack() {
+    // TODO(iposva): Consider caching a couple emtpy marking stack chunks.
+    ASSERT(IsEmpty());
+    delete head_;
+    MarkingStackChunk* next;
+    while (empty_chunks_ != NULL) {
+      next = empty_chunks_->next();
+      delete empty_chunks_;
+      empty_chunks_ = next;
+    }
+  }
+
+  MarkingWorkList* work_list() const { return work_list_; }
+
+  bool IsEmpty() const {
+    return IsMarkingStackChunkEmpty() && (head_->next() == NULL);
+  }
+
+  void Push(RawObject* value) {
+    ASSERT(!IsMarkingStackChunkFull());
+    marking_stack_[top_] = value;
+    top_++;
+    if (IsMarkingStackChunkFull()) {
+      MarkingStackChunk* new_chunk;
+      if (empty_chunks_ == NULL) {
+        new_chunk = new MarkingStackChunk();
+      } else {
+        new_chunk = empty_chunks_;
+        empty_chunks_ = new_chunk->next();
+      }
+      if (work_list_ != NULL) {
+        ASSERT(head_->next() == NULL);
+        work_list_->Publish(head_);
+        new_chunk->set_next(NULL);
+      } else {
+        new_chunk->set_next(head_);
+      }
+      head_ = new_chunk;
+      marking_stack_ = head_->MarkingStackChunkMemory();
+      top_ = 0;
+    }
+  }
+
+  RawObject* Pop() {
+    ASSERT(head_ != NULL);
+    ASSERT(!IsEmpty());
+    if (IsMarkingStackChunkEmpty()) {
+      MarkingStackChunk* empty_chunk = head_;
+      head_ = head_->next();
+      empty_chunk->set_next(empty_chunks_);
+      empty_chunks_ = empty_chunk;
+      marking_stack_ = head_->MarkingStackChunkMemory();
+      top_ = MarkingStackChunk::kMarkingStackChunkSize;
+    }
+    top_--;
+    return marking_stack_[top_];
+  }
+
+  // Refills an empty stack with a chunk published by another marking task.
+  // Returns false when there is no more work, which for a parallel marking
+  // means that all tasks are done.
+  bool Steal() {
+    ASSERT(IsEmpty());
+    if (work_list_ == NULL) {
+      return false;
+    }
+    MarkingStackChunk* chunk = work_list_->Steal();
+    if (chunk == NULL) {
+      return false;
+    }
+    head_->set_next(empty_chunks_);
+    empty_chunks_ = head_;
+    head_ = chunk;
+    marking_stack_ = head_->MarkingStackChunkMemory();
+    top_ = MarkingStackChunk::kMarkingStackChunkSize;
+    return true;
+  }
+
+ private:
+  bool IsMarkingStackChunkFull() const {
+    return top_ == MarkingStackChunk::kMarkingStackChunkSize;
+  }
+
+  bool IsMarkingStackChunkEmpty() const {
+    return top_ == 0;
+  }
+
+  MarkingStackChunk* head_;
+  MarkingStackChunk* empty_chunks_;
+  RawObject** marking_stack_;
+  uint32_t top_;
+  MarkingWorkList* work_list_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkingStack);
+};
+
+}  // namespace dart
+
+#endif  // VM_MARKING_STACK_H_
@@ -5,6 +5,7 @@
 #include "vm/megamorphic_cache_table.h"
 
 #include <stdlib.h>
+#include "vm/dart_entry.h"
 #include "vm/object.h"
 #include "vm/stub_code.h"
 #include "vm/symbols.h"
@@ -25,30 +26,67 @@ MegamorphicCacheTable::~MegamorphicCacheTable() {
 }
 
 
+intptr_t MegamorphicCacheTable::Hash(const String& name,
+                                     const Array& descriptor) {
+  // Names are symbols and descriptors are canonical, so equal keys are
+  // identical. The hash only needs to spread the keys.
+  ArgumentsDescriptor args_desc(descriptor);
+  uword hash = static_cast<uword>(name.Hash());
+  hash = 31 * hash + args_desc.Count();
+  hash = 31 * hash + args_desc.PositionalCount();
+  return static_cast<intptr_t>(hash & kSmiMax);
+}
+
+
 RawMegamorphicCache* MegamorphicCacheTable::Lookup(const String& name,
                                                    const Array& descriptor) {
-  for (intptr_t i = 0; i < length_; ++i) {
-    if ((table_[i].name == name.raw()) &&
-        (table_[i].descriptor == descriptor.raw())) {
-      return table_[i].cache;
-    }
+  if (table_ == NULL) {
+    capacity_ = kInitialCapacity;
+    table_ = reinterpret_cast<Entry*>(calloc(capacity_, sizeof(*table_)));
   }
-
-  if (length_ == capacity_) {
-    capacity_ += kCapacityIncrement;
-    table_ =
-        reinterpret_cast<Entry*>(realloc(table_, capacity_ * sizeof(*table_)));
+  const intptr_t hash = Hash(name, descriptor);
+  const intptr_t mask = capacity_ - 1;
+  intptr_t index = hash & mask;
+  while (table_[index].name != NULL) {
+    if ((table_[index].name == name.raw()) &&
+        (table_[index].descriptor == descriptor.raw())) {
+      return table_[index].cache;
+    }
+    index = (index + 1) & mask;
   }
 
-  ASSERT(length_ < capacity_);
+  // Not found, index is the first unused entry of the probe sequence.
   const MegamorphicCache& cache =
       MegamorphicCache::Handle(MegamorphicCache::New());
-  Entry entry = { name.raw(), descriptor.raw(), cache.raw() };
-  table_[length_++] = entry;
+  Entry entry = { name.raw(), descriptor.raw(), cache.raw(), hash };
+  table_[index] = entry;
+  length_++;
+  if ((2 * length_) > capacity_) {
+    Grow();
+  }
   return cache.raw();
 }
 
 
+void MegamorphicCacheTable::Grow() {
+  const intptr_t old_capacity = capacity_;
+  Entry* old_table = table_;
+  capacity_ = 2 * old_capacity;
+  table_ = reinterpret_cast<Entry*>(calloc(capacity_, sizeof(*table_)));
+  const intptr_t mask = capacity_ - 1;
+  for (intptr_t i = 0; i < old_capacity; ++i) {
+    if (old_table[i].name != NULL) {
+      intptr_t index = old_table[i].hash & mask;
+      while (table_[index].name != NULL) {
+        index = (index + 1) & mask;
+      }
+      table_[index] = old_table[i];
+    }
+  }
+  free(old_table);
+}
+
+
 void MegamorphicCacheTable::InitMissHandler() {
   // The miss handler for a class ID not found in the table is invoked as a
   // normal Dart function.
@@ -77,10 +115,13 @@ void MegamorphicCacheTable::VisitObjectPointers(ObjectPointerVisitor* v) {
   ASSERT(v != NULL);
   v->VisitPointer(reinterpret_cast<RawObject**>(&miss_handler_code_));
   v->VisitPointer(reinterpret_cast<RawObject**>(&miss_handler_function_));
-  for (intptr_t i = 0; i < length_; ++i) {
-    v->VisitPointer(reinterpret_cast<RawObject**>(&table_[i].name));
-    v->VisitPointer(reinterpret_cast<RawObject**>(&table_[i].descriptor));
-    v->VisitPointer(reinterpret_cast<RawObject**>(&table_[i].cache));
+  // The hashes do not depend on addresses, so moved keys need no rehashing.
+  for (intptr_t i = 0; i < capacity_; ++i) {
+    if (table_[i].name != NULL) {
+      v->VisitPointer(reinterpret_cast<RawObject**>(&table_[i].name));
+      v->VisitPointer(reinterpret_cast<RawObject**>(&table_[i].descriptor));
+      v->VisitPointer(reinterpret_cast<RawObject**>(&table_[i].cache));
+    }
   }
 }
 
@@ -90,7 +131,10 @@ void MegamorphicCacheTable::PrintSizes() {
   intptr_t size = 0;
   MegamorphicCache& cache = MegamorphicCache::Handle();
   Array& buckets = Array::Handle();
-  for (intptr_t i = 0; i < length_; ++i) {
+  for (intptr_t i = 0; i < capacity_; ++i) {
+    if (table_[i].name == NULL) {
+      continue;
+    }
     cache = table_[i].cache;
     buckets = cache.buckets();
     size += MegamorphicCache::InstanceSize();
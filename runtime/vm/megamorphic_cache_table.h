@@ -19,6 +19,10 @@ class RawMegamorphicCache;
 class RawString;
 class String;
 
+// Maps (name, arguments descriptor) pairs to their megamorphic caches. The
+// table is open addressed with linear probing. Hashes are computed from the
+// contents of the name and the descriptor rather than from their addresses,
+// so the table stays valid when the GC moves the keys.
 class MegamorphicCacheTable {
  public:
   MegamorphicCacheTable();
@@ -29,18 +33,28 @@ class MegamorphicCacheTable {
 
   RawMegamorphicCache* Lookup(const String& name, const Array& descriptor);
 
+  intptr_t length() const { return length_; }
+
   void VisitObjectPointers(ObjectPointerVisitor* visitor);
 
   void PrintSizes();
 
  private:
+  // An entry is unused if its name is NULL.
   struct Entry {
     RawString* name;
     RawArray* descriptor;
     RawMegamorphicCache* cache;
+    intptr_t hash;
   };
 
-  static const int kCapacityIncrement = 128;
+  // Must be a power of two.
+  static const intptr_t kInitialCapacity = 128;
+
+  static intptr_t Hash(const String& name, const Array& descriptor);
+
+  // Doubles the capacity of the table, keeping it at most half full.
+  void Grow();
 
   RawFunction* miss_handler_function_;
   RawCode* miss_handler_code_;
@@ -0,0 +1,47 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+#include "vm/dart_entry.h"
+#include "vm/megamorphic_cache_table.h"
+#include "vm/object.h"
+#include "vm/symbols.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+TEST_CASE(MegamorphicCacheTable) {
+  MegamorphicCacheTable table;
+  const Array& one_arg =
+      Array::Handle(ArgumentsDescriptor::New(1, Object::null_array()));
+  const Array& two_args =
+      Array::Handle(ArgumentsDescriptor::New(2, Object::null_array()));
+  // Enough selectors to grow the table several times.
+  const intptr_t kNumNames = 1000;
+  const Array& names = Array::Handle(Array::New(kNumNames));
+  const Array& caches = Array::Handle(Array::New(kNumNames));
+  String& name = String::Handle();
+  MegamorphicCache& cache = MegamorphicCache::Handle();
+  char buffer[32];
+  for (intptr_t i = 0; i < kNumNames; i++) {
+    OS::SNPrint(buffer, sizeof(buffer), "selector%" Pd "", i);
+    name = Symbols::New(buffer);
+    names.SetAt(i, name);
+    cache = table.Lookup(name, one_arg);
+    EXPECT(!cache.IsNull());
+    caches.SetAt(i, cache);
+  }
+  EXPECT_EQ(kNumNames, table.length());
+  for (intptr_t i = 0; i < kNumNames; i++) {
+    name ^= names.At(i);
+    cache = table.Lookup(name, one_arg);
+    EXPECT_EQ(caches.At(i), cache.raw());
+    // The same name with another descriptor gets its own cache.
+    cache = table.Lookup(name, two_args);
+    EXPECT(caches.At(i) != cache.raw());
+  }
+  EXPECT_EQ(2 * kNumNames, table.length());
+}
+
+}  // namespace dart
@@ -4,11 +4,61 @@
 
 #include "vm/message.h"
 
+#include "vm/atomic.h"
+#include "vm/dart_api_state.h"
+#include "vm/isolate.h"
+
 namespace dart {
 
+Message::~Message() {
+  free(data_);
+  RunFinalizers();
+}
+
+
+void Message::AddFinalizer(void* peer,
+                           Dart_WeakPersistentHandleFinalizer callback) {
+  finalizers_ = reinterpret_cast<Finalizer*>(
+      realloc(finalizers_, (num_finalizers_ + 1) * sizeof(*finalizers_)));
+  finalizers_[num_finalizers_].peer = peer;
+  finalizers_[num_finalizers_].callback = callback;
+  num_finalizers_++;
+}
+
+
+void Message::DropFinalizers() {
+  free(finalizers_);
+  finalizers_ = NULL;
+  num_finalizers_ = 0;
+}
+
+
+void Message::RunFinalizers() {
+  Isolate* isolate = Isolate::Current();
+  if ((num_finalizers_ > 0) &&
+      (isolate != NULL) &&
+      (isolate->api_state() != NULL)) {
+    // Finalizers are called with the weak persistent handle they belong to,
+    // give each one a handle of the current isolate.
+    FinalizablePersistentHandles& handles =
+        isolate->api_state()->weak_persistent_handles();
+    for (intptr_t i = 0; i < num_finalizers_; i++) {
+      FinalizablePersistentHandle* handle = handles.AllocateHandle();
+      handle->set_raw(Object::null());
+      handle->set_peer(finalizers_[i].peer);
+      handle->set_callback(finalizers_[i].callback);
+      FinalizablePersistentHandle::Finalize(handle);
+    }
+  }
+  // Without an isolate, e.g. when a native port is closed, the data leaks.
+  DropFinalizers();
+}
+
+
 MessageQueue::MessageQueue() {
   head_ = NULL;
   tail_ = NULL;
+  pending_ = NULL;
 }
 
 
@@ -22,21 +72,54 @@ MessageQueue::~MessageQueue() {
 void MessageQueue::Enqueue(Message* msg) {
   // Make sure messages are not reused.
   ASSERT(msg->next_ == NULL);
+  uword* pending = reinterpret_cast<uword*>(&pending_);
+  uword old_pending;
+  do {
+    old_pending = *reinterpret_cast<volatile uword*>(pending);
+    msg->next_ = reinterpret_cast<Message*>(old_pending);
+  } while (AtomicOperations::CompareAndSwapWord(
+               pending, old_pending, reinterpret_cast<uword>(msg)) !=
+           old_pending);
+}
+
+
+void MessageQueue::TakePending() {
+  // Only the consumer removes pending messages, so there is no ABA problem:
+  // the swap fails only if another message has been pushed.
+  uword* pending = reinterpret_cast<uword*>(&pending_);
+  uword old_pending;
+  do {
+    old_pending = *reinterpret_cast<volatile uword*>(pending);
+    if (old_pending == 0) {
+      return;
+    }
+  } while (AtomicOperations::CompareAndSwapWord(pending, old_pending, 0) !=
+           old_pending);
+  // Reverse the pending messages into arrival order.
+  Message* cur = reinterpret_cast<Message*>(old_pending);
+  Message* first = NULL;
+  Message* last = cur;
+  while (cur != NULL) {
+    Message* next = cur->next_;
+    cur->next_ = first;
+    first = cur;
+    cur = next;
+  }
   if (head_ == NULL) {
-    // Only element in the queue.
     ASSERT(tail_ == NULL);
-    head_ = msg;
-    tail_ = msg;
+    head_ = first;
   } else {
     ASSERT(tail_ != NULL);
-    // Append at the tail.
-    tail_->next_ = msg;
-    tail_ = msg;
+    tail_->next_ = first;
   }
+  tail_ = last;
 }
 
 
 Message* MessageQueue::Dequeue() {
+  if (head_ == NULL) {
+    TakePending();
+  }
   Message* result = head_;
   if (result != NULL) {
     head_ = result->next_;
@@ -54,6 +137,7 @@ Message* MessageQueue::Dequeue() {
 
 
 void MessageQueue::Clear() {
+  TakePending();
   Message* cur = head_;
   head_ = NULL;
   tail_ = NULL;
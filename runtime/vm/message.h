@@ -9,6 +9,10 @@
 
 // Duplicated from dart_api.h to avoid including the whole header.
 typedef int64_t Dart_Port;
+typedef struct _Dart_WeakPersistentHandle* Dart_WeakPersistentHandle;
+typedef void (*Dart_WeakPersistentHandleFinalizer)(
+    Dart_WeakPersistentHandle handle,
+    void* peer);
 
 namespace dart {
 
@@ -34,10 +38,10 @@ class Message {
         dest_port_(dest_port),
         data_(data),
         len_(len),
-        priority_(priority) {}
-  ~Message() {
-    free(data_);
-  }
+        priority_(priority),
+        finalizers_(NULL),
+        num_finalizers_(0) {}
+  ~Message();
 
   Dart_Port dest_port() const { return dest_port_; }
   uint8_t* data() const { return data_; }
@@ -46,19 +50,41 @@ class Message {
 
   bool IsOOB() const { return priority_ == Message::kOOBPriority; }
 
+  // Takes over the finalizer of external data whose backing store moved
+  // into this message, see MessageWriter::TransferFinalizers. It runs if
+  // the message is destroyed before its receiver has read it.
+  void AddFinalizer(void* peer, Dart_WeakPersistentHandleFinalizer callback);
+
+  // Called once the receiver has read the message and owns the data.
+  void DropFinalizers();
+
  private:
   friend class MessageQueue;
 
+  struct Finalizer {
+    void* peer;
+    Dart_WeakPersistentHandleFinalizer callback;
+  };
+
+  void RunFinalizers();
+
   Message* next_;
   Dart_Port dest_port_;
   uint8_t* data_;
   intptr_t len_;
   Priority priority_;
+  Finalizer* finalizers_;
+  intptr_t num_finalizers_;
 
   DISALLOW_COPY_AND_ASSIGN(Message);
 };
 
 // There is a message queue per isolate.
+//
+// Any number of threads may enqueue messages concurrently without taking a
+// lock: new messages are pushed on a lock-free stack of pending messages.
+// Dequeue and Clear must not run concurrently with each other; they move
+// the pending messages over to a FIFO list in arrival order.
 class MessageQueue {
  public:
   MessageQueue();
@@ -76,9 +102,16 @@ class MessageQueue {
  private:
   friend class MessageQueueTestPeer;
 
+  // Moves the pending messages to the end of the FIFO list.
+  void TakePending();
+
+  // FIFO list of messages, only accessed by the consumer.
   Message* head_;
   Message* tail_;
 
+  // Messages enqueued since the last TakePending, most recent first.
+  Message* pending_;
+
   DISALLOW_COPY_AND_ASSIGN(MessageQueue);
 };
 
@@ -88,7 +88,6 @@ void MessageHandler::Run(ThreadPool* pool,
 
 
 void MessageHandler::PostMessage(Message* message) {
-  MonitorLocker ml(&monitor_);
   if (FLAG_trace_isolates) {
     const char* source_name = "<native code>";
     Isolate* source_isolate = Isolate::Current();
@@ -102,6 +101,11 @@ void MessageHandler::PostMessage(Message* message) {
               source_name, name(), message->dest_port());
   }
 
+  // The queues accept messages from any number of threads without a lock.
+  // The monitor is only needed to schedule the task which handles them: a
+  // task which is done does not clear task_ before it has found both queues
+  // empty while holding the monitor, so it either sees this message or a
+  // new task gets scheduled below.
   Message::Priority saved_priority = message->priority();
   if (message->IsOOB()) {
     oob_queue_->Enqueue(message);
@@ -110,6 +114,7 @@ void MessageHandler::PostMessage(Message* message) {
   }
   message = NULL;  // Do not access message.  May have been deleted.
 
+  MonitorLocker ml(&monitor_);
   if (pool_ != NULL && task_ == NULL) {
     task_ = new MessageHandlerTask(this);
     pool_->Run(task_);
@@ -124,7 +124,9 @@ class MessageHandler {
   bool HandleMessages(bool allow_normal_messages,
                       bool allow_multiple_normal_messages);
 
-  Monitor monitor_;  // Protects all fields in MessageHandler.
+  // Protects all fields in MessageHandler. Enqueuing messages does not need
+  // the monitor, see PostMessage.
+  Monitor monitor_;
   MessageQueue* queue_;
   MessageQueue* oob_queue_;
   intptr_t control_ports_;  // The number of open control ports usually 0 or 1.
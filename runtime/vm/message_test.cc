@@ -17,7 +17,7 @@ class MessageQueueTestPeer {
   bool HasMessage() const {
     // We don't really need to grab the monitor during the unit test,
     // but it doesn't hurt.
-    bool result = (queue_->head_ != NULL);
+    bool result = (queue_->head_ != NULL) || (queue_->pending_ != NULL);
     return result;
   }
 
@@ -99,4 +99,59 @@ TEST_CASE(MessageQueue_Clear) {
   // msg1 and msg2 already delete by FlushAll.
 }
 
+
+struct EnqueueInfo {
+  MessageQueue* queue;
+  Dart_Port port;
+  intptr_t count;
+};
+
+
+static void EnqueueMessages(uword param) {
+  EnqueueInfo* info = reinterpret_cast<EnqueueInfo*>(param);
+  for (intptr_t i = 0; i < info->count; i++) {
+    // The length field carries the sequence number of the message.
+    info->queue->Enqueue(
+        new Message(info->port, NULL, i, Message::kNormalPriority));
+  }
+}
+
+
+UNIT_TEST_CASE(MessageQueue_ConcurrentEnqueue) {
+  const intptr_t kNumThreads = 4;
+  const intptr_t kMessagesPerThread = 10000;
+  MessageQueue queue;
+  EnqueueInfo info[kNumThreads];
+  intptr_t next_sequence[kNumThreads];
+  for (intptr_t i = 0; i < kNumThreads; i++) {
+    info[i].queue = &queue;
+    info[i].port = i + 1;
+    info[i].count = kMessagesPerThread;
+    next_sequence[i] = 0;
+    int result = Thread::Start(EnqueueMessages,
+                               reinterpret_cast<uword>(&info[i]));
+    EXPECT_EQ(0, result);
+  }
+  // Dequeue while the threads are still enqueuing. The messages of each
+  // thread must arrive in order.
+  intptr_t received = 0;
+  const int kMaxSleep = 20 * 1000;  // 20 seconds.
+  int sleep = 0;
+  while ((received < kNumThreads * kMessagesPerThread) && (sleep < kMaxSleep)) {
+    Message* message = queue.Dequeue();
+    if (message == NULL) {
+      OS::Sleep(1);
+      sleep += 1;
+      continue;
+    }
+    intptr_t thread = message->dest_port() - 1;
+    EXPECT_EQ(next_sequence[thread], message->len());
+    next_sequence[thread] = message->len() + 1;
+    received++;
+    delete message;
+  }
+  EXPECT_EQ(kNumThreads * kMessagesPerThread, received);
+  EXPECT(queue.Dequeue() == NULL);
+}
+
 }  // namespace dart
@@ -37,6 +37,7 @@
 #include "vm/reusable_handles.h"
 #include "vm/runtime_entry.h"
 #include "vm/scopes.h"
+#include "vm/snapshot.h"
 #include "vm/stack_frame.h"
 #include "vm/symbols.h"
 #include "vm/timer.h"
@@ -62,6 +63,7 @@ DEFINE_FLAG(bool, throw_on_javascript_int_overflow, false,
 DECLARE_FLAG(bool, eliminate_type_checks);
 DECLARE_FLAG(bool, enable_type_checks);
 DECLARE_FLAG(bool, error_on_bad_override);
+DECLARE_FLAG(bool, snapshot_code);
 DECLARE_FLAG(bool, trace_compiler);
 DECLARE_FLAG(bool, trace_deoptimization);
 DECLARE_FLAG(bool, trace_deoptimization_verbose);
@@ -1509,6 +1511,11 @@ RawObject* Object::Clone(const Object& src, Heap::Space space) {
   RawObject* raw_obj = Object::Allocate(cls.id(), size, space);
   NoGCScope no_gc;
   memmove(raw_obj->ptr(), src.raw()->ptr(), size);
+#if defined(ARCH_IS_64_BIT)
+  // The clone is a distinct object and must not share the identity hash
+  // code of the source.
+  raw_obj->SetHeaderHash(0);
+#endif
   if ((space == Heap::kOld) && !raw_obj->IsRemembered()) {
     StoreBufferUpdateVisitor visitor(Isolate::Current(), raw_obj);
     raw_obj->VisitPointers(&visitor);
@@ -4130,6 +4137,12 @@ void Function::SetCode(const Code& value) const {
 }
 
 
+void Function::ClearCode() const {
+  StorePointer(&raw_ptr()->code_, Code::null());
+  StorePointer(&raw_ptr()->unoptimized_code_, Code::null());
+}
+
+
 void Function::SwitchToUnoptimizedCode() const {
   ASSERT(HasOptimizedCode());
 
@@ -6268,6 +6281,12 @@ void LiteralToken::PrintToJSONStream(JSONStream* stream, bool ref) const {
 
 
 RawArray* TokenStream::TokenObjects() const {
+  if (raw_ptr()->serialized_token_objects_ != ExternalTypedData::null()) {
+    const ExternalTypedData& data =
+        ExternalTypedData::Handle(raw_ptr()->serialized_token_objects_);
+    SetTokenObjects(Array::Handle(SnapshotReader::ReadTokenObjects(data)));
+    SetSerializedTokenObjects(ExternalTypedData::Handle());
+  }
   return raw_ptr()->token_objects_;
 }
 
@@ -6277,6 +6296,12 @@ void TokenStream::SetTokenObjects(const Array& value) const {
 }
 
 
+void TokenStream::SetSerializedTokenObjects(
+    const ExternalTypedData& value) const {
+  StorePointer(&raw_ptr()->serialized_token_objects_, value.raw());
+}
+
+
 RawExternalTypedData* TokenStream::GetStream() const {
   return raw_ptr()->stream_;
 }
@@ -6467,8 +6492,11 @@ RawString* TokenStream::GenerateSource() const {
 
 
 intptr_t TokenStream::ComputeSourcePosition(intptr_t tok_pos) const {
-  Iterator iterator(*this, 0, Iterator::kAllTokens);
   intptr_t src_pos = 0;
+  intptr_t line = 0;
+  Iterator iterator(*this,
+                    FindCheckpoint(tok_pos, &src_pos, &line),
+                    Iterator::kAllTokens);
   Token::Kind kind = iterator.CurrentTokenKind();
   while (iterator.CurrentPosition() < tok_pos && kind != Token::kEOS) {
     iterator.Advance();
@@ -6479,6 +6507,95 @@ intptr_t TokenStream::ComputeSourcePosition(intptr_t tok_pos) const {
 }
 
 
+void TokenStream::SetCheckpoints(const Array& value) const {
+  StorePointer(&raw_ptr()->checkpoints_, value.raw());
+}
+
+
+RawArray* TokenStream::Checkpoints() const {
+  if (raw_ptr()->checkpoints_ != Array::null()) {
+    return raw_ptr()->checkpoints_;
+  }
+  GrowableArray<intptr_t> values;
+  Iterator iterator(*this, 0, Iterator::kAllTokens);
+  intptr_t token_count = 0;
+  intptr_t line = 1;
+  while (true) {
+    if ((token_count % kTokensPerCheckpoint) == 0) {
+      values.Add(iterator.CurrentPosition());
+      values.Add(token_count);
+      values.Add(line);
+    }
+    const Token::Kind kind = iterator.CurrentTokenKind();
+    if (kind == Token::kEOS) {
+      break;
+    }
+    if (kind == Token::kNEWLINE) {
+      line++;
+    }
+    iterator.Advance();
+    token_count++;
+  }
+  const Array& checkpoints =
+      Array::Handle(Array::New(values.length(), Heap::kOld));
+  Smi& value = Smi::Handle();
+  for (intptr_t i = 0; i < values.length(); i++) {
+    value = Smi::New(values[i]);
+    checkpoints.SetAt(i, value);
+  }
+  SetCheckpoints(checkpoints);
+  return checkpoints.raw();
+}
+
+
+static intptr_t CheckpointValue(const Array& checkpoints,
+                                intptr_t index,
+                                intptr_t offset) {
+  return Smi::Value(reinterpret_cast<RawSmi*>(checkpoints.At(index + offset)));
+}
+
+
+intptr_t TokenStream::FindCheckpoint(intptr_t token_pos,
+                                     intptr_t* token_count,
+                                     intptr_t* line) const {
+  const Array& checkpoints = Array::Handle(Checkpoints());
+  // Find the last checkpoint at or before token_pos, the first one is at 0.
+  intptr_t lo = 0;
+  intptr_t hi = checkpoints.Length() / kCheckpointSize;
+  while ((hi - lo) > 1) {
+    const intptr_t mid = lo + (hi - lo) / 2;
+    if (CheckpointValue(checkpoints, mid * kCheckpointSize, 0) <= token_pos) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  *token_count = CheckpointValue(checkpoints, lo * kCheckpointSize, 1);
+  *line = CheckpointValue(checkpoints, lo * kCheckpointSize, 2);
+  return CheckpointValue(checkpoints, lo * kCheckpointSize, 0);
+}
+
+
+intptr_t TokenStream::FindLineCheckpoint(intptr_t line,
+                                         intptr_t* checkpoint_line) const {
+  const Array& checkpoints = Array::Handle(Checkpoints());
+  // Find the last checkpoint on a line before the given one, or the first
+  // one.
+  intptr_t lo = 0;
+  intptr_t hi = checkpoints.Length() / kCheckpointSize;
+  while ((hi - lo) > 1) {
+    const intptr_t mid = lo + (hi - lo) / 2;
+    if (CheckpointValue(checkpoints, mid * kCheckpointSize, 2) < line) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  *checkpoint_line = CheckpointValue(checkpoints, lo * kCheckpointSize, 2);
+  return CheckpointValue(checkpoints, lo * kCheckpointSize, 0);
+}
+
+
 RawTokenStream* TokenStream::New() {
   ASSERT(Object::token_stream_class() != Class::null());
   RawObject* raw = Object::Allocate(TokenStream::kClassId,
@@ -6514,10 +6631,11 @@ class CompressedTokenStreamData : public ValueObject {
       stream_(&buffer_, Reallocate, kInitialSize),
       token_objects_(GrowableObjectArray::Handle(
           GrowableObjectArray::New(kInitialTokenCount, Heap::kOld))),
+      sorted_token_objects_(Array::Handle()),
       token_obj_(Object::Handle()),
       literal_token_(LiteralToken::Handle()),
       literal_str_(String::Handle()) {
-    token_objects_.Add(Object::null_string());
+    AddTokenObject(Object::null_string());
   }
   ~CompressedTokenStreamData() {
   }
@@ -6529,14 +6647,11 @@ class CompressedTokenStreamData : public ValueObject {
       // same index instead of duplicating it.
       intptr_t index = FindIdentIndex(ident);
       if (index == -1) {
-        WriteIndex(token_objects_.Length());
-        ASSERT(ident != NULL);
-        token_objects_.Add(*ident);
-      } else {
-        WriteIndex(index);
+        index = AddTokenObject(*ident);
       }
+      AddIndex(index);
     } else {
-      WriteIndex(0);
+      AddIndex(0);
     }
   }
 
@@ -6547,21 +6662,50 @@ class CompressedTokenStreamData : public ValueObject {
       // same index instead of duplicating it.
       intptr_t index = FindLiteralIndex(kind, literal);
       if (index == -1) {
-        WriteIndex(token_objects_.Length());
-        ASSERT(literal != NULL);
         literal_token_ = LiteralToken::New(kind, *literal);
-        token_objects_.Add(literal_token_);
-      } else {
-        WriteIndex(index);
+        index = AddTokenObject(literal_token_);
       }
+      AddIndex(index);
     } else {
-      WriteIndex(0);
+      AddIndex(0);
     }
   }
 
   // Add a simple token into the stream.
   void AddSimpleToken(intptr_t kind) {
-    stream_.WriteUnsigned(kind);
+    ASSERT(kind < Token::kNumTokens);
+    tokens_.Add(kind);
+  }
+
+  // Sort the token objects by decreasing number of uses and write the
+  // compressed token stream, see TokenStream::kFirstTwoByteValue.
+  void Encode() {
+    const intptr_t num_objects = token_objects_.Length();
+    GrowableArray<ObjectUses> order(num_objects);
+    for (intptr_t i = 0; i < num_objects; i++) {
+      ObjectUses entry;
+      entry.index = i;
+      entry.uses = uses_[i];
+      order.Add(entry);
+    }
+    order.Sort(CompareUses);
+    GrowableArray<intptr_t> new_index(num_objects);
+    for (intptr_t i = 0; i < num_objects; i++) {
+      new_index.Add(-1);
+    }
+    sorted_token_objects_ = Array::New(num_objects, Heap::kOld);
+    for (intptr_t i = 0; i < num_objects; i++) {
+      new_index[order[i].index] = i;
+      token_obj_ = token_objects_.At(order[i].index);
+      sorted_token_objects_.SetAt(i, token_obj_);
+    }
+    for (intptr_t i = 0; i < tokens_.length(); i++) {
+      intptr_t value = tokens_[i];
+      if (value >= Token::kNumTokens) {
+        value = Token::kNumTokens + new_index[value - Token::kNumTokens];
+      }
+      WriteToken(value);
+    }
   }
 
   // Return the compressed token stream.
@@ -6570,12 +6714,25 @@ class CompressedTokenStreamData : public ValueObject {
   // Return the compressed token stream length.
   intptr_t Length() const { return stream_.bytes_written(); }
 
-  // Return the token objects array.
-  const GrowableObjectArray& TokenObjects() const {
-    return token_objects_;
+  // Return the token objects array, sorted by Encode.
+  const Array& TokenObjects() const {
+    return sorted_token_objects_;
   }
 
  private:
+  struct ObjectUses {
+    intptr_t index;
+    intptr_t uses;
+  };
+
+  static int CompareUses(const ObjectUses* a, const ObjectUses* b) {
+    if (a->uses != b->uses) {
+      return (a->uses > b->uses) ? -1 : 1;
+    }
+    // Keep the order of first use, so that the encoding is deterministic.
+    return (a->index < b->index) ? -1 : ((a->index > b->index) ? 1 : 0);
+  }
+
   intptr_t FindIdentIndex(const String* ident) {
     ASSERT(ident != NULL);
     intptr_t hash_value = ident->Hash() % kTableSize;
@@ -6613,8 +6770,34 @@ class CompressedTokenStreamData : public ValueObject {
     return -1;
   }
 
-  void WriteIndex(intptr_t value) {
-    stream_.WriteUnsigned(value + Token::kNumTokens);
+  intptr_t AddTokenObject(const Object& obj) {
+    const intptr_t index = token_objects_.Length();
+    token_objects_.Add(obj);
+    uses_.Add(0);
+    return index;
+  }
+
+  void AddIndex(intptr_t index) {
+    uses_[index] += 1;
+    tokens_.Add(index + Token::kNumTokens);
+  }
+
+  void WriteToken(intptr_t value) {
+    if (value < TokenStream::kFirstTwoByteValue) {
+      WriteByte(value);
+    } else if (value < TokenStream::kFirstEscapedValue) {
+      const intptr_t offset = value - TokenStream::kFirstTwoByteValue;
+      WriteByte(TokenStream::kFirstTwoByteValue + (offset >> kBitsPerByte));
+      WriteByte(offset & 0xFF);
+    } else {
+      WriteByte(TokenStream::kEscapeValue);
+      stream_.WriteUnsigned(value - TokenStream::kFirstEscapedValue);
+    }
+  }
+
+  void WriteByte(intptr_t value) {
+    ASSERT(Utils::IsUint(kBitsPerByte, value));
+    WriteStream::Raw<1, uint8_t>::Write(&stream_, value);
   }
 
   static uint8_t* Reallocate(uint8_t* ptr,
@@ -6631,7 +6814,12 @@ class CompressedTokenStreamData : public ValueObject {
   WriteStream stream_;
   GrowableArray<intptr_t> ident_table_[kTableSize];
   GrowableArray<intptr_t> literal_table_[kTableSize];
+  // The tokens before sorting the token objects, encoded as in the stream.
+  GrowableArray<intptr_t> tokens_;
+  // The number of uses of each token object.
+  GrowableArray<intptr_t> uses_;
   const GrowableObjectArray& token_objects_;
+  Array& sorted_token_objects_;
   Object& token_obj_;
   LiteralToken& literal_token_;
   String& literal_str_;
@@ -6642,6 +6830,7 @@ class CompressedTokenStreamData : public ValueObject {
 
 RawTokenStream* TokenStream::New(const Scanner::GrowableTokenStream& tokens,
                                  const String& private_key) {
+  COMPILE_ASSERT(kFirstTwoByteValue < kEscapeValue, token_encoding);
   // Copy the relevant data out of the scanner into a compressed stream of
   // tokens.
   CompressedTokenStreamData data;
@@ -6667,6 +6856,7 @@ RawTokenStream* TokenStream::New(const Scanner::GrowableTokenStream& tokens,
     CompilerStats::num_tokens_total += len;
   }
   data.AddSimpleToken(Token::kEOS);  // End of stream.
+  data.Encode();
 
   // Create and setup the token stream object.
   const ExternalTypedData& stream = ExternalTypedData::Handle(
@@ -6678,8 +6868,7 @@ RawTokenStream* TokenStream::New(const Scanner::GrowableTokenStream& tokens,
   {
     NoGCScope no_gc;
     result.SetStream(stream);
-    const Array& tokens = Array::Handle(Array::MakeArray(data.TokenObjects()));
-    result.SetTokenObjects(tokens);
+    result.SetTokenObjects(data.TokenObjects());
   }
   return result.raw();
 }
@@ -6922,8 +7111,13 @@ void Script::GetTokenLocation(intptr_t token_pos,
   ASSERT(line != NULL);
   const TokenStream& tkns = TokenStream::Handle(tokens());
   if (column == NULL) {
-    TokenStream::Iterator tkit(tkns, 0, TokenStream::Iterator::kAllTokens);
-    intptr_t cur_line = line_offset() + 1;
+    intptr_t token_count = 0;
+    intptr_t cur_line = 0;
+    TokenStream::Iterator tkit(
+        tkns,
+        tkns.FindCheckpoint(token_pos, &token_count, &cur_line),
+        TokenStream::Iterator::kAllTokens);
+    cur_line += line_offset();
     while (tkit.CurrentPosition() < token_pos &&
            tkit.CurrentTokenKind() != Token::kEOS) {
       if (tkit.CurrentTokenKind() == Token::kNEWLINE) {
@@ -6958,9 +7152,11 @@ void Script::TokenRangeAtLine(intptr_t line_number,
   const TokenStream& tkns = TokenStream::Handle(tokens());
   line_number -= line_offset();
   if (line_number < 1) line_number = 1;
-  TokenStream::Iterator tkit(tkns, 0, TokenStream::Iterator::kAllTokens);
   // Scan through the token stream to the required line.
   intptr_t cur_line = 1;
+  TokenStream::Iterator tkit(tkns,
+                             tkns.FindLineCheckpoint(line_number, &cur_line),
+                             TokenStream::Iterator::kAllTokens);
   while (cur_line < line_number && tkit.CurrentTokenKind() != Token::kEOS) {
     if (tkit.CurrentTokenKind() == Token::kNEWLINE) {
       cur_line++;
@@ -8699,52 +8895,55 @@ void PcDescriptors::SetLength(intptr_t value) const {
 
 
 uword PcDescriptors::PC(intptr_t index) const {
-  return static_cast<uword>(*(EntryAddr(index, kPcEntry)));
+  return Rec(index)->pc;
 }
 
 
 void PcDescriptors::SetPC(intptr_t index, uword value) const {
-  *(EntryAddr(index, kPcEntry)) = static_cast<intptr_t>(value);
+  Rec(index)->pc = value;
 }
 
 
 PcDescriptors::Kind PcDescriptors::DescriptorKind(intptr_t index) const {
-  return static_cast<PcDescriptors::Kind>(*(EntryAddr(index, kKindEntry)));
+  return static_cast<PcDescriptors::Kind>(Rec(index)->kind);
 }
 
 
 void PcDescriptors::SetKind(intptr_t index, PcDescriptors::Kind value) const {
-  *(EntryAddr(index, kKindEntry)) = value;
+  Rec(index)->kind = value;
 }
 
 
 intptr_t PcDescriptors::DeoptId(intptr_t index) const {
-  return *(EntryAddr(index, kDeoptIdEntry));
+  return Rec(index)->deopt_id;
 }
 
 
 void PcDescriptors::SetDeoptId(intptr_t index, intptr_t value) const {
-  *(EntryAddr(index, kDeoptIdEntry)) = value;
+  ASSERT(Utils::IsInt(32, value));
+  Rec(index)->deopt_id = value;
 }
 
 
 intptr_t PcDescriptors::TokenPos(intptr_t index) const {
-  return *(EntryAddr(index, kTokenPosEntry));
+  return Rec(index)->token_pos;
 }
 
 
 void PcDescriptors::SetTokenPos(intptr_t index, intptr_t value) const {
-  *(EntryAddr(index, kTokenPosEntry)) = value;
+  ASSERT(Utils::IsInt(32, value));
+  Rec(index)->token_pos = value;
 }
 
 
 intptr_t PcDescriptors::TryIndex(intptr_t index) const {
-  return *(EntryAddr(index, kTryIndexEntry));
+  return Rec(index)->try_index;
 }
 
 
 void PcDescriptors::SetTryIndex(intptr_t index, intptr_t value) const {
-  *(EntryAddr(index, kTryIndexEntry)) = value;
+  ASSERT(Utils::IsInt(32, value));
+  Rec(index)->try_index = value;
 }
 
 
@@ -8886,6 +9085,25 @@ void PcDescriptors::Verify(const Function& function) const {
 }
 
 
+intptr_t PcDescriptors::FindPC(uword pc) const {
+  // Find the first record at or above pc.
+  intptr_t lo = 0;
+  intptr_t hi = Length();
+  while (lo < hi) {
+    const intptr_t mid = lo + (hi - lo) / 2;
+    if (PC(mid) < pc) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if ((lo < Length()) && (PC(lo) == pc)) {
+    return lo;
+  }
+  return -1;
+}
+
+
 uword PcDescriptors::GetPcForKind(Kind kind) const {
   for (intptr_t i = 0; i < Length(); i++) {
     if (DescriptorKind(i) == kind) {
@@ -9594,6 +9812,12 @@ const Code::Comments& Code::comments() const  {
 }
 
 
+void Code::set_relocations(const Array& value) const {
+  ASSERT(value.IsOld());
+  StorePointer(&raw_ptr()->relocations_, value.raw());
+}
+
+
 void Code::set_comments(const Code::Comments& comments) const {
   ASSERT(comments.comments_.IsOld());
   StorePointer(&raw_ptr()->comments_, comments.comments_.raw());
@@ -9665,6 +9889,7 @@ RawCode* Code::FinalizeCode(const char* name,
     // Hook up Code and Instructions objects.
     instrs.set_code(code.raw());
     code.set_instructions(instrs.raw());
+    Isolate::Current()->heap()->code_index()->Add(instrs);
 
     // Set object pool in Instructions object.
     const GrowableObjectArray& object_pool = assembler->object_pool();
@@ -9685,32 +9910,43 @@ RawCode* Code::FinalizeCode(const Function& function,
                             Assembler* assembler,
                             bool optimized) {
   // Calling ToFullyQualifiedCString is very expensive, try to avoid it.
-  if (CodeObservers::AreActive()) {
-    return FinalizeCode(function.ToFullyQualifiedCString(),
-                        assembler,
-                        optimized);
-  } else {
-    return FinalizeCode("", assembler);
+  const Code& code = Code::Handle(
+      CodeObservers::AreActive() ?
+          FinalizeCode(function.ToFullyQualifiedCString(),
+                       assembler,
+                       optimized) :
+          FinalizeCode("", assembler));
+  // Only unoptimized code is written to snapshots, it makes no assumptions
+  // that could be invalid in another process. Native and intrinsified code
+  // embeds addresses that are not recorded by the assembler.
+  if (FLAG_snapshot_code &&
+      !optimized &&
+      !function.is_native() &&
+      !Intrinsifier::CanIntrinsify(function) &&
+      (code.pointer_offsets_length() == 0)) {
+    GrowableArray<intptr_t> slots;
+    if (assembler->GetExternalSlots(&slots)) {
+      const Array& relocations =
+          Array::Handle(Array::New(slots.length(), Heap::kOld));
+      for (intptr_t i = 0; i < slots.length(); i++) {
+        relocations.SetAt(i, Smi::Handle(Smi::New(slots[i])));
+      }
+      code.set_relocations(relocations);
+    }
   }
-}
-
-
-// Check if object matches find condition.
-bool Code::FindRawCodeVisitor::FindObject(RawObject* obj) {
-  return RawInstructions::ContainsPC(obj, pc_);
+  return code.raw();
 }
 
 
 RawCode* Code::LookupCode(uword pc) {
   Isolate* isolate = Isolate::Current();
   NoGCScope no_gc;
-  FindRawCodeVisitor visitor(pc);
-  RawInstructions* instr;
   if (isolate->heap() == NULL) {
     return Code::null();
   }
-  instr = isolate->heap()->FindObjectInCodeSpace(&visitor);
-  if (instr != Instructions::null()) {
+  RawInstructions* instr = isolate->heap()->code_index()->Lookup(pc);
+  if (instr != NULL) {
+    ASSERT(RawInstructions::ContainsPC(instr, pc));
     return instr->ptr()->code_;
   }
   return Code::null();
@@ -9718,15 +9954,9 @@ RawCode* Code::LookupCode(uword pc) {
 
 
 intptr_t Code::GetTokenIndexOfPC(uword pc) const {
-  intptr_t token_pos = -1;
   const PcDescriptors& descriptors = PcDescriptors::Handle(pc_descriptors());
-  for (intptr_t i = 0; i < descriptors.Length(); i++) {
-    if (descriptors.PC(i) == pc) {
-      token_pos = descriptors.TokenPos(i);
-      break;
-    }
-  }
-  return token_pos;
+  const intptr_t index = descriptors.FindPC(pc);
+  return (index < 0) ? -1 : descriptors.TokenPos(index);
 }
 
 
@@ -9746,9 +9976,13 @@ uword Code::GetPcForDeoptId(intptr_t deopt_id, PcDescriptors::Kind kind) const {
 
 intptr_t Code::GetDeoptIdForOsr(uword pc) const {
   const PcDescriptors& descriptors = PcDescriptors::Handle(pc_descriptors());
-  for (intptr_t i = 0; i < descriptors.Length(); ++i) {
-    if ((descriptors.PC(i) == pc) &&
-        (descriptors.DescriptorKind(i) == PcDescriptors::kOsrEntry)) {
+  const intptr_t len = descriptors.Length();
+  intptr_t i = descriptors.FindPC(pc);
+  if (i < 0) {
+    return Isolate::kNoDeoptId;
+  }
+  for (; (i < len) && (descriptors.PC(i) == pc); i++) {
+    if (descriptors.DescriptorKind(i) == PcDescriptors::kOsrEntry) {
       return descriptors.DeoptId(i);
     }
   }
@@ -9871,14 +10105,23 @@ RawStackmap* Code::GetStackmap(uword pc, Array* maps, Stackmap* map) const {
   }
   // A stack map is present in the code object, use the stack map to visit
   // frame slots which are marked as having objects.
+  // The stack maps are sorted by pc.
   *maps = stackmaps();
   *map = Stackmap::null();
-  for (intptr_t i = 0; i < maps->Length(); i++) {
-    *map ^= maps->At(i);
+  intptr_t lo = 0;
+  intptr_t hi = maps->Length();
+  while (lo < hi) {
+    const intptr_t mid = lo + (hi - lo) / 2;
+    *map ^= maps->At(mid);
     ASSERT(!map->IsNull());
     if (map->PC() == pc) {
       return map->raw();  // We found a stack map for this frame.
     }
+    if (map->PC() < pc) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
   }
   // If the code has stackmaps, it must have them for all safepoints.
   UNREACHABLE();
@@ -14612,6 +14855,7 @@ RawString* String::MakeExternal(void* array,
                                 intptr_t length,
                                 void* peer,
                                 Dart_PeerFinalizer cback) const {
+  Isolate::Current()->heap()->WaitForSweeperTasks();
   NoGCScope no_gc;
   ASSERT(array != NULL);
   intptr_t str_length = this->Length();
@@ -15404,6 +15648,7 @@ RawArray* Array::New(intptr_t class_id, intptr_t len, Heap::Space space) {
 
 
 void Array::MakeImmutable() const {
+  Isolate::Current()->heap()->WaitForSweeperTasks();
   NoGCScope no_gc;
   uword tags = raw_ptr()->tags_;
   tags = RawObject::ClassIdTag::update(kImmutableArrayCid, tags);
@@ -15459,6 +15704,7 @@ RawArray* Array::MakeArray(const GrowableObjectArray& growable_array) {
   const Array& array = Array::Handle(isolate, growable_array.data());
   intptr_t capacity_size = Array::InstanceSize(capacity_len);
   intptr_t used_size = Array::InstanceSize(used_len);
+  isolate->heap()->WaitForSweeperTasks();
   NoGCScope no_gc;
 
   // Update the size in the header field and length of the array object.
@@ -16006,7 +16252,31 @@ void TypedData::PrintToJSONStream(JSONStream* stream, bool ref) const {
 FinalizablePersistentHandle* ExternalTypedData::AddFinalizer(
     void* peer, Dart_WeakPersistentHandleFinalizer callback) const {
   SetPeer(peer);
-  return dart::AddFinalizer(*this, peer, callback);
+  FinalizablePersistentHandle* handle =
+      dart::AddFinalizer(*this, peer, callback);
+  set_finalizer(handle);
+  return handle;
+}
+
+
+void ExternalTypedData::ForgetFinalizer(RawObject* raw,
+                                        FinalizablePersistentHandle* handle) {
+  if (raw->IsHeapObject() &&
+      RawObject::IsExternalTypedDataClassId(raw->GetClassId())) {
+    RawExternalTypedData* raw_array =
+        reinterpret_cast<RawExternalTypedData*>(raw);
+    if (raw_array->ptr()->finalizer_ == handle) {
+      raw_array->ptr()->finalizer_ = NULL;
+    }
+  }
+}
+
+
+void ExternalTypedData::DetachData() const {
+  SetData(NULL);
+  SetLength(0);
+  SetPeer(NULL);
+  set_finalizer(NULL);
 }
 
 
@@ -16023,6 +16293,7 @@ RawExternalTypedData* ExternalTypedData::New(intptr_t class_id,
     result ^= raw;
     result.SetLength(len);
     result.SetData(data);
+    result.set_finalizer(NULL);
   }
   return result.raw();
 }
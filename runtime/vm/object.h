@@ -11,6 +11,7 @@
 #include "vm/json_stream.h"
 #include "vm/bitmap.h"
 #include "vm/dart.h"
+#include "vm/gc_marker.h"
 #include "vm/globals.h"
 #include "vm/handles.h"
 #include "vm/heap.h"
@@ -525,6 +526,13 @@ class Object {
         !raw()->IsRemembered()) {
       raw()->SetRememberedBit();
       Isolate::Current()->store_buffer()->AddObject(raw());
+    } else if (FLAG_incremental_marking && value->IsOldObject() &&
+               raw()->IsOldObject() && !value->IsMarked()) {
+      // Keep the tri-color invariant of an incremental marking.
+      IncrementalMarker* marker = Isolate::Current()->incremental_marker();
+      if (marker != NULL) {
+        marker->MarkObject(value);
+      }
     }
   }
 
@@ -1518,6 +1526,9 @@ class Function : public Object {
   // Disables optimized code and switches to unoptimized code.
   void SwitchToUnoptimizedCode() const;
 
+  // Drops all code of the function, it is compiled again on the next call.
+  void ClearCode() const;
+
   // Return the most recently compiled and installed code for this function.
   // It is not the only Code object that points to this function.
   RawCode* CurrentCode() const { return raw_ptr()->code_; }
@@ -2315,6 +2326,8 @@ class LiteralToken : public Object {
 
 class TokenStream : public Object {
  public:
+  // Token objects of a stream read from a snapshot are materialized on the
+  // first call.
   RawArray* TokenObjects() const;
   void SetTokenObjects(const Array& value) const;
 
@@ -2324,6 +2337,15 @@ class TokenStream : public Object {
   RawString* GenerateSource() const;
   intptr_t ComputeSourcePosition(intptr_t tok_pos) const;
 
+  // Returns the position of a token at or before token_pos from which to
+  // walk the stream, and the number of tokens and the line before it.
+  intptr_t FindCheckpoint(intptr_t token_pos,
+                          intptr_t* token_count,
+                          intptr_t* line) const;
+  // Returns the position of a token on a line before the given line from
+  // which to walk the stream, and the line of that token.
+  intptr_t FindLineCheckpoint(intptr_t line, intptr_t* checkpoint_line) const;
+
   RawString* PrivateKey() const;
 
   static const intptr_t kBytesPerElement = 1;
@@ -2370,11 +2392,19 @@ class TokenStream : public Object {
 
    private:
     // Read token from the token stream (could be a simple token or an index
-    // into the token objects array for IDENT or literal tokens).
+    // into the token objects array for IDENT or literal tokens), see
+    // kFirstTwoByteValue.
     intptr_t ReadToken() {
-      int64_t value = stream_.ReadUnsigned();
-      ASSERT((value >= 0) && (value <= kIntptrMax));
-      return static_cast<intptr_t>(value);
+      const intptr_t value = ReadStream::Raw<1, uint8_t>::Read(&stream_);
+      if (value < kFirstTwoByteValue) {
+        return value;
+      }
+      if (value < kEscapeValue) {
+        const intptr_t low = ReadStream::Raw<1, uint8_t>::Read(&stream_);
+        return kFirstTwoByteValue +
+            (((value - kFirstTwoByteValue) << kBitsPerByte) | low);
+      }
+      return kFirstEscapedValue + stream_.ReadUnsigned();
     }
 
     TokenStream& tokens_;
@@ -2389,13 +2419,38 @@ class TokenStream : public Object {
   };
 
  private:
+  // A token is encoded as a value below Token::kNumTokens for a simple
+  // token, or Token::kNumTokens plus the index of its token object. Token
+  // objects are sorted by decreasing number of uses, so that the values of
+  // the most used ones fit in one byte. The next ones take two bytes, the
+  // first of which is at least kFirstTwoByteValue, and the remaining ones
+  // kEscapeValue followed by an unsigned value.
+  static const intptr_t kNumOneByteObjects = 96;
+  static const intptr_t kFirstTwoByteValue =
+      Token::kNumTokens + kNumOneByteObjects;
+  static const intptr_t kEscapeValue = 255;
+  static const intptr_t kFirstEscapedValue = kFirstTwoByteValue +
+      ((kEscapeValue - kFirstTwoByteValue) << kBitsPerByte);
+
+  // Number of tokens, newlines included, between two checkpoints.
+  static const intptr_t kTokensPerCheckpoint = 256;
+  // Number of Smi values of a checkpoint: its position, the number of tokens
+  // before it and its line.
+  static const intptr_t kCheckpointSize = 3;
+
   void SetPrivateKey(const String& value) const;
+  void SetSerializedTokenObjects(const ExternalTypedData& value) const;
+  void SetCheckpoints(const Array& value) const;
+
+  // The checkpoints are computed on first use.
+  RawArray* Checkpoints() const;
 
   static RawTokenStream* New();
   static void DataFinalizer(Dart_WeakPersistentHandle handle, void *peer);
 
   FINAL_HEAP_OBJECT_IMPLEMENTATION(TokenStream, Object);
   friend class Class;
+  friend class CompressedTokenStreamData;
 };
 
 
@@ -2866,19 +2921,6 @@ class LocalVarDescriptors : public Object {
 
 
 class PcDescriptors : public Object {
- private:
-  // Describes the layout of PC descriptor data.
-  enum {
-    kPcEntry = 0,      // PC value of the descriptor, unique.
-    kKindEntry = 1,
-    kDeoptIdEntry = 2,      // Deopt id.
-    kTokenPosEntry = 3,     // Token position in source.
-    kTryIndexEntry = 4,     // Try block index.
-    // We would potentially be adding other objects here like
-    // pointer maps for optimized functions, local variables information  etc.
-    kNumberOfEntries = 5,
-  };
-
  public:
   enum Kind {
     kDeopt,            // Deoptimization continuation point.
@@ -2904,12 +2946,14 @@ class PcDescriptors : public Object {
   intptr_t TokenPos(intptr_t index) const;
   intptr_t TryIndex(intptr_t index) const;
 
+  // Descriptors must be added in increasing pc order.
   void AddDescriptor(intptr_t index,
                      uword pc,
                      PcDescriptors::Kind kind,
                      intptr_t deopt_id,
                      intptr_t token_pos,  // Or deopt reason.
                      intptr_t try_index) const {  // Or deopt index.
+    ASSERT((index == 0) || (PC(index - 1) <= pc));
     SetPC(index, pc);
     SetKind(index, kind);
     SetDeoptId(index, deopt_id);
@@ -2917,7 +2961,8 @@ class PcDescriptors : public Object {
     SetTryIndex(index, try_index);
   }
 
-  static const intptr_t kBytesPerElement = (kNumberOfEntries * kWordSize);
+  static const intptr_t kBytesPerElement =
+      sizeof(RawPcDescriptors::PcDescriptorRec);
   static const intptr_t kMaxElements = kSmiMax / kBytesPerElement;
 
   static intptr_t InstanceSize() {
@@ -2932,6 +2977,9 @@ class PcDescriptors : public Object {
 
   static RawPcDescriptors* New(intptr_t num_descriptors);
 
+  // Returns the index of the first descriptor at 'pc' or -1 if not found.
+  intptr_t FindPC(uword pc) const;
+
   // Returns 0 if not found.
   uword GetPcForKind(Kind kind) const;
 
@@ -2952,13 +3000,9 @@ class PcDescriptors : public Object {
 
   void SetLength(intptr_t value) const;
 
-  intptr_t* EntryAddr(intptr_t index, intptr_t entry_offset) const {
-    ASSERT((index >=0) && (index < Length()));
-    intptr_t data_index = (index * kNumberOfEntries) + entry_offset;
-    return &raw_ptr()->data_[data_index];
-  }
-  RawSmi** SmiAddr(intptr_t index, intptr_t entry_offset) const {
-    return reinterpret_cast<RawSmi**>(EntryAddr(index, entry_offset));
+  RawPcDescriptors::PcDescriptorRec* Rec(intptr_t index) const {
+    ASSERT((index >= 0) && (index < Length()));
+    return &raw_ptr()->data_[index];
   }
 
   FINAL_HEAP_OBJECT_IMPLEMENTATION(PcDescriptors, Object);
@@ -3281,6 +3325,13 @@ class Code : public Object {
     StorePointer(&raw_ptr()->var_descriptors_, value.raw());
   }
 
+  // Locations of the external addresses embedded in the code, see
+  // Assembler::GetExternalSlots. Null if the code cannot be relocated.
+  RawArray* relocations() const {
+    return raw_ptr()->relocations_;
+  }
+  void set_relocations(const Array& value) const;
+
   RawExceptionHandlers* exception_handlers() const {
     return raw_ptr()->exception_handlers_;
   }
@@ -3357,22 +3408,6 @@ class Code : public Object {
   class OptimizedBit : public BitField<bool, kOptimizedBit, 1> {};
   class AliveBit : public BitField<bool, kAliveBit, 1> {};
 
-  // An object finder visitor interface.
-  class FindRawCodeVisitor : public FindObjectVisitor {
-   public:
-    explicit FindRawCodeVisitor(uword pc)
-        : FindObjectVisitor(Isolate::Current()), pc_(pc) { }
-    virtual ~FindRawCodeVisitor() { }
-
-    // Check if object matches find condition.
-    virtual bool FindObject(RawObject* obj);
-
-   private:
-    const uword pc_;
-
-    DISALLOW_COPY_AND_ASSIGN(FindRawCodeVisitor);
-  };
-
   static const intptr_t kEntrySize = sizeof(int32_t);  // NOLINT
 
   void set_instructions(RawInstructions* instructions) {
@@ -6054,6 +6089,24 @@ class ExternalTypedData : public Instance {
   FinalizablePersistentHandle* AddFinalizer(
       void* peer, Dart_WeakPersistentHandleFinalizer callback) const;
 
+  // The weak persistent handle whose finalizer releases the backing store,
+  // or NULL if it is not known.
+  FinalizablePersistentHandle* finalizer() const {
+    return raw_ptr()->finalizer_;
+  }
+  void set_finalizer(FinalizablePersistentHandle* handle) const {
+    raw_ptr()->finalizer_ = handle;
+  }
+
+  // Called when the weak persistent handle of raw is deleted while raw may
+  // still be alive.
+  static void ForgetFinalizer(RawObject* raw,
+                              FinalizablePersistentHandle* handle);
+
+  // Leaves this array empty after its backing store has been handed over to
+  // another owner.
+  void DetachData() const;
+
   static intptr_t length_offset() {
     return OFFSET_OF(RawExternalTypedData, length_);
   }
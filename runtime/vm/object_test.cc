@@ -2211,6 +2211,56 @@ TEST_CASE(EmbeddedScript) {
 }
 
 
+TEST_CASE(TokenStreamEncoding) {
+  // Enough distinct identifiers to use every encoding of token objects and
+  // enough tokens for several checkpoints.
+  const intptr_t kNumLines = 12000;
+  const intptr_t kLineLength = 24;
+  char* chars = reinterpret_cast<char*>(malloc(kNumLines * kLineLength));
+  intptr_t length = 0;
+  for (intptr_t i = 0; i < kNumLines; i++) {
+    length += OS::SNPrint(
+        chars + length, kLineLength, "var v%" Pd " = 0;\n", i);
+  }
+  const String& url = String::Handle(String::New("test-lib"));
+  const String& source = String::Handle(String::New(chars));
+  free(chars);
+  const Script& script = Script::Handle(
+      Script::New(url, source, RawScript::kScriptTag));
+  script.Tokenize(String::Handle(String::New("ABC")));
+  const TokenStream& tokens = TokenStream::Handle(script.tokens());
+
+  TokenStream::Iterator iterator(tokens, 0);
+  String& ident = String::Handle();
+  char name[kLineLength];
+  intptr_t last_line_pos = -1;
+  for (intptr_t i = 0; i < kNumLines; i++) {
+    EXPECT_EQ(Token::kVAR, iterator.CurrentTokenKind());
+    last_line_pos = iterator.CurrentPosition();
+    iterator.Advance();
+    EXPECT_EQ(Token::kIDENT, iterator.CurrentTokenKind());
+    ident = iterator.CurrentLiteral();
+    OS::SNPrint(name, kLineLength, "v%" Pd, i);
+    EXPECT(ident.Equals(name));
+    if ((i % 1000) == 0) {
+      intptr_t line = -1;
+      script.GetTokenLocation(iterator.CurrentPosition(), &line, NULL);
+      EXPECT_EQ(i + 1, line);
+    }
+    // Skip '=', '0' and ';'.
+    for (intptr_t j = 0; j < 4; j++) {
+      iterator.Advance();
+    }
+  }
+  EXPECT_EQ(Token::kEOS, iterator.CurrentTokenKind());
+
+  intptr_t first_idx, last_idx;
+  script.TokenRangeAtLine(kNumLines, &first_idx, &last_idx);
+  EXPECT_EQ(last_line_pos, first_idx);
+  EXPECT(last_idx > first_idx);
+}
+
+
 TEST_CASE(Context) {
   const int kNumVariables = 5;
   const Context& parent_context = Context::Handle(Context::New(0));
@@ -2556,8 +2606,8 @@ TEST_CASE(PcDescriptors) {
   descriptors.AddDescriptor(0, 10, PcDescriptors::kOther, 1, 20, 1);
   descriptors.AddDescriptor(1, 20, PcDescriptors::kDeopt, 2, 30, 0);
   descriptors.AddDescriptor(2, 30, PcDescriptors::kOther, 3, 40, 1);
-  descriptors.AddDescriptor(3, 10, PcDescriptors::kOther, 4, 40, 2);
-  descriptors.AddDescriptor(4, 10, PcDescriptors::kOther, 5, 80, 3);
+  descriptors.AddDescriptor(3, 30, PcDescriptors::kOther, 4, 40, 2);
+  descriptors.AddDescriptor(4, 50, PcDescriptors::kOther, 5, 80, 3);
   descriptors.AddDescriptor(5, 80, PcDescriptors::kOther, 6, 150, 3);
 
   extern void GenerateIncrement(Assembler* assembler);
@@ -2579,6 +2629,14 @@ TEST_CASE(PcDescriptors) {
   EXPECT_EQ(150, pc_descs.TokenPos(5));
   EXPECT_EQ(PcDescriptors::kOther, pc_descs.DescriptorKind(0));
   EXPECT_EQ(PcDescriptors::kDeopt, pc_descs.DescriptorKind(1));
+
+  // Lookup by pc finds the first descriptor at that pc.
+  EXPECT_EQ(0, pc_descs.FindPC(10));
+  EXPECT_EQ(2, pc_descs.FindPC(30));
+  EXPECT_EQ(5, pc_descs.FindPC(80));
+  EXPECT_EQ(-1, pc_descs.FindPC(5));
+  EXPECT_EQ(-1, pc_descs.FindPC(40));
+  EXPECT_EQ(-1, pc_descs.FindPC(90));
 }
 
 
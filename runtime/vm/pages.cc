@@ -4,11 +4,19 @@
 
 #include "vm/pages.h"
 
+#include <stdlib.h>
+
 #include "platform/assert.h"
+#include "vm/atomic.h"
 #include "vm/compiler_stats.h"
+#include "vm/dart.h"
+#include "vm/gc_compactor.h"
 #include "vm/gc_marker.h"
 #include "vm/gc_sweeper.h"
+#include "vm/json_stream.h"
 #include "vm/object.h"
+#include "vm/thread.h"
+#include "vm/thread_pool.h"
 #include "vm/virtual_memory.h"
 
 namespace dart {
@@ -31,6 +39,31 @@ DEFINE_FLAG(bool, log_code_drop, false,
             "Emit a log message when pointers to unused code are dropped.");
 DEFINE_FLAG(bool, always_drop_code, false,
             "Always try to drop code if the function's usage counter is >= 0");
+DEFINE_FLAG(bool, concurrent_sweep, false,
+            "Sweep old generation pages in a background task after marking.");
+DEFINE_FLAG(bool, incremental_marking, false,
+            "Mark old generation objects in slices interleaved with the "
+            "mutator, bounding the pause of a mark-sweep.");
+DEFINE_FLAG(int, incremental_marking_rate, 8,
+            "Bytes of objects scanned by incremental marking for every byte "
+            "old space grows by.");
+DEFINE_FLAG(bool, compact_old_space, false,
+            "Evacuate sparsely used old generation data pages when a "
+            "mark-sweep finds old space fragmented.");
+DEFINE_FLAG(int, compaction_free_ratio, 25,
+            "The percentage of free memory in old generation data pages "
+            "above which a mark-sweep compacts them.");
+
+// Only the ia32 and x64 write barriers gray the old objects stored while
+// marking.
+static bool CanMarkIncrementally() {
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+  return FLAG_incremental_marking;
+#else
+  return false;
+#endif
+}
+
 
 HeapPage* HeapPage::Initialize(VirtualMemory* memory, PageType type) {
   ASSERT(memory->size() > VirtualMemory::PageSize());
@@ -125,15 +158,31 @@ PageSpace::PageSpace(Heap* heap, intptr_t max_capacity_in_words)
       capacity_in_words_(0),
       used_in_words_(0),
       sweeping_(false),
+      concurrent_sweep_pending_(false),
+      unswept_pages_(NULL),
+      num_unswept_pages_(0),
+      next_unswept_page_(0),
+      sweeping_large_pages_(NULL),
+      pages_lock_(new Mutex()),
+      swept_freelist_(),
+      tasks_lock_(new Monitor()),
+      tasks_(0),
       page_space_controller_(FLAG_heap_growth_space_ratio,
                              FLAG_heap_growth_rate,
-                             FLAG_heap_growth_time_ratio) {
+                             FLAG_heap_growth_time_ratio),
+      incremental_marker_(NULL),
+      marking_start_in_words_(0),
+      marking_step_in_words_(0) {
 }
 
 
 PageSpace::~PageSpace() {
+  delete incremental_marker_;
+  CompleteSweep();
   FreePages(pages_);
   FreePages(large_pages_);
+  delete pages_lock_;
+  delete tasks_lock_;
 }
 
 
@@ -146,6 +195,8 @@ intptr_t PageSpace::LargePageSizeInWordsFor(intptr_t size) {
 
 HeapPage* PageSpace::AllocatePage(HeapPage::PageType type) {
   HeapPage* page = HeapPage::Allocate(kPageSizeInWords, type);
+  page->set_object_end(page->memory_->end());
+  pages_lock_->Lock();
   if (pages_ == NULL) {
     pages_ = page;
   } else {
@@ -153,7 +204,7 @@ HeapPage* PageSpace::AllocatePage(HeapPage::PageType type) {
   }
   pages_tail_ = page;
   capacity_in_words_ += kPageSizeInWords;
-  page->set_object_end(page->memory_->end());
+  pages_lock_->Unlock();
   return page;
 }
 
@@ -161,18 +212,18 @@ HeapPage* PageSpace::AllocatePage(HeapPage::PageType type) {
 HeapPage* PageSpace::AllocateLargePage(intptr_t size, HeapPage::PageType type) {
   intptr_t page_size_in_words = LargePageSizeInWordsFor(size);
   HeapPage* page = HeapPage::Allocate(page_size_in_words, type);
+  // Only one object in this page.
+  page->set_object_end(page->object_start() + size);
+  pages_lock_->Lock();
   page->set_next(large_pages_);
   large_pages_ = page;
   capacity_in_words_ += page_size_in_words;
-  // Only one object in this page.
-  page->set_object_end(page->object_start() + size);
+  pages_lock_->Unlock();
   return page;
 }
 
 
-void PageSpace::FreePage(HeapPage* page, HeapPage* previous_page) {
-  capacity_in_words_ -= (page->memory_->size() >> kWordSizeLog2);
-  // Remove the page from the list.
+void PageSpace::UnlinkPage(HeapPage* page, HeapPage* previous_page) {
   if (previous_page != NULL) {
     previous_page->set_next(page->next());
   } else {
@@ -181,6 +232,13 @@ void PageSpace::FreePage(HeapPage* page, HeapPage* previous_page) {
   if (page == pages_tail_) {
     pages_tail_ = previous_page;
   }
+}
+
+
+void PageSpace::FreePage(HeapPage* page, HeapPage* previous_page) {
+  capacity_in_words_ -= (page->memory_->size() >> kWordSizeLog2);
+  // Remove the page from the list.
+  UnlinkPage(page, previous_page);
   // TODO(iposva): Consider adding to a pool of empty pages.
   page->Deallocate();
 }
@@ -208,6 +266,21 @@ void PageSpace::FreePages(HeapPage* pages) {
 }
 
 
+uword PageSpace::AllocateFromNewPage(intptr_t size, HeapPage::PageType type) {
+  HeapPage* page = AllocatePage(type);
+  ASSERT(page != NULL);
+  // Start of the newly allocated page is the allocated object.
+  uword result = page->object_start();
+  // Enqueue the remainder in the free list.
+  uword free_start = result + size;
+  intptr_t free_size = page->object_end() - free_start;
+  if (free_size > 0) {
+    freelist_[type].Free(free_start, free_size);
+  }
+  return result;
+}
+
+
 uword PageSpace::TryAllocate(intptr_t size,
                              HeapPage::PageType type,
                              GrowthPolicy growth_policy) {
@@ -216,20 +289,14 @@ uword PageSpace::TryAllocate(intptr_t size,
   uword result = 0;
   if (size < kAllocatablePageSize) {
     result = freelist_[type].TryAllocate(size);
+    if ((result == 0) && concurrent_sweep_pending_) {
+      result = TryAllocateDuringSweep(size, type);
+    }
     if ((result == 0) &&
         (page_space_controller_.CanGrowPageSpace(size) ||
          growth_policy == kForceGrowth) &&
         CanIncreaseCapacityInWords(kPageSizeInWords)) {
-      HeapPage* page = AllocatePage(type);
-      ASSERT(page != NULL);
-      // Start of the newly allocated page is the allocated object.
-      result = page->object_start();
-      // Enqueue the remainder in the free list.
-      uword free_start = result + size;
-      intptr_t free_size = page->object_end() - free_start;
-      if (free_size > 0) {
-        freelist_[type].Free(free_start, free_size);
-      }
+      result = AllocateFromNewPage(size, type);
     }
   } else {
     // Large page allocation.
@@ -258,47 +325,73 @@ uword PageSpace::TryAllocate(intptr_t size,
 }
 
 
-bool PageSpace::Contains(uword addr) const {
-  HeapPage* page = pages_;
-  while (page != NULL) {
-    if (page->Contains(addr)) {
-      return true;
-    }
-    page = page->next();
+void PageSpace::FreeUnused(uword addr, intptr_t size) {
+  if (size >= kAllocatablePageSize) {
+    // The object has a large page of its own, the next MarkSweep releases it.
+    FreeListElement::AsElement(addr, size);
+    return;
   }
+  pages_lock_->Lock();
+  freelist_[HeapPage::kData].Free(addr, size);
+  used_in_words_ -= (size >> kWordSizeLog2);
+  pages_lock_->Unlock();
+}
 
-  page = large_pages_;
-  while (page != NULL) {
-    if (page->Contains(addr)) {
-      return true;
-    }
-    page = page->next();
-  }
-  return false;
+
+intptr_t PageSpace::CapacityInWords() const {
+  // The sweeper task releases empty pages while the isolate runs.
+  pages_lock_->Lock();
+  intptr_t result = capacity_in_words_;
+  pages_lock_->Unlock();
+  return result;
 }
 
 
-bool PageSpace::Contains(uword addr, HeapPage::PageType type) const {
-  HeapPage* page = pages_;
-  while (page != NULL) {
-    if ((page->type() == type) && page->Contains(addr)) {
-      return true;
+bool PageSpace::CanIncreaseCapacityInWords(intptr_t increase_in_words) const {
+  intptr_t capacity_in_words = CapacityInWords();
+  ASSERT(capacity_in_words <= max_capacity_in_words_);
+  return increase_in_words <= (max_capacity_in_words_ - capacity_in_words);
+}
+
+
+bool PageSpace::Contains(uword addr) const {
+  bool result = false;
+  pages_lock_->Lock();
+  HeapPage* lists[] = { pages_, large_pages_, sweeping_large_pages_ };
+  const intptr_t num_lists = ARRAY_SIZE(lists);
+  for (intptr_t i = 0; !result && (i < num_lists); i++) {
+    for (HeapPage* page = lists[i]; page != NULL; page = page->next()) {
+      if (page->Contains(addr)) {
+        result = true;
+        break;
+      }
     }
-    page = page->next();
   }
+  pages_lock_->Unlock();
+  return result;
+}
 
-  page = large_pages_;
-  while (page != NULL) {
-    if ((page->type() == type) && page->Contains(addr)) {
-      return true;
+
+bool PageSpace::Contains(uword addr, HeapPage::PageType type) const {
+  bool result = false;
+  pages_lock_->Lock();
+  HeapPage* lists[] = { pages_, large_pages_, sweeping_large_pages_ };
+  const intptr_t num_lists = ARRAY_SIZE(lists);
+  for (intptr_t i = 0; !result && (i < num_lists); i++) {
+    for (HeapPage* page = lists[i]; page != NULL; page = page->next()) {
+      if ((page->type() == type) && page->Contains(addr)) {
+        result = true;
+        break;
+      }
     }
-    page = page->next();
   }
-  return false;
+  pages_lock_->Unlock();
+  return result;
 }
 
 
-void PageSpace::StartEndAddress(uword* start, uword* end) const {
+void PageSpace::StartEndAddress(uword* start, uword* end) {
+  CompleteSweep();
   ASSERT(pages_ != NULL || large_pages_ != NULL);
   *start = static_cast<uword>(~0);
   *end = 0;
@@ -315,7 +408,8 @@ void PageSpace::StartEndAddress(uword* start, uword* end) const {
 }
 
 
-void PageSpace::VisitObjects(ObjectVisitor* visitor) const {
+void PageSpace::VisitObjects(ObjectVisitor* visitor) {
+  CompleteSweep();
   HeapPage* page = pages_;
   while (page != NULL) {
     page->VisitObjects(visitor);
@@ -330,7 +424,8 @@ void PageSpace::VisitObjects(ObjectVisitor* visitor) const {
 }
 
 
-void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
+void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) {
+  CompleteSweep();
   HeapPage* page = pages_;
   while (page != NULL) {
     page->VisitObjectPointers(visitor);
@@ -346,8 +441,9 @@ void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
 
 
 RawObject* PageSpace::FindObject(FindObjectVisitor* visitor,
-                                 HeapPage::PageType type) const {
+                                 HeapPage::PageType type) {
   ASSERT(Isolate::Current()->no_gc_scope_depth() != 0);
+  CompleteSweep();
   HeapPage* page = pages_;
   while (page != NULL) {
     if (page->type() == type) {
@@ -374,6 +470,7 @@ RawObject* PageSpace::FindObject(FindObjectVisitor* visitor,
 
 
 void PageSpace::WriteProtect(bool read_only) {
+  CompleteSweep();
   HeapPage* page = pages_;
   while (page != NULL) {
     page->WriteProtect(read_only);
@@ -387,6 +484,22 @@ void PageSpace::WriteProtect(bool read_only) {
 }
 
 
+void PageSpace::PrintToJSONObject(JSONObject* jsobj) {
+  // Report the free lists as they are once sweeping is done.
+  CompleteSweep();
+  jsobj->AddProperty("used", UsedInWords() * kWordSize);
+  jsobj->AddProperty("capacity", CapacityInWords() * kWordSize);
+  JSONArray freelists(jsobj, "freeLists");
+  for (intptr_t i = 0; i < HeapPage::kNumPageTypes; i++) {
+    JSONObject jsfreelist(&freelists);
+    jsfreelist.AddProperty("type", "FreeList");
+    jsfreelist.AddProperty("pageType",
+                           (i == HeapPage::kData) ? "data" : "executable");
+    freelist_[i].PrintToJSONObject(&jsfreelist);
+  }
+}
+
+
 bool PageSpace::ShouldCollectCode() {
   // Try to collect code if enough time has passed since the last attempt.
   const int64_t start = OS::GetCurrentTimeMicros();
@@ -408,8 +521,11 @@ bool PageSpace::ShouldCollectCode() {
 void PageSpace::MarkSweep(bool invoke_api_callbacks) {
   // MarkSweep is not reentrant. Make sure that is the case.
   ASSERT(!sweeping_);
+  // Marking requires the mark bits of the previous collection to be cleared.
+  CompleteSweep();
   sweeping_ = true;
   Isolate* isolate = Isolate::Current();
+  isolate->class_table()->FreeOldTables();
 
   NoHandleScope no_handles(isolate);
 
@@ -429,9 +545,18 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
   const int64_t start = OS::GetCurrentTimeMicros();
 
   // Mark all reachable old-gen objects.
-  bool collect_code = FLAG_collect_code && ShouldCollectCode();
   GCMarker marker(heap_);
-  marker.MarkObjects(isolate, this, invoke_api_callbacks, collect_code);
+  if (incremental_marker_ != NULL) {
+    marker.FinishIncrementalMarking(
+        isolate, this, incremental_marker_, invoke_api_callbacks);
+    delete incremental_marker_;
+    incremental_marker_ = NULL;
+  } else {
+    bool collect_code = FLAG_collect_code && ShouldCollectCode();
+    marker.MarkObjects(isolate, this, invoke_api_callbacks, collect_code);
+  }
+  // Forget dead code before the sweeper frees it.
+  code_index_.RemoveUnmarked();
 
   int64_t mid1 = OS::GetCurrentTimeMicros();
 
@@ -442,39 +567,61 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
 
   int64_t mid2 = OS::GetCurrentTimeMicros();
 
-  GCSweeper sweeper(heap_);
   intptr_t used_in_words = 0;
+  int64_t mid3 = mid2;
 
-  HeapPage* prev_page = NULL;
-  HeapPage* page = pages_;
-  while (page != NULL) {
-    HeapPage* next_page = page->next();
-    intptr_t page_in_use = sweeper.SweepPage(page, &freelist_[page->type()]);
-    if (page_in_use == 0) {
-      FreePage(page, prev_page);
-    } else {
-      used_in_words += (page_in_use >> kWordSizeLog2);
-      prev_page = page;
+  if (FLAG_concurrent_sweep) {
+    // The marked objects are exactly the ones a sweep would find in use.
+    used_in_words = marker.marked_words();
+    StartConcurrentSweep();
+    mid3 = OS::GetCurrentTimeMicros();
+  } else {
+    GCSweeper sweeper(heap_);
+
+    HeapPage* evacuated_pages = NULL;
+    if (FLAG_compact_old_space) {
+      evacuated_pages = SelectPagesToEvacuate();
     }
-    // Advance to the next page.
-    page = next_page;
-  }
 
-  int64_t mid3 = OS::GetCurrentTimeMicros();
+    HeapPage* prev_page = NULL;
+    HeapPage* page = pages_;
+    while (page != NULL) {
+      HeapPage* next_page = page->next();
+      intptr_t page_in_use =
+          sweeper.SweepPage(page, &freelist_[page->type()], false);
+      if (page_in_use == 0) {
+        FreePage(page, prev_page);
+      } else {
+        used_in_words += (page_in_use >> kWordSizeLog2);
+        prev_page = page;
+      }
+      // Advance to the next page.
+      page = next_page;
+    }
 
-  prev_page = NULL;
-  page = large_pages_;
-  while (page != NULL) {
-    intptr_t page_in_use = sweeper.SweepLargePage(page);
-    HeapPage* next_page = page->next();
-    if (page_in_use == 0) {
-      FreeLargePage(page, prev_page);
-    } else {
-      used_in_words += (page_in_use >> kWordSizeLog2);
-      prev_page = page;
+    mid3 = OS::GetCurrentTimeMicros();
+
+    prev_page = NULL;
+    page = large_pages_;
+    while (page != NULL) {
+      intptr_t page_in_use = sweeper.SweepLargePage(page, false);
+      HeapPage* next_page = page->next();
+      if (page_in_use == 0) {
+        FreeLargePage(page, prev_page);
+      } else {
+        used_in_words += (page_in_use >> kWordSizeLog2);
+        prev_page = page;
+      }
+      // Advance to the next page.
+      page = next_page;
+    }
+
+    if (evacuated_pages != NULL) {
+      const int64_t evacuation_start = OS::GetCurrentTimeMicros();
+      used_in_words += EvacuatePages(evacuated_pages);
+      // Account the evacuation to the sweeping of the regular pages.
+      mid3 += OS::GetCurrentTimeMicros() - evacuation_start;
     }
-    // Advance to the next page.
-    page = next_page;
   }
 
   // Record data and print if requested.
@@ -487,6 +634,18 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
   page_space_controller_.EvaluateGarbageCollection(used_before_in_words,
                                                    used_in_words,
                                                    start, end);
+  if (CanMarkIncrementally()) {
+    intptr_t limit_in_words = max_capacity_in_words_;
+    if (page_space_controller_.is_enabled()) {
+      limit_in_words = Utils::Minimum(
+          limit_in_words,
+          CapacityInWords() +
+              page_space_controller_.grow_heap() * kPageSizeInWords);
+    }
+    marking_start_in_words_ =
+        used_in_words + Utils::Maximum(limit_in_words - used_in_words,
+                                       static_cast<intptr_t>(0)) / 2;
+  }
 
   heap_->RecordTime(kMarkObjects, mid1 - start);
   heap_->RecordTime(kResetFreeLists, mid2 - mid1);
@@ -494,6 +653,7 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
   heap_->RecordTime(kSweepLargePages, end - mid3);
 
   if (FLAG_print_free_list_after_gc) {
+    CompleteSweep();
     OS::Print("Data Freelist (after GC):\n");
     freelist_[HeapPage::kData].Print();
     OS::Print("Executable Freelist (after GC):\n");
@@ -512,6 +672,374 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
 }
 
 
+// Usage of a data page, as found by the marker.
+struct PageUsage {
+  HeapPage* page;
+  intptr_t capacity_in_words;
+  intptr_t used_in_words;
+};
+
+
+static int CompareUsedWords(const void* a, const void* b) {
+  const intptr_t a_used = reinterpret_cast<const PageUsage*>(a)->used_in_words;
+  const intptr_t b_used = reinterpret_cast<const PageUsage*>(b)->used_in_words;
+  if (a_used < b_used) {
+    return -1;
+  }
+  return (a_used > b_used) ? 1 : 0;
+}
+
+
+static intptr_t MarkedWordsIn(HeapPage* page) {
+  intptr_t marked = 0;
+  uword current = page->object_start();
+  uword end = page->object_end();
+  while (current < end) {
+    RawObject* raw_obj = RawObject::FromAddr(current);
+    intptr_t size = raw_obj->Size();
+    if (raw_obj->IsMarked()) {
+      marked += size;
+    }
+    current += size;
+  }
+  ASSERT(current == end);
+  return marked >> kWordSizeLog2;
+}
+
+
+HeapPage* PageSpace::SelectPagesToEvacuate() {
+  intptr_t num_pages = 0;
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    if (page->type() == HeapPage::kData) {
+      num_pages++;
+    }
+  }
+  if (num_pages < 2) {
+    return NULL;
+  }
+  PageUsage* usage = new PageUsage[num_pages];
+  intptr_t capacity_in_words = 0;
+  intptr_t free_in_words = 0;
+  intptr_t i = 0;
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    if (page->type() == HeapPage::kData) {
+      usage[i].page = page;
+      usage[i].capacity_in_words =
+          (page->object_end() - page->object_start()) >> kWordSizeLog2;
+      usage[i].used_in_words = MarkedWordsIn(page);
+      capacity_in_words += usage[i].capacity_in_words;
+      free_in_words += usage[i].capacity_in_words - usage[i].used_in_words;
+      i++;
+    }
+  }
+
+  HeapPage* evacuated_pages = NULL;
+  if ((free_in_words * 100) >=
+      (capacity_in_words * FLAG_compaction_free_ratio)) {
+    // Evacuate the emptiest pages first.
+    qsort(usage, num_pages, sizeof(usage[0]), CompareUsedWords);
+    intptr_t moved_in_words = 0;
+    for (i = 0; i < num_pages; i++) {
+      HeapPage* page = usage[i].page;
+      const intptr_t page_capacity_in_words = usage[i].capacity_in_words;
+      const intptr_t page_used_in_words = usage[i].used_in_words;
+      if ((page_used_in_words * 100) >=
+          (page_capacity_in_words * kEvacuationOccupancy)) {
+        break;
+      }
+      // The pages left must have room for all evacuated objects.
+      free_in_words -= page_capacity_in_words - page_used_in_words;
+      if ((moved_in_words + page_used_in_words) > free_in_words) {
+        break;
+      }
+      moved_in_words += page_used_in_words;
+      HeapPage* previous_page = NULL;
+      HeapPage* current = pages_;
+      while (current != page) {
+        previous_page = current;
+        current = current->next();
+      }
+      UnlinkPage(page, previous_page);
+      page->set_next(evacuated_pages);
+      evacuated_pages = page;
+    }
+  }
+  delete[] usage;
+  return evacuated_pages;
+}
+
+
+uword PageSpace::AllocateForEvacuation(intptr_t size) {
+  ASSERT(size < kAllocatablePageSize);
+  uword result = freelist_[HeapPage::kData].TryAllocate(size);
+  if ((result == 0) && CanIncreaseCapacityInWords(kPageSizeInWords)) {
+    // The free blocks of the remaining pages may be too small. Growing past
+    // the growth policy of the page space is temporary, the evacuated pages
+    // are released right after.
+    result = AllocateFromNewPage(size, HeapPage::kData);
+    ASSERT(result != 0);
+  }
+  return result;
+}
+
+
+void PageSpace::UndoAllocateForEvacuation(uword addr, intptr_t size) {
+  ASSERT(size < kAllocatablePageSize);
+  freelist_[HeapPage::kData].Free(addr, size);
+}
+
+
+intptr_t PageSpace::EvacuatePages(HeapPage* pages) {
+  GCCompactor compactor(heap_, this);
+  intptr_t used_in_words = compactor.Compact(pages) >> kWordSizeLog2;
+  GCSweeper sweeper(heap_);
+  HeapPage* page = pages;
+  while (page != NULL) {
+    HeapPage* next_page = page->next();
+    if (compactor.IsEvacuated(page->object_start())) {
+      // No references into the evacuated page are left.
+      capacity_in_words_ -= (page->memory_->size() >> kWordSizeLog2);
+      page->Deallocate();
+    } else {
+      // Old space ran out before the objects of this page could be moved.
+      intptr_t page_in_use =
+          sweeper.SweepPage(page, &freelist_[HeapPage::kData], false);
+      ASSERT(page_in_use > 0);
+      used_in_words += (page_in_use >> kWordSizeLog2);
+      page->set_next(NULL);
+      pages_lock_->Lock();
+      if (pages_ == NULL) {
+        pages_ = page;
+      } else {
+        pages_tail_->set_next(page);
+      }
+      pages_tail_ = page;
+      pages_lock_->Unlock();
+    }
+    page = next_page;
+  }
+  return used_in_words;
+}
+
+
+class SweeperTask : public ThreadPool::Task {
+ public:
+  SweeperTask(Isolate* isolate, PageSpace* old_space)
+      : isolate_(isolate), old_space_(old_space) {
+  }
+
+  virtual void Run() {
+    // Object sizes are looked up in the class table of the isolate.
+    Isolate::SetCurrentHelper(isolate_);
+    GCSweeper sweeper(old_space_->heap_);
+    old_space_->SweepLargePagesConcurrently(&sweeper);
+    FreeList freelist[HeapPage::kNumPageTypes];
+    HeapPage* page;
+    while ((page = old_space_->ClaimUnsweptPage()) != NULL) {
+      HeapPage::PageType type = page->type();
+      old_space_->SweepClaimedPage(&sweeper, page, &freelist[type]);
+      // Hand out the free memory page by page, allocation picks it up the
+      // next time its own free list runs dry.
+      old_space_->pages_lock_->Lock();
+      old_space_->swept_freelist_[type].Merge(&freelist[type]);
+      old_space_->pages_lock_->Unlock();
+    }
+    Isolate::SetCurrentHelper(NULL);
+    // The page space may be deleted as soon as the last task reports back.
+    old_space_->SweeperTaskFinished();
+  }
+
+ private:
+  Isolate* isolate_;
+  PageSpace* old_space_;
+
+  DISALLOW_COPY_AND_ASSIGN(SweeperTask);
+};
+
+
+void PageSpace::StartConcurrentSweep() {
+  ASSERT(!concurrent_sweep_pending_);
+  ASSERT(unswept_pages_ == NULL);
+  ASSERT(sweeping_large_pages_ == NULL);
+  intptr_t num_pages = 0;
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    num_pages++;
+  }
+  unswept_pages_ = new HeapPage*[num_pages];
+  intptr_t i = 0;
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    unswept_pages_[i++] = page;
+  }
+  num_unswept_pages_ = num_pages;
+  next_unswept_page_ = 0;
+  sweeping_large_pages_ = large_pages_;
+  large_pages_ = NULL;
+  concurrent_sweep_pending_ = true;
+#if !defined(TARGET_ARCH_MIPS)
+  // The MIPS write barrier stub does not set the remembered bit atomically
+  // yet, so pages are only swept lazily by allocation there.
+  tasks_lock_->Enter();
+  tasks_++;
+  tasks_lock_->Exit();
+  Dart::thread_pool()->Run(new SweeperTask(Isolate::Current(), this));
+#endif
+}
+
+
+HeapPage* PageSpace::ClaimUnsweptPage() {
+  if (next_unswept_page_ >= num_unswept_pages_) {
+    return NULL;
+  }
+  uintptr_t index = AtomicOperations::FetchAndIncrement(&next_unswept_page_);
+  if (index >= num_unswept_pages_) {
+    return NULL;
+  }
+  return unswept_pages_[index];
+}
+
+
+void PageSpace::SweepClaimedPage(GCSweeper* sweeper,
+                                 HeapPage* page,
+                                 FreeList* freelist) {
+  intptr_t page_in_use = sweeper->SweepPage(page, freelist, true);
+  if (page_in_use == 0) {
+    pages_lock_->Lock();
+    HeapPage* previous_page = NULL;
+    HeapPage* current = pages_;
+    while (current != page) {
+      previous_page = current;
+      current = current->next();
+    }
+    FreePage(page, previous_page);
+    pages_lock_->Unlock();
+  }
+}
+
+
+void PageSpace::SweepLargePagesConcurrently(GCSweeper* sweeper) {
+  pages_lock_->Lock();
+  HeapPage* page = sweeping_large_pages_;
+  sweeping_large_pages_ = NULL;
+  while (page != NULL) {
+    HeapPage* next_page = page->next();
+    if (sweeper->SweepLargePage(page, true) == 0) {
+      capacity_in_words_ -= (page->memory_->size() >> kWordSizeLog2);
+      page->Deallocate();
+    } else {
+      page->set_next(large_pages_);
+      large_pages_ = page;
+    }
+    page = next_page;
+  }
+  pages_lock_->Unlock();
+}
+
+
+void PageSpace::MergeSweptFreeLists() {
+  pages_lock_->Lock();
+  freelist_[HeapPage::kData].Merge(&swept_freelist_[HeapPage::kData]);
+  freelist_[HeapPage::kExecutable].Merge(
+      &swept_freelist_[HeapPage::kExecutable]);
+  pages_lock_->Unlock();
+}
+
+
+uword PageSpace::TryAllocateDuringSweep(intptr_t size,
+                                        HeapPage::PageType type) {
+  ASSERT(concurrent_sweep_pending_);
+  MergeSweptFreeLists();
+  uword result = freelist_[type].TryAllocate(size);
+  // Rather than growing the heap, sweep pages until the allocation fits.
+  GCSweeper sweeper(heap_);
+  HeapPage* page;
+  while ((result == 0) && ((page = ClaimUnsweptPage()) != NULL)) {
+    SweepClaimedPage(&sweeper, page, &freelist_[page->type()]);
+    result = freelist_[type].TryAllocate(size);
+  }
+  return result;
+}
+
+
+void PageSpace::SweeperTaskFinished() {
+  tasks_lock_->Enter();
+  ASSERT(tasks_ > 0);
+  tasks_--;
+  tasks_lock_->NotifyAll();
+  tasks_lock_->Exit();
+}
+
+
+void PageSpace::CompleteSweep() {
+  if (!concurrent_sweep_pending_) {
+    return;
+  }
+  GCSweeper sweeper(heap_);
+  HeapPage* page;
+  while ((page = ClaimUnsweptPage()) != NULL) {
+    SweepClaimedPage(&sweeper, page, &freelist_[page->type()]);
+  }
+  tasks_lock_->Enter();
+  while (tasks_ > 0) {
+    tasks_lock_->Wait(Monitor::kNoTimeout);
+  }
+  tasks_lock_->Exit();
+  // Without a sweeper task the large pages are still left to sweep.
+  SweepLargePagesConcurrently(&sweeper);
+  MergeSweptFreeLists();
+  delete[] unswept_pages_;
+  unswept_pages_ = NULL;
+  num_unswept_pages_ = 0;
+  next_unswept_page_ = 0;
+  concurrent_sweep_pending_ = false;
+  Isolate* isolate = Isolate::Current();
+  if (isolate != NULL) {
+    isolate->class_table()->FreeOldTables();
+  }
+}
+
+
+bool PageSpace::AdvanceIncrementalMarking() {
+  if (!CanMarkIncrementally() || sweeping_) {
+    return false;
+  }
+  if (incremental_marker_ == NULL) {
+    if ((marking_start_in_words_ > 0) &&
+        (used_in_words_ >= marking_start_in_words_)) {
+      StartIncrementalMarking();
+    }
+    return false;
+  }
+  const intptr_t growth_in_words = used_in_words_ - marking_step_in_words_;
+  if (growth_in_words < kMarkingStepInWords) {
+    return false;
+  }
+  marking_step_in_words_ = used_in_words_;
+  return MarkIncrementally(
+      (growth_in_words << kWordSizeLog2) * FLAG_incremental_marking_rate);
+}
+
+
+bool PageSpace::MarkIncrementally(intptr_t budget_in_bytes) {
+  if (incremental_marker_ == NULL) {
+    return false;
+  }
+  return !incremental_marker_->Step(budget_in_bytes);
+}
+
+
+void PageSpace::StartIncrementalMarking() {
+  if (!CanMarkIncrementally() || sweeping_ || (incremental_marker_ != NULL)) {
+    return;
+  }
+  // Marking requires the mark bits of the previous collection to be cleared.
+  CompleteSweep();
+  Isolate* isolate = Isolate::Current();
+  NoHandleScope no_handles(isolate);
+  incremental_marker_ = new IncrementalMarker(heap_, isolate, this);
+  marking_step_in_words_ = used_in_words_;
+}
+
+
 PageSpaceController::PageSpaceController(int heap_growth_ratio,
                                          int heap_growth_rate,
                                          int garbage_collection_time_ratio)
@@ -5,6 +5,7 @@
 #ifndef VM_PAGES_H_
 #define VM_PAGES_H_
 
+#include "vm/code_index.h"
 #include "vm/freelist.h"
 #include "vm/globals.h"
 #include "vm/virtual_memory.h"
@@ -14,9 +15,18 @@ namespace dart {
 DECLARE_FLAG(bool, collect_code);
 DECLARE_FLAG(bool, log_code_drop);
 DECLARE_FLAG(bool, always_drop_code);
+DECLARE_FLAG(bool, concurrent_sweep);
+DECLARE_FLAG(bool, incremental_marking);
+DECLARE_FLAG(bool, compact_old_space);
 
 // Forward declarations.
+class GCCompactor;
+class GCSweeper;
 class Heap;
+class IncrementalMarker;
+class JSONObject;
+class Monitor;
+class Mutex;
 class ObjectPointerVisitor;
 
 // A page containing old generation objects.
@@ -130,6 +140,10 @@ class PageSpaceController {
     last_code_collection_in_us_ = t;
   }
 
+  // Number of pages the page space may still grow by before the next
+  // collection.
+  intptr_t grow_heap() const { return grow_heap_; }
+
   void set_is_enabled(bool state) {
     is_enabled_ = state;
   }
@@ -185,8 +199,11 @@ class PageSpace {
                     HeapPage::PageType type = HeapPage::kData,
                     GrowthPolicy growth_policy = kControlGrowth);
 
+  // Gives back data memory returned by TryAllocate that was never used.
+  void FreeUnused(uword addr, intptr_t size);
+
   intptr_t UsedInWords() const { return used_in_words_; }
-  intptr_t CapacityInWords() const { return capacity_in_words_; }
+  intptr_t CapacityInWords() const;
 
   bool Contains(uword addr) const;
   bool Contains(uword addr, HeapPage::PageType type) const;
@@ -194,11 +211,15 @@ class PageSpace {
     return Contains(addr);
   }
 
-  void VisitObjects(ObjectVisitor* visitor) const;
-  void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
+  // The page walks below wait for a concurrent sweep to finish first.
+  void VisitObjects(ObjectVisitor* visitor);
+  void VisitObjectPointers(ObjectPointerVisitor* visitor);
 
   RawObject* FindObject(FindObjectVisitor* visitor,
-                        HeapPage::PageType type) const;
+                        HeapPage::PageType type);
+
+  // Index of the Instructions objects in the executable pages.
+  CodeIndex* code_index() { return &code_index_; }
 
   // Checks if enough time has elapsed since the last attempt to collect
   // code.
@@ -207,7 +228,28 @@ class PageSpace {
   // Collect the garbage in the page space using mark-sweep.
   void MarkSweep(bool invoke_api_callbacks);
 
-  void StartEndAddress(uword* start, uword* end) const;
+  // With --concurrent_sweep, MarkSweep returns with the regular pages still
+  // unswept. They are swept by a task on the VM thread pool and, on demand,
+  // by allocation. CompleteSweep sweeps the remaining pages and waits for the
+  // task, after which the pages are consistent and no longer shared.
+  void CompleteSweep();
+
+  // With --incremental_marking, marking starts once old space has used half
+  // of the room it had left to grow by after the last MarkSweep, and then
+  // advances in proportion to the growth of old space. Called outside of GC
+  // by the heap as old space grows. Returns true once no gray objects are
+  // left, at which point MarkSweep finishes the collection in a short pause.
+  bool AdvanceIncrementalMarking();
+
+  // Starts an incremental marking right away, e.g. while the isolate is
+  // idle. Does nothing without --incremental_marking or while marking.
+  void StartIncrementalMarking();
+
+  // Scans about 'budget_in_bytes' of gray objects. Returns true once the
+  // incremental marking is complete, false if none is in progress.
+  bool MarkIncrementally(intptr_t budget_in_bytes);
+
+  void StartEndAddress(uword* start, uword* end);
 
   void SetGrowthControlState(bool state) {
     page_space_controller_.set_is_enabled(state);
@@ -219,6 +261,8 @@ class PageSpace {
 
   void WriteProtect(bool read_only);
 
+  void PrintToJSONObject(JSONObject* jsobj);
+
  private:
   // Ids for time and data records in Heap::GCStats.
   enum {
@@ -236,18 +280,44 @@ class PageSpace {
 
   static const intptr_t kAllocatablePageSize = 64 * KB;
 
+  // Old-space growth between two incremental marking steps.
+  static const intptr_t kMarkingStepInWords = 64 * KBInWords;
+
+  // Data pages used below this percentage are evacuated by a compaction.
+  static const intptr_t kEvacuationOccupancy = 50;
+
   HeapPage* AllocatePage(HeapPage::PageType type);
+  uword AllocateFromNewPage(intptr_t size, HeapPage::PageType type);
+  void UnlinkPage(HeapPage* page, HeapPage* previous_page);
   void FreePage(HeapPage* page, HeapPage* previous_page);
   HeapPage* AllocateLargePage(intptr_t size, HeapPage::PageType type);
   void FreeLargePage(HeapPage* page, HeapPage* previous_page);
   void FreePages(HeapPage* pages);
 
+  // With --compact_old_space and without --concurrent_sweep, MarkSweep
+  // evacuates the live objects of sparsely used data pages when old space is
+  // fragmented. The pages chosen are removed from the page space before the
+  // others are swept, and the free lists of the swept pages receive the
+  // evacuated objects. AllocateForEvacuation returns 0 once old space is
+  // exhausted, the page being evacuated is then kept and swept instead.
+  // EvacuatePages returns the words in use in the evacuated and kept pages.
+  HeapPage* SelectPagesToEvacuate();
+  uword AllocateForEvacuation(intptr_t size);
+  void UndoAllocateForEvacuation(uword addr, intptr_t size);
+  intptr_t EvacuatePages(HeapPage* pages);
+
+  // Concurrent sweeping, see CompleteSweep.
+  void StartConcurrentSweep();
+  uword TryAllocateDuringSweep(intptr_t size, HeapPage::PageType type);
+  HeapPage* ClaimUnsweptPage();
+  void SweepClaimedPage(GCSweeper* sweeper, HeapPage* page, FreeList* freelist);
+  void SweepLargePagesConcurrently(GCSweeper* sweeper);
+  void MergeSweptFreeLists();
+  void SweeperTaskFinished();
+
   static intptr_t LargePageSizeInWordsFor(intptr_t size);
 
-  bool CanIncreaseCapacityInWords(intptr_t increase_in_words) {
-    ASSERT(capacity_in_words_ <= max_capacity_in_words_);
-    return increase_in_words <= (max_capacity_in_words_ - capacity_in_words_);
-  }
+  bool CanIncreaseCapacityInWords(intptr_t increase_in_words) const;
 
   FreeList freelist_[HeapPage::kNumPageTypes];
 
@@ -265,9 +335,42 @@ class PageSpace {
   // Keep track whether a MarkSweep is currently running.
   bool sweeping_;
 
+  // Whether the pages of the last MarkSweep are still being swept
+  // concurrently. Only read and written by the isolate's thread.
+  bool concurrent_sweep_pending_;
+
+  // Regular pages left to sweep. Pages are claimed by atomically incrementing
+  // next_unswept_page_, both by the sweeper task and by allocation.
+  HeapPage** unswept_pages_;
+  uintptr_t num_unswept_pages_;
+  uintptr_t next_unswept_page_;
+
+  // Large pages not swept yet, owned by the sweeper task.
+  HeapPage* sweeping_large_pages_;
+
+  // Protects the page lists, the capacity and swept_freelist_ while a
+  // sweeper task is running.
+  Mutex* pages_lock_;
+  FreeList swept_freelist_[HeapPage::kNumPageTypes];
+
+  // Number of running sweeper tasks.
+  Monitor* tasks_lock_;
+  intptr_t tasks_;
+
   PageSpaceController page_space_controller_;
 
+  // Not NULL while old space is being marked incrementally.
+  IncrementalMarker* incremental_marker_;
+  // Usage at which the next incremental marking starts, set by MarkSweep.
+  intptr_t marking_start_in_words_;
+  // Usage at the last incremental marking step.
+  intptr_t marking_step_in_words_;
+
+  CodeIndex code_index_;
+
+  friend class GCCompactor;
   friend class PageSpaceController;
+  friend class SweeperTask;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(PageSpace);
 };
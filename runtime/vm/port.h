@@ -61,27 +61,41 @@ class PortMap: public AllStatic {
     bool live;
   } Entry;
 
-  // Allocate a new unique port.
+  // The ports are spread over shards by their id, so that posting messages
+  // to different ports rarely contends on the same lock.
+  typedef struct {
+    // Lock protecting access to the shard.
+    Mutex* mutex;
+
+    // Hashmap of the ports in the shard.
+    Entry* map;
+    intptr_t capacity;
+    intptr_t used;
+    intptr_t deleted;
+  } Shard;
+
+  static const intptr_t kNumShards = 16;
+
+  static Shard* ShardFor(Dart_Port port) {
+    return &shards_[port % kNumShards];
+  }
+
+  // Allocate a new port id. The caller checks that it is unused.
   static Dart_Port AllocatePort();
 
   static bool IsActivePort(Dart_Port id);
   static bool IsLivePort(Dart_Port id);
 
-  static intptr_t FindPort(Dart_Port port);
-  static void Rehash(intptr_t new_capacity);
-
-  static void MaintainInvariants();
+  static intptr_t FindPort(Shard* shard, Dart_Port port);
+  static void Rehash(Shard* shard, intptr_t new_capacity);
 
-  // Lock protecting access to the port map.
-  static Mutex* mutex_;
+  static void MaintainInvariants(Shard* shard);
 
-  // Hashmap of ports.
-  static Entry* map_;
+  static Shard shards_[kNumShards];
   static MessageHandler* deleted_entry_;
-  static intptr_t capacity_;
-  static intptr_t used_;
-  static intptr_t deleted_;
 
+  // Lock protecting next_port_.
+  static Mutex* allocation_mutex_;
   static Dart_Port next_port_;
 };
 
@@ -14,17 +14,19 @@ namespace dart {
 class PortMapTestPeer {
  public:
   static bool IsActivePort(Dart_Port port) {
-    MutexLocker ml(PortMap::mutex_);
-    return (PortMap::FindPort(port) >= 0);
+    PortMap::Shard* shard = PortMap::ShardFor(port);
+    MutexLocker ml(shard->mutex);
+    return (PortMap::FindPort(shard, port) >= 0);
   }
 
   static bool IsLivePort(Dart_Port port) {
-    MutexLocker ml(PortMap::mutex_);
-    intptr_t index = PortMap::FindPort(port);
+    PortMap::Shard* shard = PortMap::ShardFor(port);
+    MutexLocker ml(shard->mutex);
+    intptr_t index = PortMap::FindPort(shard, port);
     if (index < 0) {
       return false;
     }
-    return PortMap::map_[index].live;
+    return shard->map[index].live;
   }
 };
 
@@ -220,7 +220,40 @@ void Profiler::RecordSampleInterruptCallback(
 
 void Profiler::PrintToJSONStream(Isolate* isolate, JSONStream* stream) {
   ASSERT(isolate == Isolate::Current());
-  UNIMPLEMENTED();
+  ProcessSamples(isolate, false);
+  MutexLocker profiler_data_lock(isolate->profiler_data_mutex());
+  IsolateProfilerData* profiler_data = isolate->profiler_data();
+  if (!FLAG_profile || (profiler_data == NULL)) {
+    JSONObject jsobj(stream);
+    jsobj.AddProperty("type", "Error");
+    jsobj.AddProperty("text", "Profiler is disabled.");
+    return;
+  }
+  profiler_data->aggregator()->PrintToJSONStream(stream);
+}
+
+
+void Profiler::ProcessSamples(Isolate* isolate, bool only_if_needed) {
+  ASSERT(isolate == Isolate::Current());
+  if (!FLAG_profile) {
+    return;
+  }
+  MutexLocker profiler_data_lock(isolate->profiler_data_mutex());
+  IsolateProfilerData* profiler_data = isolate->profiler_data();
+  if (profiler_data == NULL) {
+    return;
+  }
+  SampleBuffer* sample_buffer = profiler_data->sample_buffer();
+  if (sample_buffer == NULL) {
+    return;
+  }
+  ProfilerAggregator* aggregator = profiler_data->aggregator();
+  if (only_if_needed &&
+      (aggregator->PendingSamples(sample_buffer) <
+       (sample_buffer->capacity() / 2))) {
+    return;
+  }
+  aggregator->ProcessSamples(isolate, sample_buffer);
 }
 
 
@@ -412,10 +445,13 @@ IsolateProfilerData::IsolateProfilerData(SampleBuffer* sample_buffer,
                                          bool own_sample_buffer) {
   sample_buffer_ = sample_buffer;
   own_sample_buffer_ = own_sample_buffer;
+  aggregator_ = new ProfilerAggregator();
 }
 
 
 IsolateProfilerData::~IsolateProfilerData() {
+  delete aggregator_;
+  aggregator_ = NULL;
   if (own_sample_buffer_) {
     delete sample_buffer_;
     sample_buffer_ = NULL;
@@ -467,6 +503,274 @@ Sample* SampleBuffer::ReserveSample() {
 }
 
 
+ProfilerCodeRegion::ProfilerCodeRegion(uword start, uword end, char* name)
+    : start_(start),
+      end_(end),
+      name_(name),
+      inclusive_ticks_(0),
+      exclusive_ticks_(0) {
+  ASSERT(start_ < end_);
+  ASSERT(name_ != NULL);
+}
+
+
+ProfilerCodeRegion::~ProfilerCodeRegion() {
+  free(name_);
+}
+
+
+ProfilerCallTreeNode::ProfilerCallTreeNode(intptr_t region_index)
+    : region_index_(region_index),
+      count_(0),
+      children_(NULL),
+      num_children_(0),
+      capacity_(0) {
+}
+
+
+ProfilerCallTreeNode::~ProfilerCallTreeNode() {
+  for (intptr_t i = 0; i < num_children_; i++) {
+    delete children_[i];
+  }
+  free(children_);
+}
+
+
+ProfilerCallTreeNode* ProfilerCallTreeNode::GetChild(intptr_t region_index) {
+  // Nodes have few children, a linear search is fine.
+  for (intptr_t i = 0; i < num_children_; i++) {
+    if (children_[i]->region_index() == region_index) {
+      return children_[i];
+    }
+  }
+  if (num_children_ == capacity_) {
+    capacity_ = (capacity_ == 0) ? 4 : (capacity_ * 2);
+    children_ = reinterpret_cast<ProfilerCallTreeNode**>(
+        realloc(children_, capacity_ * sizeof(*children_)));
+  }
+  ProfilerCallTreeNode* child = new ProfilerCallTreeNode(region_index);
+  children_[num_children_++] = child;
+  return child;
+}
+
+
+void ProfilerCallTreeNode::PrintToJSONArray(JSONArray* array) const {
+  array->AddValue(region_index_);
+  array->AddValue(count_);
+  array->AddValue(num_children_);
+  for (intptr_t i = 0; i < num_children_; i++) {
+    children_[i]->PrintToJSONArray(array);
+  }
+}
+
+
+ProfilerAggregator::ProfilerAggregator()
+    : processed_cursor_(0),
+      sample_count_(0),
+      lost_sample_count_(0),
+      regions_(NULL),
+      sorted_regions_(NULL),
+      num_regions_(0),
+      regions_capacity_(0),
+      root_(kNoRegion) {
+}
+
+
+ProfilerAggregator::~ProfilerAggregator() {
+  for (intptr_t i = 0; i < num_regions_; i++) {
+    delete regions_[i];
+  }
+  free(regions_);
+  free(sorted_regions_);
+}
+
+
+intptr_t ProfilerAggregator::PendingSamples(SampleBuffer* sample_buffer) const {
+  return sample_buffer->cursor() - processed_cursor_;
+}
+
+
+void ProfilerAggregator::ProcessSamples(Isolate* isolate,
+                                        SampleBuffer* sample_buffer) {
+  const uintptr_t capacity = sample_buffer->capacity();
+  const uintptr_t cursor = sample_buffer->cursor();
+  uintptr_t start = processed_cursor_;
+  if ((cursor - start) > capacity) {
+    // The buffer wrapped around before these samples could be processed.
+    lost_sample_count_ += cursor - start - capacity;
+    start = cursor - capacity;
+  }
+  for (uintptr_t i = start; i < cursor; i++) {
+    Sample* sample = sample_buffer->GetSample(i % capacity);
+    if ((sample->isolate != isolate) ||
+        (sample->type != Sample::kIsolateSample) ||
+        (sample->timestamp == 0)) {
+      continue;
+    }
+    ProcessSample(sample);
+  }
+  processed_cursor_ = cursor;
+}
+
+
+void ProfilerAggregator::ProcessSample(Sample* sample) {
+  intptr_t depth = 0;
+  while ((depth < Sample::kNumStackFrames) && (sample->pcs[depth] != 0)) {
+    depth++;
+  }
+  if (depth == 0) {
+    return;
+  }
+  sample_count_++;
+  intptr_t region_indices[Sample::kNumStackFrames];
+  for (intptr_t i = 0; i < depth; i++) {
+    region_indices[i] = FindOrAddRegion(sample->pcs[i]);
+  }
+  regions_[region_indices[0]]->TickExclusive();
+  for (intptr_t i = 0; i < depth; i++) {
+    // Count recursive frames only once per sample.
+    bool seen = false;
+    for (intptr_t j = 0; j < i; j++) {
+      if (region_indices[j] == region_indices[i]) {
+        seen = true;
+        break;
+      }
+    }
+    if (!seen) {
+      regions_[region_indices[i]]->TickInclusive();
+    }
+  }
+  ProfilerCallTreeNode* node = &root_;
+  node->Tick();
+  for (intptr_t i = depth - 1; i >= 0; i--) {
+    node = node->GetChild(region_indices[i]);
+    node->Tick();
+  }
+}
+
+
+// Returns the position in 'sorted' of the first region starting above 'pc'.
+static intptr_t UpperBound(ProfilerCodeRegion** regions,
+                           intptr_t* sorted,
+                           intptr_t length,
+                           uword pc) {
+  intptr_t lo = 0;
+  intptr_t hi = length;
+  while (lo < hi) {
+    intptr_t mid = lo + (hi - lo) / 2;
+    if (regions[sorted[mid]]->start() <= pc) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+
+intptr_t ProfilerAggregator::FindRegion(uword pc) const {
+  intptr_t pos = UpperBound(regions_, sorted_regions_, num_regions_, pc);
+  if ((pos > 0) && regions_[sorted_regions_[pos - 1]]->Contains(pc)) {
+    return sorted_regions_[pos - 1];
+  }
+  return kNoRegion;
+}
+
+
+intptr_t ProfilerAggregator::FindOrAddRegion(uword pc) {
+  intptr_t index = FindRegion(pc);
+  if (index != kNoRegion) {
+    return index;
+  }
+  // Regions of code that has been collected are never removed and may absorb
+  // the ticks of code later allocated at the same address.
+  const Code& code = Code::Handle(Code::LookupCode(pc));
+  if (!code.IsNull()) {
+    const char* name = "<stub>";
+    const Function& function = Function::Handle(code.function());
+    if (!function.IsNull()) {
+      const String& function_name =
+          String::Handle(function.QualifiedUserVisibleName());
+      name = function_name.ToCString();
+    }
+    return AddRegion(pc,
+                     code.EntryPoint(),
+                     code.EntryPoint() + code.Size(),
+                     strdup(name));
+  }
+  // Not Dart code, bin native and unknown code into buckets by PC.
+  const uword kBucketSize = 256;
+  const uword start = pc & ~(kBucketSize - 1);
+  char* name = NativeSymbolResolver::LookupSymbolName(pc);
+  if (name == NULL) {
+    const intptr_t kBuffSize = 256;
+    char buff[kBuffSize];
+    OS::SNPrint(&buff[0], kBuffSize-1, "Unknown [%" Px ", %" Px ")",
+                start, start + kBucketSize);
+    name = strdup(buff);
+  }
+  return AddRegion(pc, start, start + kBucketSize, name);
+}
+
+
+intptr_t ProfilerAggregator::AddRegion(uword pc,
+                                       uword start,
+                                       uword end,
+                                       char* name) {
+  // Clip the new region to the gap around 'pc' between its neighbours so
+  // that regions never overlap.
+  ASSERT(FindRegion(pc) == kNoRegion);
+  const intptr_t pos =
+      UpperBound(regions_, sorted_regions_, num_regions_, pc);
+  if ((pos > 0) && (regions_[sorted_regions_[pos - 1]]->end() > start)) {
+    start = regions_[sorted_regions_[pos - 1]]->end();
+  }
+  if ((pos < num_regions_) && (regions_[sorted_regions_[pos]]->start() < end)) {
+    end = regions_[sorted_regions_[pos]]->start();
+  }
+  ASSERT((start <= pc) && (pc < end));
+  if (num_regions_ == regions_capacity_) {
+    regions_capacity_ = (regions_capacity_ == 0) ? 64 : (regions_capacity_ * 2);
+    regions_ = reinterpret_cast<ProfilerCodeRegion**>(
+        realloc(regions_, regions_capacity_ * sizeof(*regions_)));
+    sorted_regions_ = reinterpret_cast<intptr_t*>(
+        realloc(sorted_regions_, regions_capacity_ * sizeof(*sorted_regions_)));
+  }
+  const intptr_t index = num_regions_++;
+  regions_[index] = new ProfilerCodeRegion(start, end, name);
+  for (intptr_t i = index; i > pos; i--) {
+    sorted_regions_[i] = sorted_regions_[i - 1];
+  }
+  sorted_regions_[pos] = index;
+  return index;
+}
+
+
+void ProfilerAggregator::PrintToJSONStream(JSONStream* stream) const {
+  JSONObject jsobj(stream);
+  jsobj.AddProperty("type", "Profile");
+  jsobj.AddProperty("samples", sample_count_);
+  jsobj.AddProperty("lostSamples", lost_sample_count_);
+  {
+    JSONArray codes(&jsobj, "codes");
+    for (intptr_t i = 0; i < num_regions_; i++) {
+      ProfilerCodeRegion* region = regions_[i];
+      JSONObject code(&codes);
+      code.AddProperty("name", region->name());
+      code.AddPropertyF("start", "%" Px "", region->start());
+      code.AddPropertyF("end", "%" Px "", region->end());
+      code.AddProperty("inclusiveTicks", region->inclusive_ticks());
+      code.AddProperty("exclusiveTicks", region->exclusive_ticks());
+    }
+  }
+  {
+    // Preorder encoding of the call tree, see ProfilerCallTreeNode.
+    JSONArray tree(&jsobj, "tree");
+    root_.PrintToJSONArray(&tree);
+  }
+}
+
+
 ProfilerSampleStackWalker::ProfilerSampleStackWalker(Sample* sample,
                                                      uintptr_t stack_lower,
                                                      uintptr_t stack_upper,
@@ -16,6 +16,7 @@ namespace dart {
 // Forward declarations.
 class JSONArray;
 class JSONStream;
+class ProfilerAggregator;
 struct Sample;
 
 // Profiler
@@ -33,6 +34,11 @@ class Profiler : public AllStatic {
 
   static void PrintToJSONStream(Isolate* isolate, JSONStream* stream);
 
+  // Folds the samples recorded for 'isolate' since the last call into its
+  // call tree. With 'only_if_needed' the samples are left alone until the
+  // sample buffer is at risk of overwriting them.
+  static void ProcessSamples(Isolate* isolate, bool only_if_needed);
+
   static void WriteTracing(Isolate* isolate);
 
   static SampleBuffer* sample_buffer() {
@@ -67,9 +73,12 @@ class IsolateProfilerData {
     sample_buffer_ = sample_buffer;
   }
 
+  ProfilerAggregator* aggregator() const { return aggregator_; }
+
  private:
   SampleBuffer* sample_buffer_;
   bool own_sample_buffer_;
+  ProfilerAggregator* aggregator_;
   DISALLOW_COPY_AND_ASSIGN(IsolateProfilerData);
 };
 
@@ -115,6 +124,10 @@ class SampleBuffer {
     return &samples_[i];
   }
 
+  // Total number of samples reserved so far. Sample number n lives in slot
+  // n % capacity() until it is overwritten.
+  uintptr_t cursor() const { return cursor_; }
+
  private:
   Sample* samples_;
   intptr_t capacity_;
@@ -124,6 +137,126 @@ class SampleBuffer {
 };
 
 
+// A range of machine code that samples are attributed to: the instructions
+// of one Code object, or a fixed size bucket of native or unknown code.
+class ProfilerCodeRegion {
+ public:
+  ProfilerCodeRegion(uword start, uword end, char* name);
+  ~ProfilerCodeRegion();
+
+  uword start() const { return start_; }
+  uword end() const { return end_; }
+  const char* name() const { return name_; }
+
+  bool Contains(uword pc) const { return (pc >= start_) && (pc < end_); }
+
+  intptr_t inclusive_ticks() const { return inclusive_ticks_; }
+  intptr_t exclusive_ticks() const { return exclusive_ticks_; }
+  void TickInclusive() { inclusive_ticks_++; }
+  void TickExclusive() { exclusive_ticks_++; }
+
+ private:
+  const uword start_;
+  const uword end_;
+  char* name_;  // Owned, malloc allocated.
+  intptr_t inclusive_ticks_;
+  intptr_t exclusive_ticks_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProfilerCodeRegion);
+};
+
+
+// Node of the top-down call tree. The path from the root to a node is a
+// sequence of code regions from the outermost sampled frame inwards and
+// count() is the number of samples whose stack starts with that path.
+class ProfilerCallTreeNode {
+ public:
+  explicit ProfilerCallTreeNode(intptr_t region_index);
+  ~ProfilerCallTreeNode();
+
+  intptr_t region_index() const { return region_index_; }
+  intptr_t count() const { return count_; }
+  void Tick() { count_++; }
+
+  intptr_t NumChildren() const { return num_children_; }
+  ProfilerCallTreeNode* ChildAt(intptr_t i) const {
+    ASSERT((i >= 0) && (i < num_children_));
+    return children_[i];
+  }
+
+  // Returns the child for 'region_index', adding it if necessary.
+  ProfilerCallTreeNode* GetChild(intptr_t region_index);
+
+  // Appends this subtree in preorder as triples of region index, count and
+  // number of children.
+  void PrintToJSONArray(JSONArray* array) const;
+
+ private:
+  const intptr_t region_index_;
+  intptr_t count_;
+  ProfilerCallTreeNode** children_;
+  intptr_t num_children_;
+  intptr_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProfilerCallTreeNode);
+};
+
+
+// Aggregates the samples of one isolate into code regions with inclusive and
+// exclusive tick counts and a call tree keyed by code region. Samples are
+// consumed incrementally, so the sample buffer may wrap around any number of
+// times without losing ticks as long as ProcessSamples runs often enough.
+class ProfilerAggregator {
+ public:
+  ProfilerAggregator();
+  ~ProfilerAggregator();
+
+  // Consumes the samples of 'isolate' recorded in 'sample_buffer' since the
+  // previous call. Must run on the isolate's thread.
+  void ProcessSamples(Isolate* isolate, SampleBuffer* sample_buffer);
+
+  // Number of samples not yet consumed from 'sample_buffer'.
+  intptr_t PendingSamples(SampleBuffer* sample_buffer) const;
+
+  intptr_t sample_count() const { return sample_count_; }
+  intptr_t lost_sample_count() const { return lost_sample_count_; }
+
+  intptr_t NumRegions() const { return num_regions_; }
+  ProfilerCodeRegion* RegionAt(intptr_t i) const {
+    ASSERT((i >= 0) && (i < num_regions_));
+    return regions_[i];
+  }
+  // Returns the index of the region containing 'pc' or -1.
+  intptr_t FindRegion(uword pc) const;
+
+  const ProfilerCallTreeNode* root() const { return &root_; }
+
+  void PrintToJSONStream(JSONStream* stream) const;
+
+ private:
+  static const intptr_t kNoRegion = -1;
+
+  void ProcessSample(Sample* sample);
+  intptr_t FindOrAddRegion(uword pc);
+  intptr_t AddRegion(uword pc, uword start, uword end, char* name);
+
+  uintptr_t processed_cursor_;
+  intptr_t sample_count_;
+  intptr_t lost_sample_count_;
+
+  // Regions in insertion order, the call tree refers to them by index.
+  ProfilerCodeRegion** regions_;
+  // Indices into 'regions_' sorted by start address.
+  intptr_t* sorted_regions_;
+  intptr_t num_regions_;
+  intptr_t regions_capacity_;
+
+  ProfilerCallTreeNode root_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProfilerAggregator);
+};
+
+
 class ProfilerSampleStackWalker : public ValueObject {
  public:
   ProfilerSampleStackWalker(Sample* sample,
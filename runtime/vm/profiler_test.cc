@@ -88,4 +88,72 @@ TEST_CASE(ProfilerSampleBufferIterateTest) {
   delete sample_buffer;
 }
 
+
+static void InitSample(Sample* sample, Isolate* isolate,
+                       uintptr_t leaf_pc, uintptr_t caller_pc) {
+  sample->Init(Sample::kIsolateSample, isolate, 1,
+               Thread::GetCurrentThreadId());
+  sample->pcs[0] = leaf_pc;
+  sample->pcs[1] = caller_pc;
+}
+
+
+TEST_CASE(ProfilerAggregatorCallTreeTest) {
+  SampleBuffer* sample_buffer = new SampleBuffer(4);
+  Isolate* i = reinterpret_cast<Isolate*>(0x1);
+  Isolate* other = reinterpret_cast<Isolate*>(0x2);
+  // Neither Dart code nor native symbols, each PC lands in its own bucket.
+  const uintptr_t kCaller = 0x2000;
+  const uintptr_t kLeafA = 0x1000;
+  const uintptr_t kLeafB = 0x3000;
+  ProfilerAggregator* aggregator = new ProfilerAggregator();
+  InitSample(sample_buffer->ReserveSample(), i, kLeafA, kCaller);
+  InitSample(sample_buffer->ReserveSample(), other, kLeafA, kCaller);
+  InitSample(sample_buffer->ReserveSample(), i, kLeafB, kCaller);
+  aggregator->ProcessSamples(i, sample_buffer);
+  EXPECT_EQ(2, aggregator->sample_count());
+  EXPECT_EQ(0, aggregator->PendingSamples(sample_buffer));
+
+  // Wrap the buffer, samples that were already processed are not lost.
+  InitSample(sample_buffer->ReserveSample(), i, kLeafA + 8, kCaller);
+  InitSample(sample_buffer->ReserveSample(), i, kLeafA, kCaller);
+  EXPECT_EQ(2, aggregator->PendingSamples(sample_buffer));
+  aggregator->ProcessSamples(i, sample_buffer);
+  EXPECT_EQ(4, aggregator->sample_count());
+  EXPECT_EQ(0, aggregator->lost_sample_count());
+
+  EXPECT_EQ(3, aggregator->NumRegions());
+  ProfilerCodeRegion* caller =
+      aggregator->RegionAt(aggregator->FindRegion(kCaller));
+  EXPECT_EQ(4, caller->inclusive_ticks());
+  EXPECT_EQ(0, caller->exclusive_ticks());
+  ProfilerCodeRegion* leaf_a =
+      aggregator->RegionAt(aggregator->FindRegion(kLeafA));
+  EXPECT_EQ(3, leaf_a->inclusive_ticks());
+  EXPECT_EQ(3, leaf_a->exclusive_ticks());
+
+  // The call tree is rooted at the outermost frame.
+  const ProfilerCallTreeNode* root = aggregator->root();
+  EXPECT_EQ(4, root->count());
+  EXPECT_EQ(1, root->NumChildren());
+  const ProfilerCallTreeNode* caller_node = root->ChildAt(0);
+  EXPECT_EQ(aggregator->FindRegion(kCaller), caller_node->region_index());
+  EXPECT_EQ(4, caller_node->count());
+  EXPECT_EQ(2, caller_node->NumChildren());
+  EXPECT_EQ(aggregator->FindRegion(kLeafA),
+            caller_node->ChildAt(0)->region_index());
+  EXPECT_EQ(3, caller_node->ChildAt(0)->count());
+  EXPECT_EQ(1, caller_node->ChildAt(1)->count());
+
+  // Samples overwritten before they were processed are counted as lost.
+  for (intptr_t j = 0; j < 6; j++) {
+    InitSample(sample_buffer->ReserveSample(), i, kLeafB, kCaller);
+  }
+  aggregator->ProcessSamples(i, sample_buffer);
+  EXPECT_EQ(8, aggregator->sample_count());
+  EXPECT_EQ(2, aggregator->lost_sample_count());
+  delete aggregator;
+  delete sample_buffer;
+}
+
 }  // namespace dart
@@ -46,17 +46,18 @@ void RawObject::Validate(Isolate* isolate) const {
 }
 
 
-intptr_t RawObject::SizeFromClass() const {
+intptr_t RawObject::SizeFromClassId(intptr_t class_id) const {
+  // No handles are created here. This is also reached from the helper threads
+  // of a parallel marking, which must not touch the isolate's scope chain.
   Isolate* isolate = Isolate::Current();
-  NoHandleScope no_handles(isolate);
 
   // Only reasonable to be called on heap objects.
   ASSERT(IsHeapObject());
 
-  RawClass* raw_class = isolate->class_table()->At(GetClassId());
+  RawClass* raw_class = isolate->class_table()->At(class_id);
   intptr_t instance_size =
       raw_class->ptr()->instance_size_in_words_ << kWordSizeLog2;
-  intptr_t class_id = raw_class->ptr()->id_;
+  class_id = raw_class->ptr()->id_;
 
   if (instance_size == 0) {
     switch (class_id) {
@@ -195,8 +196,21 @@ intptr_t RawObject::SizeFromClass() const {
 
 
 intptr_t RawObject::VisitPointers(ObjectPointerVisitor* visitor) {
+#if defined(DEBUG)
+  // Garbage collections already run inside a NoHandleScope. Not nesting
+  // another one keeps the helper threads of a parallel marking, which visit
+  // objects on behalf of the isolate, off the isolate's scope chain.
+  if (visitor->isolate()->no_handle_scope_depth() == 0) {
+    NoHandleScope no_handles(visitor->isolate());
+    return VisitPointersUnscoped(visitor);
+  }
+#endif  // defined(DEBUG)
+  return VisitPointersUnscoped(visitor);
+}
+
+
+intptr_t RawObject::VisitPointersUnscoped(ObjectPointerVisitor* visitor) {
   intptr_t size = 0;
-  NoHandleScope no_handles(visitor->isolate());
 
   // Only reasonable to be called on heap objects.
   ASSERT(IsHeapObject());
@@ -406,9 +420,7 @@ intptr_t RawFunction::VisitFunctionPointers(RawFunction* raw_obj,
       !RawFunction::SkipCode(raw_obj)) {
     visitor->VisitPointers(raw_obj->from(), raw_obj->to());
   } else {
-    GrowableArray<RawFunction*>* sfga = visitor->skipped_code_functions();
-    ASSERT(sfga != NULL);
-    sfga->Add(raw_obj);
+    visitor->AddSkippedCodeFunction(raw_obj);
     visitor->VisitPointers(raw_obj->from(), raw_obj->to_no_code());
   }
   return Function::InstanceSize();
@@ -6,6 +6,7 @@
 #define VM_RAW_OBJECT_H_
 
 #include "platform/assert.h"
+#include "vm/atomic.h"
 #include "vm/globals.h"
 #include "vm/token.h"
 #include "vm/snapshot.h"
@@ -113,6 +114,7 @@ namespace dart {
 
 
 // Forward declarations.
+class FinalizablePersistentHandle;
 class Isolate;
 #define DEFINE_FORWARD_DECLARATION(clazz)                                      \
   class Raw##clazz;
@@ -229,10 +231,17 @@ class RawObject {
     kCanonicalBit = 2,
     kFromSnapshotBit = 3,
     kRememberedBit = 4,
-    kReservedTagBit = 5,  // kReservedBit{10K,100K,1M,10M}
-    kReservedTagSize = 3,
+    kAgeTagBit = 5,
+    kAgeTagSize = 2,
+    kReservedTagBit = 7,
+    kReservedTagSize = 1,
     kSizeTagBit = 8,
     kSizeTagSize = 8,
+#if defined(ARCH_IS_64_BIT)
+    // The upper half of a 64-bit header holds the identity hash code.
+    kHashTagBit = 32,
+    kHashTagSize = 32,
+#endif
     kClassIdTagBit = kSizeTagBit + kSizeTagSize,
     kClassIdTagSize = 16
   };
@@ -272,6 +281,12 @@ class RawObject {
                                      kClassIdTagBit,
                                      kClassIdTagSize> {};  // NOLINT
 
+#if defined(ARCH_IS_64_BIT)
+  class HashTag : public BitField<intptr_t,
+                                  kHashTagBit,
+                                  kHashTagSize> {};  // NOLINT
+#endif
+
   bool IsHeapObject() const {
     uword value = reinterpret_cast<uword>(this);
     return (value & kSmiTagMask) == kHeapObjectTag;
@@ -298,11 +313,29 @@ class RawObject {
     uword tags = ptr()->tags_;
     ptr()->tags_ = MarkBit::update(true, tags);
   }
+  // Sets the mark bit atomically for use by parallel marking. Returns false
+  // if the object was already marked, possibly by another marking thread.
+  bool TryAcquireMarkBit() {
+    uword old_tags;
+    do {
+      old_tags = ptr()->tags_;
+      if (MarkBit::decode(old_tags)) {
+        return false;
+      }
+    } while (AtomicOperations::CompareAndSwapWord(
+        &ptr()->tags_, old_tags, MarkBit::update(true, old_tags)) != old_tags);
+    return true;
+  }
   void ClearMarkBit() {
     ASSERT(IsMarked());
     uword tags = ptr()->tags_;
     ptr()->tags_ = MarkBit::update(false, tags);
   }
+  // Used by sweeper tasks, which run concurrently with the mutator.
+  void ClearMarkBitAtomic() {
+    ASSERT(IsMarked());
+    UpdateTagBitAtomic<MarkBit>(false);
+  }
 
   // Support for GC watched bit.
   bool IsWatched() const {
@@ -324,8 +357,7 @@ class RawObject {
     return CanonicalObjectTag::decode(ptr()->tags_);
   }
   void SetCanonical() {
-    uword tags = ptr()->tags_;
-    ptr()->tags_ = CanonicalObjectTag::update(true, tags);
+    UpdateTagBitAtomic<CanonicalObjectTag>(true);
   }
   bool IsCreatedFromSnapshot() const {
     return CreatedFromSnapshotTag::decode(ptr()->tags_);
@@ -335,18 +367,35 @@ class RawObject {
     ptr()->tags_ = CreatedFromSnapshotTag::update(true, tags);
   }
 
+#if defined(ARCH_IS_64_BIT)
+  // Support for the identity hash code kept in the header. A hash code of
+  // 0 means that none was assigned yet.
+  intptr_t GetHeaderHash() const {
+    return HashTag::decode(ptr()->tags_);
+  }
+  void SetHeaderHash(intptr_t hash) {
+    // Other threads, e.g. the sweeper, may update the tags concurrently.
+    uword old_tags;
+    do {
+      old_tags = ptr()->tags_;
+    } while (AtomicOperations::CompareAndSwapWord(
+        &ptr()->tags_, old_tags, HashTag::update(hash, old_tags)) !=
+        old_tags);
+  }
+#endif
+
   // Support for GC remembered bit.
   bool IsRemembered() const {
     return RememberedBit::decode(ptr()->tags_);
   }
   void SetRememberedBit() {
     ASSERT(!IsRemembered());
-    uword tags = ptr()->tags_;
-    ptr()->tags_ = RememberedBit::update(true, tags);
+    UpdateTagBitAtomic<RememberedBit>(true);
   }
   void ClearRememberedBit() {
-    uword tags = ptr()->tags_;
-    ptr()->tags_ = RememberedBit::update(false, tags);
+    if (IsRemembered()) {
+      UpdateTagBitAtomic<RememberedBit>(false);
+    }
   }
 
   bool IsDartInstance() {
@@ -368,6 +417,16 @@ class RawObject {
     return result;
   }
 
+  // Like Size, but decodes the given tags instead of the header, which may
+  // be replaced by a forwarding address concurrently.
+  intptr_t SizeFromTags(uword tags) const {
+    intptr_t result = SizeTag::decode(tags);
+    if (result != 0) {
+      return result;
+    }
+    return SizeFromClassId(ClassIdTag::decode(tags));
+  }
+
   void Validate(Isolate* isolate) const;
   intptr_t VisitPointers(ObjectPointerVisitor* visitor);
   bool FindObject(FindObjectVisitor* visitor);
@@ -390,6 +449,16 @@ class RawObject {
     return CanonicalObjectTag::decode(value);
   }
 
+  // Support for the age of new objects, the number of scavenges they have
+  // survived. Ages saturate at kMaxAge and only matter in new space.
+  static const intptr_t kMaxAge = (1 << kAgeTagSize) - 1;
+  static intptr_t AgeFromTags(uword tags) {
+    return AgeTag::decode(tags);
+  }
+  static uword UpdateAge(intptr_t age, uword tags) {
+    return AgeTag::update(age, tags);
+  }
+
   // Class Id predicates.
   static bool IsErrorClassId(intptr_t index);
   static bool IsNumberClassId(intptr_t index);
@@ -419,6 +488,8 @@ class RawObject {
 
   class CreatedFromSnapshotTag : public BitField<bool, kFromSnapshotBit, 1> {};
 
+  class AgeTag : public BitField<intptr_t, kAgeTagBit, kAgeTagSize> {};
+
   class ReservedBits : public BitField<intptr_t,
                                        kReservedTagBit,
                                        kReservedTagSize> {};  // NOLINT
@@ -429,7 +500,24 @@ class RawObject {
         reinterpret_cast<uword>(this) - kHeapObjectTag);
   }
 
-  intptr_t SizeFromClass() const;
+  intptr_t SizeFromClass() const {
+    return SizeFromClassId(GetClassId());
+  }
+  intptr_t SizeFromClassId(intptr_t class_id) const;
+
+  // Tag bits of live old objects can be updated by the mutator while a
+  // sweeper task clears their mark bits, so such updates must not be lost.
+  template<class TagBitField>
+  void UpdateTagBitAtomic(bool value) {
+    uword old_tags;
+    do {
+      old_tags = ptr()->tags_;
+    } while (AtomicOperations::CompareAndSwapWord(
+        &ptr()->tags_, old_tags, TagBitField::update(value, old_tags)) !=
+        old_tags);
+  }
+
+  intptr_t VisitPointersUnscoped(ObjectPointerVisitor* visitor);
 
   intptr_t GetClassId() const {
     uword tags = ptr()->tags_;
@@ -731,9 +819,13 @@ class RawTokenStream : public RawObject {
   }
   RawString* private_key_;  // Key used for private identifiers.
   RawArray* token_objects_;
+  // Encoded token objects of a snapshot, read on first use.
+  RawExternalTypedData* serialized_token_objects_;
   RawExternalTypedData* stream_;
+  // Positions from which to walk the stream, computed on first use.
+  RawArray* checkpoints_;
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&ptr()->stream_);
+    return reinterpret_cast<RawObject**>(&ptr()->checkpoints_);
   }
 
   friend class SnapshotReader;
@@ -845,8 +937,9 @@ class RawCode : public RawObject {
   RawArray* stackmaps_;
   RawLocalVarDescriptors* var_descriptors_;
   RawArray* comments_;
+  RawArray* relocations_;  // Smi slots of external addresses, or null.
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&ptr()->comments_);
+    return reinterpret_cast<RawObject**>(&ptr()->relocations_);
   }
 
   intptr_t pointer_offsets_length_;
@@ -858,6 +951,7 @@ class RawCode : public RawObject {
   // Variable length data follows here.
   int32_t data_[0];
 
+  friend class SnapshotReader;
   friend class StackFrame;
 };
 
@@ -885,17 +979,31 @@ class RawInstructions : public RawObject {
 
   friend class RawCode;
   friend class Code;
+  friend class SnapshotReader;
   friend class StackFrame;
 };
 
 
 class RawPcDescriptors : public RawObject {
+ public:
+  // A descriptor record. Apart from the pc, every field fits in 32 bits.
+  struct PcDescriptorRec {
+    uword pc;
+    int32_t deopt_id;
+    int32_t token_pos;  // Or deopt reason.
+    int32_t try_index;  // Or deopt index.
+    int32_t kind;
+  };
+
+ private:
   RAW_HEAP_OBJECT_IMPLEMENTATION(PcDescriptors);
 
   RawSmi* length_;  // Number of descriptors.
 
-  // Variable length data follows here.
-  intptr_t data_[0];
+  // Variable length data follows here, records are sorted by pc.
+  PcDescriptorRec data_[0];
+
+  friend class SnapshotReader;
 };
 
 
@@ -920,6 +1028,8 @@ class RawStackmap : public RawObject {
 
   // Variable length data follows here (bitmap of the stack layout).
   uint8_t data_[0];
+
+  friend class SnapshotReader;
 };
 
 
@@ -947,6 +1057,8 @@ class RawLocalVarDescriptors : public RawObject {
   RawArray* names_;  // Array of [length_] variable names.
 
   VarInfo data_[0];   // Variable info with [length_] entries.
+
+  friend class SnapshotReader;
 };
 
 
@@ -972,6 +1084,8 @@ class RawExceptionHandlers : public RawObject {
 
   // Exception handler info of length [length_].
   HandlerInfo data_[0];
+
+  friend class SnapshotReader;
 };
 
 
@@ -1492,6 +1606,8 @@ class RawExternalTypedData : public RawInstance {
 
   uint8_t* data_;
   void* peer_;
+  // The weak persistent handle whose finalizer releases data_, if any.
+  FinalizablePersistentHandle* finalizer_;
 
   friend class TokenStream;
   friend class RawTokenStream;
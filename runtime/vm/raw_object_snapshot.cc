@@ -3,6 +3,7 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "vm/bigint_operations.h"
+#include "vm/dart_api_state.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
 #include "vm/snapshot.h"
@@ -856,9 +857,16 @@ void RawFunction::WriteTo(SnapshotWriter* writer,
   writer->Write<uint16_t>(ptr()->optimized_instruction_count_);
   writer->Write<uint16_t>(ptr()->optimized_call_site_count_);
 
-  // Write out all the object pointer fields.
+  // Write out all the object pointer fields. Optimized code is never written,
+  // the function starts out running its unoptimized code when read.
   SnapshotWriterVisitor visitor(writer);
-  visitor.VisitPointers(from(), to());
+  visitor.VisitPointers(from(), to_no_code());
+  RawCode* code = ptr()->unoptimized_code_;
+  if (code == Code::null()) {
+    code = ptr()->code_;
+  }
+  visitor.VisitPointer(reinterpret_cast<RawObject**>(&code));
+  visitor.VisitPointer(reinterpret_cast<RawObject**>(&code));
 }
 
 
@@ -1000,9 +1008,30 @@ RawTokenStream* TokenStream::ReadFrom(SnapshotReader* reader,
     reader->ReadBytes(stream->ptr()->data_, len);
   }
 
-  // Read in the literal/identifier token array.
-  *(reader->TokensHandle()) ^= reader->ReadObjectImpl();
+  // Read in the literal/identifier token array. The snapshot usually holds
+  // an encoding of it which is only read when the stream is used.
+  *(reader->TokensHandle()) = Array::null();
+  *(reader->DataHandle()) = ExternalTypedData::null();
+  intptr_t serialized_len = reader->ReadIntptrValue();
+  if (serialized_len > 0) {
+    if (kind == Snapshot::kFull) {
+      *(reader->DataHandle()) = reader->NewExternalData(serialized_len);
+    } else {
+      // The embedder owns the buffer of a script snapshot, keep a copy.
+      uint8_t* data = reinterpret_cast<uint8_t*>(::malloc(serialized_len));
+      ASSERT(data != NULL);
+      reader->ReadBytes(data, serialized_len);
+      *(reader->DataHandle()) = ExternalTypedData::New(
+          kExternalTypedDataUint8ArrayCid, data, serialized_len, Heap::kOld);
+      reader->DataHandle()->AddFinalizer(data, DataFinalizer);
+    }
+  } else {
+    *(reader->TokensHandle()) ^= reader->ReadObjectImpl();
+  }
   token_stream.SetTokenObjects(*(reader->TokensHandle()));
+  token_stream.SetSerializedTokenObjects(*(reader->DataHandle()));
+  // The checkpoints are not written, they are computed again on first use.
+  token_stream.SetCheckpoints(Object::null_array());
   // Read in the private key in use by the token stream.
   *(reader->StringHandle()) ^= reader->ReadObjectImpl();
   token_stream.SetPrivateKey(*(reader->StringHandle()));
@@ -1033,7 +1062,7 @@ void RawTokenStream::WriteTo(SnapshotWriter* writer,
   writer->WriteBytes(stream->ptr()->data_, len);
 
   // Write out the literal/identifier token array.
-  writer->WriteObjectImpl(ptr()->token_objects_);
+  writer->WriteTokenObjects(this);
   // Write out the private key in use by the token stream.
   writer->WriteObjectImpl(ptr()->private_key_);
 }
@@ -1302,17 +1331,109 @@ RawCode* Code::ReadFrom(SnapshotReader* reader,
                         intptr_t object_id,
                         intptr_t tags,
                         Snapshot::Kind kind) {
-  UNREACHABLE();
-  return Code::null();
+  ASSERT(reader != NULL);
+  ASSERT(kind == Snapshot::kFull);
+
+  // Allocate code object, code with embedded object pointers is not written.
+  Code& result = Code::ZoneHandle(reader->isolate(), reader->NewCode(0));
+  reader->AddBackRef(object_id, &result, kIsDeserialized);
+
+  // Set the object tags.
+  result.set_tags(tags);
+
+  // Set all non object fields.
+  result.raw_ptr()->state_bits_ = reader->ReadIntptrValue();
+
+  // Copy the instructions into executable memory, the external addresses
+  // are patched by SnapshotReader::RelocateCode.
+  intptr_t size = reader->ReadIntptrValue();
+  const Instructions& instrs = Instructions::Handle(
+      reader->isolate(), reader->NewInstructions(size));
+  uword entry_point = instrs.EntryPoint();
+  reader->ReadBytes(reinterpret_cast<uint8_t*>(entry_point), size);
+  instrs.set_code(result.raw());
+  result.raw_ptr()->instructions_ = instrs.raw();
+
+  // Set all the object fields.
+  instrs.raw_ptr()->object_pool_ =
+      reinterpret_cast<RawArray*>(reader->ReadObjectRef());
+  result.raw_ptr()->function_ =
+      reinterpret_cast<RawFunction*>(reader->ReadObjectRef());
+  result.raw_ptr()->pc_descriptors_ = (reader->Read<int8_t>() != 0) ?
+      reader->ReadPcDescriptors(entry_point) : PcDescriptors::null();
+  result.raw_ptr()->exception_handlers_ = (reader->Read<int8_t>() != 0) ?
+      reader->ReadExceptionHandlers(entry_point) : ExceptionHandlers::null();
+  result.raw_ptr()->deopt_info_array_ =
+      reinterpret_cast<RawArray*>(reader->ReadObjectRef());
+  result.raw_ptr()->object_table_ =
+      reinterpret_cast<RawArray*>(reader->ReadObjectRef());
+  result.raw_ptr()->static_calls_target_table_ =
+      reinterpret_cast<RawArray*>(reader->ReadObjectRef());
+  result.raw_ptr()->stackmaps_ =
+      reinterpret_cast<RawArray*>(reader->ReadObjectRef());
+  result.raw_ptr()->var_descriptors_ =
+      reinterpret_cast<RawLocalVarDescriptors*>(reader->ReadObjectRef());
+  result.raw_ptr()->comments_ = Object::empty_array().raw();
+  result.raw_ptr()->relocations_ =
+      reinterpret_cast<RawArray*>(reader->ReadObjectRef());
+
+  reader->isolate()->heap()->code_index()->Add(instrs);
+  reader->ReadCodeRelocations(result);
+  return result.raw();
 }
 
 
 void RawCode::WriteTo(SnapshotWriter* writer,
                       intptr_t object_id,
                       Snapshot::Kind kind) {
-  // We have already checked for this and written a NULL object, hence we
-  // should not reach here.
-  UNREACHABLE();
+  ASSERT(writer != NULL);
+  // Only code accepted by SnapshotWriter::CanWriteCode reaches here, other
+  // code is written as a NULL object.
+  ASSERT(kind == Snapshot::kFull);
+  ASSERT(ptr()->pointer_offsets_length_ == 0);
+
+  // Write out the serialization header value for this object.
+  writer->WriteInlinedObjectHeader(object_id);
+
+  // Write out the class and tags information.
+  writer->WriteVMIsolateObject(kCodeCid);
+  writer->WriteIntptrValue(writer->GetObjectTags(this));
+
+  // Write out all the non object fields.
+  writer->WriteIntptrValue(ptr()->state_bits_);
+
+  // Write out the instructions.
+  RawInstructions* instrs = ptr()->instructions_;
+  uword entry_point = SnapshotWriter::CodeEntryPoint(this);
+  writer->WriteIntptrValue(instrs->ptr()->size_);
+  writer->WriteBytes(reinterpret_cast<uint8_t*>(entry_point),
+                     instrs->ptr()->size_);
+
+  // Write out all the object fields, pcs are written relative to the entry
+  // point and the comments are not written.
+  writer->WriteObjectRef(instrs->ptr()->object_pool_);
+  writer->WriteObjectRef(ptr()->function_);
+  if (ptr()->pc_descriptors_ != PcDescriptors::null()) {
+    writer->Write<int8_t>(1);
+    writer->WritePcDescriptors(ptr()->pc_descriptors_, entry_point);
+  } else {
+    writer->Write<int8_t>(0);
+  }
+  if (ptr()->exception_handlers_ != ExceptionHandlers::null()) {
+    writer->Write<int8_t>(1);
+    writer->WriteExceptionHandlers(ptr()->exception_handlers_, entry_point);
+  } else {
+    writer->Write<int8_t>(0);
+  }
+  writer->WriteObjectRef(ptr()->deopt_info_array_);
+  writer->WriteObjectRef(ptr()->object_table_);
+  writer->WriteObjectRef(ptr()->static_calls_target_table_);
+  writer->WriteObjectRef(ptr()->stackmaps_);
+  writer->WriteObjectRef(ptr()->var_descriptors_);
+  writer->WriteObjectRef(ptr()->relocations_);
+
+  // Write out the external addresses embedded in the instructions.
+  writer->WriteCodeRelocations(this);
 }
 
 
@@ -1352,15 +1473,55 @@ RawStackmap* Stackmap::ReadFrom(SnapshotReader* reader,
                                 intptr_t object_id,
                                 intptr_t tags,
                                 Snapshot::Kind kind) {
-  UNREACHABLE();
-  return Stackmap::null();
+  ASSERT(reader != NULL);
+  ASSERT(kind == Snapshot::kFull);
+
+  // The code was read before its stack maps.
+  dart::Code& code = dart::Code::Handle(reader->isolate());
+  code ^= reader->ReadObjectRef();
+
+  // Allocate stack map object.
+  intptr_t length = reader->ReadIntptrValue();
+  Stackmap& result = Stackmap::ZoneHandle(reader->isolate(),
+                                          reader->NewStackmap(length));
+  reader->AddBackRef(object_id, &result, kIsDeserialized);
+
+  // Set the object tags.
+  result.set_tags(tags);
+
+  // Set all the fields.
+  result.raw_ptr()->code_ = code.raw();
+  result.SetRegisterBitCount(reader->ReadIntptrValue());
+  result.SetPC(code.EntryPoint() + reader->ReadIntptrValue());
+  intptr_t payload_size = Utils::RoundUp(length, kBitsPerByte) / kBitsPerByte;
+  reader->ReadBytes(result.raw_ptr()->data_, payload_size);
+
+  return result.raw();
 }
 
 
 void RawStackmap::WriteTo(SnapshotWriter* writer,
                           intptr_t object_id,
                           Snapshot::Kind kind) {
-  UNREACHABLE();
+  ASSERT(writer != NULL);
+  ASSERT(kind == Snapshot::kFull);
+
+  // Write out the serialization header value for this object.
+  writer->WriteInlinedObjectHeader(object_id);
+
+  // Write out the class and tags information.
+  writer->WriteVMIsolateObject(kStackmapCid);
+  writer->WriteIntptrValue(writer->GetObjectTags(this));
+
+  // Write out the code first, the pc is written relative to its entry point.
+  writer->WriteObjectRef(ptr()->code_);
+  writer->WriteIntptrValue(ptr()->length_);
+  writer->WriteIntptrValue(ptr()->register_bit_count_);
+  writer->WriteIntptrValue(
+      ptr()->pc_ - SnapshotWriter::CodeEntryPoint(ptr()->code_));
+  intptr_t payload_size =
+      Utils::RoundUp(ptr()->length_, kBitsPerByte) / kBitsPerByte;
+  writer->WriteBytes(ptr()->data_, payload_size);
 }
 
 
@@ -1368,15 +1529,47 @@ RawLocalVarDescriptors* LocalVarDescriptors::ReadFrom(SnapshotReader* reader,
                                                       intptr_t object_id,
                                                       intptr_t tags,
                                                       Snapshot::Kind kind) {
-  UNREACHABLE();
-  return LocalVarDescriptors::null();
+  ASSERT(reader != NULL);
+  ASSERT(kind == Snapshot::kFull);
+
+  // Allocate local variable descriptors object.
+  intptr_t num_vars = reader->ReadIntptrValue();
+  LocalVarDescriptors& result = LocalVarDescriptors::ZoneHandle(
+      reader->isolate(), reader->NewLocalVarDescriptors(num_vars));
+  reader->AddBackRef(object_id, &result, kIsDeserialized);
+
+  // Set the object tags.
+  result.set_tags(tags);
+
+  // Set all the fields.
+  result.raw_ptr()->names_ =
+      reinterpret_cast<RawArray*>(reader->ReadObjectRef());
+  reader->ReadBytes(reinterpret_cast<uint8_t*>(result.raw_ptr()->data_),
+                    num_vars * sizeof(RawLocalVarDescriptors::VarInfo));
+
+  return result.raw();
 }
 
 
 void RawLocalVarDescriptors::WriteTo(SnapshotWriter* writer,
                                      intptr_t object_id,
                                      Snapshot::Kind kind) {
-  UNREACHABLE();
+  ASSERT(writer != NULL);
+  ASSERT(kind == Snapshot::kFull);
+
+  // Write out the serialization header value for this object.
+  writer->WriteInlinedObjectHeader(object_id);
+
+  // Write out the class and tags information.
+  writer->WriteVMIsolateObject(kLocalVarDescriptorsCid);
+  writer->WriteIntptrValue(writer->GetObjectTags(this));
+
+  // Write out all the fields.
+  writer->WriteIntptrValue(ptr()->length_);
+  SnapshotWriterVisitor visitor(writer);
+  visitor.VisitPointer(reinterpret_cast<RawObject**>(&ptr()->names_));
+  writer->WriteBytes(reinterpret_cast<uint8_t*>(ptr()->data_),
+                     ptr()->length_ * sizeof(VarInfo));
 }
 
 
@@ -1491,15 +1684,55 @@ RawICData* ICData::ReadFrom(SnapshotReader* reader,
                             intptr_t object_id,
                             intptr_t tags,
                             Snapshot::Kind kind) {
-  UNREACHABLE();
-  return NULL;
+  ASSERT(reader != NULL);
+  ASSERT(kind == Snapshot::kFull);
+
+  // Allocate IC data object.
+  ICData& result = ICData::ZoneHandle(reader->isolate(), reader->NewICData());
+  reader->AddBackRef(object_id, &result, kIsDeserialized);
+
+  // Set the object tags.
+  result.set_tags(tags);
+
+  // Set all non object fields.
+  result.set_deopt_id(reader->ReadIntptrValue());
+  result.set_num_args_tested(reader->ReadIntptrValue());
+  result.raw_ptr()->deopt_reason_ = reader->Read<uint8_t>();
+  result.raw_ptr()->is_closure_call_ = reader->Read<uint8_t>();
+
+  // Set all the object fields.
+  intptr_t num_flds = (result.raw()->to() - result.raw()->from());
+  for (intptr_t i = 0; i <= num_flds; i++) {
+    *(result.raw()->from() + i) = reader->ReadObjectRef();
+  }
+
+  return result.raw();
 }
 
 
 void RawICData::WriteTo(SnapshotWriter* writer,
                         intptr_t object_id,
                         Snapshot::Kind kind) {
-  UNREACHABLE();
+  ASSERT(writer != NULL);
+  // IC data is only written as part of code in full snapshots.
+  ASSERT(kind == Snapshot::kFull);
+
+  // Write out the serialization header value for this object.
+  writer->WriteInlinedObjectHeader(object_id);
+
+  // Write out the class and tags information.
+  writer->WriteVMIsolateObject(kICDataCid);
+  writer->WriteIntptrValue(writer->GetObjectTags(this));
+
+  // Write out all the non object fields.
+  writer->WriteIntptrValue(ptr()->deopt_id_);
+  writer->WriteIntptrValue(ptr()->num_args_tested_);
+  writer->Write<uint8_t>(ptr()->deopt_reason_);
+  writer->Write<uint8_t>(ptr()->is_closure_call_);
+
+  // Write out all the object pointer fields.
+  SnapshotWriterVisitor visitor(writer);
+  visitor.VisitPointers(from(), to());
 }
 
 
@@ -1523,15 +1756,42 @@ RawSubtypeTestCache* SubtypeTestCache::ReadFrom(SnapshotReader* reader,
                                                 intptr_t object_id,
                                                 intptr_t tags,
                                                 Snapshot::Kind kind) {
-  UNREACHABLE();
-  return NULL;
+  ASSERT(reader != NULL);
+  ASSERT(kind == Snapshot::kFull);
+
+  // Allocate subtype test cache object.
+  SubtypeTestCache& result = SubtypeTestCache::ZoneHandle(
+      reader->isolate(), reader->NewSubtypeTestCache());
+  reader->AddBackRef(object_id, &result, kIsDeserialized);
+
+  // Set the object tags.
+  result.set_tags(tags);
+
+  // Set all the object fields.
+  result.raw_ptr()->cache_ =
+      reinterpret_cast<RawArray*>(reader->ReadObjectRef());
+
+  return result.raw();
 }
 
 
 void RawSubtypeTestCache::WriteTo(SnapshotWriter* writer,
                                   intptr_t object_id,
                                   Snapshot::Kind kind) {
-  UNREACHABLE();
+  ASSERT(writer != NULL);
+  // Subtype test caches are only written as part of code in full snapshots.
+  ASSERT(kind == Snapshot::kFull);
+
+  // Write out the serialization header value for this object.
+  writer->WriteInlinedObjectHeader(object_id);
+
+  // Write out the class and tags information.
+  writer->WriteVMIsolateObject(kSubtypeTestCacheCid);
+  writer->WriteIntptrValue(writer->GetObjectTags(this));
+
+  // Write out all the object pointer fields.
+  SnapshotWriterVisitor visitor(writer);
+  visitor.VisitPointer(reinterpret_cast<RawObject**>(&ptr()->cache_));
 }
 
 
@@ -1945,13 +2205,21 @@ RawOneByteString* OneByteString::ReadFrom(SnapshotReader* reader,
 
   if (kind == Snapshot::kFull) {
     ASSERT(reader->isolate()->no_gc_scope_depth() != 0);
-    RawOneByteString* obj = reader->NewOneByteString(len);
-    str_obj = obj;
-    str_obj.set_tags(tags);
-    obj->ptr()->hash_ = Smi::New(hash);
-    if (len > 0) {
-      uint8_t* raw_ptr = CharAddr(str_obj, 0);
-      reader->ReadBytes(raw_ptr, len);
+    RawOneByteString* obj = NULL;
+    if (RawObject::IsCanonical(tags)) {
+      obj = reader->ReadSharedSymbol(len, hash);
+    }
+    if (obj != NULL) {
+      str_obj = obj;
+    } else {
+      obj = reader->NewOneByteString(len);
+      str_obj = obj;
+      str_obj.set_tags(tags);
+      obj->ptr()->hash_ = Smi::New(hash);
+      if (len > 0) {
+        uint8_t* raw_ptr = CharAddr(str_obj, 0);
+        reader->ReadBytes(raw_ptr, len);
+      }
     }
     ASSERT((hash == 0) || (String::Hash(str_obj, 0, str_obj.Length()) == hash));
   } else {
@@ -2500,6 +2768,21 @@ void RawExternalTypedData::WriteTo(SnapshotWriter* writer,
   // Write out the serialization header value for this object.
   writer->WriteInlinedObjectHeader(object_id);
 
+  if (kind == Snapshot::kMessage) {
+    FinalizablePersistentHandle* handle = writer->TransferExternalData(this);
+    if (handle != NULL) {
+      // Hand the backing store and its finalizer over to the receiver in the
+      // same format ExternalTypedData::ReadFrom expects.
+      writer->WriteIndexedObject(cid);
+      writer->WriteIntptrValue(tags);
+      writer->Write<RawObject*>(ptr()->length_);
+      writer->WriteIntptrValue(reinterpret_cast<intptr_t>(ptr()->data_));
+      writer->WriteIntptrValue(reinterpret_cast<intptr_t>(handle->peer()));
+      writer->WriteIntptrValue(reinterpret_cast<intptr_t>(handle->callback()));
+      return;
+    }
+  }
+
   switch (cid) {
     case kExternalTypedDataInt8ArrayCid:
       EXT_TYPED_DATA_WRITE(kTypedDataInt8ArrayCid, int8_t);
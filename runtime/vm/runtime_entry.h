@@ -28,7 +28,10 @@ class RuntimeEntry : public ValueObject {
         function_(function),
         argument_count_(argument_count),
         is_leaf_(is_leaf),
-        is_float_(is_float) { }
+        is_float_(is_float),
+        next_(list_) {
+    list_ = this;
+  }
   ~RuntimeEntry() {}
 
   const char* name() const { return name_; }
@@ -41,6 +44,11 @@ class RuntimeEntry : public ValueObject {
   // Generate code to call the runtime entry.
   void Call(Assembler* assembler, intptr_t argument_count) const;
 
+  // Return the runtime entry with the given name or entry point, or NULL.
+  // Used to relocate code loaded from a snapshot.
+  static const RuntimeEntry* LookupByName(const char* name);
+  static const RuntimeEntry* LookupByEntryPoint(uword entry_point);
+
  private:
   const char* name_;
   const RuntimeFunction function_;
@@ -48,6 +56,10 @@ class RuntimeEntry : public ValueObject {
   const bool is_leaf_;
   const bool is_float_;
 
+  // All runtime entries are statically allocated and linked on construction.
+  const RuntimeEntry* next_;
+  static const RuntimeEntry* list_;
+
   DISALLOW_COPY_AND_ASSIGN(RuntimeEntry);
 };
 
@@ -8,12 +8,17 @@
 #include <map>
 #include <utility>
 
+#include "vm/atomic.h"
 #include "vm/dart.h"
 #include "vm/dart_api_state.h"
+#include "vm/freelist.h"
+#include "vm/gc_marker.h"
 #include "vm/isolate.h"
+#include "vm/marking_stack.h"
 #include "vm/object.h"
 #include "vm/stack_frame.h"
 #include "vm/store_buffer.h"
+#include "vm/thread_pool.h"
 #include "vm/verifier.h"
 #include "vm/visitor.h"
 #include "vm/weak_table.h"
@@ -23,6 +28,18 @@ namespace dart {
 
   DEFINE_FLAG(int, early_tenuring_threshold, 66, "Skip TO space when promoting"
                                                  " above this percentage.");
+DEFINE_FLAG(int, new_gen_min_heap_size, 4,
+            "The initial and minimum size of the new gen heap in MB. It grows "
+            "up to --new_gen_heap_size while scavenges stay short.");
+DEFINE_FLAG(int, scavenge_pause_target_in_us, 5000,
+            "The scavenge pause in microseconds the new gen heap is sized "
+            "for.");
+DEFINE_FLAG(int, tenuring_age, 2,
+            "Promote new gen objects once they survive this many scavenges, "
+            "at most 4.");
+DEFINE_FLAG(int, scavenger_tasks, 0,
+            "The number of tasks used to scavenge new-space objects in "
+            "parallel. Values below 2 scavenge on the isolate's thread only.");
 
 // Scavenger uses RawObject::kMarkBit to distinguish forwaded and non-forwarded
 // objects. The kMarkBit does not intersect with the target address because of
@@ -69,20 +86,33 @@ class BoolScope : public ValueObject {
 };
 
 
+// With a work stack, the visitor is one of the tasks of a parallel scavenge.
+// It then copies objects into private copy and promotion buffers, installs
+// forwarding addresses atomically and pushes the copies on its work stack
+// instead of leaving them to a scan of the to space.
 class ScavengerVisitor : public ObjectPointerVisitor {
  public:
-  explicit ScavengerVisitor(Isolate* isolate, Scavenger* scavenger)
+  ScavengerVisitor(Isolate* isolate,
+                   Scavenger* scavenger,
+                   MarkingStack* work_stack = NULL)
       : ObjectPointerVisitor(isolate),
         scavenger_(scavenger),
         heap_(scavenger->heap_),
         vm_heap_(Dart::vm_isolate()->heap()),
         visited_count_(0),
         handled_count_(0),
+        store_buffer_visited_count_(0),
+        store_buffer_handled_count_(0),
         delayed_weak_stack_(),
         growth_policy_(PageSpace::kControlGrowth),
         bytes_promoted_(0),
         visiting_old_object_(NULL),
-        in_scavenge_pointer_(false) { }
+        in_scavenge_pointer_(false),
+        work_stack_(work_stack),
+        copy_top_(0),
+        copy_end_(0),
+        promotion_top_(0),
+        promotion_end_(0) { }
 
   void VisitPointers(RawObject** first, RawObject** last) {
     for (RawObject** current = first; current <= last; current++) {
@@ -99,7 +129,16 @@ class ScavengerVisitor : public ObjectPointerVisitor {
     visiting_old_object_ = obj;
   }
 
+  MarkingStack* work_stack() const { return work_stack_; }
+  bool is_parallel() const { return work_stack_ != NULL; }
+
   void DelayWeakProperty(RawWeakProperty* raw_weak) {
+    if (is_parallel()) {
+      // Another task may still copy the key, so the watched bit cannot be
+      // used. The property is processed again once all tasks are done.
+      deferred_weak_properties_.Push(raw_weak);
+      return;
+    }
     RawObject* raw_key = raw_weak->ptr()->key_;
     DelaySet::iterator it = delay_set_.find(raw_key);
     if (it != delay_set_.end()) {
@@ -122,7 +161,147 @@ class ScavengerVisitor : public ObjectPointerVisitor {
   intptr_t handled_count() const { return handled_count_; }
   intptr_t bytes_promoted() const { return bytes_promoted_; }
 
+  intptr_t store_buffer_visited_count() const {
+    return store_buffer_visited_count_;
+  }
+  intptr_t store_buffer_handled_count() const {
+    return store_buffer_handled_count_;
+  }
+  void AddStoreBufferCounts(intptr_t visited, intptr_t handled) {
+    store_buffer_visited_count_ += visited;
+    store_buffer_handled_count_ += handled;
+  }
+
+  // Takes over the counts of a parallel scavenging task.
+  void AddCounts(ScavengerVisitor* task_visitor) {
+    ASSERT(!is_parallel() && task_visitor->is_parallel());
+    visited_count_ += task_visitor->visited_count_;
+    handled_count_ += task_visitor->handled_count_;
+    bytes_promoted_ += task_visitor->bytes_promoted_;
+    AddStoreBufferCounts(task_visitor->store_buffer_visited_count_,
+                         task_visitor->store_buffer_handled_count_);
+  }
+
+  // Returns NULL once all deferred weak properties have been handed out.
+  RawWeakProperty* PopDeferredWeakProperty() {
+    if (deferred_weak_properties_.IsEmpty()) {
+      return NULL;
+    }
+    return reinterpret_cast<RawWeakProperty*>(deferred_weak_properties_.Pop());
+  }
+
+  // Makes the unused end of the copy buffer walkable and gives the unused
+  // end of the promotion buffer back to old space.
+  void RetireBuffers() {
+    RetireBuffer(&copy_top_, &copy_end_, false);
+    RetireBuffer(&promotion_top_, &promotion_end_, true);
+  }
+
  private:
+  // Sizes of the private buffers of a parallel scavenging task. Larger
+  // objects are allocated directly.
+  static const intptr_t kCopyBufferSize = 32 * KB;
+  static const intptr_t kPromotionBufferSize = 32 * KB;
+
+  void RetireBuffer(uword* top, uword* end, bool promote) {
+    if (*top < *end) {
+      if (promote) {
+        scavenger_->UnpromoteShared(*top, *end - *top);
+      } else {
+        FreeListElement::AsElement(*top, *end - *top);
+      }
+    }
+    *top = 0;
+    *end = 0;
+  }
+
+  // Bump allocates from the buffer [*top, *end), refilling it if needed.
+  // Returns 0 if no memory is left.
+  uword TryAllocateInBuffer(intptr_t size,
+                            intptr_t buffer_size,
+                            uword* top,
+                            uword* end,
+                            bool promote) {
+    if (size > static_cast<intptr_t>(*end - *top)) {
+      if (size > (buffer_size / 4)) {
+        return promote ? scavenger_->TryPromoteShared(size)
+                       : scavenger_->TryAllocateShared(size);
+      }
+      RetireBuffer(top, end, promote);
+      uword buffer = promote ? scavenger_->TryPromoteShared(buffer_size)
+                             : scavenger_->TryAllocateShared(buffer_size);
+      if (buffer == 0) {
+        return promote ? scavenger_->TryPromoteShared(size)
+                       : scavenger_->TryAllocateShared(size);
+      }
+      *top = buffer;
+      *end = buffer + buffer_size;
+    }
+    uword result = *top;
+    *top += size;
+    return result;
+  }
+
+  // Gives back the memory of a copy that lost the race to forward an object.
+  void UndoAllocation(uword addr, intptr_t size, bool promoted) {
+    uword* top = promoted ? &promotion_top_ : &copy_top_;
+    if ((addr + size) == *top) {
+      *top = addr;
+    } else if (promoted) {
+      // Directly allocated in old space.
+      scavenger_->UnpromoteShared(addr, size);
+    } else {
+      // Directly allocated in the to space, keep the memory walkable.
+      FreeListElement::AsElement(addr, size);
+    }
+  }
+
+  uword CopyParallel(RawObject* raw_obj, uword header) {
+    uword raw_addr = RawObject::ToAddr(raw_obj);
+    // The header is only read once, as another task may replace it with a
+    // forwarding address at any time.
+    intptr_t size = raw_obj->SizeFromTags(header);
+    bool promoted = false;
+    uword new_addr = 0;
+    if (scavenger_->ShouldPromote(header)) {
+      new_addr = TryAllocateInBuffer(size, kPromotionBufferSize,
+                                     &promotion_top_, &promotion_end_, true);
+      promoted = (new_addr != 0);
+    }
+    if (new_addr == 0) {
+      new_addr = TryAllocateInBuffer(size, kCopyBufferSize,
+                                     &copy_top_, &copy_end_, false);
+    }
+    if (new_addr == 0) {
+      // The to space can run out as the ends of the copy buffers are not
+      // used. Promote the object instead.
+      new_addr = TryAllocateInBuffer(size, kPromotionBufferSize,
+                                     &promotion_top_, &promotion_end_, true);
+      promoted = (new_addr != 0);
+    }
+    if (new_addr == 0) {
+      FATAL("Out of memory during a parallel scavenge.\n");
+    }
+    memmove(reinterpret_cast<void*>(new_addr),
+            reinterpret_cast<void*>(raw_addr),
+            size);
+    *reinterpret_cast<uword*>(new_addr) =
+        Scavenger::CopiedTags(header, promoted);
+    ASSERT((new_addr & kForwardingMask) == 0);
+    uword previous = AtomicOperations::CompareAndSwapWord(
+        reinterpret_cast<uword*>(raw_addr), header, new_addr | kForwarded);
+    if (previous != header) {
+      // Another task copied the object first.
+      UndoAllocation(new_addr, size, promoted);
+      return ForwardedAddr(previous);
+    }
+    if (promoted) {
+      bytes_promoted_ += size;
+    }
+    work_stack_->Push(RawObject::FromAddr(new_addr));
+    return new_addr;
+  }
+
   void UpdateStoreBuffer(RawObject** p, RawObject* obj) {
     uword ptr = reinterpret_cast<uword>(p);
     ASSERT(obj->IsHeapObject());
@@ -134,7 +313,12 @@ class ScavengerVisitor : public ObjectPointerVisitor {
       return;
     }
     visiting_old_object_->SetRememberedBit();
-    isolate()->store_buffer()->AddObjectGC(visiting_old_object_);
+    if (is_parallel()) {
+      work_stack_->work_list()->AddToStoreBuffer(isolate(),
+                                                 visiting_old_object_);
+    } else {
+      isolate()->store_buffer()->AddObjectGC(visiting_old_object_);
+    }
   }
 
   void ScavengePointer(RawObject** p) {
@@ -169,6 +353,8 @@ class ScavengerVisitor : public ObjectPointerVisitor {
     if (IsForwarding(header)) {
       // Get the new location of the object.
       new_addr = ForwardedAddr(header);
+    } else if (is_parallel()) {
+      new_addr = CopyParallel(raw_obj, header);
     } else {
       if (raw_obj->IsWatched()) {
         raw_obj->ClearWatchedBit();
@@ -186,17 +372,12 @@ class ScavengerVisitor : public ObjectPointerVisitor {
       }
       intptr_t size = raw_obj->Size();
       // Check whether object should be promoted.
-      if (scavenger_->survivor_end_ <= raw_addr) {
-        // Not a survivor of a previous scavenge. Just copy the object into the
-        // to space.
+      if (!scavenger_->ShouldPromote(header)) {
+        // Too young to be promoted. Just copy the object into the to space.
         new_addr = scavenger_->TryAllocate(size);
       } else {
-        // TODO(iposva): Experiment with less aggressive promotion. For example
-        // a coin toss determines if an object is promoted or whether it should
-        // survive in this generation.
-        //
-        // This object is a survivor of a previous scavenge. Attempt to promote
-        // the object.
+        // This object survived enough scavenges. Attempt to promote the
+        // object.
         new_addr = heap_->TryAllocate(size, Heap::kOld, growth_policy_);
         if (new_addr != 0) {
           // If promotion succeeded then we need to remember it so that it can
@@ -231,6 +412,10 @@ class ScavengerVisitor : public ObjectPointerVisitor {
       memmove(reinterpret_cast<void*>(new_addr),
               reinterpret_cast<void*>(raw_addr),
               size);
+      // The watched bit may have been cleared since the header was read.
+      uword* new_header = reinterpret_cast<uword*>(new_addr);
+      *new_header = Scavenger::CopiedTags(
+          *new_header, !scavenger_->to_->Contains(new_addr));
       // Remember forwarding address.
       ForwardTo(raw_addr, new_addr);
     }
@@ -248,6 +433,8 @@ class ScavengerVisitor : public ObjectPointerVisitor {
   Heap* vm_heap_;
   intptr_t visited_count_;
   intptr_t handled_count_;
+  intptr_t store_buffer_visited_count_;
+  intptr_t store_buffer_handled_count_;
   typedef std::multimap<RawObject*, RawWeakProperty*> DelaySet;
   DelaySet delay_set_;
   GrowableArray<RawObject*> delayed_weak_stack_;
@@ -258,6 +445,14 @@ class ScavengerVisitor : public ObjectPointerVisitor {
   RawObject* visiting_old_object_;
   bool in_scavenge_pointer_;
 
+  // Only used by the tasks of a parallel scavenge.
+  MarkingStack* work_stack_;
+  MarkingStack deferred_weak_properties_;
+  uword copy_top_;
+  uword copy_end_;
+  uword promotion_top_;
+  uword promotion_end_;
+
   DISALLOW_COPY_AND_ASSIGN(ScavengerVisitor);
 };
 
@@ -306,12 +501,22 @@ class VerifyStoreBufferPointerVisitor : public ObjectPointerVisitor {
 };
 
 
+// The smallest size of a semispace, bounded by the reserved size.
+static intptr_t MinSemiSpaceSize(intptr_t max_semi_space_size) {
+  intptr_t size = Utils::RoundUp((FLAG_new_gen_min_heap_size * MB) / 2,
+                                 VirtualMemory::PageSize());
+  size = Utils::Maximum(size, VirtualMemory::PageSize());
+  return Utils::Minimum(size, max_semi_space_size);
+}
+
+
 Scavenger::Scavenger(Heap* heap,
                      intptr_t max_capacity_in_words,
                      uword object_alignment)
     : heap_(heap),
       object_alignment_(object_alignment),
-      scavenging_(false) {
+      scavenging_(false),
+      promotion_mutex_(new Mutex()) {
   // Verify assumptions about the first word in objects which the scavenger is
   // going to use for forwarding pointers.
   ASSERT(Object::tags_offset() == 0);
@@ -325,12 +530,14 @@ Scavenger::Scavenger(Heap* heap,
   // Allocate the entire space at the beginning.
   space_->Commit(false);
 
-  // Setup the semi spaces.
+  // Setup the semi spaces. They start out at their minimum size and are
+  // resized within their halves of the space, see AdjustCapacity.
   uword semi_space_size = space_->size() / 2;
   ASSERT((semi_space_size & (VirtualMemory::PageSize() - 1)) == 0);
-  to_ = new MemoryRegion(space_->address(), semi_space_size);
+  intptr_t initial_size = MinSemiSpaceSize(semi_space_size);
+  to_ = new MemoryRegion(space_->address(), initial_size);
   uword middle = space_->start() + semi_space_size;
-  from_ = new MemoryRegion(reinterpret_cast<void*>(middle), semi_space_size);
+  from_ = new MemoryRegion(reinterpret_cast<void*>(middle), initial_size);
 
   // Make sure that the two semi-spaces are aligned properly.
   ASSERT(Utils::IsAligned(to_->start(), kObjectAlignment));
@@ -341,11 +548,10 @@ Scavenger::Scavenger(Heap* heap,
   resolved_top_ = top_;
   end_ = to_->end();
 
-  survivor_end_ = FirstObjectStart();
+  early_tenuring_ = false;
 
 #if defined(DEBUG)
-  memset(to_->pointer(), 0xf3, to_->size());
-  memset(from_->pointer(), 0xf3, from_->size());
+  memset(space_->address(), 0xf3, space_->size());
 #endif  // defined(DEBUG)
 }
 
@@ -354,6 +560,7 @@ Scavenger::~Scavenger() {
   delete to_;
   delete from_;
   delete space_;
+  delete promotion_mutex_;
 }
 
 
@@ -368,7 +575,8 @@ void Scavenger::Prologue(Isolate* isolate, bool invoke_api_callbacks) {
   to_ = temp;
   top_ = FirstObjectStart();
   resolved_top_ = top_;
-  end_ = to_->end();
+  // All survivors fit into a to space as large as the from space.
+  ResizeToSpace(from_->size());
 }
 
 
@@ -380,14 +588,9 @@ void Scavenger::Epilogue(Isolate* isolate,
   int promotion_ratio = static_cast<int>(
       (static_cast<double>(visitor->bytes_promoted()) /
        static_cast<double>(to_->size())) * 100.0);
-  if (promotion_ratio < FLAG_early_tenuring_threshold) {
-    // Remember the limit to which objects have been copied.
-    survivor_end_ = top_;
-  } else {
-    // Move survivor end to the end of the to_ space, making all surviving
-    // objects candidates for promotion.
-    survivor_end_ = end_;
-  }
+  // Above the threshold, all surviving objects are candidates for promotion
+  // in the next scavenge regardless of their age.
+  early_tenuring_ = (promotion_ratio >= FLAG_early_tenuring_threshold);
 
 #if defined(DEBUG)
   VerifyStoreBufferPointerVisitor verify_store_buffer_visitor(isolate, to_);
@@ -401,35 +604,107 @@ void Scavenger::Epilogue(Isolate* isolate,
 }
 
 
-void Scavenger::IterateStoreBuffers(Isolate* isolate,
-                                    ScavengerVisitor* visitor) {
-  StoreBuffer* buffer = isolate->store_buffer();
-  heap_->RecordData(kStoreBufferEntries, buffer->Count());
+void Scavenger::ResizeToSpace(intptr_t size) {
+  ASSERT(Utils::IsAligned(size, VirtualMemory::PageSize()));
+  ASSERT(top_ <= (to_->start() + size));
+  // The whole space stays committed, a semispace only moves its end within
+  // its half of the space.
+  MemoryRegion semi_space(to_->pointer(), space_->size() / 2);
+  to_->Subregion(semi_space, 0, size);
+  end_ = to_->end();
+}
 
-  // Iterating through the store buffers.
-  // Grab the deduplication sets out of the store buffer.
+
+void Scavenger::AdjustCapacity(intptr_t used_before_in_words,
+                               int64_t pause_in_us) {
+  // At a steady survival rate, the survivors and with them the pause grow
+  // with the capacity. Shrink when the pause is over the target, and grow
+  // when it is well below while the mutator fills the space.
+  ASSERT(!PromotedStackHasMore());
+  intptr_t size = to_->size();
+  if (pause_in_us > FLAG_scavenge_pause_target_in_us) {
+    size /= 2;
+  } else if ((2 * pause_in_us <= FLAG_scavenge_pause_target_in_us) &&
+             ((used_before_in_words << kWordSizeLog2) >= (size / 2))) {
+    size *= 2;
+  }
+  const intptr_t max_size = space_->size() / 2;
+  size = Utils::Minimum(size, max_size);
+  size = Utils::Maximum(size, MinSemiSpaceSize(max_size));
+  // The survivors stay where they are.
+  intptr_t used = Utils::RoundUp(top_ - to_->start(),
+                                 VirtualMemory::PageSize());
+  ResizeToSpace(Utils::Maximum(size, used));
+}
+
+
+// Grabs the deduplication sets out of the store buffer. The caller owns the
+// returned array and the blocks in it.
+static StoreBufferBlock** TakeStoreBufferBlocks(Isolate* isolate,
+                                                intptr_t* num_blocks) {
+  intptr_t count = 0;
   StoreBufferBlock* pending = isolate->store_buffer()->Blocks();
+  for (StoreBufferBlock* block = pending;
+       block != NULL;
+       block = block->next()) {
+    count++;
+  }
+  StoreBufferBlock** blocks = new StoreBufferBlock*[count];
+  for (intptr_t i = 0; i < count; i++) {
+    blocks[i] = pending;
+    pending = pending->next();
+  }
+  *num_blocks = count;
+  return blocks;
+}
+
+
+void Scavenger::IterateStoreBufferBlocks(StoreBufferBlock** blocks,
+                                         intptr_t num_blocks,
+                                         intptr_t first_block,
+                                         intptr_t block_stride,
+                                         ScavengerVisitor* visitor) {
   intptr_t visited_count_before = visitor->visited_count();
   intptr_t handled_count_before = visitor->handled_count();
-  while (pending != NULL) {
-    StoreBufferBlock* next = pending->next();
-    intptr_t count = pending->Count();
+  for (intptr_t b = first_block; b < num_blocks; b += block_stride) {
+    StoreBufferBlock* block = blocks[b];
+    intptr_t count = block->Count();
     for (intptr_t i = 0; i < count; i++) {
-      RawObject* raw_object = pending->At(i);
+      RawObject* raw_object = block->At(i);
       ASSERT(raw_object->IsRemembered());
       raw_object->ClearRememberedBit();
       visitor->VisitingOldObject(raw_object);
       raw_object->VisitPointers(visitor);
     }
-    delete pending;
-    pending = next;
+    delete block;
+    blocks[b] = NULL;
   }
-  heap_->RecordData(kStoreBufferVisited,
-                    visitor->visited_count() - visited_count_before);
-  heap_->RecordData(kStoreBufferPointers,
-                    visitor->handled_count() - handled_count_before);
   // Done iterating through old objects remembered in the store buffers.
   visitor->VisitingOldObject(NULL);
+  visitor->AddStoreBufferCounts(
+      visitor->visited_count() - visited_count_before,
+      visitor->handled_count() - handled_count_before);
+}
+
+
+void Scavenger::IterateStoreBuffers(Isolate* isolate,
+                                    ScavengerVisitor* visitor) {
+  StoreBuffer* buffer = isolate->store_buffer();
+  heap_->RecordData(kStoreBufferEntries, buffer->Count());
+
+  // Iterating through the store buffers.
+  intptr_t num_blocks = 0;
+  StoreBufferBlock** blocks = TakeStoreBufferBlocks(isolate, &num_blocks);
+  intptr_t visited_count_before = visitor->store_buffer_visited_count();
+  intptr_t handled_count_before = visitor->store_buffer_handled_count();
+  IterateStoreBufferBlocks(blocks, num_blocks, 0, 1, visitor);
+  delete[] blocks;
+  heap_->RecordData(kStoreBufferVisited,
+                    visitor->store_buffer_visited_count() -
+                    visited_count_before);
+  heap_->RecordData(kStoreBufferPointers,
+                    visitor->store_buffer_handled_count() -
+                    handled_count_before);
 }
 
 
@@ -462,6 +737,176 @@ void Scavenger::IterateRoots(Isolate* isolate,
 }
 
 
+uword Scavenger::TryAllocateShared(intptr_t size) {
+  ASSERT(Utils::IsAligned(size, kObjectAlignment));
+  // The end of the to space does not move during the parallel phase, as
+  // promoted objects are pushed on the work stacks instead of the promoted
+  // stack.
+  uword result;
+  do {
+    result = top_;
+    if (size > static_cast<intptr_t>(end_ - result)) {
+      return 0;
+    }
+  } while (AtomicOperations::CompareAndSwapWord(
+               &top_, result, result + size) != result);
+  return result;
+}
+
+
+uword Scavenger::TryPromoteShared(intptr_t size) {
+  // Follows the promotion policy of ScavengerVisitor::ScavengePointer: after
+  // the first promotion failure, all promotions force growth.
+  promotion_mutex_->Lock();
+  PageSpace::GrowthPolicy growth_policy = had_promotion_failure_ ?
+      PageSpace::kForceGrowth : PageSpace::kControlGrowth;
+  uword result = heap_->TryAllocate(size, Heap::kOld, growth_policy);
+  if ((result == 0) && !had_promotion_failure_) {
+    had_promotion_failure_ = true;
+    result = heap_->TryAllocate(size, Heap::kOld, PageSpace::kForceGrowth);
+  }
+  promotion_mutex_->Unlock();
+  return result;
+}
+
+
+void Scavenger::UnpromoteShared(uword addr, intptr_t size) {
+  promotion_mutex_->Lock();
+  heap_->FreeUnusedOld(addr, size);
+  promotion_mutex_->Unlock();
+}
+
+
+void Scavenger::DrainWorkStack(ScavengerVisitor* visitor) {
+  MarkingStack* work_stack = visitor->work_stack();
+  do {
+    while (!work_stack->IsEmpty()) {
+      RawObject* raw_obj = work_stack->Pop();
+      if (raw_obj->IsOldObject()) {
+        // Promoted objects are scanned strongly, as in ProcessToSpace.
+        visitor->VisitingOldObject(raw_obj);
+        raw_obj->VisitPointers(visitor);
+        visitor->VisitingOldObject(NULL);
+      } else if (raw_obj->GetClassId() == kWeakPropertyCid) {
+        RawWeakProperty* raw_weak = reinterpret_cast<RawWeakProperty*>(raw_obj);
+        ProcessWeakProperty(raw_weak, visitor);
+      } else {
+        raw_obj->VisitPointers(visitor);
+      }
+    }
+  } while (work_stack->Steal());
+}
+
+
+class ScavengerTask : public ThreadPool::Task {
+ public:
+  ScavengerTask(Scavenger* scavenger,
+                Isolate* isolate,
+                ScavengerVisitor* visitor,
+                StoreBufferBlock** blocks,
+                intptr_t num_blocks,
+                intptr_t task_index,
+                intptr_t num_tasks)
+      : scavenger_(scavenger),
+        isolate_(isolate),
+        visitor_(visitor),
+        blocks_(blocks),
+        num_blocks_(num_blocks),
+        task_index_(task_index),
+        num_tasks_(num_tasks) {
+  }
+
+  virtual void Run() {
+    Isolate::SetCurrentHelper(isolate_);
+    scavenger_->IterateStoreBufferBlocks(blocks_, num_blocks_,
+                                         task_index_, num_tasks_, visitor_);
+    scavenger_->DrainWorkStack(visitor_);
+    Isolate::SetCurrentHelper(NULL);
+    // The work list is owned by the isolate's thread, which may release it
+    // as soon as the last task reports back.
+    visitor_->work_stack()->work_list()->TaskFinished();
+  }
+
+ private:
+  Scavenger* scavenger_;
+  Isolate* isolate_;
+  ScavengerVisitor* visitor_;
+  StoreBufferBlock** blocks_;
+  intptr_t num_blocks_;
+  intptr_t task_index_;
+  intptr_t num_tasks_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScavengerTask);
+};
+
+
+// Copies the live new-space objects with num_tasks tasks. The tasks share
+// the store buffer blocks, copy objects into private buffers, race to
+// install forwarding addresses with a compare-and-swap and balance their
+// work by stealing from each other's work stacks. Afterwards the to space
+// is fully scanned, and weak properties, weak references and weak handles
+// are processed serially with visitor.
+void Scavenger::ScavengeParallel(Isolate* isolate,
+                                 ScavengerVisitor* visitor,
+                                 bool visit_prologue_weak_persistent_handles,
+                                 intptr_t num_tasks) {
+  int64_t start = OS::GetCurrentTimeMicros();
+  heap_->RecordData(kStoreBufferEntries, isolate->store_buffer()->Count());
+  intptr_t num_blocks = 0;
+  StoreBufferBlock** blocks = TakeStoreBufferBlocks(isolate, &num_blocks);
+
+  MarkingWorkList work_list(num_tasks);
+  MarkingStack** work_stacks = new MarkingStack*[num_tasks];
+  ScavengerVisitor** task_visitors = new ScavengerVisitor*[num_tasks];
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    work_stacks[i] = new MarkingStack(&work_list);
+    task_visitors[i] = new ScavengerVisitor(isolate, this, work_stacks[i]);
+  }
+  for (intptr_t i = 1; i < num_tasks; i++) {
+    Dart::thread_pool()->Run(new ScavengerTask(this, isolate, task_visitors[i],
+                                               blocks, num_blocks,
+                                               i, num_tasks));
+  }
+  isolate->VisitObjectPointers(task_visitors[0],
+                               visit_prologue_weak_persistent_handles,
+                               StackFrameIterator::kDontValidateFrames);
+  IterateObjectIdTable(isolate, task_visitors[0]);
+  int64_t middle = OS::GetCurrentTimeMicros();
+  IterateStoreBufferBlocks(blocks, num_blocks, 0, num_tasks,
+                           task_visitors[0]);
+  DrainWorkStack(task_visitors[0]);
+  work_list.WaitForHelperTasks();
+  delete[] blocks;
+
+  // Everything copied so far has been scanned by the tasks.
+  resolved_top_ = top_;
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    task_visitors[i]->RetireBuffers();
+    visitor->AddCounts(task_visitors[i]);
+  }
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    // Weak properties whose keys had not been copied when a task reached
+    // them are resolved serially, just like the rest of the weak processing.
+    RawWeakProperty* raw_weak;
+    while ((raw_weak = task_visitors[i]->PopDeferredWeakProperty()) != NULL) {
+      ProcessWeakProperty(raw_weak, visitor);
+    }
+    delete task_visitors[i];
+    delete work_stacks[i];
+  }
+  delete[] task_visitors;
+  delete[] work_stacks;
+  int64_t end = OS::GetCurrentTimeMicros();
+  heap_->RecordData(kStoreBufferVisited,
+                    visitor->store_buffer_visited_count());
+  heap_->RecordData(kStoreBufferPointers,
+                    visitor->store_buffer_handled_count());
+  heap_->RecordData(kToKBAfterStoreBuffer, RoundWordsToKB(UsedInWords()));
+  heap_->RecordTime(kVisitIsolateRoots, middle - start);
+  heap_->RecordTime(kIterateStoreBuffers, end - middle);
+}
+
+
 bool Scavenger::IsUnreachable(RawObject** p) {
   RawObject* raw_obj = *p;
   if (!raw_obj->IsHeapObject()) {
@@ -546,6 +991,8 @@ void Scavenger::IterateWeakRoots(Isolate* isolate,
 
 void Scavenger::ProcessToSpace(ScavengerVisitor* visitor) {
   GrowableArray<RawObject*>* delayed_weak_stack = visitor->DelayedWeakStack();
+  IncrementalMarker* incremental_marker =
+      Isolate::Current()->incremental_marker();
 
   // Iterate until all work has been drained.
   while ((resolved_top_ < top_) ||
@@ -568,6 +1015,10 @@ void Scavenger::ProcessToSpace(ScavengerVisitor* visitor) {
         // can potentially push more objects on this stack as well as add more
         // objects to be resolved in the to space.
         ASSERT(!raw_object->IsRemembered());
+        if (incremental_marker != NULL) {
+          // Old objects already scanned by the marker may now refer to it.
+          incremental_marker->MarkObject(raw_object);
+        }
         visitor->VisitingOldObject(raw_object);
         raw_object->VisitPointers(visitor);
       }
@@ -674,9 +1125,18 @@ void Scavenger::Scavenge(bool invoke_api_callbacks) {
   }
 
   // Setup the visitor and run a scavenge.
+  int64_t scavenge_start = OS::GetCurrentTimeMicros();
+  intptr_t used_before_in_words = UsedInWords();
   ScavengerVisitor visitor(isolate, this);
   Prologue(isolate, invoke_api_callbacks);
-  IterateRoots(isolate, &visitor, !invoke_api_callbacks);
+  // Objects promoted while old space is marked incrementally are grayed as
+  // they are taken off the promoted stack, which only a serial scavenge uses.
+  if ((FLAG_scavenger_tasks > 1) && (isolate->incremental_marker() == NULL)) {
+    ScavengeParallel(isolate, &visitor, !invoke_api_callbacks,
+                     FLAG_scavenger_tasks);
+  } else {
+    IterateRoots(isolate, &visitor, !invoke_api_callbacks);
+  }
   int64_t start = OS::GetCurrentTimeMicros();
   ProcessToSpace(&visitor);
   int64_t middle = OS::GetCurrentTimeMicros();
@@ -689,6 +1149,7 @@ void Scavenger::Scavenge(bool invoke_api_callbacks) {
   heap_->RecordTime(kProcessToSpace, middle - start);
   heap_->RecordTime(kIterateWeaks, end - middle);
   Epilogue(isolate, &visitor, invoke_api_callbacks);
+  AdjustCapacity(used_before_in_words, end - scavenge_start);
 
   if (FLAG_verify_after_gc) {
     OS::PrintErr("Verifying after Scavenge...");
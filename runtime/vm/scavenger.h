@@ -18,9 +18,12 @@ namespace dart {
 // Forward declarations.
 class Heap;
 class Isolate;
+class Mutex;
 class ScavengerVisitor;
+class StoreBufferBlock;
 
 DECLARE_FLAG(bool, gc_at_alloc);
+DECLARE_FLAG(int, tenuring_age);
 
 class Scavenger {
  public:
@@ -72,7 +75,11 @@ class Scavenger {
   intptr_t UsedInWords() const {
     return (top_ - FirstObjectStart()) >> kWordSizeLog2;
   }
-  intptr_t CapacityInWords() const { return space_->size() >> kWordSizeLog2; }
+  // The capacity of both semispaces, which adapts to the pauses of the
+  // scavenges, see AdjustCapacity.
+  intptr_t CapacityInWords() const {
+    return (2 * to_->size()) >> kWordSizeLog2;
+  }
 
   void VisitObjects(ObjectVisitor* visitor) const;
   void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
@@ -105,8 +112,37 @@ class Scavenger {
   };
 
   uword FirstObjectStart() const { return to_->start() | object_alignment_; }
+
+  // Objects are promoted once they have survived --tenuring_age scavenges.
+  // Ages saturate, larger values promote at the saturated age.
+  bool ShouldPromote(uword tags) const {
+    const intptr_t tenuring_age =
+        Utils::Minimum(static_cast<intptr_t>(FLAG_tenuring_age),
+                       RawObject::kMaxAge + 1);
+    return early_tenuring_ ||
+        ((RawObject::AgeFromTags(tags) + 1) >= tenuring_age);
+  }
+  // Returns the tags of the copy of an object: copies in the to space are
+  // one scavenge older, promoted copies start out with age 0.
+  static uword CopiedTags(uword tags, bool promoted) {
+    intptr_t age = 0;
+    if (!promoted) {
+      age = Utils::Minimum(RawObject::AgeFromTags(tags) + 1,
+                           RawObject::kMaxAge);
+    }
+    return RawObject::UpdateAge(age, tags);
+  }
+
+  // Sizes the semispaces for the next scavenge from the pause of this one.
+  void AdjustCapacity(intptr_t used_before_in_words, int64_t pause_in_us);
+  void ResizeToSpace(intptr_t size);
   void Prologue(Isolate* isolate, bool invoke_api_callbacks);
   void IterateStoreBuffers(Isolate* isolate, ScavengerVisitor* visitor);
+  void IterateStoreBufferBlocks(StoreBufferBlock** blocks,
+                                intptr_t num_blocks,
+                                intptr_t first_block,
+                                intptr_t block_stride,
+                                ScavengerVisitor* visitor);
   void IterateObjectIdTable(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateRoots(Isolate* isolate,
                     ScavengerVisitor* visitor,
@@ -117,6 +153,16 @@ class Scavenger {
                         HandleVisitor* visitor,
                         bool visit_prologue_weak_persistent_handles);
   void ProcessToSpace(ScavengerVisitor* visitor);
+
+  // Parallel scavenge, see ScavengeParallel.
+  void ScavengeParallel(Isolate* isolate,
+                        ScavengerVisitor* visitor,
+                        bool visit_prologue_weak_persistent_handles,
+                        intptr_t num_tasks);
+  void DrainWorkStack(ScavengerVisitor* visitor);
+  uword TryAllocateShared(intptr_t size);
+  uword TryPromoteShared(intptr_t size);
+  void UnpromoteShared(uword addr, intptr_t size);
   uword ProcessWeakProperty(RawWeakProperty* raw_weak,
                             ScavengerVisitor* visitor);
   void Epilogue(Isolate* isolate,
@@ -161,8 +207,9 @@ class Scavenger {
   // this value meets the allocation top.
   uword resolved_top_;
 
-  // Objects below this address have survived a scavenge.
-  uword survivor_end_;
+  // Set when the last scavenge promoted more than --early_tenuring_threshold
+  // percent of the to space, all survivors of the next one are promoted.
+  bool early_tenuring_;
 
   // All object are aligned to this value.
   uword object_alignment_;
@@ -172,6 +219,10 @@ class Scavenger {
   // Keep track whether the scavenge had a promotion failure.
   bool had_promotion_failure_;
 
+  // Serializes promotion during a parallel scavenge.
+  Mutex* promotion_mutex_;
+
+  friend class ScavengerTask;
   friend class ScavengerVisitor;
   friend class ScavengerWeakVisitor;
 
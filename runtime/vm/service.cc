@@ -14,6 +14,8 @@
 #include "vm/object_id_ring.h"
 #include "vm/object_store.h"
 #include "vm/port.h"
+#include "vm/profiler.h"
+#include "vm/symbols.h"
 
 namespace dart {
 
@@ -224,6 +226,16 @@ static void HandleObjectHistogram(Isolate* isolate, JSONStream* js) {
 }
 
 
+static void HandleHeap(Isolate* isolate, JSONStream* js) {
+  isolate->heap()->PrintToJSONStream(js);
+}
+
+
+static void HandleSymbols(Isolate* isolate, JSONStream* js) {
+  Symbols::PrintToJSONStream(isolate, js);
+}
+
+
 static void HandleEcho(Isolate* isolate, JSONStream* js) {
   JSONObject jsobj(js);
   jsobj.AddProperty("type", "message");
@@ -319,16 +331,24 @@ static void HandleCpu(Isolate* isolate, JSONStream* js) {
 }
 
 
+static void HandleProfile(Isolate* isolate, JSONStream* js) {
+  Profiler::PrintToJSONStream(isolate, js);
+}
+
+
 static ServiceMessageHandlerEntry __message_handlers[] = {
   { "_echo", HandleEcho },
   { "classes", HandleClasses },
   { "cpu", HandleCpu },
   { "debug", HandleDebug },
+  { "heap", HandleHeap },
   { "library", HandleLibrary },
   { "name", HandleName },
   { "objecthistogram", HandleObjectHistogram},
   { "objects", HandleObjects },
+  { "profile", HandleProfile },
   { "stacktrace", HandleStackTrace },
+  { "symbols", HandleSymbols },
 };
 
 
@@ -146,4 +146,66 @@ TEST_CASE(Service_DebugBreakpoints) {
                handler.msg());
 }
 
+
+TEST_CASE(Service_Heap) {
+  const char* kScript =
+      "var port;\n"  // Set to our mock port by C++.
+      "\n"
+      "main() {\n"
+      "}";
+
+  Isolate* isolate = Isolate::Current();
+  Dart_Handle lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(lib);
+
+  // Build a mock message handler and wrap it in a dart port.
+  ServiceTestMessageHandler handler;
+  Dart_Port port_id = PortMap::CreatePort(&handler);
+  Dart_Handle port =
+      Api::NewHandle(isolate, DartLibraryCalls::NewSendPort(port_id));
+  EXPECT_VALID(port);
+  EXPECT_VALID(Dart_SetField(lib, NewString("port"), port));
+
+  Instance& service_msg = Instance::Handle();
+  service_msg = Eval(lib, "[port, ['heap'], [], []]");
+  Service::HandleServiceMessage(isolate, service_msg);
+  handler.HandleNextMessage();
+  EXPECT_SUBSTRING("{\"type\":\"Heap\",\"new\":{\"used\":",
+                   handler.msg());
+  EXPECT_SUBSTRING("\"freeLists\":[{\"type\":\"FreeList\","
+                   "\"pageType\":\"data\",\"freeBytes\":",
+                   handler.msg());
+  EXPECT_SUBSTRING("\"pageType\":\"executable\"", handler.msg());
+}
+
+
+TEST_CASE(Service_Symbols) {
+  const char* kScript =
+      "var port;\n"  // Set to our mock port by C++.
+      "\n"
+      "main() {\n"
+      "}";
+
+  Isolate* isolate = Isolate::Current();
+  Dart_Handle lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(lib);
+
+  // Build a mock message handler and wrap it in a dart port.
+  ServiceTestMessageHandler handler;
+  Dart_Port port_id = PortMap::CreatePort(&handler);
+  Dart_Handle port =
+      Api::NewHandle(isolate, DartLibraryCalls::NewSendPort(port_id));
+  EXPECT_VALID(port);
+  EXPECT_VALID(Dart_SetField(lib, NewString("port"), port));
+
+  Instance& service_msg = Instance::Handle();
+  service_msg = Eval(lib, "[port, ['symbols'], [], []]");
+  Service::HandleServiceMessage(isolate, service_msg);
+  handler.HandleNextMessage();
+  EXPECT_SUBSTRING("{\"type\":\"SymbolTable\",\"grows\":", handler.msg());
+  EXPECT_SUBSTRING("\"vm\":{\"symbols\":", handler.msg());
+  EXPECT_SUBSTRING("\"isolate\":{\"symbols\":", handler.msg());
+  EXPECT_SUBSTRING("\"maxProbeLength\":", handler.msg());
+}
+
 }  // namespace dart
@@ -8,20 +8,96 @@
 #include "vm/bigint_operations.h"
 #include "vm/bootstrap.h"
 #include "vm/class_finalizer.h"
+#include "vm/cpu.h"
+#include "vm/dart_api_state.h"
+#include "vm/dart_entry.h"
 #include "vm/exceptions.h"
+#include "vm/flags.h"
 #include "vm/heap.h"
 #include "vm/longjump.h"
+#include "vm/message.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
+#include "vm/runtime_entry.h"
 #include "vm/snapshot_ids.h"
+#include "vm/stub_code.h"
 #include "vm/symbols.h"
 
 namespace dart {
 
+DEFINE_FLAG(bool, share_symbols, true,
+            "Share the symbols of the first full snapshot among isolates.");
+DEFINE_FLAG(bool, snapshot_code, false,
+            "Include unoptimized code in full snapshots.");
+DECLARE_FLAG(bool, enable_asserts);
+DECLARE_FLAG(bool, enable_type_checks);
+DECLARE_FLAG(bool, incremental_marking);
+DECLARE_FLAG(bool, throw_on_javascript_int_overflow);
+
 static const int kNumInitialReferencesInFullSnapshot = 160 * KB;
 static const int kNumInitialReferences = 64;
 
 
+// Kinds of external addresses embedded in code, they are written as a kind
+// and an id and patched with the addresses of the reading isolate.
+enum ExternalAddressKind {
+  kUnknownAddress = 0,
+  kStubAddress,  // Id is the index of the stub.
+  kRuntimeEntryAddress,  // Written by name, id is the entry point.
+  kIsolateAddress,  // Id is one of IsolateAddressId.
+  kAllocationStubAddress,  // Id is the class id.
+};
+
+
+enum IsolateAddressId {
+  kStackLimitAddress = 0,
+  kNewSpaceTopAddress,
+  kNewSpaceEndAddress,
+};
+
+
+static uword IsolateAddress(Isolate* isolate, intptr_t id) {
+  switch (id) {
+    case kStackLimitAddress: return isolate->stack_limit_address();
+    case kNewSpaceTopAddress: return isolate->heap()->TopAddress();
+    case kNewSpaceEndAddress: return isolate->heap()->EndAddress();
+    default: UNREACHABLE();
+  }
+  return 0;
+}
+
+
+// The flags that change the unoptimized code generated for a function.
+static int8_t CodeGenerationFlags() {
+  return (FLAG_enable_type_checks ? 1 : 0) |
+         (FLAG_enable_asserts ? 2 : 0) |
+         (FLAG_throw_on_javascript_int_overflow ? 4 : 0) |
+         (FLAG_incremental_marking ? 8 : 0);
+}
+
+
+static bool IsCodeClassId(intptr_t class_id) {
+  // Check if objects of this class are only referenced from code and cannot
+  // be written to a snapshot on their own.
+  switch (class_id) {
+    case kCodeCid:
+    case kInstructionsCid:
+    case kPcDescriptorsCid:
+    case kStackmapCid:
+    case kLocalVarDescriptorsCid:
+    case kExceptionHandlersCid:
+    case kDeoptInfoCid:
+    case kContextScopeCid:
+    case kMegamorphicCacheCid:
+    case kUnhandledExceptionCid:
+    case kUnwindErrorCid:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
 static bool IsSingletonClassId(intptr_t class_id) {
   // Check if this is a singleton object class which is shared by all isolates.
   return ((class_id >= kClassCid && class_id <= kUnwindErrorCid) ||
@@ -162,7 +238,12 @@ SnapshotReader::SnapshotReader(const uint8_t* buffer,
       error_(UnhandledException::Handle()),
       backward_references_((kind == Snapshot::kFull) ?
                            kNumInitialReferencesInFullSnapshot :
-                           kNumInitialReferences) {
+                           kNumInitialReferences),
+      code_objects_(),
+      pending_relocations_(),
+      discard_code_(false),
+      populate_shared_symbols_(false),
+      shared_symbols_() {
 }
 
 
@@ -369,6 +450,15 @@ void SnapshotReader::ReadFullSnapshot() {
   ASSERT(object_store != NULL);
   NoGCScope no_gc;
 
+  // The first isolate read from a full snapshot allocates its symbols in the
+  // VM isolate heap, isolates read later on share them.
+  Heap* vm_heap = Dart::vm_isolate()->heap();
+  populate_shared_symbols_ = FLAG_share_symbols &&
+                             Symbols::ClaimSharedSymbols();
+  if (populate_shared_symbols_) {
+    vm_heap->WriteProtect(false);
+  }
+
   // TODO(asiva): Add a check here to ensure we have the right heap
   // size for the full snapshot being read.
 
@@ -384,11 +474,122 @@ void SnapshotReader::ReadFullSnapshot() {
     }
   }
 
+  if (populate_shared_symbols_) {
+    Symbols::SetSharedSymbols(shared_symbols_.data(),
+                              shared_symbols_.length());
+    vm_heap->WriteProtect(true);
+    populate_shared_symbols_ = false;
+  }
+
   // Setup native resolver for bootstrap impl.
   Bootstrap::SetupNativeResolver();
 }
 
 
+void SnapshotReader::RelocateCode() {
+  ASSERT(kind_ == Snapshot::kFull);
+  if (discard_code_) {
+    // The code relies on class ids or flags that differ in this isolate, the
+    // functions are compiled again when they are first called.
+    Function& function = Function::Handle();
+    for (intptr_t i = 0; i < code_objects_.length(); i++) {
+      function = code_objects_[i]->function();
+      function.ClearCode();
+    }
+    code_objects_.Clear();
+    pending_relocations_.Clear();
+    return;
+  }
+  Class& cls = Class::Handle();
+  Code& stub = Code::Handle();
+  Instructions& instrs = Instructions::Handle();
+  Array& pool = Array::Handle();
+  Smi& value = Smi::Handle();
+  for (intptr_t i = 0; i < pending_relocations_.length(); i++) {
+    const PendingRelocation& relocation = pending_relocations_[i];
+    uword address = 0;
+    switch (relocation.kind) {
+      case kStubAddress:
+        address = StubCode::EntryPointOfStub(relocation.id);
+        break;
+      case kRuntimeEntryAddress:
+        address = relocation.id;
+        break;
+      case kIsolateAddress:
+        address = IsolateAddress(isolate(), relocation.id);
+        break;
+      case kAllocationStubAddress:
+        cls = isolate()->class_table()->At(relocation.id);
+        stub = StubCode::GetAllocationStubForClass(cls);
+        address = stub.EntryPoint();
+        break;
+      default:
+        UNREACHABLE();
+    }
+    instrs = relocation.code->instructions();
+    if (relocation.slot >= 0) {
+      pool = instrs.object_pool();
+      value = reinterpret_cast<RawSmi*>(address);
+      pool.SetAt(relocation.slot, value);
+    } else {
+      uword imm = instrs.EntryPoint() + (-1 - relocation.slot);
+      *reinterpret_cast<uword*>(imm) = address;
+    }
+  }
+  for (intptr_t i = 0; i < code_objects_.length(); i++) {
+    instrs = code_objects_[i]->instructions();
+    CPU::FlushICache(instrs.EntryPoint(), instrs.size());
+  }
+  code_objects_.Clear();
+  pending_relocations_.Clear();
+}
+
+
+RawArray* SnapshotReader::ReadTokenObjects(const ExternalTypedData& data) {
+  Isolate* isolate = Isolate::Current();
+  ReadStream stream(reinterpret_cast<uint8_t*>(data.DataAddr(0)),
+                    data.Length());
+  intptr_t len = ReadStream::Raw<sizeof(intptr_t), intptr_t>::Read(&stream);
+  const Array& result = Array::Handle(isolate, Array::New(len, Heap::kOld));
+  String& str = String::Handle(isolate);
+  LiteralToken& literal_token = LiteralToken::Handle(isolate);
+  uint8_t* chars = NULL;
+  intptr_t chars_len = 0;
+  for (intptr_t i = 0; i < len; i++) {
+    Token::Kind kind = static_cast<Token::Kind>(
+        ReadStream::Raw<sizeof(intptr_t), intptr_t>::Read(&stream));
+    if (kind == Token::kILLEGAL) {
+      continue;  // Null entry.
+    }
+    bool is_canonical = ReadStream::Raw<1, int8_t>::Read(&stream) != 0;
+    bool is_one_byte = ReadStream::Raw<1, int8_t>::Read(&stream) != 0;
+    intptr_t str_len =
+        ReadStream::Raw<sizeof(intptr_t), intptr_t>::Read(&stream);
+    intptr_t num_bytes = is_one_byte ? str_len : (str_len * sizeof(uint16_t));
+    if (num_bytes > chars_len) {
+      chars = isolate->current_zone()->Alloc<uint8_t>(num_bytes);
+      chars_len = num_bytes;
+    }
+    stream.ReadBytes(chars, num_bytes);
+    if (is_one_byte) {
+      str = is_canonical ? Symbols::FromLatin1(chars, str_len) :
+                           String::FromLatin1(chars, str_len, Heap::kOld);
+    } else {
+      const uint16_t* utf16 = reinterpret_cast<const uint16_t*>(chars);
+      str = is_canonical ? Symbols::FromUTF16(utf16, str_len) :
+                           String::FromUTF16(utf16, str_len, Heap::kOld);
+    }
+    if (kind == Token::kIDENT) {
+      result.SetAt(i, str);
+    } else {
+      literal_token = LiteralToken::New(kind, str);
+      result.SetAt(i, literal_token);
+    }
+  }
+  return result.raw();
+}
+
+
 #define ALLOC_NEW_OBJECT_WITH_LEN(type, class_obj, length)                     \
   ASSERT(kind_ == Snapshot::kFull);                                            \
   ASSERT(isolate()->no_gc_scope_depth() != 0);                                 \
@@ -425,6 +626,46 @@ RawTwoByteString* SnapshotReader::NewTwoByteString(intptr_t len) {
 }
 
 
+RawOneByteString* SnapshotReader::ReadSharedSymbol(intptr_t len,
+                                                   intptr_t hash) {
+  ASSERT(kind_ == Snapshot::kFull);
+  ASSERT(isolate()->no_gc_scope_depth() != 0);
+  if (hash == 0) {
+    return NULL;
+  }
+  if (!populate_shared_symbols_) {
+    RawString* symbol =
+        Symbols::LookupSharedSymbol(CurrentBufferAddress(), len, hash);
+    if (symbol == NULL) {
+      return NULL;
+    }
+    Advance(len);
+    return reinterpret_cast<RawOneByteString*>(symbol);
+  }
+  intptr_t size = OneByteString::InstanceSize(len);
+  uword address = Dart::vm_isolate()->heap()->TryAllocate(
+      size, Heap::kOld, PageSpace::kForceGrowth);
+  if (address == 0) {
+    return NULL;
+  }
+  RawOneByteString* obj =
+      reinterpret_cast<RawOneByteString*>(address + kHeapObjectTag);
+  // Objects of the VM isolate heap are premarked.
+  uword tags = 0;
+  tags = RawObject::ClassIdTag::update(kOneByteStringCid, tags);
+  tags = RawObject::SizeTag::update(size, tags);
+  tags = RawObject::MarkBit::update(true, tags);
+  tags = RawObject::CanonicalObjectTag::update(true, tags);
+  tags = RawObject::CreatedFromSnapshotTag::update(true, tags);
+  obj->ptr()->tags_ = tags;
+  obj->ptr()->length_ = Smi::New(len);
+  obj->ptr()->hash_ = Smi::New(hash);
+  ReadBytes(obj->ptr()->data_, len);
+  shared_symbols_.Add(obj);
+  return obj;
+}
+
+
 RawTypeArguments* SnapshotReader::NewTypeArguments(intptr_t len) {
   ALLOC_NEW_OBJECT_WITH_LEN(TypeArguments,
                             Object::type_arguments_class(),
@@ -438,6 +679,16 @@ RawTokenStream* SnapshotReader::NewTokenStream(intptr_t len) {
   cls_ = Object::token_stream_class();
   stream_ = reinterpret_cast<RawTokenStream*>(
       AllocateUninitialized(cls_, TokenStream::InstanceSize()));
+  data_ = NewExternalData(len);
+  stream_.SetStream(data_);
+  return stream_.raw();
+}
+
+
+RawExternalTypedData* SnapshotReader::NewExternalData(intptr_t len) {
+  ASSERT(kind_ == Snapshot::kFull);
+  ASSERT(isolate()->no_gc_scope_depth() != 0);
+  // The data is not copied, the full snapshot buffer outlives the isolate.
   cls_ = isolate()->class_table()->At(kExternalTypedDataUint8ArrayCid);
   uint8_t* array = const_cast<uint8_t*>(CurrentBufferAddress());
   ASSERT(array != NULL);
@@ -446,8 +697,7 @@ RawTokenStream* SnapshotReader::NewTokenStream(intptr_t len) {
       AllocateUninitialized(cls_, ExternalTypedData::InstanceSize()));
   data_.SetData(array);
   data_.SetLength(len);
-  stream_.SetStream(data_);
-  return stream_.raw();
+  return data_.raw();
 }
 
 
@@ -478,6 +728,10 @@ RawClass* SnapshotReader::NewClass(intptr_t class_id) {
   cls_ = obj;
   cls_.set_id(kIllegalCid);
   isolate()->RegisterClass(cls_);
+  if (cls_.id() != class_id) {
+    // Code embeds class ids, it cannot be used if they are renumbered.
+    discard_code_ = true;
+  }
   return cls_.raw();
 }
 
@@ -670,6 +924,78 @@ RawStacktrace* SnapshotReader::NewStacktrace() {
 }
 
 
+RawCode* SnapshotReader::NewCode(intptr_t pointer_offsets_length) {
+  ASSERT(kind_ == Snapshot::kFull);
+  ASSERT(isolate()->no_gc_scope_depth() != 0);
+  cls_ = Object::code_class();
+  RawCode* obj = reinterpret_cast<RawCode*>(
+      AllocateUninitialized(cls_, Code::InstanceSize(pointer_offsets_length)));
+  obj->ptr()->pointer_offsets_length_ = pointer_offsets_length;
+  return obj;
+}
+
+
+RawInstructions* SnapshotReader::NewInstructions(intptr_t size) {
+  ASSERT(kind_ == Snapshot::kFull);
+  ASSERT(isolate()->no_gc_scope_depth() != 0);
+  cls_ = Object::instructions_class();
+  RawInstructions* obj = reinterpret_cast<RawInstructions*>(
+      AllocateUninitialized(cls_, Instructions::InstanceSize(size), true));
+  obj->ptr()->size_ = size;
+  return obj;
+}
+
+
+RawPcDescriptors* SnapshotReader::NewPcDescriptors(intptr_t len) {
+  ALLOC_NEW_OBJECT_WITH_LEN(PcDescriptors,
+                            Object::pc_descriptors_class(),
+                            len);
+}
+
+
+RawExceptionHandlers* SnapshotReader::NewExceptionHandlers(intptr_t len) {
+  ASSERT(kind_ == Snapshot::kFull);
+  ASSERT(isolate()->no_gc_scope_depth() != 0);
+  cls_ = Object::exception_handlers_class();
+  RawExceptionHandlers* obj = reinterpret_cast<RawExceptionHandlers*>(
+      AllocateUninitialized(cls_, ExceptionHandlers::InstanceSize(len)));
+  obj->ptr()->length_ = len;
+  return obj;
+}
+
+
+RawLocalVarDescriptors* SnapshotReader::NewLocalVarDescriptors(intptr_t len) {
+  ASSERT(kind_ == Snapshot::kFull);
+  ASSERT(isolate()->no_gc_scope_depth() != 0);
+  cls_ = Object::var_descriptors_class();
+  RawLocalVarDescriptors* obj = reinterpret_cast<RawLocalVarDescriptors*>(
+      AllocateUninitialized(cls_, LocalVarDescriptors::InstanceSize(len)));
+  obj->ptr()->length_ = len;
+  return obj;
+}
+
+
+RawStackmap* SnapshotReader::NewStackmap(intptr_t length) {
+  ASSERT(kind_ == Snapshot::kFull);
+  ASSERT(isolate()->no_gc_scope_depth() != 0);
+  cls_ = Object::stackmap_class();
+  RawStackmap* obj = reinterpret_cast<RawStackmap*>(
+      AllocateUninitialized(cls_, Stackmap::InstanceSize(length)));
+  obj->ptr()->length_ = length;
+  return obj;
+}
+
+
+RawICData* SnapshotReader::NewICData() {
+  ALLOC_NEW_OBJECT(ICData, Object::icdata_class());
+}
+
+
+RawSubtypeTestCache* SnapshotReader::NewSubtypeTestCache() {
+  ALLOC_NEW_OBJECT(SubtypeTestCache, Object::subtypetestcache_class());
+}
+
+
 RawClass* SnapshotReader::LookupInternalClass(intptr_t class_header) {
   // If the header is an object Id, lookup singleton VM classes or classes
   // stored in the object store.
@@ -689,12 +1015,14 @@ RawClass* SnapshotReader::LookupInternalClass(intptr_t class_header) {
 
 
 RawObject* SnapshotReader::AllocateUninitialized(const Class& cls,
-                                                 intptr_t size) {
+                                                 intptr_t size,
+                                                 bool executable) {
   ASSERT(isolate()->no_gc_scope_depth() != 0);
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
   Heap* heap = isolate()->heap();
 
-  uword address = heap->TryAllocate(size, Heap::kOld);
+  uword address =
+      heap->TryAllocate(size, executable ? Heap::kCode : Heap::kOld);
   if (address == 0) {
     // Use the preallocated out of memory exception to avoid calling
     // into dart code or allocating any code.
@@ -743,10 +1071,15 @@ RawObject* SnapshotReader::ReadVMIsolateObject(intptr_t header_value) {
   intptr_t class_id = ClassIdFromObjectId(object_id);
   if (IsSingletonClassId(class_id)) {
     return isolate()->class_table()->At(class_id);  // get singleton class.
-  } else {
-    ASSERT(Symbols::IsVMSymbolId(object_id));
+  }
+  if (Symbols::IsVMSymbolId(object_id)) {
     return Symbols::GetVMSymbol(object_id);  // return VM symbol.
   }
+  intptr_t index =
+      object_id - (kMaxPredefinedObjectIds + Symbols::kMaxPredefinedId);
+  if ((index >= 0) && (index < ArgumentsDescriptor::NumCachedDescriptors())) {
+    return ArgumentsDescriptor::CachedDescriptor(index);
+  }
   UNREACHABLE();
   return Object::null();
 }
@@ -888,6 +1221,80 @@ void SnapshotReader::ArrayReadFrom(const Array& result,
 }
 
 
+RawPcDescriptors* SnapshotReader::ReadPcDescriptors(uword entry_point) {
+  intptr_t len = ReadIntptrValue();
+  const PcDescriptors& descriptors =
+      PcDescriptors::Handle(NewPcDescriptors(len));
+  descriptors.set_tags(ReadIntptrValue());
+  for (intptr_t i = 0; i < len; i++) {
+    uword pc = entry_point + ReadIntptrValue();
+    intptr_t deopt_id = Read<int32_t>();
+    intptr_t token_pos = Read<int32_t>();
+    intptr_t try_index = Read<int32_t>();
+    PcDescriptors::Kind kind = static_cast<PcDescriptors::Kind>(
+        Read<int32_t>());
+    descriptors.AddDescriptor(i, pc, kind, deopt_id, token_pos, try_index);
+  }
+  return descriptors.raw();
+}
+
+
+RawExceptionHandlers* SnapshotReader::ReadExceptionHandlers(
+    uword entry_point) {
+  intptr_t len = ReadIntptrValue();
+  const ExceptionHandlers& handlers =
+      ExceptionHandlers::Handle(NewExceptionHandlers(len));
+  handlers.set_tags(ReadIntptrValue());
+  // The handled types are read as a reference, the array is filled later.
+  *ObjectHandle() = ReadObjectRef();
+  handlers.set_handled_types_data(Array::Cast(*ObjectHandle()));
+  for (intptr_t i = 0; i < len; i++) {
+    intptr_t handler_pc = entry_point + ReadIntptrValue();
+    intptr_t outer_try_index = Read<int16_t>();
+    bool needs_stacktrace = (Read<int8_t>() != 0);
+    bool has_catch_all = (Read<int8_t>() != 0);
+    handlers.SetHandlerInfo(i,
+                            outer_try_index,
+                            handler_pc,
+                            needs_stacktrace,
+                            has_catch_all);
+  }
+  return handlers.raw();
+}
+
+
+void SnapshotReader::ReadCodeRelocations(const Code& code) {
+  if (Read<int8_t>() != CodeGenerationFlags()) {
+    discard_code_ = true;
+  }
+  const Code* handle = &Code::ZoneHandle(isolate(), code.raw());
+  code_objects_.Add(handle);
+  intptr_t len = ReadIntptrValue();
+  for (intptr_t i = 0; i < len; i++) {
+    PendingRelocation relocation;
+    relocation.code = handle;
+    relocation.slot = ReadIntptrValue();
+    relocation.kind = Read<int8_t>();
+    if (relocation.kind == kRuntimeEntryAddress) {
+      intptr_t name_len = ReadIntptrValue();
+      char* name = isolate()->current_zone()->Alloc<char>(name_len + 1);
+      ReadBytes(reinterpret_cast<uint8_t*>(name), name_len);
+      name[name_len] = '\0';
+      const RuntimeEntry* entry = RuntimeEntry::LookupByName(name);
+      if (entry == NULL) {
+        discard_code_ = true;
+        relocation.id = 0;
+      } else {
+        relocation.id = entry->GetEntryPoint();
+      }
+    } else {
+      relocation.id = ReadIntptrValue();
+    }
+    pending_relocations_.Add(relocation);
+  }
+}
+
+
 SnapshotWriter::SnapshotWriter(Snapshot::Kind kind,
                                uint8_t** buffer,
                                ReAlloc alloc,
@@ -898,7 +1305,14 @@ SnapshotWriter::SnapshotWriter(Snapshot::Kind kind,
       class_table_(Isolate::Current()->class_table()),
       forward_list_(),
       exception_type_(Exceptions::kNone),
-      exception_msg_(NULL) {
+      exception_msg_(NULL),
+      transfer_external_data_(false),
+      transferred_list_(),
+      shared_object_ids_(),
+      snapshot_code_((kind == Snapshot::kFull) && FLAG_snapshot_code) {
+  // Serialized objects temporarily have their header replaced by a forwarding
+  // id, which a concurrent sweeper must not see.
+  Isolate::Current()->heap()->WaitForSweeperTasks();
 }
 
 
@@ -908,47 +1322,40 @@ void SnapshotWriter::WriteObject(RawObject* rawobj) {
 }
 
 
-void SnapshotWriter::HandleVMIsolateObject(RawObject* rawobj) {
+intptr_t SnapshotWriter::LookupVMIsolateObjectId(RawObject* rawobj) {
   // Check if it is a singleton null object.
   if (rawobj == Object::null()) {
-    WriteVMIsolateObject(kNullObject);
-    return;
+    return kNullObject;
   }
 
   // Check if it is a singleton sentinel object.
   if (rawobj == Object::sentinel().raw()) {
-    WriteVMIsolateObject(kSentinelObject);
-    return;
+    return kSentinelObject;
   }
 
   // Check if it is a singleton empty array object.
   if (rawobj == Object::empty_array().raw()) {
-    WriteVMIsolateObject(kEmptyArrayObject);
-    return;
+    return kEmptyArrayObject;
   }
 
   // Check if it is a singleton dyanmic Type object.
   if (rawobj == Object::dynamic_type()) {
-    WriteVMIsolateObject(kDynamicType);
-    return;
+    return kDynamicType;
   }
 
   // Check if it is a singleton void Type object.
   if (rawobj == Object::void_type()) {
-    WriteVMIsolateObject(kVoidType);
-    return;
+    return kVoidType;
   }
 
   // Check if it is a singleton boolean true object.
   if (rawobj == Bool::True().raw()) {
-    WriteVMIsolateObject(kTrueValue);
-    return;
+    return kTrueValue;
   }
 
   // Check if it is a singleton boolean false object.
   if (rawobj == Bool::False().raw()) {
-    WriteVMIsolateObject(kFalseValue);
-    return;
+    return kFalseValue;
   }
 
   // Check if it is a singleton class object which is shared by
@@ -958,20 +1365,64 @@ void SnapshotWriter::HandleVMIsolateObject(RawObject* rawobj) {
     RawClass* raw_class = reinterpret_cast<RawClass*>(rawobj);
     intptr_t class_id = raw_class->ptr()->id_;
     if (IsSingletonClassId(class_id)) {
-      intptr_t object_id = ObjectIdFromClassId(class_id);
-      WriteVMIsolateObject(object_id);
-      return;
+      return ObjectIdFromClassId(class_id);
     }
   }
 
   // Check it is a predefined symbol in the VM isolate.
   id = Symbols::LookupVMSymbol(rawobj);
   if (id != kInvalidIndex) {
-    WriteVMIsolateObject(id);
+    return id;
+  }
+
+  // Check if it is a cached arguments descriptor, these appear in the object
+  // pools of code.
+  id = ArgumentsDescriptor::IndexOfCachedDescriptor(rawobj);
+  if (id != -1) {
+    return kMaxPredefinedObjectIds + Symbols::kMaxPredefinedId + id;
+  }
+
+  return kInvalidIndex;
+}
+
+
+bool SnapshotWriter::IsSharedSymbol(RawObject* raw) {
+  if (raw->GetClassId() != kOneByteStringCid) {
+    return false;
+  }
+  RawOneByteString* str = reinterpret_cast<RawOneByteString*>(raw);
+  return Symbols::LookupSharedSymbol(str->ptr()->data_,
+                                     Smi::Value(str->ptr()->length_),
+                                     Smi::Value(str->ptr()->hash_)) == raw;
+}
+
+
+void SnapshotWriter::WriteSharedSymbol(RawOneByteString* raw) {
+  intptr_t object_id = shared_object_ids_.Lookup(raw);
+  if (object_id != 0) {
+    WriteIndexedObject(object_id);
     return;
   }
+  // The symbol is written like one of the isolate, it gets an object id but
+  // its header is left untouched.
+  object_id = forward_list_.length() + kMaxPredefinedObjectIds;
+  ASSERT(object_id <= kMaxObjectId);
+  ForwardObjectNode* node =
+      new ForwardObjectNode(raw, raw->ptr()->tags_, kIsSerialized);
+  forward_list_.Add(node);
+  shared_object_ids_.Insert(ObjectIdPair(raw, object_id));
+  raw->WriteTo(this, object_id, kind_);
+}
 
-  UNREACHABLE();
+
+void SnapshotWriter::HandleVMIsolateObject(RawObject* rawobj) {
+  if (IsSharedSymbol(rawobj)) {
+    WriteSharedSymbol(reinterpret_cast<RawOneByteString*>(rawobj));
+    return;
+  }
+  intptr_t id = LookupVMIsolateObjectId(rawobj);
+  ASSERT(id != kInvalidIndex);
+  WriteVMIsolateObject(id);
 }
 
 
@@ -1110,13 +1561,25 @@ void FullSnapshotWriter::WriteFullSnapshot() {
 }
 
 
+// The identity hash code and the age in the header are not part of the
+// snapshot.
+static uword StripHeaderState(uword tags) {
+  tags = RawObject::UpdateAge(0, tags);
+#if defined(ARCH_IS_64_BIT)
+  tags = RawObject::HashTag::update(0, tags);
+#endif
+  return tags;
+}
+
+
 uword SnapshotWriter::GetObjectTags(RawObject* raw) {
   uword tags = raw->ptr()->tags_;
   if (SerializedHeaderTag::decode(tags) == kObjectId) {
     intptr_t id = SerializedHeaderData::decode(tags);
-    return forward_list_[id - kMaxPredefinedObjectIds]->tags();
+    return StripHeaderState(
+        forward_list_[id - kMaxPredefinedObjectIds]->tags());
   } else {
-    return tags;
+    return StripHeaderState(tags);
   }
 }
 
@@ -1142,8 +1605,54 @@ void SnapshotWriter::UnmarkAll() {
   NoGCScope no_gc;
   for (intptr_t i = 0; i < forward_list_.length(); i++) {
     RawObject* raw = forward_list_[i]->raw();
-    raw->ptr()->tags_ = forward_list_[i]->tags();  // Restore original tags.
+    // Shared symbols are never marked, see WriteSharedSymbol.
+    if (raw->ptr()->tags_ != forward_list_[i]->tags()) {
+      raw->ptr()->tags_ = forward_list_[i]->tags();  // Restore original tags.
+    }
+  }
+}
+
+
+FinalizablePersistentHandle* SnapshotWriter::TransferExternalData(
+    RawExternalTypedData* raw) {
+  if (!transfer_external_data_) {
+    return NULL;
+  }
+  // Only the finalizers of regular weak persistent handles are recorded in
+  // the array, see ExternalTypedData::finalizer.
+  FinalizablePersistentHandle* handle = raw->ptr()->finalizer_;
+  if ((handle == NULL) ||
+      (handle->raw() != raw) ||
+      (handle->callback() == NULL)) {
+    // Without a finalizer the receiver could never free the data, copy it.
+    return NULL;
+  }
+  transferred_list_.Add(new TransferredDataNode(
+      raw, handle, handle->peer(), handle->callback()));
+  return handle;
+}
+
+
+void SnapshotWriter::DetachTransferredData() {
+  NoGCScope no_gc;
+  ApiState* state = Isolate::Current()->api_state();
+  ASSERT(state != NULL);
+  ExternalTypedData& array = ExternalTypedData::Handle();
+  for (intptr_t i = 0; i < transferred_list_.length(); i++) {
+    TransferredDataNode* node = transferred_list_[i];
+    array = node->raw();
+    array.DetachData();
+    state->weak_persistent_handles().FreeHandle(node->handle());
+  }
+}
+
+
+void SnapshotWriter::MoveFinalizersTo(Message* message) {
+  for (intptr_t i = 0; i < transferred_list_.length(); i++) {
+    TransferredDataNode* node = transferred_list_[i];
+    message->AddFinalizer(node->peer(), node->callback());
   }
+  transferred_list_.Clear();
 }
 
 
@@ -1191,9 +1700,10 @@ bool SnapshotWriter::CheckAndWritePredefinedObject(RawObject* rawobj) {
     }
   }
 
-  // Check if it is a code object in that case just write a Null object
-  // as we do not want code objects in the snapshot.
-  if (rawobj->GetClassId() == kCodeCid) {
+  // Check if it is a code object that cannot be written, in that case just
+  // write a Null object and the function is compiled lazily when read.
+  if ((rawobj->GetClassId() == kCodeCid) &&
+      !CanWriteCode(reinterpret_cast<RawCode*>(rawobj))) {
     WriteVMIsolateObject(kNullObject);
     return true;
   }
@@ -1225,6 +1735,265 @@ bool SnapshotWriter::CheckAndWritePredefinedObject(RawObject* rawobj) {
 }
 
 
+intptr_t SnapshotWriter::GetObjectClassId(RawObject* raw) {
+  return RawObject::ClassIdTag::decode(GetObjectTags(raw));
+}
+
+
+uword SnapshotWriter::CodeEntryPoint(RawCode* raw) {
+  RawInstructions* instrs = raw->ptr()->instructions_;
+  return reinterpret_cast<uword>(instrs->ptr()) + Instructions::HeaderSize();
+}
+
+
+uword SnapshotWriter::ExternalAddressAt(RawCode* raw, intptr_t slot) {
+  if (slot >= 0) {
+    RawArray* pool = raw->ptr()->instructions_->ptr()->object_pool_;
+    return reinterpret_cast<uword>(pool->ptr()->data()[slot]);
+  }
+  return *reinterpret_cast<uword*>(CodeEntryPoint(raw) + (-1 - slot));
+}
+
+
+intptr_t SnapshotWriter::LookupExternalAddress(uword address, intptr_t* id) {
+  *id = StubCode::IndexOfStub(address);
+  if (*id != -1) {
+    return kStubAddress;
+  }
+  *id = 0;
+  if (RuntimeEntry::LookupByEntryPoint(address) != NULL) {
+    return kRuntimeEntryAddress;
+  }
+  Isolate* isolate = Isolate::Current();
+  for (*id = kStackLimitAddress; *id <= kNewSpaceEndAddress; (*id)++) {
+    if (address == IsolateAddress(isolate, *id)) {
+      return kIsolateAddress;
+    }
+  }
+  for (*id = kInstanceCid; *id < class_table_->NumCids(); (*id)++) {
+    if (!class_table_->HasValidClassAt(*id)) {
+      continue;
+    }
+    RawCode* stub = class_table_->At(*id)->ptr()->allocation_stub_;
+    if (stub == Code::null()) {
+      continue;
+    }
+    if (address == CodeEntryPoint(stub)) {
+      return kAllocationStubAddress;
+    }
+  }
+  return kUnknownAddress;
+}
+
+
+bool SnapshotWriter::CanWriteCode(RawCode* raw) {
+  if (!snapshot_code_) {
+    return false;
+  }
+  NoGCScope no_gc;
+  RawArray* relocations = raw->ptr()->relocations_;
+  if (relocations == Array::null()) {
+    return false;
+  }
+  const Code& code = Code::Handle(raw);
+  if (code.is_optimized() || !code.is_alive() ||
+      (raw->ptr()->function_ == Function::null())) {
+    return false;
+  }
+  // Unoptimized code has no deoptimization info and calls other functions
+  // through ICs, patched static calls are not relocated.
+  RawArray* table = raw->ptr()->deopt_info_array_;
+  if ((table != Array::null()) && (Smi::Value(table->ptr()->length_) != 0)) {
+    return false;
+  }
+  table = raw->ptr()->static_calls_target_table_;
+  if ((table != Array::null()) && (Smi::Value(table->ptr()->length_) != 0)) {
+    return false;
+  }
+  RawArray* pool = raw->ptr()->instructions_->ptr()->object_pool_;
+  intptr_t len = Smi::Value(pool->ptr()->length_);
+  for (intptr_t i = 0; i < len; i++) {
+    RawObject* obj = pool->ptr()->data()[i];
+    if (!obj->IsHeapObject()) {
+      continue;
+    }
+    uword tags = obj->ptr()->tags_;
+    if ((SerializedHeaderTag::decode(tags) != kObjectId) &&
+        obj->IsVMHeapObject()) {
+      if ((LookupVMIsolateObjectId(obj) == kInvalidIndex) &&
+          !IsSharedSymbol(obj)) {
+        return false;
+      }
+    } else if (IsCodeClassId(GetObjectClassId(obj))) {
+      return false;
+    }
+  }
+  len = Smi::Value(relocations->ptr()->length_);
+  for (intptr_t i = 0; i < len; i++) {
+    intptr_t slot = Smi::Value(
+        reinterpret_cast<RawSmi*>(relocations->ptr()->data()[i]));
+    intptr_t id;
+    if (LookupExternalAddress(ExternalAddressAt(raw, slot), &id) ==
+        kUnknownAddress) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void SnapshotWriter::WritePcDescriptors(RawPcDescriptors* raw,
+                                        uword entry_point) {
+  intptr_t len = Smi::Value(raw->ptr()->length_);
+  WriteIntptrValue(len);
+  WriteIntptrValue(GetObjectTags(raw));
+  for (intptr_t i = 0; i < len; i++) {
+    const RawPcDescriptors::PcDescriptorRec& rec = raw->ptr()->data_[i];
+    WriteIntptrValue(rec.pc - entry_point);
+    Write<int32_t>(rec.deopt_id);
+    Write<int32_t>(rec.token_pos);
+    Write<int32_t>(rec.try_index);
+    Write<int32_t>(rec.kind);
+  }
+}
+
+
+void SnapshotWriter::WriteExceptionHandlers(RawExceptionHandlers* raw,
+                                            uword entry_point) {
+  intptr_t len = raw->ptr()->length_;
+  WriteIntptrValue(len);
+  WriteIntptrValue(GetObjectTags(raw));
+  WriteObjectRef(raw->ptr()->handled_types_data_);
+  for (intptr_t i = 0; i < len; i++) {
+    const RawExceptionHandlers::HandlerInfo& info = raw->ptr()->data_[i];
+    WriteIntptrValue(info.handler_pc - entry_point);
+    Write<int16_t>(info.outer_try_index);
+    Write<int8_t>(info.needs_stacktrace);
+    Write<int8_t>(info.has_catch_all);
+  }
+}
+
+
+void SnapshotWriter::WriteCodeRelocations(RawCode* raw) {
+  Write<int8_t>(CodeGenerationFlags());
+  RawArray* relocations = raw->ptr()->relocations_;
+  intptr_t len = Smi::Value(relocations->ptr()->length_);
+  WriteIntptrValue(len);
+  for (intptr_t i = 0; i < len; i++) {
+    intptr_t slot = Smi::Value(
+        reinterpret_cast<RawSmi*>(relocations->ptr()->data()[i]));
+    WriteIntptrValue(slot);
+    uword address = ExternalAddressAt(raw, slot);
+    intptr_t id;
+    intptr_t kind = LookupExternalAddress(address, &id);
+    ASSERT(kind != kUnknownAddress);
+    Write<int8_t>(kind);
+    if (kind == kRuntimeEntryAddress) {
+      // Runtime entries are identified by name, their order is not stable.
+      const char* name = RuntimeEntry::LookupByEntryPoint(address)->name();
+      intptr_t name_len = strlen(name);
+      WriteIntptrValue(name_len);
+      WriteBytes(reinterpret_cast<const uint8_t*>(name), name_len);
+    } else {
+      WriteIntptrValue(id);
+    }
+  }
+}
+
+
+static uint8_t* ReallocateTokenObjects(uint8_t* ptr,
+                                       intptr_t old_size,
+                                       intptr_t new_size) {
+  return reinterpret_cast<uint8_t*>(::realloc(ptr, new_size));
+}
+
+
+void SnapshotWriter::WriteTokenObjects(RawTokenStream* raw) {
+  ASSERT((kind_ == Snapshot::kFull) || (kind_ == Snapshot::kScript));
+  RawExternalTypedData* serialized = raw->ptr()->serialized_token_objects_;
+  if (serialized != ExternalTypedData::null()) {
+    // The token objects were never read, copy their encoding.
+    intptr_t len = Smi::Value(serialized->ptr()->length_);
+    WriteIntptrValue(len);
+    WriteBytes(serialized->ptr()->data_, len);
+    return;
+  }
+  RawArray* token_objects = raw->ptr()->token_objects_;
+  if (!CanEncodeTokenObjects(token_objects)) {
+    WriteIntptrValue(0);
+    WriteObjectImpl(token_objects);
+    return;
+  }
+  const intptr_t kInitialSize = 1 * KB;
+  uint8_t* buffer = NULL;
+  WriteStream stream(&buffer, ReallocateTokenObjects, kInitialSize);
+  intptr_t len = Smi::Value(token_objects->ptr()->length_);
+  WriteStream::Raw<sizeof(intptr_t), intptr_t>::Write(&stream, len);
+  for (intptr_t i = 0; i < len; i++) {
+    RawObject* obj = token_objects->ptr()->data()[i];
+    if (obj == Object::null()) {
+      WriteStream::Raw<sizeof(intptr_t), intptr_t>::Write(&stream,
+                                                          Token::kILLEGAL);
+    } else if (GetObjectClassId(obj) == kLiteralTokenCid) {
+      RawLiteralToken* literal_token = reinterpret_cast<RawLiteralToken*>(obj);
+      WriteStream::Raw<sizeof(intptr_t), intptr_t>::Write(
+          &stream, literal_token->ptr()->kind_);
+      EncodeTokenString(&stream, literal_token->ptr()->literal_);
+    } else {
+      WriteStream::Raw<sizeof(intptr_t), intptr_t>::Write(&stream,
+                                                          Token::kIDENT);
+      EncodeTokenString(&stream, reinterpret_cast<RawString*>(obj));
+    }
+  }
+  WriteIntptrValue(stream.bytes_written());
+  WriteBytes(buffer, stream.bytes_written());
+  free(buffer);
+}
+
+
+bool SnapshotWriter::CanEncodeTokenObjects(RawArray* raw) {
+  if (raw == Array::null()) {
+    return false;
+  }
+  intptr_t len = Smi::Value(raw->ptr()->length_);
+  for (intptr_t i = 0; i < len; i++) {
+    RawObject* obj = raw->ptr()->data()[i];
+    if (obj == Object::null()) {
+      continue;
+    }
+    if (GetObjectClassId(obj) == kLiteralTokenCid) {
+      obj = reinterpret_cast<RawLiteralToken*>(obj)->ptr()->literal_;
+      if (obj == Object::null()) {
+        return false;
+      }
+    }
+    intptr_t class_id = GetObjectClassId(obj);
+    if ((class_id != kOneByteStringCid) && (class_id != kTwoByteStringCid)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void SnapshotWriter::EncodeTokenString(WriteStream* stream, RawString* raw) {
+  bool is_one_byte = (GetObjectClassId(raw) == kOneByteStringCid);
+  intptr_t len = Smi::Value(raw->ptr()->length_);
+  WriteStream::Raw<1, int8_t>::Write(
+      stream, RawObject::IsCanonical(GetObjectTags(raw)) ? 1 : 0);
+  WriteStream::Raw<1, int8_t>::Write(stream, is_one_byte ? 1 : 0);
+  WriteStream::Raw<sizeof(intptr_t), intptr_t>::Write(stream, len);
+  if (is_one_byte) {
+    stream->WriteBytes(reinterpret_cast<RawOneByteString*>(raw)->ptr()->data_,
+                       len);
+  } else {
+    stream->WriteBytes(reinterpret_cast<uint8_t*>(
+        reinterpret_cast<RawTwoByteString*>(raw)->ptr()->data_),
+        len * sizeof(uint16_t));
+  }
+}
+
+
 void SnapshotWriter::WriteObjectImpl(RawObject* raw) {
   // First check if object can be written as a simple predefined type.
   if (CheckAndWritePredefinedObject(raw)) {
@@ -1250,7 +2019,8 @@ void SnapshotWriter::WriteInlinedObject(RawObject* raw) {
   uword tags = raw->ptr()->tags_;
   ASSERT(SerializedHeaderTag::decode(tags) == kObjectId);
   intptr_t object_id = SerializedHeaderData::decode(tags);
-  tags = forward_list_[object_id - kMaxPredefinedObjectIds]->tags();
+  tags = StripHeaderState(
+      forward_list_[object_id - kMaxPredefinedObjectIds]->tags());
   RawClass* cls = class_table_->At(RawObject::ClassIdTag::decode(tags));
   intptr_t class_id = cls->ptr()->id_;
 
@@ -1519,6 +2289,7 @@ void MessageWriter::WriteMessage(const Object& obj) {
     NoGCScope no_gc;
     WriteObject(obj.raw());
     UnmarkAll();
+    DetachTransferredData();
     isolate->set_long_jump_base(base);
   } else {
     isolate->set_long_jump_base(base);
@@ -12,6 +12,7 @@
 #include "vm/exceptions.h"
 #include "vm/globals.h"
 #include "vm/growable_array.h"
+#include "vm/hash_map.h"
 #include "vm/isolate.h"
 #include "vm/visitor.h"
 
@@ -24,10 +25,12 @@ class Array;
 class Class;
 class ClassTable;
 class ExternalTypedData;
+class FinalizablePersistentHandle;
 class GrowableObjectArray;
 class Heap;
 class LanguageError;
 class Library;
+class Message;
 class Object;
 class ObjectStore;
 class RawAbstractTypeArguments;
@@ -39,9 +42,18 @@ class RawMixinAppType;
 class RawClass;
 class RawContext;
 class RawDouble;
+class RawExternalTypedData;
 class RawField;
 class RawClosureData;
+class RawCode;
+class RawExceptionHandlers;
+class RawICData;
+class RawInstructions;
+class RawLocalVarDescriptors;
+class RawPcDescriptors;
 class RawRedirectionData;
+class RawStackmap;
+class RawSubtypeTestCache;
 class RawFunction;
 class RawGrowableObjectArray;
 class RawFloat32x4;
@@ -67,6 +79,7 @@ class RawTypeArguments;
 class RawTwoByteString;
 class RawUnresolvedClass;
 class String;
+class Code;
 class TokenStream;
 class UnhandledException;
 
@@ -241,6 +254,14 @@ class SnapshotReader : public BaseReader {
   // Read a full snap shot.
   void ReadFullSnapshot();
 
+  // Patch the external addresses embedded in code read from a full snapshot,
+  // once the stubs of the isolate have been generated.
+  void RelocateCode();
+
+  // Materializes the token objects array of a token stream from the encoding
+  // written by SnapshotWriter::WriteTokenObjects.
+  static RawArray* ReadTokenObjects(const ExternalTypedData& data);
+
   // Helper functions for creating uninitialized versions
   // of various object types. These are used when reading a
   // full snapshot.
@@ -250,6 +271,7 @@ class SnapshotReader : public BaseReader {
   RawTwoByteString* NewTwoByteString(intptr_t len);
   RawTypeArguments* NewTypeArguments(intptr_t len);
   RawTokenStream* NewTokenStream(intptr_t len);
+  RawExternalTypedData* NewExternalData(intptr_t len);
   RawContext* NewContext(intptr_t num_variables);
   RawClass* NewClass(intptr_t class_id);
   RawMint* NewMint(int64_t value);
@@ -278,6 +300,18 @@ class SnapshotReader : public BaseReader {
   RawLanguageError* NewLanguageError();
   RawObject* NewInteger(int64_t value);
   RawStacktrace* NewStacktrace();
+  RawCode* NewCode(intptr_t pointer_offsets_length);
+  RawInstructions* NewInstructions(intptr_t size);
+  RawPcDescriptors* NewPcDescriptors(intptr_t len);
+  RawExceptionHandlers* NewExceptionHandlers(intptr_t len);
+  RawLocalVarDescriptors* NewLocalVarDescriptors(intptr_t len);
+  RawStackmap* NewStackmap(intptr_t length);
+  RawICData* NewICData();
+  RawSubtypeTestCache* NewSubtypeTestCache();
+
+  // Returns the shared symbol for the next 'len' characters of the buffer
+  // or NULL if they have to be read into a symbol of the isolate.
+  RawOneByteString* ReadSharedSymbol(intptr_t len, intptr_t hash);
 
  private:
   class BackRefNode : public ZoneAllocated {
@@ -295,8 +329,19 @@ class SnapshotReader : public BaseReader {
     DISALLOW_COPY_AND_ASSIGN(BackRefNode);
   };
 
+  // An external address in code that is patched by RelocateCode.
+  struct PendingRelocation {
+    const Code* code;
+    intptr_t slot;  // See Assembler::GetExternalSlots.
+    intptr_t kind;  // See ExternalAddressKind in snapshot.cc.
+    intptr_t id;
+  };
+
   // Allocate uninitialized objects, this is used when reading a full snapshot.
-  RawObject* AllocateUninitialized(const Class& cls, intptr_t size);
+  // Instructions are allocated in executable pages.
+  RawObject* AllocateUninitialized(const Class& cls,
+                                   intptr_t size,
+                                   bool executable = false);
 
   RawClass* ReadClassId(intptr_t object_id);
   RawObject* ReadObjectImpl();
@@ -318,6 +363,12 @@ class SnapshotReader : public BaseReader {
 
   void ArrayReadFrom(const Array& result, intptr_t len, intptr_t tags);
 
+  // Helpers for reading the parts of a code object, pcs are stored relative
+  // to the entry point of the code.
+  RawPcDescriptors* ReadPcDescriptors(uword entry_point);
+  RawExceptionHandlers* ReadExceptionHandlers(uword entry_point);
+  void ReadCodeRelocations(const Code& code);
+
   Snapshot::Kind kind_;  // Indicates type of snapshot(full, script, message).
   Isolate* isolate_;  // Current isolate.
   Class& cls_;  // Temporary Class handle.
@@ -333,12 +384,18 @@ class SnapshotReader : public BaseReader {
   ExternalTypedData& data_;  // Temporary stream data handle.
   UnhandledException& error_;  // Error handle.
   GrowableArray<BackRefNode*> backward_references_;
+  GrowableArray<const Code*> code_objects_;  // Code read from the snapshot.
+  GrowableArray<PendingRelocation> pending_relocations_;
+  bool discard_code_;  // Code was generated under different assumptions.
+  bool populate_shared_symbols_;  // Symbols are allocated in the VM heap.
+  GrowableArray<RawString*> shared_symbols_;
 
   friend class ApiError;
   friend class Array;
   friend class BoundedType;
   friend class MixinAppType;
   friend class Class;
+  friend class Code;
   friend class Context;
   friend class ContextScope;
   friend class Field;
@@ -346,17 +403,21 @@ class SnapshotReader : public BaseReader {
   friend class RedirectionData;
   friend class Function;
   friend class GrowableObjectArray;
+  friend class ICData;
   friend class ImmutableArray;
   friend class InstantiatedTypeArguments;
   friend class JSRegExp;
   friend class LanguageError;
   friend class Library;
   friend class LibraryPrefix;
+  friend class LocalVarDescriptors;
   friend class Namespace;
   friend class LiteralToken;
   friend class PatchClass;
   friend class Script;
+  friend class Stackmap;
   friend class Stacktrace;
+  friend class SubtypeTestCache;
   friend class TokenStream;
   friend class Type;
   friend class TypeArguments;
@@ -474,7 +535,37 @@ class SnapshotWriter : public BaseWriter {
   }
   void ThrowException(Exceptions::ExceptionType type, const char* msg);
 
+  // When set, external typed data with a finalizer is written as a pointer
+  // to its backing store instead of a copy of its contents. Ownership of the
+  // data and the finalizer moves to the receiver once the write completes.
+  bool transfer_external_data() const { return transfer_external_data_; }
+
+  // Returns the weak persistent handle carrying the finalizer for 'raw' and
+  // records 'raw' for detaching, or NULL if its contents must be copied.
+  FinalizablePersistentHandle* TransferExternalData(RawExternalTypedData* raw);
+
  protected:
+  class TransferredDataNode : public ZoneAllocated {
+   public:
+    TransferredDataNode(RawExternalTypedData* raw,
+                        FinalizablePersistentHandle* handle,
+                        void* peer,
+                        Dart_WeakPersistentHandleFinalizer callback)
+        : raw_(raw), handle_(handle), peer_(peer), callback_(callback) {}
+    RawExternalTypedData* raw() const { return raw_; }
+    FinalizablePersistentHandle* handle() const { return handle_; }
+    void* peer() const { return peer_; }
+    Dart_WeakPersistentHandleFinalizer callback() const { return callback_; }
+
+   private:
+    RawExternalTypedData* raw_;
+    FinalizablePersistentHandle* handle_;
+    void* peer_;
+    Dart_WeakPersistentHandleFinalizer callback_;
+
+    DISALLOW_COPY_AND_ASSIGN(TransferredDataNode);
+  };
+
   class ForwardObjectNode : public ZoneAllocated {
    public:
     ForwardObjectNode(RawObject* raw, uword tags, SerializeState state)
@@ -495,8 +586,66 @@ class SnapshotWriter : public BaseWriter {
   intptr_t MarkObject(RawObject* raw, SerializeState state);
   void UnmarkAll();
 
+  // Symbols shared by all isolates live in the write protected VM isolate
+  // heap, their object ids are kept on the side instead of in the header.
+  class ObjectIdPair {
+   public:
+    // Typedefs needed for the DirectChainedHashMap template.
+    typedef RawObject* Key;
+    typedef intptr_t Value;
+    typedef ObjectIdPair Pair;
+
+    ObjectIdPair(Key key, Value value) : key_(key), value_(value) { }
+
+    static Key KeyOf(Pair kv) { return kv.key_; }
+
+    static Value ValueOf(Pair kv) { return kv.value_; }
+
+    static intptr_t Hashcode(Key key) {
+      return reinterpret_cast<intptr_t>(key) >> kWordSizeLog2;
+    }
+
+    static inline bool IsKeyEqual(Pair kv, Key key) {
+      return kv.key_ == key;
+    }
+
+   private:
+    Key key_;
+    Value value_;
+  };
+
+  bool IsSharedSymbol(RawObject* raw);
+  void WriteSharedSymbol(RawOneByteString* raw);
+
+  void set_transfer_external_data(bool value) {
+    transfer_external_data_ = value;
+  }
+  // Empties the external typed data whose backing store was transferred and
+  // releases the sender's finalizer for it.
+  void DetachTransferredData();
+  void MoveFinalizersTo(Message* message);
+
   bool CheckAndWritePredefinedObject(RawObject* raw);
   void HandleVMIsolateObject(RawObject* raw);
+  intptr_t LookupVMIsolateObjectId(RawObject* raw);
+  intptr_t GetObjectClassId(RawObject* raw);
+
+  // Code is only written to full snapshots when --snapshot_code is set, and
+  // only if all its objects and external addresses can be written.
+  bool CanWriteCode(RawCode* raw);
+  intptr_t LookupExternalAddress(uword address, intptr_t* id);
+  uword ExternalAddressAt(RawCode* raw, intptr_t slot);
+  static uword CodeEntryPoint(RawCode* raw);
+  void WritePcDescriptors(RawPcDescriptors* raw, uword entry_point);
+  void WriteExceptionHandlers(RawExceptionHandlers* raw, uword entry_point);
+  void WriteCodeRelocations(RawCode* raw);
+
+  // Token objects of a token stream in a full or script snapshot are encoded
+  // without references to other snapshot objects so that they can be read
+  // lazily.
+  void WriteTokenObjects(RawTokenStream* raw);
+  bool CanEncodeTokenObjects(RawArray* raw);
+  void EncodeTokenString(WriteStream* stream, RawString* raw);
 
   void WriteObjectRef(RawObject* raw);
   void WriteClassId(RawClass* cls);
@@ -526,16 +675,22 @@ class SnapshotWriter : public BaseWriter {
   GrowableArray<ForwardObjectNode*> forward_list_;
   Exceptions::ExceptionType exception_type_;  // Exception type.
   const char* exception_msg_;  // Message associated with exception.
+  bool transfer_external_data_;
+  GrowableArray<TransferredDataNode*> transferred_list_;
+  DirectChainedHashMap<ObjectIdPair> shared_object_ids_;
+  bool snapshot_code_;
 
   friend class RawArray;
   friend class RawClass;
   friend class RawClosureData;
+  friend class RawCode;
   friend class RawGrowableObjectArray;
   friend class RawImmutableArray;
   friend class RawJSRegExp;
   friend class RawLibrary;
   friend class RawLiteralToken;
   friend class RawScript;
+  friend class RawStackmap;
   friend class RawStacktrace;
   friend class RawTokenStream;
   friend class RawTypeArguments;
@@ -584,15 +739,23 @@ class ScriptSnapshotWriter : public SnapshotWriter {
 class MessageWriter : public SnapshotWriter {
  public:
   static const intptr_t kInitialSize = 512;
-  MessageWriter(uint8_t** buffer, ReAlloc alloc)
+  MessageWriter(uint8_t** buffer,
+                ReAlloc alloc,
+                bool transfer_external_data = false)
       : SnapshotWriter(Snapshot::kMessage, buffer, alloc, kInitialSize) {
     ASSERT(buffer != NULL);
     ASSERT(alloc != NULL);
+    set_transfer_external_data(transfer_external_data);
   }
   ~MessageWriter() { }
 
   void WriteMessage(const Object& obj);
 
+  // Hands the finalizers of the external data transferred by WriteMessage
+  // over to the message carrying it, which runs them if it is destroyed
+  // undelivered.
+  void TransferFinalizers(Message* message) { MoveFinalizersTo(message); }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(MessageWriter);
 };
@@ -10,6 +10,7 @@
 #include "vm/dart_api_message.h"
 #include "vm/dart_api_state.h"
 #include "vm/flags.h"
+#include "vm/message.h"
 #include "vm/snapshot.h"
 #include "vm/symbols.h"
 #include "vm/unicode.h"
@@ -18,6 +19,8 @@
 namespace dart {
 
 DECLARE_FLAG(bool, enable_type_checks);
+DECLARE_FLAG(bool, share_symbols);
+DECLARE_FLAG(bool, snapshot_code);
 
 // Check if serialized and deserialized objects are equal.
 static bool Equals(const Object& expected, const Object& actual) {
@@ -551,6 +554,39 @@ TEST_CASE(SerializeString) {
 }
 
 
+TEST_CASE(SerializeSharedSymbol) {
+  // Symbols of the first full snapshot read are shared by the isolates read
+  // from a full snapshot later on, they live in the write protected VM
+  // isolate heap.
+  if (!FLAG_share_symbols || (bin::snapshot_buffer == NULL)) {
+    return;
+  }
+  const String& symbol = String::Handle(Symbols::New("removeRange"));
+  EXPECT(symbol.IsSymbol());
+  EXPECT(symbol.InVMHeap());
+
+  // Write snapshot with object content, the header of the symbol must not
+  // be used for marking it.
+  const Array& array = Array::Handle(Array::New(2));
+  array.SetAt(0, symbol);
+  array.SetAt(1, symbol);
+  uint8_t* buffer;
+  MessageWriter writer(&buffer, &malloc_allocator);
+  writer.WriteObject(array.raw());
+  intptr_t buffer_len = writer.BytesWritten();
+
+  // Read object back from the snapshot.
+  SnapshotReader reader(buffer, buffer_len, Snapshot::kMessage,
+                        Isolate::Current());
+  Array& serialized_array = Array::Handle();
+  serialized_array ^= reader.ReadObject();
+  EXPECT_EQ(2, serialized_array.Length());
+  EXPECT(serialized_array.At(0) == symbol.raw());
+  EXPECT(serialized_array.At(1) == symbol.raw());
+  free(buffer);
+}
+
+
 TEST_CASE(SerializeArray) {
   StackZone zone(Isolate::Current());
 
@@ -782,6 +818,92 @@ TEST_CASE(SerializeExternalTypedArray) {
 }
 
 
+static void TransferredDataFinalizer(Dart_WeakPersistentHandle handle,
+                                     void* peer) {
+  free(peer);
+}
+
+
+TEST_CASE(TransferExternalTypedArray) {
+  StackZone zone(Isolate::Current());
+  const intptr_t kLength = 16;
+  uint8_t* data = reinterpret_cast<uint8_t*>(malloc(kLength));
+  for (intptr_t i = 0; i < kLength; i++) {
+    data[i] = i;
+  }
+  const ExternalTypedData& array = ExternalTypedData::Handle(
+      ExternalTypedData::New(kExternalTypedDataUint8ArrayCid, data, kLength));
+  array.AddFinalizer(data, TransferredDataFinalizer);
+
+  // Write the array in transfer mode, the sender is left with an empty array.
+  uint8_t* buffer;
+  MessageWriter writer(&buffer, &zone_allocator, true);
+  writer.WriteMessage(array);
+  intptr_t buffer_len = writer.BytesWritten();
+  EXPECT_EQ(0, array.Length());
+
+  // The receiver adopts the same backing store.
+  SnapshotReader reader(buffer, buffer_len,
+                        Snapshot::kMessage, Isolate::Current());
+  ExternalTypedData& transferred = ExternalTypedData::Handle();
+  transferred ^= reader.ReadObject();
+  EXPECT_EQ(kLength, transferred.Length());
+  EXPECT(transferred.DataAddr(0) == data);
+  for (intptr_t i = 0; i < kLength; i++) {
+    EXPECT_EQ(i, transferred.GetUint8(i));
+  }
+
+  // Read object back from the snapshot into a C structure.
+  ApiNativeScope scope;
+  ApiMessageReader api_reader(buffer, buffer_len, &zone_allocator);
+  Dart_CObject* root = api_reader.ReadMessage();
+  EXPECT_EQ(Dart_CObject_kExternalTypedData, root->type);
+  EXPECT_EQ(Dart_TypedData_kUint8, root->value.as_external_typed_data.type);
+  EXPECT_EQ(kLength, root->value.as_external_typed_data.length);
+  EXPECT(root->value.as_external_typed_data.data == data);
+  EXPECT(root->value.as_external_typed_data.peer == data);
+  EXPECT(root->value.as_external_typed_data.callback ==
+         TransferredDataFinalizer);
+}
+
+
+static intptr_t undelivered_finalizer_count = 0;
+static void* undelivered_finalizer_peer = NULL;
+
+
+static void UndeliveredDataFinalizer(Dart_WeakPersistentHandle handle,
+                                     void* peer) {
+  undelivered_finalizer_count++;
+  undelivered_finalizer_peer = peer;
+  free(peer);
+}
+
+
+TEST_CASE(TransferExternalTypedArrayUndelivered) {
+  StackZone zone(Isolate::Current());
+  const intptr_t kLength = 16;
+  uint8_t* data = reinterpret_cast<uint8_t*>(malloc(kLength));
+  const ExternalTypedData& array = ExternalTypedData::Handle(
+      ExternalTypedData::New(kExternalTypedDataUint8ArrayCid, data, kLength));
+  array.AddFinalizer(data, UndeliveredDataFinalizer);
+
+  uint8_t* buffer = NULL;
+  MessageWriter writer(&buffer, &malloc_allocator, true);
+  writer.WriteMessage(array);
+  EXPECT_EQ(0, array.Length());
+  Message* message = new Message(Message::kIllegalPort, buffer,
+                                 writer.BytesWritten(),
+                                 Message::kNormalPriority);
+  writer.TransferFinalizers(message);
+
+  // Destroying the message before it is read releases the backing store.
+  undelivered_finalizer_count = 0;
+  delete message;
+  EXPECT_EQ(1, undelivered_finalizer_count);
+  EXPECT(undelivered_finalizer_peer == data);
+}
+
+
 TEST_CASE(SerializeEmptyByteArray) {
   StackZone zone(Isolate::Current());
 
@@ -1130,6 +1252,135 @@ UNIT_TEST_CASE(FullSnapshot1) {
 }
 
 
+// Token objects of a full snapshot are only read when the token stream is
+// first used, e.g. when compiling a function.
+UNIT_TEST_CASE(FullSnapshotTokenObjects) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static const one_byte = 'h\\u00e9llo';\n"
+      "  static const two_byte = '\\u2603';\n"
+      "  static const dbl = 1.5;\n"
+      "  static const big = 0x1234567890abcdef1234;\n"
+      "  static int add(int x) => x + 42;\n"
+      "}\n"
+      "test() =>\n"
+      "    '${A.one_byte} ${A.two_byte} ${A.dbl} ${A.big} ${A.add(1)}';\n";
+  uint8_t* buffer;
+  char* expected = NULL;
+
+  // Start an Isolate, load a script and create a full snapshot.
+  {
+    TestIsolateScope __test_isolate__;
+
+    Isolate* isolate = Isolate::Current();
+    StackZone zone(isolate);
+    HandleScope scope(isolate);
+
+    // Create a test library and Load up a test script in it.
+    Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+    EXPECT_VALID(Api::CheckIsolateState(isolate));
+
+    // Write snapshot with object content.
+    FullSnapshotWriter writer(&buffer, &malloc_allocator);
+    writer.WriteFullSnapshot();
+
+    Dart_Handle result = Dart_Invoke(lib, NewString("test"), 0, NULL);
+    EXPECT_VALID(result);
+    const char* result_cstr = NULL;
+    EXPECT_VALID(Dart_StringToCString(result, &result_cstr));
+    expected = strdup(result_cstr);
+  }
+
+  // Now Create another isolate using the snapshot, the function is compiled
+  // from the token stream read from the snapshot.
+  TestCase::CreateTestIsolateFromSnapshot(buffer);
+  {
+    Dart_EnterScope();  // Start a Dart API scope for invoking API functions.
+    Dart_Handle result =
+        Dart_Invoke(TestCase::lib(), NewString("test"), 0, NULL);
+    EXPECT_VALID(result);
+    const char* result_cstr = NULL;
+    EXPECT_VALID(Dart_StringToCString(result, &result_cstr));
+    EXPECT_STREQ(expected, result_cstr);
+    Dart_ExitScope();
+  }
+  Dart_ShutdownIsolate();
+  free(expected);
+  free(buffer);
+}
+
+
+#if defined(TARGET_ARCH_X64)
+UNIT_TEST_CASE(FullSnapshotWithCode) {
+  const char* kScriptChars =
+      "class Point {\n"
+      "  Point(this.x, this.y);\n"
+      "  final x;\n"
+      "  final y;\n"
+      "}\n"
+      "class CodeTest {\n"
+      "  static int testMain() {\n"
+      "    var sum = 0;\n"
+      "    for (var i = 0; i < 10; i++) {\n"
+      "      var p = new Point(i, i + 1);\n"
+      "      sum += p.x + p.y;\n"
+      "    }\n"
+      "    return sum;\n"
+      "  }\n"
+      "}\n";
+  uint8_t* buffer;
+
+  // Start an Isolate, run a function so that it is compiled and create a
+  // full snapshot including its code.
+  const bool saved_snapshot_code = FLAG_snapshot_code;
+  FLAG_snapshot_code = true;
+  {
+    TestIsolateScope __test_isolate__;
+
+    Isolate* isolate = Isolate::Current();
+    StackZone zone(isolate);
+    HandleScope scope(isolate);
+
+    Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+    EXPECT_VALID(Api::CheckIsolateState(isolate));
+    Dart_Handle cls = Dart_GetClass(lib, NewString("CodeTest"));
+    Dart_Handle result = Dart_Invoke(cls, NewString("testMain"), 0, NULL);
+    EXPECT_VALID(result);
+
+    // Write snapshot with object content.
+    FullSnapshotWriter writer(&buffer, &malloc_allocator);
+    writer.WriteFullSnapshot();
+  }
+  FLAG_snapshot_code = saved_snapshot_code;
+
+  // Now Create another isolate using the snapshot, the function has code
+  // before it is first called.
+  TestCase::CreateTestIsolateFromSnapshot(buffer);
+  {
+    Dart_EnterScope();  // Start a Dart API scope for invoking API functions.
+    Dart_Handle cls = Dart_GetClass(TestCase::lib(), NewString("CodeTest"));
+    EXPECT_VALID(cls);
+    Type& type = Type::Handle();
+    type ^= Api::UnwrapHandle(cls);
+    const Class& clazz = Class::Handle(type.type_class());
+    const Function& function = Function::Handle(
+        clazz.LookupStaticFunction(String::Handle(String::New("testMain"))));
+    EXPECT(!function.IsNull());
+    EXPECT(function.HasCode());
+
+    Dart_Handle result = Dart_Invoke(cls, NewString("testMain"), 0, NULL);
+    EXPECT_VALID(result);
+    int64_t value = 0;
+    EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+    EXPECT_EQ(100, value);
+    Dart_ExitScope();
+  }
+  Dart_ShutdownIsolate();
+  free(buffer);
+}
+#endif  // defined(TARGET_ARCH_X64)
+
+
 UNIT_TEST_CASE(ScriptSnapshot) {
   const char* kLibScriptChars =
       "library dart_import_lib;"
@@ -1257,6 +1508,80 @@ UNIT_TEST_CASE(ScriptSnapshot) {
 }
 
 
+// Token objects of a script snapshot are only read when the token stream is
+// first used, from a copy of their encoding since the embedder may release
+// the snapshot buffer once it is loaded.
+UNIT_TEST_CASE(ScriptSnapshotTokenObjects) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static const one_byte = 'h\\u00e9llo';\n"
+      "  static const two_byte = '\\u2603';\n"
+      "  static const dbl = 1.5;\n"
+      "  static const big = 0x1234567890abcdef1234;\n"
+      "  static int add(int x) => x + 42;\n"
+      "}\n"
+      "test() =>\n"
+      "    '${A.one_byte} ${A.two_byte} ${A.dbl} ${A.big} ${A.add(1)}';\n";
+  Dart_Handle result;
+  uint8_t* buffer;
+  intptr_t size;
+  uint8_t* full_snapshot = NULL;
+  uint8_t* script_snapshot = NULL;
+  char* expected = NULL;
+
+  {
+    // Start an Isolate, and create a full snapshot of it.
+    TestIsolateScope __test_isolate__;
+    Dart_EnterScope();  // Start a Dart API scope for invoking API functions.
+    result = Dart_CreateSnapshot(&buffer, &size);
+    EXPECT_VALID(result);
+    full_snapshot = reinterpret_cast<uint8_t*>(malloc(size));
+    memmove(full_snapshot, buffer, size);
+    Dart_ExitScope();
+  }
+
+  {
+    // Load the script into an isolate created from the full snapshot and
+    // create a script snapshot of it.
+    TestCase::CreateTestIsolateFromSnapshot(full_snapshot);
+    Dart_EnterScope();  // Start a Dart API scope for invoking API functions.
+    TestCase::LoadTestScript(kScriptChars, NULL);
+    EXPECT_VALID(Api::CheckIsolateState(Isolate::Current()));
+    result = Dart_CreateScriptSnapshot(&buffer, &size);
+    EXPECT_VALID(result);
+    script_snapshot = reinterpret_cast<uint8_t*>(malloc(size));
+    memmove(script_snapshot, buffer, size);
+    result = Dart_Invoke(TestCase::lib(), NewString("test"), 0, NULL);
+    EXPECT_VALID(result);
+    const char* result_cstr = NULL;
+    EXPECT_VALID(Dart_StringToCString(result, &result_cstr));
+    expected = strdup(result_cstr);
+    Dart_ExitScope();
+    Dart_ShutdownIsolate();
+  }
+
+  {
+    // Load the script snapshot, release its buffer and compile the function
+    // from the token stream read from it.
+    TestCase::CreateTestIsolateFromSnapshot(full_snapshot);
+    Dart_EnterScope();  // Start a Dart API scope for invoking API functions.
+    Dart_Handle lib = Dart_LoadScriptFromSnapshot(script_snapshot, size);
+    EXPECT_VALID(lib);
+    memset(script_snapshot, 0, size);
+    free(script_snapshot);
+    result = Dart_Invoke(lib, NewString("test"), 0, NULL);
+    EXPECT_VALID(result);
+    const char* result_cstr = NULL;
+    EXPECT_VALID(Dart_StringToCString(result, &result_cstr));
+    EXPECT_STREQ(expected, result_cstr);
+    Dart_ExitScope();
+  }
+  Dart_ShutdownIsolate();
+  free(expected);
+  free(full_snapshot);
+}
+
+
 UNIT_TEST_CASE(ScriptSnapshot1) {
   const char* kScriptChars =
     "class _SimpleNumEnumerable<T extends num> {"
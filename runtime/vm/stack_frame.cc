@@ -192,9 +192,12 @@ bool StackFrame::FindExceptionHandler(uword* handler_pc,
   const PcDescriptors& descriptors =
       PcDescriptors::Handle(isolate, code.pc_descriptors());
   const intptr_t len = descriptors.Length();
-  for (intptr_t i = 0; i < len; i++) {
-    if ((static_cast<uword>(descriptors.PC(i)) == pc()) &&
-        (descriptors.TryIndex(i) != -1)) {
+  intptr_t i = descriptors.FindPC(pc());
+  if (i < 0) {
+    return false;
+  }
+  for (; (i < len) && (descriptors.PC(i) == pc()); i++) {
+    if (descriptors.TryIndex(i) != -1) {
       const intptr_t try_index = descriptors.TryIndex(i);
       RawExceptionHandlers::HandlerInfo handler_info;
       handlers.GetHandlerInfo(try_index, &handler_info);
@@ -216,12 +219,8 @@ intptr_t StackFrame::GetTokenPos() const {
   const PcDescriptors& descriptors =
       PcDescriptors::Handle(code.pc_descriptors());
   ASSERT(!descriptors.IsNull());
-  for (int i = 0; i < descriptors.Length(); i++) {
-    if (static_cast<uword>(descriptors.PC(i)) == pc()) {
-      return descriptors.TokenPos(i);
-    }
-  }
-  return -1;
+  const intptr_t index = descriptors.FindPC(pc());
+  return (index < 0) ? -1 : descriptors.TokenPos(index);
 }
 
 
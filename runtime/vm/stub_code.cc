@@ -166,4 +166,37 @@ const char* StubCode::NameOfStub(uword entry_point) {
   return NULL;
 }
 
+
+intptr_t StubCode::IndexOfStub(uword entry_point) {
+  intptr_t index = 0;
+#define STUB_CODE_TESTER(name)                                                 \
+  if ((name##_entry() != NULL) && (entry_point == name##EntryPoint())) {       \
+    return index;                                                              \
+  }                                                                            \
+  index++;
+
+  VM_STUB_CODE_LIST(STUB_CODE_TESTER);
+  Isolate* isolate = Isolate::Current();
+  if ((isolate != NULL) && (isolate->stub_code() != NULL)) {
+    STUB_CODE_LIST(STUB_CODE_TESTER);
+  }
+#undef STUB_CODE_TESTER
+  return -1;
+}
+
+
+uword StubCode::EntryPointOfStub(intptr_t index) {
+  intptr_t i = 0;
+#define STUB_CODE_ENTRY(name)                                                  \
+  if (i++ == index) {                                                          \
+    return name##EntryPoint();                                                 \
+  }
+
+  VM_STUB_CODE_LIST(STUB_CODE_ENTRY);
+  STUB_CODE_LIST(STUB_CODE_ENTRY);
+#undef STUB_CODE_ENTRY
+  UNREACHABLE();
+  return 0;
+}
+
 }  // namespace dart
@@ -123,6 +123,11 @@ class StubCode {
   // Returns NULL if no stub found.
   static const char* NameOfStub(uword entry_point);
 
+  // Stable index of the stub with the specified entry point, used to relocate
+  // code in snapshots. Returns -1 if no stub found.
+  static intptr_t IndexOfStub(uword entry_point);
+  static uword EntryPointOfStub(intptr_t index);
+
   // Define the shared stub code accessors.
 #define STUB_CODE_ACCESSOR(name)                                               \
   static StubEntry* name##_entry() {                                           \
@@ -1050,8 +1050,16 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   __ Ret();
 
   __ Bind(&add_to_buffer);
+  // A sweeper task may be clearing the mark bit of this object concurrently,
+  // so the remembered bit is set with an exclusive load/store pair.
+  Label retry;
+  __ AddImmediate(R3, R0, Object::tags_offset() - kHeapObjectTag);
+  __ Bind(&retry);
+  __ ldrex(R2, R3);
   __ orr(R2, R2, ShifterOperand(1 << RawObject::kRememberedBit));
-  __ str(R2, FieldAddress(R0, Object::tags_offset()));
+  __ strex(R1, R2, R3);
+  __ cmp(R1, ShifterOperand(1));
+  __ b(&retry, EQ);
 
   // Load the isolate out of the context.
   // Spilled: R1, R2, R3.
@@ -27,6 +27,7 @@ DEFINE_FLAG(bool, use_slow_path, false,
     "Set to true for debugging & verifying the slow paths.");
 DECLARE_FLAG(int, optimization_counter_threshold);
 DECLARE_FLAG(bool, trace_optimized_ic_calls);
+DECLARE_FLAG(bool, incremental_marking);
 
 // Input parameters:
 //   ESP : points to return address.
@@ -1024,11 +1025,21 @@ void StubCode::GenerateAllocateContextStub(Assembler* assembler) {
 }
 
 DECLARE_LEAF_RUNTIME_ENTRY(void, StoreBufferBlockProcess, Isolate* isolate);
+DECLARE_LEAF_RUNTIME_ENTRY(void, MarkStoredObject,
+                           Isolate* isolate, RawObject* value);
 
 // Helper stub to implement Assembler::StoreIntoObject.
 // Input parameters:
 //   EAX: Address being stored
+//   ECX: Value being stored, with --incremental_marking only
 void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+  Label old_value;
+  if (FLAG_incremental_marking) {
+    // The value is a heap object and the object is old.
+    __ testl(ECX, Immediate(kNewObjectAlignmentOffset));
+    __ j(ZERO, &old_value);
+  }
+
   // Save values being destroyed.
   __ pushl(EDX);
   __ pushl(ECX);
@@ -1046,8 +1057,11 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   __ ret();
 
   __ Bind(&add_to_buffer);
-  __ orl(ECX, Immediate(1 << RawObject::kRememberedBit));
-  __ movl(FieldAddress(EAX, Object::tags_offset()), ECX);
+  // A sweeper task may be clearing the mark bit of this object concurrently,
+  // so the remembered bit is set with a locked instruction.
+  __ lock();
+  __ orl(FieldAddress(EAX, Object::tags_offset()),
+         Immediate(1 << RawObject::kRememberedBit));
 
   // Load the isolate out of the context.
   // Spilled: EDX, ECX
@@ -1089,6 +1103,35 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   // Restore callee-saved registers, tear down frame.
   __ LeaveCallRuntimeFrame();
   __ ret();
+
+  if (FLAG_incremental_marking) {
+    // Gray an unmarked old value while old space is marked incrementally.
+    // Objects of the VM isolate heap are always marked.
+    // EAX: Address being stored
+    // ECX: Value being stored
+    Label skip_marking, mark_value;
+    __ Bind(&old_value);
+    __ pushl(EDX);
+    __ movl(EDX, FieldAddress(ECX, Object::tags_offset()));
+    __ testl(EDX, Immediate(1 << RawObject::kMarkBit));
+    __ j(NOT_ZERO, &skip_marking, Assembler::kNearJump);
+    __ movl(EDX, FieldAddress(CTX, Context::isolate_offset()));
+    __ cmpl(Address(EDX, Isolate::incremental_marker_offset()), Immediate(0));
+    __ j(NOT_EQUAL, &mark_value, Assembler::kNearJump);
+    __ Bind(&skip_marking);
+    __ popl(EDX);
+    __ ret();
+
+    __ Bind(&mark_value);
+    __ popl(EDX);
+    __ EnterCallRuntimeFrame(2 * kWordSize);
+    __ movl(EAX, FieldAddress(CTX, Context::isolate_offset()));
+    __ movl(Address(ESP, 0 * kWordSize), EAX);  // Isolate.
+    __ movl(Address(ESP, 1 * kWordSize), ECX);  // Value.
+    __ CallRuntime(kMarkStoredObjectRuntimeEntry, 2);
+    __ LeaveCallRuntimeFrame();
+    __ ret();
+  }
 }
 
 
@@ -27,6 +27,7 @@ DEFINE_FLAG(bool, use_slow_path, false,
     "Set to true for debugging & verifying the slow paths.");
 DECLARE_FLAG(int, optimization_counter_threshold);
 DECLARE_FLAG(bool, trace_optimized_ic_calls);
+DECLARE_FLAG(bool, incremental_marking);
 
 
 // Input parameters:
@@ -1027,11 +1028,21 @@ void StubCode::GenerateAllocateContextStub(Assembler* assembler) {
 
 
 DECLARE_LEAF_RUNTIME_ENTRY(void, StoreBufferBlockProcess, Isolate* isolate);
+DECLARE_LEAF_RUNTIME_ENTRY(void, MarkStoredObject,
+                           Isolate* isolate, RawObject* value);
 
 // Helper stub to implement Assembler::StoreIntoObject.
 // Input parameters:
 //   RAX: Address being stored
+//   RCX: Value being stored, with --incremental_marking only
 void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+  Label old_value;
+  if (FLAG_incremental_marking) {
+    // The value is a heap object and the object is old.
+    __ testl(RCX, Immediate(kNewObjectAlignmentOffset));
+    __ j(ZERO, &old_value);
+  }
+
   // Save registers being destroyed.
   __ pushq(RDX);
   __ pushq(RCX);
@@ -1049,8 +1060,11 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   __ ret();
 
   __ Bind(&add_to_buffer);
-  __ orq(RCX, Immediate(1 << RawObject::kRememberedBit));
-  __ movq(FieldAddress(RAX, Object::tags_offset()), RCX);
+  // A sweeper task may be clearing the mark bit of this object concurrently,
+  // so the remembered bit is set with a locked instruction.
+  __ lock();
+  __ orq(FieldAddress(RAX, Object::tags_offset()),
+         Immediate(1 << RawObject::kRememberedBit));
 
   // Load the isolate out of the context.
   // RAX: Address being stored
@@ -1085,6 +1099,34 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   __ CallRuntime(kStoreBufferBlockProcessRuntimeEntry, 1);
   __ LeaveCallRuntimeFrame();
   __ ret();
+
+  if (FLAG_incremental_marking) {
+    // Gray an unmarked old value while old space is marked incrementally.
+    // Objects of the VM isolate heap are always marked.
+    // RAX: Address being stored
+    // RCX: Value being stored
+    Label skip_marking, mark_value;
+    __ Bind(&old_value);
+    __ pushq(RDX);
+    __ movq(RDX, FieldAddress(RCX, Object::tags_offset()));
+    __ testq(RDX, Immediate(1 << RawObject::kMarkBit));
+    __ j(NOT_ZERO, &skip_marking, Assembler::kNearJump);
+    __ movq(RDX, FieldAddress(CTX, Context::isolate_offset()));
+    __ cmpq(Address(RDX, Isolate::incremental_marker_offset()), Immediate(0));
+    __ j(NOT_EQUAL, &mark_value, Assembler::kNearJump);
+    __ Bind(&skip_marking);
+    __ popq(RDX);
+    __ ret();
+
+    __ Bind(&mark_value);
+    __ popq(RDX);
+    __ EnterCallRuntimeFrame(0);
+    __ movq(RDI, FieldAddress(CTX, Context::isolate_offset()));
+    __ movq(RSI, RCX);
+    __ CallRuntime(kMarkStoredObjectRuntimeEntry, 2);
+    __ LeaveCallRuntimeFrame();
+    __ ret();
+  }
 }
 
 
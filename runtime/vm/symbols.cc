@@ -4,9 +4,11 @@
 
 #include "vm/symbols.h"
 
+#include "vm/atomic.h"
 #include "vm/handles.h"
 #include "vm/handles_impl.h"
 #include "vm/isolate.h"
+#include "vm/json_stream.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
 #include "vm/raw_object.h"
@@ -35,8 +37,68 @@ PREDEFINED_SYMBOLS_LIST(DEFINE_SYMBOL_LITERAL)
 #undef DEFINE_KEYWORD_SYMBOL_INDEX
 };
 
+// A symbol table is an Array of entries, each a symbol and its hash as a
+// Smi, followed by the number of used entries. Empty entries have a hash of
+// 0, which no string has, so probes only read the hashes of the entries they
+// pass and growing the table does not touch the symbols. The capacity is a
+// power of two and collisions are resolved by triangular probing, which
+// visits every entry.
+enum {
+  kSymbolOffset = 0,
+  kHashOffset = 1,
+  kEntrySize = 2
+};
+
+
+static intptr_t TableCapacity(const Array& symbol_table) {
+  return (symbol_table.Length() - 1) / kEntrySize;
+}
+
+
+static intptr_t UsedCountIndex(const Array& symbol_table) {
+  return symbol_table.Length() - 1;
+}
+
+
+static intptr_t SymbolIndex(intptr_t entry) {
+  return (entry * kEntrySize) + kSymbolOffset;
+}
+
+
+static intptr_t HashIndex(intptr_t entry) {
+  return (entry * kEntrySize) + kHashOffset;
+}
+
+
+static intptr_t HashAt(const Array& symbol_table, intptr_t entry) {
+  return Smi::Value(reinterpret_cast<RawSmi*>(
+      symbol_table.At(HashIndex(entry))));
+}
+
+
+static intptr_t UsedCount(const Array& symbol_table) {
+  return Smi::Value(reinterpret_cast<RawSmi*>(
+      symbol_table.At(UsedCountIndex(symbol_table))));
+}
+
+
+static RawArray* NewSymbolTable(intptr_t capacity) {
+  ASSERT(Utils::IsPowerOfTwo(capacity));
+  const Array& symbol_table =
+      Array::Handle(Array::New((capacity * kEntrySize) + 1, Heap::kOld));
+  const Smi& zero = Smi::Handle(Smi::New(0));
+  for (intptr_t i = 0; i < capacity; i++) {
+    symbol_table.SetAt(HashIndex(i), zero);
+  }
+  symbol_table.SetAt(UsedCountIndex(symbol_table), zero);
+  return symbol_table.raw();
+}
+
+
 intptr_t Symbols::num_of_grows_;
 intptr_t Symbols::collision_count_[kMaxCollisionBuckets];
+uword Symbols::shared_symbols_claimed_ = 0;
+Symbols::SharedTable* Symbols::shared_symbols_ = NULL;
 
 DEFINE_FLAG(bool, dump_symbol_stats, false, "Dump symbol table statistics");
 
@@ -122,11 +184,8 @@ void Symbols::SetupSymbolTable(Isolate* isolate) {
   // Setup the symbol table used within the String class.
   const intptr_t initial_size = (isolate == Dart::vm_isolate()) ?
       kInitialVMIsolateSymtabSize : kInitialSymtabSize;
-  const Array& array = Array::Handle(Array::New(initial_size + 1));
-
-  // Last element contains the count of used slots.
-  array.SetAt(initial_size, Smi::Handle(Smi::New(0)));
-  isolate->object_store()->set_symbol_table(array);
+  isolate->object_store()->set_symbol_table(
+      Array::Handle(NewSymbolTable(initial_size)));
 }
 
 
@@ -134,10 +193,7 @@ intptr_t Symbols::Size(Isolate* isolate) {
   ASSERT(isolate != NULL);
   Array& symbol_table = Array::Handle(isolate,
                                       isolate->object_store()->symbol_table());
-  intptr_t table_size_index = symbol_table.Length() - 1;
-  dart::Smi& used = Smi::Handle();
-  used ^= symbol_table.At(table_size_index);
-  return used.Value();
+  return UsedCount(symbol_table);
 }
 
 
@@ -146,7 +202,7 @@ void Symbols::Add(const Array& symbol_table, const String& str) {
   ASSERT(Isolate::Current() == Dart::vm_isolate());
   intptr_t hash = str.Hash();
   intptr_t index = FindIndex(symbol_table, str, 0, str.Length(), hash);
-  ASSERT(symbol_table.At(index) == String::null());
+  ASSERT(symbol_table.At(SymbolIndex(index)) == String::null());
   InsertIntoSymbolTable(symbol_table, str, index);
 }
 
@@ -208,14 +264,14 @@ RawString* Symbols::NewSymbol(const CharacterType* characters,
   // First check if a symbol exists in the vm isolate for these characters.
   symbol_table = Dart::vm_isolate()->object_store()->symbol_table();
   intptr_t index = FindIndex(symbol_table, characters, len, hash);
-  symbol ^= symbol_table.At(index);
+  symbol ^= symbol_table.At(SymbolIndex(index));
   if (symbol.IsNull()) {
     // Now try in the symbol table of the current isolate.
     symbol_table = isolate->object_store()->symbol_table();
     index = FindIndex(symbol_table, characters, len, hash);
     // Since we leave enough room in the table to guarantee, that we find an
     // empty spot, index is the insertion point if symbol is null.
-    symbol ^= symbol_table.At(index);
+    symbol ^= symbol_table.At(SymbolIndex(index));
     if (symbol.IsNull()) {
       // Allocate new result string.
       symbol = (*new_string)(characters, len, Heap::kOld);
@@ -269,14 +325,14 @@ RawString* Symbols::New(const String& str, intptr_t begin_index, intptr_t len) {
   // First check if a symbol exists in the vm isolate for these characters.
   symbol_table = Dart::vm_isolate()->object_store()->symbol_table();
   intptr_t index = FindIndex(symbol_table, str, begin_index, len, hash);
-  symbol ^= symbol_table.At(index);
+  symbol ^= symbol_table.At(SymbolIndex(index));
   if (symbol.IsNull()) {
     // Now try in the symbol table of the current isolate.
     symbol_table = isolate->object_store()->symbol_table();
     index = FindIndex(symbol_table, str, begin_index, len, hash);
     // Since we leave enough room in the table to guarantee, that we find an
     // empty spot, index is the insertion point if symbol is null.
-    symbol ^= symbol_table.At(index);
+    symbol ^= symbol_table.At(SymbolIndex(index));
     if (symbol.IsNull()) {
       if (str.IsOld() && begin_index == 0 && len == str.Length()) {
         // Reuse the incoming str as the symbol value.
@@ -304,23 +360,28 @@ RawString* Symbols::FromCharCode(int32_t char_code) {
 
 void Symbols::DumpStats() {
   if (FLAG_dump_symbol_stats) {
-    intptr_t table_size = 0;
-    dart::Smi& used = Smi::Handle();
     Array& symbol_table = Array::Handle(Array::null());
 
     // First dump VM symbol table stats.
     symbol_table = Dart::vm_isolate()->object_store()->symbol_table();
-    table_size = symbol_table.Length() - 1;
-    used ^= symbol_table.At(table_size);
-    OS::Print("VM Isolate: Number of symbols : %" Pd "\n", used.Value());
-    OS::Print("VM Isolate: Symbol table capacity : %" Pd "\n", table_size);
+    OS::Print("VM Isolate: Number of symbols : %" Pd "\n",
+              UsedCount(symbol_table));
+    OS::Print("VM Isolate: Symbol table capacity : %" Pd "\n",
+              TableCapacity(symbol_table));
 
     // Now dump regular isolate symbol table stats.
     symbol_table = Isolate::Current()->object_store()->symbol_table();
-    table_size = symbol_table.Length() - 1;
-    used ^= symbol_table.At(table_size);
-    OS::Print("Isolate: Number of symbols : %" Pd "\n", used.Value());
-    OS::Print("Isolate: Symbol table capacity : %" Pd "\n", table_size);
+    OS::Print("Isolate: Number of symbols : %" Pd "\n",
+              UsedCount(symbol_table));
+    OS::Print("Isolate: Symbol table capacity : %" Pd "\n",
+              TableCapacity(symbol_table));
+
+    // Symbols shared by all isolates read from a full snapshot.
+    const SharedTable* shared = shared_symbols_;
+    if (shared != NULL) {
+      OS::Print("Shared: Number of symbols : %" Pd "\n", shared->length);
+      OS::Print("Shared: Symbol table capacity : %" Pd "\n", shared->size);
+    }
 
     // Dump overall collision and growth counts.
     OS::Print("Number of symbol table grows = %" Pd "\n", num_of_grows_);
@@ -334,40 +395,100 @@ void Symbols::DumpStats() {
 }
 
 
+static void PrintSymbolTable(const Array& symbol_table, JSONObject* jsobj) {
+  const intptr_t capacity = TableCapacity(symbol_table);
+  const intptr_t mask = capacity - 1;
+  const intptr_t used = UsedCount(symbol_table);
+  intptr_t total_probes = 0;
+  intptr_t max_probes = 0;
+  for (intptr_t entry = 0; entry < capacity; entry++) {
+    const intptr_t hash = HashAt(symbol_table, entry);
+    if (hash == 0) {
+      continue;
+    }
+    // Count the collisions a lookup of the symbol runs into.
+    intptr_t probes = 0;
+    intptr_t index = hash & mask;
+    while (index != entry) {
+      probes += 1;
+      index = (index + probes) & mask;
+    }
+    total_probes += probes;
+    max_probes = Utils::Maximum(max_probes, probes);
+  }
+  jsobj->AddProperty("symbols", used);
+  jsobj->AddProperty("capacity", capacity);
+  jsobj->AddProperty("occupancy", static_cast<double>(used) / capacity);
+  jsobj->AddProperty("averageProbeLength",
+                     (used > 0) ? static_cast<double>(total_probes) / used
+                                : 0.0);
+  jsobj->AddProperty("maxProbeLength", max_probes);
+}
+
+
+void Symbols::PrintToJSONStream(Isolate* isolate, JSONStream* stream) {
+  JSONObject jsobj(stream);
+  jsobj.AddProperty("type", "SymbolTable");
+  jsobj.AddProperty("grows", num_of_grows_);
+  {
+    JSONObject vm_table(&jsobj, "vm");
+    PrintSymbolTable(
+        Array::Handle(Dart::vm_isolate()->object_store()->symbol_table()),
+        &vm_table);
+  }
+  {
+    JSONObject isolate_table(&jsobj, "isolate");
+    PrintSymbolTable(Array::Handle(isolate->object_store()->symbol_table()),
+                     &isolate_table);
+  }
+  const SharedTable* shared = shared_symbols_;
+  if (shared != NULL) {
+    JSONObject shared_table(&jsobj, "shared");
+    shared_table.AddProperty("symbols", shared->length);
+    shared_table.AddProperty("capacity", shared->size);
+  }
+}
+
+
+void Symbols::CountCollisions(intptr_t num_collisions) {
+  if (FLAG_dump_symbol_stats) {
+    if (num_collisions >= kMaxCollisionBuckets) {
+      num_collisions = (kMaxCollisionBuckets - 1);
+    }
+    collision_count_[num_collisions] += 1;
+  }
+}
+
+
 void Symbols::GrowSymbolTable(const Array& symbol_table) {
   // TODO(iposva): Avoid exponential growth.
   num_of_grows_ += 1;
-  intptr_t table_size = symbol_table.Length() - 1;
+  intptr_t table_size = TableCapacity(symbol_table);
   intptr_t new_table_size = table_size * 2;
-  Array& new_symbol_table = Array::Handle(Array::New(new_table_size + 1));
-  // Copy all elements from the original symbol table to the newly allocated
-  // array.
-  String& element = String::Handle();
-  dart::Object& new_element = Object::Handle();
+  intptr_t mask = new_table_size - 1;
+  Array& new_symbol_table = Array::Handle(NewSymbolTable(new_table_size));
+  // Move all entries from the original symbol table to the newly allocated
+  // array. Only the stored hashes are read, not the symbols.
+  dart::Object& element = Object::Handle();
   for (intptr_t i = 0; i < table_size; i++) {
-    element ^= symbol_table.At(i);
-    if (!element.IsNull()) {
-      intptr_t hash = element.Hash();
-      intptr_t index = hash % new_table_size;
-      new_element = new_symbol_table.At(index);
+    intptr_t hash = HashAt(symbol_table, i);
+    if (hash != 0) {
+      intptr_t index = hash & mask;
       intptr_t num_collisions = 0;
-      while (!new_element.IsNull()) {
-        index = (index + 1) % new_table_size;  // Move to next element.
-        new_element = new_symbol_table.At(index);
+      while (HashAt(new_symbol_table, index) != 0) {
         num_collisions += 1;
+        index = (index + num_collisions) & mask;  // Move to next element.
       }
-      if (FLAG_dump_symbol_stats) {
-        if (num_collisions >= kMaxCollisionBuckets) {
-          num_collisions = (kMaxCollisionBuckets - 1);
-        }
-        collision_count_[num_collisions] += 1;
-      }
-      new_symbol_table.SetAt(index, element);
+      CountCollisions(num_collisions);
+      element = symbol_table.At(SymbolIndex(i));
+      new_symbol_table.SetAt(SymbolIndex(index), element);
+      element = symbol_table.At(HashIndex(i));
+      new_symbol_table.SetAt(HashIndex(index), element);
     }
   }
   // Copy used count.
-  new_element = symbol_table.At(table_size);
-  new_symbol_table.SetAt(new_table_size, new_element);
+  element = symbol_table.At(UsedCountIndex(symbol_table));
+  new_symbol_table.SetAt(UsedCountIndex(new_symbol_table), element);
   // Remember the new symbol table now.
   Isolate::Current()->object_store()->set_symbol_table(new_symbol_table);
 }
@@ -376,17 +497,17 @@ void Symbols::GrowSymbolTable(const Array& symbol_table) {
 void Symbols::InsertIntoSymbolTable(const Array& symbol_table,
                                     const String& symbol,
                                     intptr_t index) {
-  intptr_t table_size = symbol_table.Length() - 1;
   symbol.SetCanonical();  // Mark object as being canonical.
-  symbol_table.SetAt(index, symbol);  // Remember the new symbol.
-  dart::Smi& used = Smi::Handle();
-  used ^= symbol_table.At(table_size);
-  intptr_t used_elements = used.Value() + 1;  // One more element added.
-  used = Smi::New(used_elements);
-  symbol_table.SetAt(table_size, used);  // Update used count.
+  // Remember the new symbol and its hash.
+  symbol_table.SetAt(SymbolIndex(index), symbol);
+  dart::Smi& value = Smi::Handle(Smi::New(symbol.Hash()));
+  symbol_table.SetAt(HashIndex(index), value);
+  intptr_t used_elements = UsedCount(symbol_table) + 1;  // One more element.
+  value = Smi::New(used_elements);
+  symbol_table.SetAt(UsedCountIndex(symbol_table), value);
 
   // Rehash if symbol_table is 75% full.
-  if (used_elements > ((table_size / 4) * 3)) {
+  if (used_elements > ((TableCapacity(symbol_table) / 4) * 3)) {
     GrowSymbolTable(symbol_table);
   }
 }
@@ -397,24 +518,25 @@ intptr_t Symbols::FindIndex(const Array& symbol_table,
                             const T* characters,
                             intptr_t len,
                             intptr_t hash) {
-  // Last element of the array is the number of used elements.
-  intptr_t table_size = symbol_table.Length() - 1;
-  intptr_t index = hash % table_size;
+  intptr_t mask = TableCapacity(symbol_table) - 1;
+  intptr_t index = hash & mask;
   intptr_t num_collisions = 0;
 
+  // Only symbols with the same hash are compared.
   String& symbol = String::Handle();
-  symbol ^= symbol_table.At(index);
-  while (!symbol.IsNull() && !symbol.Equals(characters, len)) {
-    index = (index + 1) % table_size;  // Move to next element.
-    symbol ^= symbol_table.At(index);
-    num_collisions += 1;
-  }
-  if (FLAG_dump_symbol_stats) {
-    if (num_collisions >= kMaxCollisionBuckets) {
-      num_collisions = (kMaxCollisionBuckets - 1);
+  intptr_t entry_hash = HashAt(symbol_table, index);
+  while (entry_hash != 0) {
+    if (entry_hash == hash) {
+      symbol ^= symbol_table.At(SymbolIndex(index));
+      if (symbol.Equals(characters, len)) {
+        break;
+      }
     }
-    collision_count_[num_collisions] += 1;
+    num_collisions += 1;
+    index = (index + num_collisions) & mask;  // Move to next element.
+    entry_hash = HashAt(symbol_table, index);
   }
+  CountCollisions(num_collisions);
   return index;  // Index of symbol if found or slot into which to add symbol.
 }
 
@@ -438,24 +560,25 @@ intptr_t Symbols::FindIndex(const Array& symbol_table,
                             intptr_t begin_index,
                             intptr_t len,
                             intptr_t hash) {
-  // Last element of the array is the number of used elements.
-  intptr_t table_size = symbol_table.Length() - 1;
-  intptr_t index = hash % table_size;
+  intptr_t mask = TableCapacity(symbol_table) - 1;
+  intptr_t index = hash & mask;
   intptr_t num_collisions = 0;
 
+  // Only symbols with the same hash are compared.
   String& symbol = String::Handle();
-  symbol ^= symbol_table.At(index);
-  while (!symbol.IsNull() && !symbol.Equals(str, begin_index, len)) {
-    index = (index + 1) % table_size;  // Move to next element.
-    symbol ^= symbol_table.At(index);
-    num_collisions += 1;
-  }
-  if (FLAG_dump_symbol_stats) {
-    if (num_collisions >= kMaxCollisionBuckets) {
-      num_collisions = (kMaxCollisionBuckets - 1);
+  intptr_t entry_hash = HashAt(symbol_table, index);
+  while (entry_hash != 0) {
+    if (entry_hash == hash) {
+      symbol ^= symbol_table.At(SymbolIndex(index));
+      if (symbol.Equals(str, begin_index, len)) {
+        break;
+      }
     }
-    collision_count_[num_collisions] += 1;
+    num_collisions += 1;
+    index = (index + num_collisions) & mask;  // Move to next element.
+    entry_hash = HashAt(symbol_table, index);
   }
+  CountCollisions(num_collisions);
   return index;  // Index of symbol if found or slot into which to add symbol.
 }
 
@@ -479,4 +602,60 @@ RawObject* Symbols::GetVMSymbol(intptr_t object_id) {
   return Object::null();
 }
 
+
+bool Symbols::ClaimSharedSymbols() {
+  return AtomicOperations::CompareAndSwapWord(&shared_symbols_claimed_,
+                                              0, 1) == 0;
+}
+
+
+void Symbols::SetSharedSymbols(RawString** symbols, intptr_t length) {
+  ASSERT(shared_symbols_claimed_ != 0);
+  ASSERT(shared_symbols_ == NULL);
+  // Keep the table at most half full.
+  intptr_t size = Utils::RoundUpToPowerOfTwo(2 * length + 1);
+  SharedTable* table = reinterpret_cast<SharedTable*>(
+      malloc(sizeof(SharedTable) + ((size - 1) * sizeof(RawString*))));
+  table->size = size;
+  table->length = length;
+  for (intptr_t i = 0; i < size; i++) {
+    table->symbols[i] = NULL;
+  }
+  String& symbol = String::Handle();
+  for (intptr_t i = 0; i < length; i++) {
+    symbol = symbols[i];
+    ASSERT(symbol.IsSymbol() && symbol.InVMHeap());
+    intptr_t index = symbol.Hash() & (size - 1);
+    while (table->symbols[index] != NULL) {
+      index = (index + 1) & (size - 1);
+    }
+    table->symbols[index] = symbol.raw();
+  }
+  // Publish the table once it is complete.
+  AtomicOperations::CompareAndSwapWord(
+      reinterpret_cast<uword*>(&shared_symbols_),
+      0,
+      reinterpret_cast<uword>(table));
+}
+
+
+RawString* Symbols::LookupSharedSymbol(const uint8_t* characters,
+                                       intptr_t len,
+                                       intptr_t hash) {
+  const SharedTable* table = shared_symbols_;
+  if (table == NULL) {
+    return NULL;
+  }
+  String& symbol = String::Handle();
+  intptr_t index = hash & (table->size - 1);
+  while (table->symbols[index] != NULL) {
+    symbol = table->symbols[index];
+    if ((symbol.Hash() == hash) && symbol.Equals(characters, len)) {
+      return symbol.raw();
+    }
+    index = (index + 1) & (table->size - 1);
+  }
+  return NULL;
+}
+
 }  // namespace dart
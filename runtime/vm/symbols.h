@@ -12,6 +12,7 @@ namespace dart {
 
 // Forward declarations.
 class Isolate;
+class JSONStream;
 class ObjectPointerVisitor;
 
 #define PREDEFINED_SYMBOLS_LIST(V)                                             \
@@ -450,6 +451,10 @@ PREDEFINED_SYMBOLS_LIST(DEFINE_SYMBOL_HANDLE_ACCESSOR)
 
   static void DumpStats();
 
+  // Prints the number of symbols, capacity and probe lengths of the symbol
+  // tables of the VM isolate and of the given isolate.
+  static void PrintToJSONStream(Isolate* isolate, JSONStream* stream);
+
  private:
   enum {
     kInitialVMIsolateSymtabSize = 512,
@@ -473,6 +478,9 @@ PREDEFINED_SYMBOLS_LIST(DEFINE_SYMBOL_HANDLE_ACCESSOR)
   // Grow the symbol table.
   static void GrowSymbolTable(const Array& symbol_table);
 
+  // Records the number of collisions of a probe, see FLAG_dump_symbol_stats.
+  static void CountCollisions(intptr_t num_collisions);
+
   // Return index in symbol table if the symbol already exists or
   // return the index into which the new symbol can be added.
   template<typename T>
@@ -487,6 +495,16 @@ PREDEFINED_SYMBOLS_LIST(DEFINE_SYMBOL_HANDLE_ACCESSOR)
                             intptr_t hash);
   static intptr_t LookupVMSymbol(RawObject* obj);
   static RawObject* GetVMSymbol(intptr_t object_id);
+
+  // The one byte symbols of the first full snapshot read by the VM are
+  // allocated in the VM isolate heap and shared by all isolates read from a
+  // full snapshot later on. Only the first reader may claim the table, it is
+  // visible to other isolates once set.
+  static bool ClaimSharedSymbols();
+  static void SetSharedSymbols(RawString** symbols, intptr_t length);
+  static RawString* LookupSharedSymbol(const uint8_t* characters,
+                                       intptr_t len,
+                                       intptr_t hash);
   static bool IsVMSymbolId(intptr_t object_id) {
     return (object_id >= kMaxPredefinedObjectIds &&
             object_id < (kMaxPredefinedObjectIds + kMaxPredefinedId));
@@ -500,6 +518,15 @@ PREDEFINED_SYMBOLS_LIST(DEFINE_SYMBOL_HANDLE_ACCESSOR)
   // List of handles for predefined symbols.
   static String* symbol_handles_[kMaxPredefinedId];
 
+  // Open addressing hash table of the shared symbols, never freed.
+  struct SharedTable {
+    intptr_t size;  // A power of two.
+    intptr_t length;  // Number of symbols.
+    RawString* symbols[1];
+  };
+  static uword shared_symbols_claimed_;
+  static SharedTable* shared_symbols_;
+
   // Statistics used to measure the efficiency of the symbol table.
   static const intptr_t kMaxCollisionBuckets = 10;
   static intptr_t num_of_grows_;
@@ -25,9 +25,11 @@ class ObjectPointerVisitor {
   // Range of pointers to visit 'first' <= pointer <= 'last'.
   virtual void VisitPointers(RawObject** first, RawObject** last) = 0;
 
+  // Visitors that do not visit function code are told about every function
+  // whose code pointers were skipped.
   virtual bool visit_function_code() const { return true; }
-  virtual GrowableArray<RawFunction*>* skipped_code_functions() {
-    return NULL;
+  virtual void AddSkippedCodeFunction(RawFunction* raw_function) {
+    UNREACHABLE();
   }
 
   // len argument is the number of pointers to visit starting from 'p'.
@@ -113,6 +113,9 @@ patch class _RandomAccessFile {
   patch static _readInto(int id, List<int> buffer, int start, int end) {
     throw new UnsupportedError("RandomAccessFile._readInto");
   }
+  patch static _map(int id, int bytes) {
+    throw new UnsupportedError("RandomAccessFile._map");
+  }
   patch static _writeByte(int id, int value) {
     throw new UnsupportedError("RandomAccessFile._writeByte");
   }
@@ -406,6 +406,28 @@ abstract class RandomAccessFile {
    */
   List<int> readSync(int bytes);
 
+  /**
+   * Maps a maximum of [bytes] bytes of the file starting at the current
+   * position into memory instead of copying them, and advances the position
+   * past them like [read]. The mapping is private: changes to the returned
+   * list are not written to the file. Files that cannot be mapped, like pipes
+   * and special files, are read into a copy instead.
+   *
+   * Truncating the file while the returned list is alive makes accessing the
+   * bytes beyond the new length fail.
+   *
+   * Returns a [:Future<List<int>>:] that completes with the mapped bytes.
+   */
+  Future<List<int>> map(int bytes);
+
+  /**
+   * Synchronously maps a maximum of [bytes] bytes of the file starting at the
+   * current position into memory, see [map].
+   *
+   * Throws a [FileSystemException] if the operation fails.
+   */
+  List<int> mapSync(int bytes);
+
   /**
    * Reads into an existing List<int> from the file. If [start] is present, the
    * bytes will be filled into [buffer] from at index [start], otherwise index
@@ -642,6 +642,32 @@ class _RandomAccessFile implements RandomAccessFile {
     return result;
   }
 
+  Future<List<int>> map(int bytes) {
+    if (bytes is !int) {
+      throw new ArgumentError(bytes);
+    }
+    return _dispatch(_FILE_MAP, [_id, bytes]).then((response) {
+      if (_isErrorResponse(response)) {
+        throw _exceptionFromResponse(response, "map failed", path);
+      }
+      return response[1];
+    });
+  }
+
+  external static _map(int id, int bytes);
+
+  List<int> mapSync(int bytes) {
+    _checkAvailable();
+    if (bytes is !int) {
+      throw new ArgumentError(bytes);
+    }
+    var result = _map(_id, bytes);
+    if (result is OSError) {
+      throw new FileSystemException("mapSync failed", path, result);
+    }
+    return result;
+  }
+
   Future<int> readInto(List<int> buffer, [int start, int end]) {
     if (buffer is !List ||
         (start != null && start is !int) ||
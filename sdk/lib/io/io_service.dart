@@ -44,6 +44,7 @@ const int _DIRECTORY_LIST_NEXT = 35;
 const int _DIRECTORY_LIST_STOP = 36;
 const int _DIRECTORY_RENAME = 37;
 const int _SSL_PROCESS_FILTER = 38;
+const int _FILE_MAP = 39;
 
 class _IOService {
   external static Future dispatch(int request, List data);
@@ -275,6 +275,46 @@ class FileTest {
     Expect.equals(len, file.openSync().readSync(len * 10).length);
   }
 
+  static void testMap() {
+    asyncStart();
+    String filename = getFilename("tests/vm/data/fixed_length_file");
+    File file = new File(filename);
+    List<int> expected = file.readAsBytesSync();
+    file.open().then((RandomAccessFile raf) {
+      return raf.setPosition(5)
+          .then((_) => raf.map(10))
+          .then((bytes) {
+            Expect.listEquals(expected.sublist(5, 15), bytes);
+            return raf.position();
+          })
+          .then((position) {
+            Expect.equals(15, position);
+            return raf.map(expected.length);
+          })
+          .then((bytes) {
+            Expect.listEquals(expected.sublist(15), bytes);
+            return raf.close();
+          });
+    }).then((_) => asyncEnd());
+  }
+
+  static void testMapSync() {
+    String filename = getFilename("tests/vm/data/fixed_length_file");
+    File file = new File(filename);
+    List<int> expected = file.readAsBytesSync();
+    RandomAccessFile raf = file.openSync();
+    Expect.listEquals(expected, raf.mapSync(expected.length * 2));
+    Expect.equals(expected.length, raf.positionSync());
+    Expect.equals(0, raf.mapSync(1).length);
+    raf.setPositionSync(1);
+    List<int> bytes = raf.mapSync(3);
+    Expect.listEquals(expected.sublist(1, 4), bytes);
+    // Writes stay private to the mapping.
+    bytes[0] = bytes[0] + 1;
+    raf.closeSync();
+    Expect.listEquals(expected, file.readAsBytesSync());
+  }
+
   // Test for file read and write functionality.
   static void testReadWrite() {
     asyncTestStarted();
@@ -1276,6 +1316,8 @@ class FileTest {
 
     testRead();
     testReadSync();
+    testMap();
+    testMapSync();
     testReadStream();
     testLengthSync();
     testPositionSync();